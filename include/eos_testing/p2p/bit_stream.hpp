@@ -0,0 +1,400 @@
+#pragma once
+
+/**
+ * EOS Testing - Bit Stream Serialization
+ *
+ * Header-only bit-packing writer and reader for gameplay messages:
+ * - Raw bit fields, bools, ranged integers and varints
+ * - Floats quantized to a range and bit count, vectors with one range
+ *   for all components, quaternions as "smallest three"
+ * - Bits collect in a 64-bit scratch word that is stored 32 bits at a
+ *   time, so the per-field cost is a few shifts and one rarely taken
+ *   branch
+ *
+ *   uint8_t packet[64];
+ *   BitWriter writer(packet, sizeof(packet));
+ *   writer.write_varint(tick);
+ *   writer.write_vec3(position, -512.0f, 512.0f, 18);
+ *   writer.write_quat(rotation, 10);
+ *   p2p.send_packet(peer, packet, writer.finish());
+ *
+ *   BitReader reader(view.data, view.size);
+ *   uint32_t tick = reader.read_varint();
+ *   Vec3 position = reader.read_vec3(-512.0f, 512.0f, 18);
+ *   Quat rotation = reader.read_quat(10);
+ *   if (reader.overflowed()) return;   // Truncated packet
+ *
+ * Both sides must use the same ranges and bit counts. Running out of
+ * room, or of data, sets a sticky overflowed() flag instead of failing
+ * every call; check it once at the end. Output is little-endian on every
+ * platform.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace eos_testing {
+
+struct Vec3 {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+struct Quat {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float w = 1.0f;
+};
+
+/**
+ * Bits needed to hold values 0..range
+ */
+constexpr uint32_t bits_required(uint32_t range) {
+    uint32_t bits = 0;
+    while (range > 0) {
+        bits++;
+        range >>= 1;
+    }
+    return bits;
+}
+
+namespace bit_stream_detail {
+
+constexpr uint32_t low_mask(uint32_t bits) {
+    return static_cast<uint32_t>((uint64_t(1) << bits) - 1);
+}
+
+// Smallest-three components lie within +/- 1/sqrt(2)
+constexpr float QUAT_COMPONENT_LIMIT = 0.70710678f;
+
+inline uint32_t quantize(float value, float min, float max, uint32_t bits) {
+    float steps = static_cast<float>(low_mask(bits));
+    float unit = (std::min(std::max(value, min), max) - min) / (max - min);
+    return static_cast<uint32_t>(unit * steps + 0.5f);
+}
+
+inline float dequantize(uint32_t value, float min, float max, uint32_t bits) {
+    float steps = static_cast<float>(low_mask(bits));
+    return min + static_cast<float>(value) * ((max - min) / steps);
+}
+
+} // namespace bit_stream_detail
+
+class BitWriter {
+public:
+    /**
+     * @param buffer Output; must stay valid until finish()
+     * @param capacity Bytes available in buffer
+     */
+    BitWriter(uint8_t* buffer, uint32_t capacity)
+        : m_buffer(buffer)
+        , m_capacity(capacity) {}
+
+    /**
+     * Write the low `bits` bits of value (1-32).
+     */
+    void write_bits(uint32_t value, uint32_t bits) {
+        m_scratch |= static_cast<uint64_t>(value & bit_stream_detail::low_mask(bits)) << m_scratch_bits;
+        m_scratch_bits += bits;
+        if (m_scratch_bits >= 32) store_word();
+    }
+
+    void write_bool(bool value) { write_bits(value ? 1u : 0u, 1); }
+
+    /**
+     * Write an integer in [min, max] using just the bits that range needs.
+     */
+    void write_int(int32_t value, int32_t min, int32_t max) {
+        uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min);
+        uint32_t clamped = static_cast<uint32_t>(std::min(std::max(value, min), max)) - static_cast<uint32_t>(min);
+        write_bits(clamped, std::max<uint32_t>(bits_required(range), 1));
+    }
+
+    /**
+     * Write an unsigned integer in 8-bit groups of [more][7 bits]:
+     * values below 128 take one group, a full uint32_t five.
+     */
+    void write_varint(uint32_t value) {
+        while (value >= 0x80) {
+            write_bits((value & 0x7F) | 0x80, 8);
+            value >>= 7;
+        }
+        write_bits(value, 8);
+    }
+
+    /**
+     * Write a signed varint; zigzag encoding keeps small negatives short.
+     */
+    void write_signed_varint(int32_t value) {
+        write_varint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+    /**
+     * Write a float at full precision.
+     */
+    void write_float(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write_bits(bits, 32);
+    }
+
+    /**
+     * Write a float clamped to [min, max] and rounded to one of
+     * 2^bits evenly spaced values (bits 1-24).
+     */
+    void write_float(float value, float min, float max, uint32_t bits) {
+        write_bits(bit_stream_detail::quantize(value, min, max, bits), bits);
+    }
+
+    void write_vec3(const Vec3& value, float min, float max, uint32_t bits) {
+        write_float(value.x, min, max, bits);
+        write_float(value.y, min, max, bits);
+        write_float(value.z, min, max, bits);
+    }
+
+    /**
+     * Write a unit quaternion as the index of its largest component plus
+     * the other three with `bits` bits each. q and -q are the same
+     * rotation, so the sign is chosen to make the dropped one positive.
+     */
+    void write_quat(const Quat& value, uint32_t bits) {
+        float components[4] = {value.x, value.y, value.z, value.w};
+        uint32_t largest = 0;
+        for (uint32_t i = 1; i < 4; i++) {
+            largest = std::fabs(components[i]) > std::fabs(components[largest]) ? i : largest;
+        }
+        float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        write_bits(largest, 2);
+        for (uint32_t i = 0; i < 4; i++) {
+            if (i == largest) continue;
+            write_float(components[i] * sign, -bit_stream_detail::QUAT_COMPONENT_LIMIT,
+                        bit_stream_detail::QUAT_COMPONENT_LIMIT, bits);
+        }
+    }
+
+    /**
+     * Write raw bytes (bit-aligned, not padded).
+     */
+    void write_bytes(const void* data, uint32_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (uint32_t i = 0; i < size; i++) write_bits(bytes[i], 8);
+    }
+
+    /**
+     * Write a string as a varint length and its bytes, truncated to max_length.
+     */
+    void write_string(const char* text, uint32_t max_length) {
+        uint32_t length = 0;
+        while (length < max_length && text[length] != '\0') length++;
+        write_varint(length);
+        write_bytes(text, length);
+    }
+
+    /**
+     * Store the bits still in the scratch word. Call once, after the last write.
+     *
+     * @return Total bytes written, or 0 if the buffer overflowed
+     */
+    uint32_t finish() {
+        uint32_t tail = (m_scratch_bits + 7) / 8;
+        if (m_size + tail > m_capacity) {
+            m_overflow = true;
+        } else {
+            for (uint32_t i = 0; i < tail; i++) {
+                m_buffer[m_size + i] = static_cast<uint8_t>(m_scratch >> (i * 8));
+            }
+        }
+        m_size += tail;
+        m_scratch = 0;
+        m_scratch_bits = 0;
+        return m_overflow ? 0 : m_size;
+    }
+
+    /**
+     * Bits written so far, including those not yet stored.
+     */
+    uint32_t bits_written() const { return m_size * 8 + m_scratch_bits; }
+
+    bool overflowed() const { return m_overflow; }
+
+private:
+    void store_word() {
+        if (m_size + 4 <= m_capacity) {
+            // Through a local: byte stores may alias our members, which
+            // would otherwise be reloaded after each one
+            uint8_t* out = m_buffer + m_size;
+            uint32_t word = static_cast<uint32_t>(m_scratch);
+            out[0] = static_cast<uint8_t>(word);
+            out[1] = static_cast<uint8_t>(word >> 8);
+            out[2] = static_cast<uint8_t>(word >> 16);
+            out[3] = static_cast<uint8_t>(word >> 24);
+        } else {
+            m_overflow = true;
+        }
+        m_size += 4;
+        m_scratch >>= 32;
+        m_scratch_bits -= 32;
+    }
+
+    uint8_t* m_buffer;
+    uint32_t m_capacity;
+    uint32_t m_size = 0;            // Bytes stored from the scratch word
+    uint64_t m_scratch = 0;
+    uint32_t m_scratch_bits = 0;
+    bool m_overflow = false;
+};
+
+class BitReader {
+public:
+    /**
+     * @param data Bytes written by BitWriter; must stay valid while reading
+     * @param size Byte count
+     */
+    BitReader(const uint8_t* data, uint32_t size)
+        : m_data(data)
+        , m_size(size) {}
+
+    /**
+     * Read `bits` bits (1-32). Past the end this returns zeros and sets overflowed().
+     */
+    uint32_t read_bits(uint32_t bits) {
+        if (m_scratch_bits < bits) load_word(bits);
+        uint32_t value = static_cast<uint32_t>(m_scratch) & bit_stream_detail::low_mask(bits);
+        m_scratch >>= bits;
+        m_scratch_bits -= bits;
+        return value;
+    }
+
+    bool read_bool() { return read_bits(1) != 0; }
+
+    int32_t read_int(int32_t min, int32_t max) {
+        uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min);
+        uint32_t value = read_bits(std::max<uint32_t>(bits_required(range), 1));
+        // A corrupt value may exceed the range; clamp so callers can trust it
+        return static_cast<int32_t>(std::min(value, range) + static_cast<uint32_t>(min));
+    }
+
+    uint32_t read_varint() {
+        uint32_t value = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7) {
+            uint32_t group = read_bits(8);
+            value |= (group & 0x7F) << shift;
+            if (!(group & 0x80)) return value;
+        }
+        m_overflow = true;      // More than five groups: not ours
+        return value;
+    }
+
+    int32_t read_signed_varint() {
+        uint32_t value = read_varint();
+        return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+    }
+
+    float read_float() {
+        uint32_t bits = read_bits(32);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    float read_float(float min, float max, uint32_t bits) {
+        return bit_stream_detail::dequantize(read_bits(bits), min, max, bits);
+    }
+
+    Vec3 read_vec3(float min, float max, uint32_t bits) {
+        Vec3 value;
+        value.x = read_float(min, max, bits);
+        value.y = read_float(min, max, bits);
+        value.z = read_float(min, max, bits);
+        return value;
+    }
+
+    Quat read_quat(uint32_t bits) {
+        uint32_t largest = read_bits(2);
+        float components[4];
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < 4; i++) {
+            if (i == largest) continue;
+            components[i] = read_float(-bit_stream_detail::QUAT_COMPONENT_LIMIT,
+                                       bit_stream_detail::QUAT_COMPONENT_LIMIT, bits);
+            sum += components[i] * components[i];
+        }
+        components[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+
+        Quat value;
+        value.x = components[0];
+        value.y = components[1];
+        value.z = components[2];
+        value.w = components[3];
+        return value;
+    }
+
+    void read_bytes(void* out, uint32_t size) {
+        uint8_t* bytes = static_cast<uint8_t*>(out);
+        for (uint32_t i = 0; i < size; i++) bytes[i] = static_cast<uint8_t>(read_bits(8));
+    }
+
+    /**
+     * Read a string written by write_string into out (NUL-terminated).
+     *
+     * @param capacity Size of out, including the terminator
+     * @return false if it didn't fit (out holds the truncated string)
+     */
+    bool read_string(char* out, uint32_t capacity) {
+        uint32_t length = read_varint();
+        if (length > bits_remaining() / 8) {
+            m_overflow = true;
+            length = 0;
+        }
+
+        uint32_t kept = capacity > 0 ? std::min(length, capacity - 1) : 0;
+        read_bytes(out, kept);
+        for (uint32_t i = kept; i < length; i++) read_bits(8);
+        if (capacity > 0) out[kept] = '\0';
+        return kept == length;
+    }
+
+    /**
+     * Bits left before the end of the data.
+     */
+    uint32_t bits_remaining() const { return (m_size - m_offset) * 8 + m_scratch_bits; }
+
+    bool overflowed() const { return m_overflow; }
+
+private:
+    void load_word(uint32_t bits) {
+        if (m_offset + 4 <= m_size) {
+            const uint8_t* in = m_data + m_offset;
+            uint32_t word = static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+                            (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+            m_scratch |= static_cast<uint64_t>(word) << m_scratch_bits;
+            m_scratch_bits += 32;
+            m_offset += 4;
+            return;
+        }
+
+        // The last few bytes
+        while (m_offset < m_size) {
+            m_scratch |= static_cast<uint64_t>(m_data[m_offset++]) << m_scratch_bits;
+            m_scratch_bits += 8;
+        }
+        if (m_scratch_bits < bits) {
+            m_overflow = true;
+            m_scratch_bits = bits;      // Zero bits past the end
+        }
+    }
+
+    const uint8_t* m_data;
+    uint32_t m_size;
+    uint32_t m_offset = 0;
+    uint64_t m_scratch = 0;
+    uint32_t m_scratch_bits = 0;
+    bool m_overflow = false;
+};
+
+} // namespace eos_testing
@@ -0,0 +1,134 @@
+#pragma once
+
+/**
+ * EOS Testing - Payload Compression
+ *
+ * A small LZ77 codec for packet-sized payloads, bundled so there is no
+ * external dependency:
+ * - LZ4-style sequences: a token with 4-bit literal and match lengths,
+ *   the literals, a 16-bit offset, and length extensions past 15
+ * - Greedy single-probe hash matching; no entropy stage, so both
+ *   directions run at memory speed
+ * - An optional dictionary acts as history in front of every payload.
+ *   Short messages that repeat the same keys and phrasing (chat, lobby
+ *   sync) then compress even when a packet alone has nothing to match.
+ *
+ * P2PManager applies it per channel through P2PConfig::channel_compression.
+ * Train a dictionary from captured payloads:
+ *
+ *   auto dictionary = std::make_shared<CompressionDictionary>(
+ *       CompressionDictionary::train(captured_chat_payloads));
+ *   config.channel_compression.resize(3);
+ *   config.channel_compression[2] = {CompressionMode::Dictionary, dictionary};
+ *
+ * Both ends must configure the same dictionary for a channel; its id is
+ * checked on receive.
+ */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace eos_testing {
+
+enum class CompressionMode : uint8_t {
+    None = 0,
+    Fast = 1,           // LZ on the payload alone
+    Dictionary = 2      // LZ with the channel's dictionary as history
+};
+
+/**
+ * Shared history for CompressionMode::Dictionary, with a prebuilt match
+ * index so compressing doesn't rescan it for every packet.
+ */
+class CompressionDictionary {
+public:
+    static constexpr uint32_t MAX_SIZE = 65535;     // Reachable by a 16-bit offset
+    static constexpr uint32_t INDEX_BITS = 12;
+
+    CompressionDictionary() = default;
+
+    /**
+     * @param content Dictionary bytes; only the last MAX_SIZE are kept
+     */
+    explicit CompressionDictionary(std::vector<uint8_t> content);
+
+    /**
+     * Build a dictionary from sample payloads: the segments whose 8-byte
+     * substrings occur in the most samples, best last (closest to the
+     * data, so cheapest to reference).
+     *
+     * @param samples Typical payloads for one channel
+     * @param max_size Dictionary size in bytes
+     */
+    static CompressionDictionary train(const std::vector<std::vector<uint8_t>>& samples, uint32_t max_size = 4096);
+
+    const std::vector<uint8_t>& content() const { return m_content; }
+
+    // Match index used by lz_compress (position + 1 by 4-byte hash, 0 = none)
+    const std::vector<uint16_t>& index() const { return m_index; }
+
+    // Hash of the content, to detect mismatched dictionaries
+    uint32_t id() const { return m_id; }
+
+    bool empty() const { return m_content.empty(); }
+
+private:
+    std::vector<uint8_t> m_content;
+    std::vector<uint16_t> m_index;
+    uint32_t m_id = 0;
+};
+
+/**
+ * Per-channel setting (P2PConfig::channel_compression)
+ */
+struct ChannelCompression {
+    CompressionMode mode = CompressionMode::None;
+    std::shared_ptr<const CompressionDictionary> dictionary;    // For Dictionary mode
+};
+
+/**
+ * P2PManager compression counters
+ */
+struct CompressionStats {
+    uint64_t frames_compressed = 0;
+    uint64_t frames_incompressible = 0;     // Sent as-is: compressing didn't make them smaller
+    uint64_t bytes_in = 0;                  // Before compression (compressed frames only)
+    uint64_t bytes_out = 0;                 // After, headers included
+    uint64_t frames_decompressed = 0;
+    uint64_t decompress_failures = 0;       // Corrupt, or dictionary missing or different
+};
+
+/**
+ * Largest output lz_compress can produce for `size` input bytes.
+ */
+constexpr uint32_t lz_compress_bound(uint32_t size) {
+    return size + size / 255 + 16;
+}
+
+/**
+ * Compress a payload.
+ *
+ * @param dictionary History to match against (nullptr for none)
+ * @return Compressed size, or 0 if it doesn't fit in capacity
+ */
+uint32_t lz_compress(const uint8_t* source,
+                     uint32_t size,
+                     uint8_t* destination,
+                     uint32_t capacity,
+                     const CompressionDictionary* dictionary = nullptr);
+
+/**
+ * Decompress a payload from lz_compress.
+ *
+ * @param dictionary The dictionary it was compressed with (nullptr for none)
+ * @return Decompressed size, or 0 if the input is malformed or needs
+ *         more than capacity bytes
+ */
+uint32_t lz_decompress(const uint8_t* source,
+                       uint32_t size,
+                       uint8_t* destination,
+                       uint32_t capacity,
+                       const CompressionDictionary* dictionary = nullptr);
+
+} // namespace eos_testing
@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * EOS Testing - Congestion Control
+ *
+ * Adapts one peer's send rate to what the path carries, AIMD style, so a
+ * degrading relay slows the sender down instead of filling queues:
+ * - Round trips from the link quality probes give a base RTT (the
+ *   shortest in the last base_rtt_window_us, i.e. the path with empty
+ *   queues) and a queuing delay, the recent RTT above it. A queuing delay
+ *   over delay_threshold_us counts as congestion, so the rate usually
+ *   backs off before anything is lost.
+ * - Lost probes and a growing transport send queue count as congestion too
+ * - Congestion multiplies the rate by decrease_factor (by half when the
+ *   queuing delay is past four times the threshold, as after slow start
+ *   overshoots), at most once per response time: RTT plus probe
+ *   interval, the soonest a change can show up. After a cut for delay,
+ *   the queue has to drain by half the threshold per response time or
+ *   the rate is cut again.
+ * - Otherwise the rate doubles per response time until the first
+ *   congestion or half the delay threshold (slow start), then grows by
+ *   increase_bytes_per_second each second. Unlike TCP's one packet per
+ *   round trip this doesn't depend on RTT, so a short path doesn't
+ *   overshoot more.
+ * - It only grows while the peer actually uses it, so an idle peer's
+ *   rate doesn't climb to a level never tested against the path
+ *
+ * P2PManager runs one per peer with P2PConfig::congestion_control and
+ * applies the rate as the peer's send budget:
+ *
+ *   config.congestion_control = true;
+ *   ...
+ *   if (auto congestion = p2p.get_congestion_stats(peer_id)) {
+ *       hud.show(congestion->rate_bytes_per_second, congestion->queuing_delay_ms);
+ *   }
+ *
+ * The class itself is plain arithmetic on microsecond timestamps, so it
+ * can be driven directly with any clock.
+ */
+
+#include <cstdint>
+
+namespace eos_testing {
+
+/**
+ * Congestion control state for a peer (P2PManager::get_congestion_stats)
+ */
+struct CongestionStats {
+    uint32_t rate_bytes_per_second = 0;         // Send budget
+    uint32_t send_rate_bytes_per_second = 0;    // Measured, smoothed
+    float base_rtt_ms = 0.0f;                   // Shortest recent RTT (0 until measured)
+    float queuing_delay_ms = 0.0f;              // Recent RTT above the base
+    bool slow_start = true;
+    bool app_limited = false;                   // Using too little of the rate to raise it
+    uint64_t loss_events = 0;
+    uint64_t delay_events = 0;
+    uint64_t backlog_events = 0;                // Transport send queue over the limit and growing
+    uint64_t decreases = 0;                     // Congestion events that cut the rate
+};
+
+class CongestionController {
+public:
+    struct Settings {
+        uint32_t min_bytes_per_second = 4 * 1024;
+        uint32_t initial_bytes_per_second = 32 * 1024;
+        uint32_t max_bytes_per_second = 1024 * 1024;
+        uint32_t increase_bytes_per_second = 16 * 1024; // Added to the rate per second
+        float decrease_factor = 0.7f;
+        uint32_t delay_threshold_us = 25000;            // Queuing delay that counts as congestion
+        uint32_t probe_interval_us = 100000;            // Time between RTT samples
+        uint32_t base_rtt_window_us = 10000000;
+    };
+
+    CongestionController() = default;
+    explicit CongestionController(const Settings& settings) : m_settings(settings) {}
+
+    /**
+     * Start over at the initial rate.
+     */
+    void reset(uint64_t now_us);
+
+    /**
+     * A probe's round trip came back.
+     */
+    void on_rtt_sample(uint32_t rtt_us, uint64_t now_us);
+
+    /**
+     * A probe was lost.
+     */
+    void on_loss(uint64_t now_us);
+
+    /**
+     * The transport's send queue is over its limit and still growing.
+     */
+    void on_backlog(uint64_t now_us);
+
+    /**
+     * Advance the rate. Call regularly (P2PManager does every tick).
+     *
+     * @param bytes_sent Bytes handed to the transport since the last update
+     * @param bytes_queued Bytes waiting for budget in the send scheduler
+     */
+    void update(uint64_t bytes_sent, uint32_t bytes_queued, uint64_t now_us);
+
+    uint32_t rate() const { return static_cast<uint32_t>(m_rate); }
+
+    CongestionStats get_stats() const;
+
+private:
+    // Cut the rate unless it was cut within the last response time
+    bool decrease(uint64_t now_us);
+    uint64_t response_time_us() const;
+    uint32_t base_rtt_us() const;
+    uint32_t queuing_delay_us() const;
+
+    Settings m_settings;
+
+    double m_rate = 0.0;
+    double m_send_rate = 0.0;
+    bool m_slow_start = true;
+    bool m_app_limited = false;
+    uint64_t m_last_update_us = 0;
+    uint64_t m_last_decrease_us = 0;
+    bool m_has_decreased = false;
+
+    // Base RTT: minimum over the current and previous half window
+    uint32_t m_base_rtt_us[2] = {0, 0};
+    uint64_t m_base_rtt_started_us = 0;
+
+    uint32_t m_srtt_us = 0;             // Smoothed, for the response time
+    uint32_t m_recent_rtt_us = 0;       // Lower of the last two samples
+    uint32_t m_last_sample_us = 0;
+    uint32_t m_delay_reference_us = 0;  // Queuing delay the next sample must drain from
+    uint64_t m_delay_reference_at_us = 0;
+
+    CongestionStats m_stats;
+};
+
+} // namespace eos_testing
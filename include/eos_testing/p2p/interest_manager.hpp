@@ -0,0 +1,194 @@
+#pragma once
+
+/**
+ * EOS Testing - Interest Management
+ *
+ * Decides, per tick, which entities each peer hears about and how often,
+ * so a lobby's traffic grows with what each player can see rather than
+ * with players squared:
+ * - Entities and peers' viewpoints have a 2D position (use the ground
+ *   plane). A uniform grid finds the entities within view_radius of each
+ *   viewpoint without looking at the rest.
+ * - Distance gives the relevance: High within high_radius (every tick),
+ *   Medium within medium_radius, Low out to view_radius, and None (not
+ *   sent at all) beyond
+ * - A per-peer callback may override it, e.g. Low for occluded entities,
+ *   High for teammates, None for hidden ones
+ * - Medium and Low entities are due every medium_interval / low_interval
+ *   ticks, staggered by entity id so the load is spread evenly
+ *
+ * SnapshotReplicator::set_interest() applies the result to snapshots:
+ *
+ *   InterestManager interest;
+ *   replicator.set_interest(&interest);
+ *
+ *   // Authority, every tick
+ *   interest.set_entity(player_id, x, y);
+ *   interest.set_peer(peer_id, view_x, view_y);
+ *   interest.update();
+ *   replicator.commit();
+ *   replicator.broadcast();
+ *
+ * For one-off messages about an entity (sounds, hit effects), send to
+ * get_interested_peers() instead of broadcasting. Not thread-safe; use
+ * from the game thread.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "eos_testing/p2p/transport.hpp"
+
+namespace eos_testing {
+
+enum class Relevance : uint8_t {
+    None = 0,       // Not sent
+    Low = 1,        // Every low_interval ticks
+    Medium = 2,     // Every medium_interval ticks
+    High = 3        // Every tick
+};
+
+/**
+ * An entity in a peer's interest set
+ */
+struct InterestEntry {
+    uint16_t id = 0;
+    Relevance relevance = Relevance::None;
+    bool due = false;       // Its update goes out this tick
+};
+
+/**
+ * Counters from the last update()
+ */
+struct InterestStats {
+    uint32_t peers = 0;
+    uint32_t entities = 0;
+    uint64_t entries = 0;       // Interest set sizes, summed over peers
+    uint64_t due = 0;           // Of which due this tick
+    uint64_t candidates = 0;    // Entities looked at by the grid queries
+    uint32_t tick = 0;
+};
+
+class InterestManager {
+public:
+    struct Settings {
+        float cell_size = 64.0f;        // Grid cell edge; about the medium radius works well
+        float high_radius = 32.0f;
+        float medium_radius = 96.0f;
+        float view_radius = 256.0f;
+        uint32_t medium_interval = 3;   // Ticks between updates
+        uint32_t low_interval = 10;
+    };
+
+    /**
+     * Relevance of an entity to a peer.
+     *
+     * @param peer The peer
+     * @param entity The entity
+     * @param spatial Relevance by distance (at least Low for
+     *        always-relevant entities)
+     */
+    using RelevanceCallback = std::function<Relevance(EOS_ProductUserId peer, uint16_t entity, Relevance spatial)>;
+
+    InterestManager() = default;
+    explicit InterestManager(const Settings& settings) : m_settings(settings) {}
+
+    /**
+     * Add or move an entity.
+     */
+    void set_entity(uint16_t id, float x, float y);
+
+    void remove_entity(uint16_t id);
+
+    /**
+     * Send an entity to every peer regardless of distance (game state,
+     * scores). Its relevance is the spatial one, at least Low.
+     */
+    void set_always_relevant(uint16_t id, bool always);
+
+    /**
+     * Add or move a peer's viewpoint.
+     */
+    void set_peer(EOS_ProductUserId peer, float x, float y);
+
+    /**
+     * Override relevance for one peer (nullptr to remove). Called for
+     * every entity in view and every always-relevant entity.
+     */
+    void set_peer_callback(EOS_ProductUserId peer, RelevanceCallback callback);
+
+    /**
+     * Forget a disconnected peer.
+     */
+    void remove_peer(EOS_ProductUserId peer);
+
+    /**
+     * Recompute every peer's interest set for the next tick.
+     */
+    void update();
+
+    /**
+     * A peer's interest set from the last update(), sorted by id. Empty
+     * for peers without a viewpoint.
+     */
+    const std::vector<InterestEntry>& get_interest(EOS_ProductUserId peer) const;
+
+    /**
+     * Relevance of an entity to a peer as of the last update().
+     */
+    Relevance get_relevance(EOS_ProductUserId peer, uint16_t id) const;
+
+    /**
+     * Peers that had an entity in their interest set at the last update().
+     *
+     * @param id The entity
+     * @param min_relevance Leave out peers for which it is less relevant
+     * @param out Replaced with the peers
+     */
+    void get_interested_peers(uint16_t id, Relevance min_relevance, std::vector<EOS_ProductUserId>& out) const;
+
+    /**
+     * Whether an entity at this relevance was due on any of the last
+     * `ticks` updates, for a sender that skipped some of them.
+     */
+    bool was_due(uint16_t id, Relevance relevance, uint32_t ticks) const;
+
+    const Settings& get_settings() const { return m_settings; }
+    const InterestStats& get_stats() const { return m_stats; }
+
+private:
+    struct Entity {
+        float x = 0.0f;
+        float y = 0.0f;
+        uint64_t cell = 0;
+        bool active = false;
+        bool always_relevant = false;
+    };
+
+    struct Peer {
+        float x = 0.0f;
+        float y = 0.0f;
+        RelevanceCallback callback;
+        std::vector<InterestEntry> entries;
+    };
+
+    uint64_t cell_of(float x, float y) const;
+    void remove_from_cell(uint16_t id, uint64_t cell);
+    uint32_t interval_of(Relevance relevance) const;
+
+    Settings m_settings;
+
+    std::vector<Entity> m_entities;     // By id
+    std::unordered_map<uint64_t, std::vector<uint16_t>> m_cells;
+    std::vector<uint16_t> m_always_relevant;
+    uint32_t m_entity_count = 0;
+
+    std::unordered_map<EOS_ProductUserId, Peer> m_peers;
+    uint32_t m_tick = 0;
+
+    InterestStats m_stats;
+};
+
+} // namespace eos_testing
@@ -0,0 +1,412 @@
+#pragma once
+
+/**
+ * EOS Testing - Jitter Buffer and Snapshot Interpolation
+ *
+ * Holds timestamped snapshots from one peer and plays them back a little
+ * behind real time, so state is rendered smoothly however unevenly the
+ * packets arrive:
+ * - Snapshots are kept in timestamp order; late, duplicate and
+ *   out-of-order arrivals are sorted in or dropped
+ * - The playout delay adapts to the link: it covers on_time_fraction of
+ *   recent arrival delays, plus one snapshot interval so there is always
+ *   a next snapshot to interpolate toward. Changes are applied by playing
+ *   up to max_rate_change faster or slower, never by jumping back.
+ * - Entities are interpolated between the two snapshots around the
+ *   render time. Past the newest snapshot they are extrapolated for at
+ *   most max_extrapolation_us, then held.
+ *
+ *   JitterBuffer<Transform> buffer(interpolate_transform);
+ *
+ *   // On every snapshot (timestamps in the sender's clock, e.g. server
+ *   // time, arrivals in ours)
+ *   buffer.push(snapshot_time_us, p2p.get_server_time_us(), entities.data(), count);
+ *
+ *   // Every frame
+ *   uint64_t render_time = buffer.advance(p2p.get_server_time_us());
+ *   buffer.sample_all(render_time, interpolated);
+ *
+ * Use one buffer per peer. Storage is sized up front (reserve_entities)
+ * or by the largest snapshot so far; after that push, advance and
+ * sample_all into a reused vector don't allocate. Not thread-safe.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "eos_testing/p2p/bit_stream.hpp"
+
+namespace eos_testing {
+
+struct JitterBufferSettings {
+    uint32_t capacity = 32;                 // Snapshots held
+    float on_time_fraction = 0.95f;         // Of arrivals the delay covers
+    uint32_t safety_margin_us = 2000;       // Added to the delay
+    uint32_t max_jitter_us = 250000;        // Most delay added for jitter
+    uint32_t max_extrapolation_us = 100000;
+    float max_rate_change = 0.05f;          // Playout speed range while the delay adapts
+    uint32_t step_threshold_us = 100000;    // Larger delay changes are applied at once
+};
+
+/**
+ * Jitter buffer counters
+ */
+struct JitterStats {
+    uint64_t snapshots_received = 0;
+    uint64_t snapshots_late = 0;        // Arrived after their time had been rendered
+    uint64_t snapshots_dropped = 0;     // Too old to use, duplicates, or evicted
+    uint64_t frames_rendered = 0;       // advance() calls
+    uint64_t frames_extrapolated = 0;   // Rendered past the newest snapshot
+    uint64_t frames_held = 0;           // Past the extrapolation limit
+    int64_t delay_us = 0;               // Our time minus render time, as applied
+    int64_t target_delay_us = 0;
+    uint32_t jitter_us = 0;             // Covered arrival delay above the fastest
+    uint32_t interval_us = 0;           // Average time between recent snapshots
+    uint32_t buffered = 0;
+};
+
+/**
+ * Adaptive playout delay: turns arrival times into a smooth render time.
+ * Used by JitterBuffer; usable alone for streams that buffer elsewhere.
+ */
+class PlayoutClock {
+public:
+    static constexpr uint32_t WINDOW = 64;     // Arrivals the delay is computed over
+    static constexpr uint32_t SETTLE_ARRIVALS = 8;
+
+    explicit PlayoutClock(const JitterBufferSettings& settings = JitterBufferSettings()) : m_settings(settings) {}
+
+    void reset();
+
+    /**
+     * Record an arrival.
+     *
+     * @param timestamp_us Sender's timestamp of the snapshot
+     * @param arrival_us When it arrived (our clock)
+     */
+    void on_arrival(uint64_t timestamp_us, uint64_t arrival_us);
+
+    /**
+     * Sender time to render at our time now_us. Never goes backwards.
+     */
+    uint64_t render_time(uint64_t now_us);
+
+    bool is_started() const { return m_arrivals > 0; }
+    void fill_stats(JitterStats& stats) const;
+
+private:
+    JitterBufferSettings m_settings;
+
+    int64_t m_transit[WINDOW] = {};     // Arrival minus timestamp
+    uint64_t m_timestamps[WINDOW] = {};
+    uint64_t m_arrivals = 0;
+    uint32_t m_interval_us = 0;
+    uint32_t m_jitter_us = 0;
+
+    int64_t m_target_delay = 0;
+    int64_t m_delay = 0;
+    uint64_t m_last_now = 0;
+    uint64_t m_last_render = 0;
+    bool m_rendering = false;
+};
+
+// ============================================================================
+// Interpolation helpers. t runs from 0 (from) to 1 (to); above 1 extrapolates.
+// ============================================================================
+
+inline float lerp(float from, float to, float t) {
+    return from + (to - from) * t;
+}
+
+inline Vec3 lerp(const Vec3& from, const Vec3& to, float t) {
+    return {lerp(from.x, to.x, t), lerp(from.y, to.y, t), lerp(from.z, to.z, t)};
+}
+
+/**
+ * Normalized lerp along the shorter arc; close to slerp for the small
+ * angles between snapshots, and much cheaper.
+ */
+inline Quat nlerp(const Quat& from, const Quat& to, float t) {
+    float dot = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+    float sign = dot < 0.0f ? -1.0f : 1.0f;
+    Quat q = {lerp(from.x, sign * to.x, t), lerp(from.y, sign * to.y, t),
+              lerp(from.z, sign * to.z, t), lerp(from.w, sign * to.w, t)};
+    float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    if (length <= 0.0f) return from;
+    return {q.x / length, q.y / length, q.z / length, q.w / length};
+}
+
+template <typename T>
+class JitterBuffer {
+public:
+    struct Entity {
+        uint16_t id = 0;
+        T state{};
+    };
+
+    using Interpolate = std::function<T(const T& from, const T& to, float t)>;
+
+    /**
+     * @param interpolate Blends two states; must accept t above 1
+     * @param settings Delay and extrapolation limits
+     * @param reserve_entities Entities per snapshot to allocate for now
+     */
+    explicit JitterBuffer(Interpolate interpolate,
+                          const JitterBufferSettings& settings = JitterBufferSettings(),
+                          uint32_t reserve_entities = 0)
+        : m_interpolate(std::move(interpolate))
+        , m_settings(settings)
+        , m_clock(settings)
+        , m_frames(std::max<uint32_t>(settings.capacity, 2)) {
+        m_order.reserve(m_frames.size());
+        m_free.reserve(m_frames.size());
+        reserve(reserve_entities);
+        clear();
+    }
+
+    void clear() {
+        m_order.clear();
+        m_free.clear();
+        for (uint32_t slot = 0; slot < m_frames.size(); slot++) m_free.push_back(slot);
+        m_clock.reset();
+        m_render_time = 0;
+    }
+
+    /**
+     * Add a snapshot. Entities needn't be sorted.
+     *
+     * @param timestamp_us Sender's timestamp
+     * @param arrival_us Arrival time, in the clock later passed to advance()
+     * @return false if it was dropped (duplicate or too old)
+     */
+    bool push(uint64_t timestamp_us, uint64_t arrival_us, const Entity* entities, uint32_t count) {
+        m_stats.snapshots_received++;
+        bool late = m_clock.is_started() && timestamp_us < m_render_time;
+        if (late) m_stats.snapshots_late++;
+        m_clock.on_arrival(timestamp_us, arrival_us);
+
+        auto position = std::lower_bound(m_order.begin(), m_order.end(), timestamp_us,
+                                         [this](uint32_t index, uint64_t key) { return m_frames[index].timestamp < key; });
+        bool duplicate = position != m_order.end() && m_frames[*position].timestamp == timestamp_us;
+
+        // Older than the frame being rendered from: no use any more
+        bool stale = late && position == m_order.begin() && !m_order.empty();
+        if (duplicate || stale) {
+            m_stats.snapshots_dropped++;
+            return false;
+        }
+
+        uint32_t slot;
+        if (!m_free.empty()) {
+            slot = m_free.back();
+            m_free.pop_back();
+        } else {
+            // Full: evict the oldest, unless this is older still
+            if (position == m_order.begin()) {
+                m_stats.snapshots_dropped++;
+                return false;
+            }
+            size_t index = position - m_order.begin();
+            slot = m_order.front();
+            m_order.erase(m_order.begin());
+            position = m_order.begin() + (index - 1);
+            m_stats.snapshots_dropped++;
+        }
+
+        // Every slot at once, so a later burst doesn't find one unsized
+        if (count > m_reserved) reserve(count);
+
+        Frame& frame = m_frames[slot];
+        frame.timestamp = timestamp_us;
+        frame.entities.assign(entities, entities + count);
+        auto by_id = [](const Entity& a, const Entity& b) { return a.id < b.id; };
+        if (!std::is_sorted(frame.entities.begin(), frame.entities.end(), by_id)) {
+            std::sort(frame.entities.begin(), frame.entities.end(), by_id);
+        }
+        m_order.insert(position, slot);
+        return true;
+    }
+
+    bool push(uint64_t timestamp_us, uint64_t arrival_us, const std::vector<Entity>& entities) {
+        return push(timestamp_us, arrival_us, entities.data(), static_cast<uint32_t>(entities.size()));
+    }
+
+    /**
+     * Move playout forward to our time now_us and drop snapshots no
+     * longer needed. Call once per frame.
+     *
+     * @return Render time, in the sender's clock (0 before any snapshot)
+     */
+    uint64_t advance(uint64_t now_us) {
+        if (!m_clock.is_started()) return 0;
+        m_render_time = m_clock.render_time(now_us);
+        m_stats.frames_rendered++;
+
+        // Keep the last snapshot at or before the render time, and at least two
+        while (m_order.size() > 2 && m_frames[m_order[1]].timestamp <= m_render_time) {
+            m_free.push_back(m_order.front());
+            m_order.erase(m_order.begin());
+        }
+
+        uint64_t newest = m_order.empty() ? 0 : m_frames[m_order.back()].timestamp;
+        if (!m_order.empty() && m_render_time > newest) {
+            m_stats.frames_extrapolated++;
+            if (m_render_time - newest > m_settings.max_extrapolation_us) m_stats.frames_held++;
+        }
+        return m_render_time;
+    }
+
+    /**
+     * One entity's state at a render time.
+     *
+     * @return false if it isn't in the buffered snapshots at that time
+     */
+    bool sample(uint64_t time_us, uint16_t id, T& out) const {
+        Bracket bracket;
+        if (!find_bracket(time_us, bracket)) return false;
+
+        if (bracket.extrapolating) {
+            const Entity* newest = find(*bracket.to, id);
+            if (!newest) return false;
+            const Entity* previous = find(*bracket.from, id);
+            out = previous ? m_interpolate(previous->state, newest->state, bracket.t) : newest->state;
+            return true;
+        }
+
+        const Entity* from = find(*bracket.from, id);
+        if (!from) return false;
+        const Entity* to = bracket.to ? find(*bracket.to, id) : nullptr;
+        out = to ? m_interpolate(from->state, to->state, bracket.t) : from->state;
+        return true;
+    }
+
+    /**
+     * Every entity's state at a render time. Entities that disappear in
+     * the next snapshot are held; ones that appear in it aren't out yet.
+     * Past the newest snapshot, its entities are extrapolated.
+     *
+     * @param out Replaced; keeps its capacity between calls
+     * @return Number of entities
+     */
+    uint32_t sample_all(uint64_t time_us, std::vector<Entity>& out) const {
+        out.clear();
+        Bracket bracket;
+        if (!find_bracket(time_us, bracket)) return 0;
+
+        const auto& from = bracket.from->entities;
+        if (!bracket.to) {
+            out.assign(from.begin(), from.end());
+            return static_cast<uint32_t>(out.size());
+        }
+
+        // Both sorted by id: walk them together, along the one whose
+        // entities are out at this time
+        const auto& to = bracket.to->entities;
+        const auto& present = bracket.extrapolating ? to : from;
+        const auto& other = bracket.extrapolating ? from : to;
+        size_t j = 0;
+        for (const auto& entity : present) {
+            while (j < other.size() && other[j].id < entity.id) j++;
+            Entity result;
+            result.id = entity.id;
+            result.state = entity.state;
+            if (j < other.size() && other[j].id == entity.id) {
+                result.state = bracket.extrapolating ? m_interpolate(other[j].state, entity.state, bracket.t)
+                                                     : m_interpolate(entity.state, other[j].state, bracket.t);
+            }
+            out.push_back(result);
+        }
+        return static_cast<uint32_t>(out.size());
+    }
+
+    /**
+     * Timestamp of the newest buffered snapshot (0 if none).
+     */
+    uint64_t newest_timestamp() const {
+        return m_order.empty() ? 0 : m_frames[m_order.back()].timestamp;
+    }
+
+    JitterStats get_stats() const {
+        JitterStats stats = m_stats;
+        m_clock.fill_stats(stats);
+        stats.buffered = static_cast<uint32_t>(m_order.size());
+        return stats;
+    }
+
+private:
+    struct Frame {
+        uint64_t timestamp = 0;
+        std::vector<Entity> entities;   // Sorted by id
+    };
+
+    // Snapshots to blend at a time: to is null when from is used as is.
+    // When extrapolating, to is the newest and its entities are the ones out.
+    struct Bracket {
+        const Frame* from = nullptr;
+        const Frame* to = nullptr;
+        float t = 0.0f;
+        bool extrapolating = false;
+    };
+
+    void reserve(uint32_t entities) {
+        for (auto& frame : m_frames) frame.entities.reserve(entities);
+        m_reserved = std::max(m_reserved, entities);
+    }
+
+    static const Entity* find(const Frame& frame, uint16_t id) {
+        auto it = std::lower_bound(frame.entities.begin(), frame.entities.end(), id,
+                                   [](const Entity& entity, uint16_t key) { return entity.id < key; });
+        return it != frame.entities.end() && it->id == id ? &*it : nullptr;
+    }
+
+    bool find_bracket(uint64_t time_us, Bracket& bracket) const {
+        if (m_order.empty()) return false;
+
+        // First snapshot after the time
+        auto next = std::upper_bound(m_order.begin(), m_order.end(), time_us,
+                                     [this](uint64_t key, uint32_t index) { return key < m_frames[index].timestamp; });
+        if (next == m_order.begin()) {
+            bracket.from = &m_frames[*next];    // Before everything buffered: hold the oldest
+            return true;
+        }
+
+        if (next != m_order.end()) {
+            const Frame& from = m_frames[*(next - 1)];
+            const Frame& to = m_frames[*next];
+            bracket.from = &from;
+            bracket.to = &to;
+            bracket.t = static_cast<float>(time_us - from.timestamp) / static_cast<float>(to.timestamp - from.timestamp);
+            return true;
+        }
+
+        // Past the newest: extrapolate from the last two, up to the limit
+        const Frame& newest = m_frames[m_order.back()];
+        bracket.from = &newest;
+        if (m_order.size() < 2) return true;
+
+        const Frame& previous = m_frames[m_order[m_order.size() - 2]];
+        uint64_t ahead = std::min<uint64_t>(time_us - newest.timestamp, m_settings.max_extrapolation_us);
+        bracket.from = &previous;
+        bracket.to = &newest;
+        bracket.extrapolating = true;
+        bracket.t = 1.0f + static_cast<float>(ahead) / static_cast<float>(newest.timestamp - previous.timestamp);
+        return true;
+    }
+
+    Interpolate m_interpolate;
+    JitterBufferSettings m_settings;
+    PlayoutClock m_clock;
+
+    std::vector<Frame> m_frames;        // Fixed pool of capacity frames
+    std::vector<uint32_t> m_order;      // Used frames by timestamp
+    std::vector<uint32_t> m_free;
+    uint32_t m_reserved = 0;           // Entities every frame has room for
+    uint64_t m_render_time = 0;
+
+    JitterStats m_stats;
+};
+
+} // namespace eos_testing
@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+ * EOS Testing - In-Process Loopback Transport
+ *
+ * Lets several P2PManager instances in one process exchange real bytes,
+ * so the whole send/receive pipeline can be benchmarked and stress
+ * tested without EOS credentials:
+ *
+ *   auto network = std::make_shared<LoopbackNetwork>();
+ *   P2PManager a, b;
+ *   P2PConfig config;
+ *   config.transport = network->create_endpoint(id_a);
+ *   a.initialize(config);
+ *   config.transport = network->create_endpoint(id_b);
+ *   b.initialize(config);
+ *   a.connect_to_peer(id_b);
+ *
+ * Each endpoint has a bounded lock-free inbox. Sends copy into a shared
+ * packet pool; receive copies out, as EOS does. Delivery is immediate and
+ * lossless unless an inbox is full.
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "eos_testing/p2p/packet_pool.hpp"
+#include "eos_testing/p2p/ring_queue.hpp"
+#include "eos_testing/p2p/transport.hpp"
+
+namespace eos_testing {
+
+class LoopbackNetwork : public std::enable_shared_from_this<LoopbackNetwork> {
+public:
+    /**
+     * @param inbox_capacity Packets each endpoint can have waiting
+     * @param max_packet_size Largest packet the network carries
+     */
+    explicit LoopbackNetwork(uint32_t inbox_capacity = 4096, uint32_t max_packet_size = 1170);
+
+    LoopbackNetwork(const LoopbackNetwork&) = delete;
+    LoopbackNetwork& operator=(const LoopbackNetwork&) = delete;
+
+    /**
+     * Create an endpoint. It stays reachable until the returned transport
+     * is destroyed. The network must be owned by a shared_ptr.
+     *
+     * @param local_user_id Address of the new endpoint (must be unique)
+     * @return nullptr if the id is already taken
+     */
+    std::shared_ptr<Transport> create_endpoint(EOS_ProductUserId local_user_id);
+
+    /**
+     * Packets dropped because the destination was unknown or its inbox full.
+     */
+    uint64_t get_dropped_packet_count() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Packets delivered to an inbox.
+     */
+    uint64_t get_delivered_packet_count() const { return m_delivered.load(std::memory_order_relaxed); }
+
+private:
+    friend class LoopbackTransport;
+
+    struct Packet {
+        EOS_ProductUserId sender = nullptr;
+        uint8_t socket = 0;
+        uint8_t channel = 0;
+        PacketBuffer data;
+    };
+
+    struct Inbox {
+        EOS_ProductUserId id = nullptr;
+        RingQueue<Packet> packets;
+    };
+
+    using InboxMap = std::unordered_map<EOS_ProductUserId, std::shared_ptr<Inbox>>;
+
+    bool deliver(EOS_ProductUserId sender, EOS_ProductUserId target,
+                 uint8_t socket, uint8_t channel, const uint8_t* data, uint32_t size);
+    void remove_endpoint(EOS_ProductUserId local_user_id);
+
+    uint32_t m_inbox_capacity;
+    uint32_t m_max_packet_size;
+
+    // Declared before the inboxes so it outlives their buffers
+    PacketPool m_pool;
+
+    // Copy-on-write: senders read with std::atomic_load, endpoints come
+    // and go under the mutex
+    std::shared_ptr<const InboxMap> m_inboxes;
+    std::mutex m_endpoints_mutex;
+
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_delivered{0};
+};
+
+} // namespace eos_testing
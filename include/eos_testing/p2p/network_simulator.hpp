@@ -0,0 +1,198 @@
+#pragma once
+
+/**
+ * EOS Testing - Network Condition Simulator
+ *
+ * Transport wrapper that impairs incoming packets to reproduce relay
+ * conditions in the lab: latency, jitter, bursty loss, duplication,
+ * reordering and a token-bucket bandwidth cap. Enable it through
+ * P2PConfig::network_conditions, or wrap any transport directly:
+ *
+ *   NetworkConditions relay;
+ *   relay.latency_ms = 120;
+ *   relay.jitter_ms = 40;
+ *   relay.loss_rate = 0.03f;
+ *   relay.loss_burst_length = 4;
+ *   config.network_conditions = relay;
+ *
+ * Conditions apply to packets arriving at this endpoint; configure both
+ * ends for a symmetric link. Every random decision comes from a PRNG
+ * seeded with `seed`, so the same traffic sees the same impairments.
+ * Sends and connection events pass through untouched.
+ *
+ * Delay counts from when receive() pulls a packet off the wrapped
+ * transport, and due packets are released by receive(), so timing is as
+ * fine as receive_packets() is called (io_poll_interval_us with
+ * threaded_receive).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "eos_testing/p2p/packet_pool.hpp"
+#include "eos_testing/p2p/transport.hpp"
+
+namespace eos_testing {
+
+/**
+ * Link impairments. All zero = perfect link (simulator not installed).
+ */
+struct NetworkConditions {
+    // One-way delay, plus a uniform +/- jitter_ms per packet. Jitter alone
+    // doesn't reorder: packets keep arrival order, so a dense stream sees
+    // delays toward the top of the jitter range.
+    uint32_t latency_ms = 0;
+    uint32_t jitter_ms = 0;
+
+    // Fraction of packets lost (0-1). Losses come in bursts averaging
+    // loss_burst_length packets (Gilbert-Elliott); 1 = independent.
+    float loss_rate = 0.0f;
+    float loss_burst_length = 1.0f;
+
+    // Fraction of packets delivered twice
+    float duplicate_rate = 0.0f;
+
+    // Fraction of packets held back an extra reorder_delay_ms so later
+    // packets overtake them
+    float reorder_rate = 0.0f;
+    uint32_t reorder_delay_ms = 10;
+
+    // Token-bucket cap on incoming bytes (0 = unlimited). Bursts up to
+    // bandwidth_burst_bytes pass at once; beyond that packets queue, and
+    // are dropped once the queue would take longer than
+    // bandwidth_queue_ms to drain.
+    uint32_t bandwidth_kbps = 0;
+    uint32_t bandwidth_burst_bytes = 16 * 1024;
+    uint32_t bandwidth_queue_ms = 200;
+
+    uint32_t seed = 1;
+
+    bool is_active() const {
+        return latency_ms > 0 || jitter_ms > 0 || loss_rate > 0.0f || duplicate_rate > 0.0f ||
+               reorder_rate > 0.0f || bandwidth_kbps > 0;
+    }
+};
+
+/**
+ * What the simulator did to the traffic so far
+ */
+struct NetworkSimulatorStats {
+    uint64_t received = 0;          // Packets taken from the wrapped transport
+    uint64_t delivered = 0;         // Packets handed on, duplicates included
+    uint64_t lost = 0;              // Dropped by the loss model
+    uint64_t bandwidth_dropped = 0; // Dropped because the bandwidth queue was full
+    uint64_t duplicated = 0;
+    uint64_t reordered = 0;
+    uint32_t in_flight = 0;         // Packets currently delayed
+};
+
+class NetworkSimulator : public Transport {
+public:
+    using Clock = std::chrono::steady_clock;
+    using ClockSource = std::function<Clock::time_point()>;
+
+    /**
+     * @param inner Transport whose incoming packets are impaired
+     * @param conditions Impairments to apply
+     * @param max_packet_size Largest packet to carry
+     * @param clock Time source (steady_clock when empty); tests can step time by hand
+     */
+    NetworkSimulator(std::shared_ptr<Transport> inner,
+                     const NetworkConditions& conditions,
+                     uint32_t max_packet_size = 1170,
+                     ClockSource clock = nullptr);
+    ~NetworkSimulator() override;
+
+    NetworkSimulator(const NetworkSimulator&) = delete;
+    NetworkSimulator& operator=(const NetworkSimulator&) = delete;
+
+    bool open() override;
+    void close() override;
+
+    EOS_ProductUserId local_user_id() const override { return m_inner->local_user_id(); }
+    bool is_simulated() const override { return m_inner->is_simulated(); }
+    bool supports_threaded_receive() const override { return m_inner->supports_threaded_receive(); }
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override {
+        return m_inner->send(peer_id, channel, data, size, reliability, socket);
+    }
+
+    void flush() override { m_inner->flush(); }
+    uint64_t get_outgoing_queue_bytes() const override { return m_inner->get_outgoing_queue_bytes(); }
+
+    /**
+     * Pull everything waiting on the wrapped transport into the delay
+     * line, then hand out the earliest packet that is due.
+     */
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override;
+
+    void accept(EOS_ProductUserId peer_id) override { m_inner->accept(peer_id); }
+    void disconnect(EOS_ProductUserId peer_id) override { m_inner->disconnect(peer_id); }
+
+    const NetworkConditions& get_conditions() const { return m_conditions; }
+    NetworkSimulatorStats get_stats() const;
+
+private:
+    struct DelayedPacket {
+        Clock::time_point due;
+        uint64_t order = 0;     // Tie-break so equal due times keep arrival order
+        EOS_ProductUserId sender = nullptr;
+        uint8_t socket = 0;
+        uint8_t channel = 0;
+        PacketBuffer data;
+    };
+
+    // Min-heap on (due, order)
+    struct Later {
+        bool operator()(const DelayedPacket& a, const DelayedPacket& b) const {
+            return a.due != b.due ? a.due > b.due : a.order > b.order;
+        }
+    };
+
+    void admit(const TransportPacketInfo& info, const uint8_t* data, Clock::time_point now);
+    void schedule(const TransportPacketInfo& info, const uint8_t* data, Clock::time_point due);
+    bool is_lost();
+    bool take_bandwidth(uint32_t size, Clock::time_point now, Clock::time_point& departure);
+    float random_unit();
+    Clock::duration random_jitter();
+
+    std::shared_ptr<Transport> m_inner;
+    NetworkConditions m_conditions;
+    ClockSource m_clock;
+
+    PacketPool m_pool;
+    std::vector<uint8_t> m_scratch;
+    std::vector<DelayedPacket> m_delayed;
+    uint64_t m_next_order = 0;
+    Clock::time_point m_last_due{};     // Keeps non-reordered packets in order
+
+    std::mt19937 m_rng;
+    bool m_in_loss_burst = false;
+    float m_enter_burst_probability = 0.0f;
+    float m_leave_burst_probability = 1.0f;
+
+    // Token bucket; tokens go negative while packets queue behind the cap
+    double m_bytes_per_second = 0.0;
+    double m_tokens = 0.0;
+    Clock::time_point m_tokens_updated{};
+
+    std::atomic<uint64_t> m_received{0};
+    std::atomic<uint64_t> m_delivered{0};
+    std::atomic<uint64_t> m_lost{0};
+    std::atomic<uint64_t> m_bandwidth_dropped{0};
+    std::atomic<uint64_t> m_duplicated{0};
+    std::atomic<uint64_t> m_reordered{0};
+    std::atomic<uint32_t> m_in_flight{0};
+};
+
+} // namespace eos_testing
@@ -7,6 +7,7 @@
  * - NAT traversal / hole punching
  * - Relay fallback when direct connection fails
  * - Reliable and unreliable message channels
+ * - Several sockets, each with its own queues (see SocketConfig)
  * - Connection state management
  * 
  * This is the core networking for real-time gameplay in
@@ -16,10 +17,24 @@
 #include <string>
 #include <vector>
 #include <functional>
-#include <unordered_map>
-#include <queue>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
 #include <optional>
+#include <chrono>
+#include <deque>
+
+#include "eos_testing/p2p/compression.hpp"
+#include "eos_testing/p2p/congestion_controller.hpp"
+#include "eos_testing/p2p/network_simulator.hpp"
+#include "eos_testing/p2p/packet_capture.hpp"
+#include "eos_testing/p2p/packet_pool.hpp"
+#include "eos_testing/p2p/peer_table.hpp"
+#include "eos_testing/p2p/ring_queue.hpp"
+#include "eos_testing/p2p/send_scheduler.hpp"
+#include "eos_testing/p2p/time_sync.hpp"
+#include "eos_testing/p2p/transport.hpp"
 
 #ifndef EOS_STUB_MODE
     #include <eos_sdk.h>
@@ -30,63 +45,264 @@
 
 namespace eos_testing {
 
+class FragmentReassembler;
+class ReliabilityLayer;
+
 /**
- * P2P packet reliability
+ * Incoming packet
+ * 
+ * Owns its bytes through a pooled PacketBuffer (move-only).
  */
-enum class PacketReliability {
-    UnreliableUnordered,    // Fire and forget (best for position updates)
-    ReliableUnordered,      // Guaranteed delivery, any order
-    ReliableOrdered         // Guaranteed delivery, in order (best for events)
+struct IncomingPacket {
+    EOS_ProductUserId sender = nullptr;
+    uint8_t socket = 0;     // Index, see P2PManager::get_socket_index()
+    uint8_t channel = 0;
+    PacketBuffer data;
 };
 
 /**
- * Connection status
+ * Non-owning view of a received packet.
+ * 
+ * Points into P2PManager's reusable receive buffer, so it is only valid
+ * for the duration of the callback it is passed to. Call retain() to keep
+ * the packet past that point.
  */
-enum class ConnectionStatus {
-    Disconnected,
-    Connecting,
-    Connected,
-    ConnectionFailed
+struct PacketView {
+    EOS_ProductUserId sender = nullptr;
+    uint8_t socket = 0;
+    uint8_t channel = 0;
+    const uint8_t* data = nullptr;
+    uint32_t size = 0;
+    
+    // Pool used by retain(); heap when nullptr
+    PacketPool* pool = nullptr;
+    
+    /**
+     * Copy the viewed bytes into an owning packet.
+     */
+    IncomingPacket retain() const;
 };
 
 /**
- * P2P connection info
+ * What send_packet() did with a packet
  */
-struct PeerConnection {
-    EOS_ProductUserId peer_id = nullptr;
-    std::string display_name;
-    ConnectionStatus status = ConnectionStatus::Disconnected;
-    bool is_relay = false;      // True if using relay, false if direct
-    uint32_t ping_ms = 0;
-    uint64_t bytes_sent = 0;
-    uint64_t bytes_received = 0;
+enum class SendStatus : uint8_t {
+    Sent,       // Handed to the transport
+    Queued,     // Waiting in the send scheduler for the peer's budget
+    Rejected,   // Over a backpressure high-water mark; nothing was sent
+    Failed      // Invalid, too large, or refused by the transport
 };
 
 /**
- * Incoming packet
+ * Result of send_packet(): whether the packet went out and how much is
+ * backed up behind it. True when the packet was sent or queued.
  */
-struct IncomingPacket {
-    EOS_ProductUserId sender = nullptr;
-    uint8_t channel = 0;
-    std::vector<uint8_t> data;
+struct SendResult {
+    SendStatus status = SendStatus::Failed;
+    uint32_t peer_queued_bytes = 0;         // In the send scheduler for this peer
+    uint32_t channel_queued_bytes = 0;      // Of which on this channel
+    uint64_t transport_queued_bytes = 0;    // In the transport's send queue, all peers (as of the last tick)
+    
+    explicit operator bool() const { return status == SendStatus::Sent || status == SendStatus::Queued; }
+};
+
+/**
+ * Set of sockets by index, for receive_packets(): bit n is socket n
+ */
+using SocketMask = uint32_t;
+constexpr uint32_t MAX_SOCKETS = 32;
+constexpr SocketMask ALL_SOCKETS = 0xFFFFFFFFu;
+
+constexpr SocketMask socket_bit(uint8_t socket) {
+    return socket < MAX_SOCKETS ? SocketMask(1) << socket : 0;
+}
+
+/**
+ * A socket alongside P2PConfig::socket_name
+ * 
+ * Every socket has its own receive queue, its own send queues under a
+ * send budget, and with custom_reliability its own sequence space, so a
+ * bulk transfer on one socket can't hold up gameplay packets on another:
+ * 
+ *   config.sockets = {{"Bulk", PacketReliability::ReliableOrdered}};
+ *   ...
+ *   uint8_t bulk = *p2p.get_socket_index("Bulk");
+ *   p2p.send_on_socket(bulk, peer_id, chunk.data(), chunk.size());
+ * 
+ *   p2p.receive_packets(100, socket_bit(0));    // Gameplay every frame
+ *   p2p.receive_packets(16, socket_bit(bulk));  // Bulk when there is time
+ */
+struct SocketConfig {
+    std::string name;   // 1-32 characters
+    
+    // Used by send_on_socket() and broadcast_on_socket() when no reliability is given
+    PacketReliability default_reliability = PacketReliability::UnreliableUnordered;
+    
+    // As P2PConfig::channel_priorities and channel_compression, for this socket's channels
+    std::vector<ChannelPriority> channel_priorities;
+    std::vector<ChannelCompression> channel_compression;
+    
+    // Packets that can wait for receive_packets() to take this socket in
+    // the lock-free queue (rounded up to a power of two). Packets read from
+    // the transport beyond that go on a growable overflow list instead, so
+    // the other sockets are never held up; nothing is dropped, but memory
+    // grows until this socket is drained. queue_incoming_packet() rejects
+    // packets once it is full.
+    uint32_t incoming_queue_capacity = 1024;
+};
+
+/**
+ * Receive counters for a socket
+ */
+struct SocketStats {
+    uint64_t packets_received = 0;  // Handed to the callbacks by receive_packets()
+    uint64_t packets_dropped = 0;   // Receive queue full (queue_incoming_packet() only)
+    uint64_t packets_overflowed = 0;  // Set aside past incoming_queue_capacity
+    uint32_t queued_packets = 0;    // Waiting for receive_packets() to take the socket, overflow included
 };
 
 /**
  * P2P Configuration
  */
 struct P2PConfig {
-    // Socket name identifies your game's P2P network
+    // Socket name identifies your game's P2P network (1-32 characters).
+    // It is socket 0, and uses the channel settings below.
     std::string socket_name = "GameSocket";
     
+    // Further sockets, numbered from 1 in order, then additional_sockets
+    // with default settings. At most MAX_SOCKETS in all; see SocketConfig.
+    std::vector<SocketConfig> sockets;
+    std::vector<std::string> additional_sockets;
+    
     // Allow relay connections when direct fails
     bool allow_relay = true;
     
-    // Maximum packet size (EOS limit is 1170 bytes)
+    // Let EOS hold packets for a peer whose connection isn't open yet
+    // (and open it) rather than fail the send
+    bool allow_delayed_delivery = true;
+    
+    // Maximum packet size on the wire (EOS limit is 1170 bytes).
+    // One byte of this is the P2PManager frame header.
     uint32_t max_packet_size = 1170;
     
     // Number of channels (0-255)
     // Common setup: 0=unreliable position, 1=reliable events
     uint8_t num_channels = 2;
+    
+    // Maximum simultaneous peers; further connections are refused
+    uint32_t max_peers = 64;
+    
+    // Number of max_packet_size slabs in the packet pool.
+    // Check get_packet_pool_stats() high-water mark to size this.
+    uint32_t packet_pool_slabs = 256;
+    
+    // Capacity of socket 0's lock-free incoming packet queue (rounded up to a power of two)
+    uint32_t incoming_queue_capacity = 1024;
+    
+    // Drain the transport on a background thread. receive_packets() then
+    // only takes the packets handed over since the last frame, so a long
+    // frame never stalls the receive queue. Not for the EOS transport: the
+    // SDK expects its calls on the thread that ticks the platform, so
+    // initialize() fails if this is set there.
+    bool threaded_receive = false;
+    
+    // How long the I/O thread sleeps when there is nothing to receive
+    uint32_t io_poll_interval_us = 500;
+    
+    // Reliable sends larger than a packet are split into fragments and
+    // reassembled by the receiver. Memory held for incomplete messages is
+    // capped per peer, and they are dropped after the timeout.
+    uint32_t max_reassembly_bytes_per_peer = 4 * 1024 * 1024;
+    uint32_t reassembly_timeout_ms = 10000;
+    
+    // Stub mode only: deliver every sent packet back to ourselves as if
+    // the peer had sent it, so the full send/receive path can be tested.
+    bool stub_loopback = false;
+    
+    // Packet transport. nullptr uses EOS P2P (or the stub in stub builds);
+    // set a LoopbackNetwork endpoint to run several managers in-process.
+    std::shared_ptr<Transport> transport;
+    
+    // Link quality probes. Every ping_interval_ms, tick() pings each peer
+    // on ping_channel to measure RTT, jitter and loss (see PeerConnection).
+    // Probes unanswered after ping_timeout_ms count as lost. 0 disables.
+    uint32_t ping_interval_ms = 1000;
+    uint32_t ping_timeout_ms = 2000;
+    uint8_t ping_channel = 255;     // Reserved; don't use it for game traffic
+    
+    // Clock synchronization with sync_time_to(): one exchange every
+    // time_sync_interval_ms on ping_channel, faster until synchronized.
+    uint32_t time_sync_interval_ms = 1000;
+    
+    // Impair incoming traffic (latency, jitter, loss, duplication,
+    // reordering, bandwidth) to test against relay-like conditions.
+    // Off by default; see network_simulator.hpp.
+    NetworkConditions network_conditions;
+    
+    // Send reliable packets through P2PManager's own protocol (sequence
+    // numbers, ack bitfields, RTT-based resends) as unreliable transport
+    // packets, instead of the transport's reliable modes. Receivers handle
+    // it whatever their own setting. Resend timeouts stay within the
+    // min/max; see get_reliability_stats().
+    bool custom_reliability = false;
+    uint32_t reliability_min_rto_ms = 30;
+    uint32_t reliability_max_rto_ms = 1000;
+    
+    // Per-peer send budget in bytes per second (0 = send immediately).
+    // When set, sends queue per peer and channel and tick() releases them:
+    // higher channel_priorities first, equal priorities sharing by weight.
+    // Unreliable frames still queued after send_max_unreliable_delay_ms are
+    // dropped, and a full queue evicts low priority unreliable frames;
+    // reliable frames are only deferred. See send_scheduler.hpp.
+    uint32_t send_budget_bytes_per_second = 0;
+    uint32_t send_budget_burst_bytes = 8 * 1024;
+    uint32_t send_max_unreliable_delay_ms = 100;
+    uint32_t send_max_queued_bytes_per_peer = 256 * 1024;
+    std::vector<ChannelPriority> channel_priorities;    // By channel; missing = priority 0, weight 1
+    
+    // Congestion control: each peer's send budget follows the path, AIMD
+    // between the min and max rates, cut on queuing delay above
+    // congestion_delay_threshold_ms, lost probes, or the transport's send
+    // queue growing past congestion_max_transport_queue_bytes (EOS's is
+    // shared by all peers). Sends go through the send scheduler as with
+    // send_budget_bytes_per_second, which is then ignored. Probes go out
+    // every congestion_probe_interval_ms, or ping_interval_ms if shorter.
+    // See congestion_controller.hpp.
+    bool congestion_control = false;
+    uint32_t congestion_min_bytes_per_second = 4 * 1024;
+    uint32_t congestion_initial_bytes_per_second = 32 * 1024;
+    uint32_t congestion_max_bytes_per_second = 1024 * 1024;
+    uint32_t congestion_delay_threshold_ms = 25;
+    uint32_t congestion_probe_interval_ms = 100;
+    uint32_t congestion_max_transport_queue_bytes = 64 * 1024;
+    
+    // Backpressure: once more than send_high_water_bytes wait in the send
+    // scheduler for a peer (needs a send budget or congestion control), or
+    // more than transport_high_water_bytes in the transport's send queue
+    // (EOS has one for all peers), sends on channels with a priority below
+    // backpressure_min_priority are rejected: send_packet() returns
+    // SendStatus::Rejected, broadcast_packet() skips the peer.
+    // on_backpressure reports each mark being crossed and the queue
+    // draining back under half of it. 0 = no mark.
+    uint32_t send_high_water_bytes = 0;
+    uint64_t transport_high_water_bytes = 0;
+    uint8_t backpressure_min_priority = 1;
+    
+    // Per-channel payload compression (see compression.hpp). Frames of at
+    // least compression_min_frame_size bytes on a compressed channel are
+    // sent compressed when that makes them smaller. Receivers decode
+    // whatever arrives, but Dictionary frames need the same dictionary
+    // configured on the channel at both ends.
+    std::vector<ChannelCompression> channel_compression;    // By channel; missing = None
+    uint32_t compression_min_frame_size = 32;
+    
+    // Record every packet sent and received to this file ("" = off), for
+    // offline replay with ReplayTransport or the eos_replay tool. A
+    // background thread writes the file; if it falls more than
+    // capture_max_buffered_bytes behind, packets are left out of the
+    // capture. See packet_capture.hpp.
+    std::string capture_path;
+    uint32_t capture_max_buffered_bytes = 8 * 1024 * 1024;
 };
 
 /**
@@ -94,24 +310,35 @@ struct P2PConfig {
  */
 using ConnectionCallback = std::function<void(EOS_ProductUserId peer, ConnectionStatus status)>;
 using PacketCallback = std::function<void(const IncomingPacket& packet)>;
+using PacketViewCallback = std::function<void(const PacketView& packet)>;
+
+// peer is nullptr for the transport's shared send queue
+using BackpressureCallback = std::function<void(EOS_ProductUserId peer, bool active, uint64_t queued_bytes)>;
 
 /**
  * P2P Manager
  * 
  * Manages peer-to-peer connections and packet transmission.
  * Uses EOS relay infrastructure for NAT traversal.
+ * 
+ * Games use the shared instance(). Additional instances, each with its
+ * own transport, can be created to simulate several endpoints in one
+ * process (see loopback_transport.hpp).
  */
 class P2PManager {
 public:
     static P2PManager& instance();
     
+    P2PManager();
+    ~P2PManager();
+    
     // Delete copy/move
     P2PManager(const P2PManager&) = delete;
     P2PManager& operator=(const P2PManager&) = delete;
     
     /**
      * Initialize P2P with configuration.
-     * Must be called after authentication.
+     * Must be called after authentication (unless config.transport is set).
      * 
      * @param config P2P configuration
      * @return true if initialization succeeded
@@ -155,39 +382,228 @@ public:
      * Send a packet to a specific peer.
      * 
      * @param peer_id Target peer
+     * Reliable packets larger than max_packet_size - 1 are fragmented
+     * automatically and arrive as a single packet on the other side.
+     * 
      * @param data Packet data
-     * @param size Data size in bytes
+     * @param size Data size in bytes (unreliable: at most max_packet_size - 1)
      * @param channel Channel number (default 0)
      * @param reliability Delivery guarantee level
-     * @return true if packet was queued for sending
+     * @return Status and queue depths; true if the packet was sent or queued
      */
-    bool send_packet(EOS_ProductUserId peer_id,
+    SendResult send_packet(EOS_ProductUserId peer_id,
                      const void* data,
                      uint32_t size,
                      uint8_t channel = 0,
                      PacketReliability reliability = PacketReliability::UnreliableUnordered);
     
+    /**
+     * Send a packet on one of the sockets (send_packet() uses socket 0).
+     * 
+     * @param socket Socket index (see get_socket_index())
+     * @param reliability Delivery guarantee level; the socket's
+     *        default_reliability when not given
+     * @return As send_packet(); Failed for an unknown socket
+     */
+    SendResult send_on_socket(uint8_t socket,
+                              EOS_ProductUserId peer_id,
+                              const void* data,
+                              uint32_t size,
+                              uint8_t channel = 0,
+                              std::optional<PacketReliability> reliability = std::nullopt);
+    
+    /**
+     * Queue a small message for coalescing.
+     * 
+     * Messages for the same peer, channel and reliability are packed into
+     * one packet of up to max_packet_size bytes and sent by the next
+     * flush_batches() / tick(). The receiver splits them back into
+     * individual on_packet_received / on_packet_view events.
+     * 
+     * @param peer_id Target peer
+     * @param data Message data (copied)
+     * @param size Data size in bytes
+     * @param channel Channel number (default 0)
+     * @param reliability Delivery guarantee level
+     * @return true if the message was queued (false under backpressure)
+     */
+    bool queue_packet(EOS_ProductUserId peer_id,
+                      const void* data,
+                      uint32_t size,
+                      uint8_t channel = 0,
+                      PacketReliability reliability = PacketReliability::UnreliableUnordered);
+    
+    /**
+     * Send all messages queued with queue_packet().
+     */
+    void flush_batches();
+    
+    /**
+     * Per-frame housekeeping: flushes coalesced messages, releases what
+     * the send budget allows, sends link quality pings and time sync
+     * requests when due and drops timed-out fragment reassembly.
+     * Call once per frame after game logic has queued its sends.
+     */
+    void tick();
+    
     /**
      * Send a packet to all connected peers.
      * 
+     * The packet is framed once and sent to a cached peer list that is
+     * only rebuilt when connections change. No lock is taken per peer
+     * unless a peer's slot was reused since the list was built.
+     * 
      * @param data Packet data
      * @param size Data size in bytes
      * @param channel Channel number
      * @param reliability Delivery guarantee level
+     * @param exclude Peers to skip (e.g. the original sender when relaying)
      */
     void broadcast_packet(const void* data,
                           uint32_t size,
                           uint8_t channel = 0,
-                          PacketReliability reliability = PacketReliability::UnreliableUnordered);
+                          PacketReliability reliability = PacketReliability::UnreliableUnordered,
+                          const std::vector<EOS_ProductUserId>& exclude = {});
+    
+    /**
+     * Send a packet to all connected peers on one of the sockets.
+     * 
+     * @param reliability Delivery guarantee level; the socket's
+     *        default_reliability when not given
+     */
+    void broadcast_on_socket(uint8_t socket,
+                             const void* data,
+                             uint32_t size,
+                             uint8_t channel = 0,
+                             std::optional<PacketReliability> reliability = std::nullopt,
+                             const std::vector<EOS_ProductUserId>& exclude = {});
     
     /**
      * Receive pending packets.
      * Call this regularly (every frame) to process incoming data.
      * 
+     * Packets are read into a reusable buffer. If only on_packet_view is
+     * set, no allocation happens per packet; on_packet_received still gets
+     * an owning copy for callers that need one. Callbacks never run while
+     * an internal lock is held.
+     * 
+     * Packets on sockets outside `sockets` are set aside on their socket's
+     * queue for a later call, so a busy socket can be drained less often
+     * without delaying the others. They don't count towards max_packets.
+     * A full set-aside queue overflows onto a growable list rather than
+     * stop the transport being read (reliable packets can't be dropped),
+     * so the busy socket should still be drained now and then to bound
+     * memory.
+     * 
      * @param max_packets Maximum packets to process per call
+     * @param sockets Sockets to deliver packets from (see socket_bit())
      * @return Number of packets processed
      */
-    uint32_t receive_packets(uint32_t max_packets = 100);
+    uint32_t receive_packets(uint32_t max_packets = 100, SocketMask sockets = ALL_SOCKETS);
+    
+    /**
+     * Push a packet onto its socket's incoming queue. Lock-free, safe from
+     * any thread; it is delivered by the next receive_packets() call that
+     * takes the socket.
+     * 
+     * @param packet Packet to deliver
+     * @return false if the queue is full, has overflowed, or the socket is
+     *         unknown (packet is dropped)
+     */
+    bool queue_incoming_packet(IncomingPacket&& packet);
+    
+    /**
+     * Get the index of a socket by name (socket_name is 0).
+     * 
+     * @return nullopt if there is no such socket
+     */
+    std::optional<uint8_t> get_socket_index(const std::string& name) const;
+    
+    /**
+     * Get number of sockets, socket_name included.
+     */
+    uint32_t get_socket_count() const { return static_cast<uint32_t>(m_sockets.size()); }
+    
+    /**
+     * Get receive counters for a socket.
+     * 
+     * @return nullopt if there is no such socket
+     */
+    std::optional<SocketStats> get_socket_stats(uint8_t socket) const;
+    
+    /**
+     * Get number of packets dropped because an incoming queue was full.
+     */
+    uint64_t get_dropped_packet_count() const { return m_dropped_packets.load(std::memory_order_relaxed); }
+    
+    /**
+     * Get number of sends rejected by backpressure (per peer for broadcasts).
+     */
+    uint64_t get_backpressure_rejected_count() const { return m_backpressure_rejected.load(std::memory_order_relaxed); }
+    
+    /**
+     * Get what the network simulator has done so far (all zero when
+     * config.network_conditions is off).
+     */
+    NetworkSimulatorStats get_network_simulator_stats() const;
+    
+    /**
+     * Get retransmit statistics for a peer on a socket (config.custom_reliability).
+     * 
+     * @return nullopt if no reliable traffic has been exchanged with the peer
+     */
+    std::optional<ReliabilityStats> get_reliability_stats(EOS_ProductUserId peer_id, uint8_t socket = 0) const;
+    
+    /**
+     * Get send queue statistics for a peer (config.send_budget_bytes_per_second).
+     * 
+     * @return nullopt if nothing has been queued for the peer
+     */
+    std::optional<SendQueueStats> get_send_queue_stats(EOS_ProductUserId peer_id) const;
+    
+    /**
+     * Get a peer's send rate and what it is based on (config.congestion_control).
+     * 
+     * @return nullopt if congestion control is off or the peer isn't connected
+     */
+    std::optional<CongestionStats> get_congestion_stats(EOS_ProductUserId peer_id) const;
+    
+    /**
+     * Get compression counters for all channels (config.channel_compression).
+     */
+    CompressionStats get_compression_stats() const;
+    
+    /**
+     * Get packet capture counters (all zero when config.capture_path is empty).
+     */
+    CaptureStats get_capture_stats() const;
+    
+    /**
+     * Synchronize to a peer's clock. Server time then follows the
+     * authority's get_server_time_us(); see time_sync.hpp. The authority
+     * itself needs no setup: every endpoint answers time requests once
+     * its own server time is meaningful.
+     * 
+     * @param authority Peer whose clock is server time (nullptr = our own clock)
+     */
+    void sync_time_to(EOS_ProductUserId authority);
+    
+    /**
+     * Get server time in microseconds: the time authority's clock since
+     * its initialize(), or ours when not synchronizing. Never decreases.
+     */
+    uint64_t get_server_time_us() const;
+    
+    /**
+     * Whether server time is tracking the authority set by sync_time_to()
+     * (always true for the authority itself).
+     */
+    bool is_time_synchronized() const;
+    
+    /**
+     * Get clock synchronization state (zero before sync_time_to()).
+     */
+    TimeSyncStats get_time_sync_stats() const;
     
     /**
      * Get connection status for a peer.
@@ -197,6 +613,18 @@ public:
      */
     std::optional<PeerConnection> get_peer_connection(EOS_ProductUserId peer_id) const;
     
+    /**
+     * Get a peer's slot index, stable until the peer disconnects.
+     * 
+     * @return INVALID_PEER_INDEX if the peer is unknown
+     */
+    PeerIndex get_peer_index(EOS_ProductUserId peer_id) const;
+    
+    /**
+     * Get connection status by slot index (O(1), no hashing).
+     */
+    std::optional<PeerConnection> get_peer_connection_by_index(PeerIndex index) const;
+    
     /**
      * Get all peer connections.
      */
@@ -212,6 +640,18 @@ public:
      */
     uint32_t get_peer_count() const;
     
+    /**
+     * Acquire a pooled buffer, e.g. for staging an outgoing packet.
+     * 
+     * @param size Bytes needed (heap fallback if above max_packet_size)
+     */
+    PacketBuffer acquire_packet_buffer(uint32_t size) { return m_packet_pool.acquire(size); }
+    
+    /**
+     * Get packet pool statistics (high-water mark, misses).
+     */
+    PacketPoolStats get_packet_pool_stats() const { return m_packet_pool.get_stats(); }
+    
     /**
      * Get current configuration.
      */
@@ -221,25 +661,221 @@ public:
     ConnectionCallback on_connection_established;
     ConnectionCallback on_connection_closed;
     PacketCallback on_packet_received;
+    PacketViewCallback on_packet_view;     // Zero-copy, valid only during the callback
+    BackpressureCallback on_backpressure;  // From tick()
 
 private:
-    P2PManager() = default;
-    
-    void register_callbacks();
-    void unregister_callbacks();
     void handle_connection_request(EOS_ProductUserId peer_id);
     void handle_connection_established(EOS_ProductUserId peer_id);
     void handle_connection_closed(EOS_ProductUserId peer_id);
+    void dispatch_packet(const PacketView& packet);
+    void dispatch_frame(const PacketView& frame);
+    void dispatch_reliable(const PacketView& frame);
+    void dispatch_compressed(const PacketView& frame);
+    void deliver_message(const PacketView& message);
+    
+    // Immutable list of connected peers, republished on every change
+    struct PeerSnapshot {
+        struct Entry {
+            EOS_ProductUserId peer_id = nullptr;
+            PeerSlot slot;
+        };
+        std::vector<Entry> peers;
+    };
+    void publish_peer_snapshot();   // Caller holds m_connections_mutex
+    
+    // Adds a peer to m_peers if there is room. Caller holds m_connections_mutex.
+    PeerIndex add_peer(EOS_ProductUserId peer_id, ConnectionStatus status);
+    
+    // Whether sends at this reliability go through the socket's ReliabilityLayer
+    bool uses_custom_reliability(PacketReliability reliability) const {
+        return m_config.custom_reliability && reliability != PacketReliability::UnreliableUnordered;
+    }
+    
+    // Whether sends queue on m_scheduler rather than going straight out
+    bool uses_scheduler() const {
+        return m_config.send_budget_bytes_per_second > 0 || m_config.congestion_control;
+    }
+    
+    // Largest frame send_wire accepts at this reliability
+    uint32_t max_frame_size(PacketReliability reliability) const;
+    
+    // Compresses per the channel's setting, then queues on the scheduler
+    // when there is a send budget or congestion control, otherwise transmits
+    bool send_wire(uint8_t socket,
+                   EOS_ProductUserId peer_id,
+                   const uint8_t* data,
+                   uint32_t size,
+                   uint8_t channel,
+                   PacketReliability reliability,
+                   PeerSlot slot = {},
+                   SendQueueDepth* depth = nullptr);
+    
+    // Sends now and credits the peer's bytes_sent: through `slot` without
+    // the lock while it is still current (broadcast's snapshot), otherwise
+    // by looking peer_id up under the lock.
+    bool transmit_wire(uint8_t socket,
+                       EOS_ProductUserId peer_id,
+                       const uint8_t* data,
+                       uint32_t size,
+                       uint8_t channel,
+                       PacketReliability reliability,
+                       PeerSlot slot = {});
+    void release_scheduled();
+    void update_congestion(uint64_t transport_queued);
+    
+    // Whether a send on this channel is rejected, filling in the peer's
+    // queue depth when a mark applies
+    bool is_backpressured(EOS_ProductUserId peer_id, uint8_t socket, uint8_t channel, SendResult& result) const;
+    void update_backpressure(uint64_t transport_queued);
+    
+    // Coalesced sends waiting for flush_batches()
+    struct PendingBatch {
+        EOS_ProductUserId peer_id = nullptr;
+        uint8_t channel = 0;
+        PacketReliability reliability = PacketReliability::UnreliableUnordered;
+        PacketBuffer buffer;
+        uint32_t message_count = 0;
+    };
+    void send_batch(PendingBatch& batch);
+    
+    // Discard a departed peer's open batches unsent
+    void drop_batches(EOS_ProductUserId peer_id);
+    
+    // Link quality probes
+    uint32_t now_us() const;
+    uint32_t ping_interval_ms() const;
+    void send_pings();
+    void handle_ping(const PacketView& packet);
+    void handle_pong(const PacketView& packet);
+    
+    // Clock synchronization
+    uint64_t time_us() const;   // Full-width now_us()
+    void send_time_request();
+    void handle_time_request(const PacketView& packet);
+    void handle_time_response(const PacketView& packet);
+    bool send_fragmented(uint8_t socket,
+                         EOS_ProductUserId peer_id,
+                         const uint8_t* data,
+                         uint32_t size,
+                         uint8_t channel,
+                         PacketReliability reliability);
+    
+    // Threaded receive
+    void start_io_thread();
+    void stop_io_thread();
+    void io_thread_main();
+    uint32_t poll_transport();
+    
+    // Queue a packet read from the transport for a later receive_packets(),
+    // overflowing when its socket's queue is full
+    void set_aside_packet(IncomingPacket&& packet);
     
     bool m_initialized = false;
     P2PConfig m_config;
     
-    std::unordered_map<EOS_ProductUserId, PeerConnection> m_connections;
+    std::shared_ptr<Transport> m_transport;
+    std::shared_ptr<NetworkSimulator> m_network_simulator;  // Wraps the transport when conditions are set
+    std::shared_ptr<CaptureTransport> m_capture;            // Outermost wrapper when capture_path is set
+    EOS_ProductUserId m_local_user_id = nullptr;
+    
+    // Declared before anything holding PacketBuffers so it outlives them
+    PacketPool m_packet_pool;
+    
+    // Slots never move, so their atomic counters may be updated without the mutex
+    PeerTable m_peers;
     mutable std::mutex m_connections_mutex;
     
-    // Pending packets queue for thread-safe access
-    std::queue<IncomingPacket> m_incoming_packets;
-    std::mutex m_packets_mutex;
+    // Timestamps in ping frames are microseconds since initialize()
+    std::chrono::steady_clock::time_point m_epoch;
+    
+    // Server time estimate for sync_time_to()
+    mutable std::mutex m_time_mutex;
+    mutable TimeSync m_time_sync;
+    EOS_ProductUserId m_time_authority = nullptr;
+    uint64_t m_last_time_request_us = 0;
+    
+    // Read with std::atomic_load so broadcast never touches the mutex
+    std::shared_ptr<const PeerSnapshot> m_peer_snapshot;
+    
+    // Per-socket state, by socket index, built by initialize()
+    struct SocketState {
+        SocketConfig config;
+        
+        // Pending packets, pushed by any thread and drained by receive_packets()
+        RingQueue<IncomingPacket> incoming;
+        std::atomic<uint64_t> packets_received{0};
+        std::atomic<uint64_t> packets_dropped{0};
+        
+        // Transport packets that found `incoming` full, newer than anything
+        // in it. overflow_size mirrors overflow.size() for lock-free checks.
+        std::mutex overflow_mutex;
+        std::deque<IncomingPacket> overflow;
+        std::atomic<uint32_t> overflow_size{0};
+        std::atomic<uint64_t> packets_overflowed{0};
+        
+        // Sequencing, acks and resends for custom_reliability
+        std::unique_ptr<ReliabilityLayer> reliability;
+    };
+    std::vector<std::unique_ptr<SocketState>> m_sockets;
+    std::atomic<uint64_t> m_dropped_packets{0};     // All sockets
+    
+    // Background receive thread (threaded_receive)
+    std::thread m_io_thread;
+    std::atomic<bool> m_io_running{false};
+    
+    // Reusable receive buffer, sized once at initialize()
+    std::vector<uint8_t> m_receive_buffer;
+    
+    // Large reliable messages in flight (game thread only)
+    std::unique_ptr<FragmentReassembler> m_reassembler;
+    std::vector<uint8_t> m_reassembled_message;
+    std::atomic<uint16_t> m_next_message_id{0};
+    
+    // Compressed frames are expanded here (game thread only)
+    std::vector<uint8_t> m_decompressed_frame;
+    std::atomic<uint64_t> m_frames_compressed{0};
+    std::atomic<uint64_t> m_frames_incompressible{0};
+    std::atomic<uint64_t> m_compression_bytes_in{0};
+    std::atomic<uint64_t> m_compression_bytes_out{0};
+    std::atomic<uint64_t> m_frames_decompressed{0};
+    std::atomic<uint64_t> m_decompress_failures{0};
+    
+    // Per-peer priority queues under send_budget_bytes_per_second or congestion_control
+    SendScheduler m_scheduler;
+    std::vector<SendScheduler::Frame> m_released_frames;   // Game thread only
+    
+    // Congestion control by PeerIndex, under m_connections_mutex. A slot
+    // whose peer_id doesn't match the table's is reset before use.
+    struct CongestionSlot {
+        EOS_ProductUserId peer_id = nullptr;
+        CongestionController controller;
+        uint64_t bytes_sent = 0;    // Peer's counter at the last update
+    };
+    std::vector<CongestionSlot> m_congestion;
+    std::vector<std::pair<EOS_ProductUserId, uint32_t>> m_congestion_rates;    // Game thread only
+    std::atomic<uint64_t> m_transport_queue_bytes{0};   // As of the last tick
+    
+    // Backpressure state by PeerIndex, under m_connections_mutex, reset
+    // like the congestion slots. Events are collected, then reported
+    // without the lock.
+    struct BackpressureSlot {
+        EOS_ProductUserId peer_id = nullptr;
+        bool active = false;
+    };
+    struct BackpressureEvent {
+        EOS_ProductUserId peer_id = nullptr;
+        bool active = false;
+        uint64_t queued_bytes = 0;
+    };
+    std::vector<BackpressureSlot> m_backpressure;
+    bool m_transport_backpressure = false;
+    std::vector<BackpressureEvent> m_backpressure_events;  // Game thread only
+    std::atomic<uint64_t> m_backpressure_rejected{0};
+    
+    // One open batch per (peer, channel, reliability), until the next flush
+    std::vector<PendingBatch> m_batches;
+    std::mutex m_batches_mutex;
 };
 
 } // namespace eos_testing
@@ -0,0 +1,241 @@
+#pragma once
+
+/**
+ * EOS Testing - Packet Capture and Replay
+ *
+ * Record every packet P2PManager sends and receives to a compact binary
+ * log, then feed the received side back through receive_packets() to
+ * reproduce a session offline or benchmark the receive pipeline:
+ *
+ *   config.capture_path = "session.p2pcap";    // Capture while playing
+ *
+ *   // Later (or run eos_replay session.p2pcap)
+ *   std::vector<CaptureRecord> records;
+ *   read_capture("session.p2pcap", records);
+ *   auto replay = std::make_shared<ReplayTransport>(std::move(records), 1.0);
+ *   config.transport = replay;
+ *   replayer.initialize(config);
+ *   while (!replay->finished()) replayer.receive_packets();
+ *
+ * Packets are captured at the transport, after the network simulator, so
+ * what is recorded is exactly what the game saw. Capturing costs a copy
+ * into a buffer under a mutex; a background thread writes the buffer out.
+ * If the writer falls more than max_buffered_bytes behind, packets are
+ * dropped from the capture (not from the game) and counted.
+ *
+ * File layout (little-endian):
+ *   [u32 magic "P2PC"][u16 version][u16 reserved]
+ *   per packet: [u8 direction][u8 reliability][u8 channel][u8 socket][u16 peer]
+ *               [u32 microseconds since the previous packet][u16 size][data]
+ * Version 1 files, without the socket byte, still load (as socket 0).
+ *
+ * Peers are numbered in order of first appearance; user ids aren't
+ * meaningful outside the session. The transport doesn't report the
+ * reliability of received packets, so they record CAPTURE_RELIABILITY_UNKNOWN.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "eos_testing/p2p/transport.hpp"
+
+namespace eos_testing {
+
+constexpr uint32_t CAPTURE_MAGIC = 0x43503250;     // "P2PC"
+constexpr uint16_t CAPTURE_VERSION = 2;
+constexpr uint8_t CAPTURE_RELIABILITY_UNKNOWN = 0xFF;
+
+enum class CaptureDirection : uint8_t {
+    Sent = 0,
+    Received = 1
+};
+
+/**
+ * One captured packet
+ */
+struct CaptureRecord {
+    uint64_t timestamp_us = 0;      // Since the capture started
+    CaptureDirection direction = CaptureDirection::Received;
+    uint8_t reliability = CAPTURE_RELIABILITY_UNKNOWN;  // PacketReliability value for sends
+    uint8_t channel = 0;
+    uint8_t socket = 0;
+    uint16_t peer = 0;              // Capture-local peer number
+    std::vector<uint8_t> data;      // The wire frame, as the transport carried it
+};
+
+/**
+ * Capture counters (P2PManager::get_capture_stats)
+ */
+struct CaptureStats {
+    uint64_t packets_captured = 0;
+    uint64_t packets_dropped = 0;   // Writer too far behind, or packet too large
+    uint64_t bytes_written = 0;     // File size so far
+    bool write_failed = false;
+};
+
+/**
+ * Transport wrapper that records traffic to a file. P2PManager installs
+ * it when P2PConfig::capture_path is set.
+ */
+class CaptureTransport : public Transport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param inner Transport whose traffic is recorded
+     * @param path File to write (truncated on open)
+     * @param max_buffered_bytes Capture backlog allowed before packets are dropped
+     */
+    CaptureTransport(std::shared_ptr<Transport> inner, std::string path, uint32_t max_buffered_bytes = 8 * 1024 * 1024);
+    ~CaptureTransport() override;
+
+    CaptureTransport(const CaptureTransport&) = delete;
+    CaptureTransport& operator=(const CaptureTransport&) = delete;
+
+    /**
+     * Opens the capture file and starts the writer, then the wrapped transport.
+     *
+     * @return false if the file can't be created
+     */
+    bool open() override;
+
+    /**
+     * Closes the wrapped transport, then writes out what is buffered.
+     */
+    void close() override;
+
+    EOS_ProductUserId local_user_id() const override { return m_inner->local_user_id(); }
+    bool is_simulated() const override { return m_inner->is_simulated(); }
+    bool supports_threaded_receive() const override { return m_inner->supports_threaded_receive(); }
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override;
+
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override;
+
+    void flush() override { m_inner->flush(); }
+    uint64_t get_outgoing_queue_bytes() const override { return m_inner->get_outgoing_queue_bytes(); }
+    void accept(EOS_ProductUserId peer_id) override { m_inner->accept(peer_id); }
+    void disconnect(EOS_ProductUserId peer_id) override { m_inner->disconnect(peer_id); }
+
+    CaptureStats get_stats() const;
+
+private:
+    void record(CaptureDirection direction,
+                EOS_ProductUserId peer_id,
+                uint8_t socket,
+                uint8_t channel,
+                uint8_t reliability,
+                const uint8_t* data,
+                uint32_t size);
+    void writer_main();
+
+    std::shared_ptr<Transport> m_inner;
+    std::string m_path;
+    uint32_t m_max_buffered_bytes;
+
+    std::FILE* m_file = nullptr;
+    std::thread m_writer;
+    bool m_stopping = false;                // Guarded by m_mutex
+
+    // Records waiting for the writer, and what they need to be encoded
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<uint8_t> m_pending;
+    std::unordered_map<EOS_ProductUserId, uint16_t> m_peer_numbers;
+    Clock::time_point m_last_record;
+
+    std::atomic<uint64_t> m_packets_captured{0};
+    std::atomic<uint64_t> m_packets_dropped{0};
+    std::atomic<uint64_t> m_bytes_written{0};
+    std::atomic<bool> m_write_failed{false};
+};
+
+/**
+ * Load a whole capture file.
+ *
+ * @return false if the file is missing, not a capture, or truncated
+ *         (records before the damage are still returned)
+ */
+bool read_capture(const std::string& path, std::vector<CaptureRecord>& records);
+
+/**
+ * Transport that plays the received side of a capture back into a
+ * P2PManager. Sends (acks, pongs, anything the game replies with) are
+ * counted and discarded.
+ */
+class ReplayTransport : public Transport {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param records Capture to play; sent records are skipped
+     * @param speed 1.0 = recorded timing, 2.0 = twice as fast, 0 = as fast as receive() is called
+     */
+    explicit ReplayTransport(std::vector<CaptureRecord> records, double speed = 1.0);
+
+    /**
+     * User id a captured peer number is replayed as.
+     */
+    static EOS_ProductUserId peer_id(uint16_t peer) {
+        return reinterpret_cast<EOS_ProductUserId>(static_cast<uintptr_t>(REPLAY_PEER_BASE) + peer);
+    }
+
+    EOS_ProductUserId local_user_id() const override {
+        return reinterpret_cast<EOS_ProductUserId>(static_cast<uintptr_t>(REPLAY_LOCAL_ID));
+    }
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override;
+
+    /**
+     * Hands out the next received packet once its recorded time (scaled
+     * by speed) has passed since the first call.
+     */
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override;
+
+    // Every received packet has been handed out
+    bool finished() const { return m_next >= m_records.size(); }
+
+    uint64_t get_replayed_packets() const { return m_replayed_packets; }
+    uint64_t get_replayed_bytes() const { return m_replayed_bytes; }
+    uint64_t get_discarded_sends() const { return m_discarded_sends.load(std::memory_order_relaxed); }
+
+    // Start over from the first packet
+    void rewind();
+
+private:
+    static constexpr uint32_t REPLAY_PEER_BASE = 0x7E000000;
+    static constexpr uint32_t REPLAY_LOCAL_ID = 0x7DFFFFFF;
+
+    void skip_sent();
+
+    std::vector<CaptureRecord> m_records;
+    double m_speed;
+    size_t m_next = 0;
+    bool m_started = false;
+    Clock::time_point m_start;
+
+    uint64_t m_replayed_packets = 0;
+    uint64_t m_replayed_bytes = 0;
+    std::atomic<uint64_t> m_discarded_sends{0};
+};
+
+} // namespace eos_testing
@@ -0,0 +1,148 @@
+#pragma once
+
+/**
+ * EOS Testing - Packet Buffer Pool
+ *
+ * Fixed-size slab allocator for P2P packet storage:
+ * - One arena allocated up front, carved into equal slabs
+ * - Slabs handed out as move-only PacketBuffer handles
+ * - Falls back to the heap when exhausted (counted as a miss)
+ *
+ * Sized to P2PConfig::max_packet_size so the steady-state game loop
+ * does no malloc per packet.
+ */
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <utility>
+
+#include "eos_testing/p2p/ring_queue.hpp"
+
+namespace eos_testing {
+
+class PacketPool;
+
+/**
+ * Pool statistics, for sizing the pool per deployment
+ */
+struct PacketPoolStats {
+    uint32_t slab_size = 0;         // Bytes per slab
+    uint32_t slab_count = 0;        // Total slabs in the arena
+    uint32_t in_use = 0;            // Slabs currently handed out
+    uint32_t high_water_mark = 0;   // Most slabs ever in use at once
+    uint64_t acquisitions = 0;      // Total acquire() calls
+    uint64_t misses = 0;            // Pool exhausted, fell back to heap
+    uint64_t oversize = 0;          // Request larger than a slab, fell back to heap
+};
+
+/**
+ * Move-only handle to packet storage.
+ *
+ * Behaves like a fixed-capacity byte vector. Returns its slab to the
+ * owning pool on destruction. Must not outlive the pool it came from.
+ */
+class PacketBuffer {
+public:
+    PacketBuffer() = default;
+    ~PacketBuffer() { reset(); }
+
+    PacketBuffer(const PacketBuffer&) = delete;
+    PacketBuffer& operator=(const PacketBuffer&) = delete;
+    PacketBuffer(PacketBuffer&& other) noexcept { *this = std::move(other); }
+    PacketBuffer& operator=(PacketBuffer&& other) noexcept;
+
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    uint32_t size() const { return m_size; }
+    uint32_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+
+    uint8_t* begin() { return m_data; }
+    uint8_t* end() { return m_data + m_size; }
+    const uint8_t* begin() const { return m_data; }
+    const uint8_t* end() const { return m_data + m_size; }
+
+    uint8_t& operator[](uint32_t index) { return m_data[index]; }
+    const uint8_t& operator[](uint32_t index) const { return m_data[index]; }
+
+    /**
+     * Allocate a heap-backed buffer, for use without a pool.
+     */
+    static PacketBuffer allocate(uint32_t size);
+
+    /**
+     * Set the used size. Clamped to capacity; never reallocates.
+     */
+    void resize(uint32_t size) { m_size = size < m_capacity ? size : m_capacity; }
+
+    /**
+     * Release the storage back to its pool (or the heap).
+     */
+    void reset();
+
+private:
+    friend class PacketPool;
+
+    PacketPool* m_pool = nullptr;   // nullptr = heap allocated
+    uint8_t* m_data = nullptr;
+    uint32_t m_size = 0;
+    uint32_t m_capacity = 0;
+};
+
+/**
+ * Packet Pool
+ *
+ * Lock-free: the free list is a RingQueue, so a network thread can
+ * acquire while the game thread releases. All slabs share one contiguous
+ * arena allocated by reset(); acquire/release never touch the heap while
+ * slabs remain.
+ */
+class PacketPool {
+public:
+    PacketPool() = default;
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    /**
+     * (Re)allocate the arena. Not thread-safe.
+     * Fails if any buffer from the previous arena is still alive.
+     *
+     * @param slab_size Bytes per slab (usually max_packet_size)
+     * @param slab_count Number of slabs
+     * @return true if the arena was (re)allocated
+     */
+    bool reset(uint32_t slab_size, uint32_t slab_count);
+
+    /**
+     * Acquire a buffer of at least `size` bytes.
+     * The returned buffer's size() is set to `size`.
+     */
+    PacketBuffer acquire(uint32_t size);
+
+    /**
+     * Get a snapshot of pool statistics.
+     */
+    PacketPoolStats get_stats() const;
+
+    uint32_t slab_size() const { return m_slab_size; }
+
+private:
+    friend class PacketBuffer;
+
+    void release(uint8_t* slab);
+
+    uint32_t m_slab_size = 0;
+    uint32_t m_slab_count = 0;
+    std::vector<uint8_t> m_arena;
+    RingQueue<uint8_t*> m_free_slabs;
+    
+    std::atomic<uint32_t> m_in_use{0};
+    std::atomic<uint32_t> m_high_water_mark{0};
+    std::atomic<uint64_t> m_acquisitions{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_oversize{0};
+};
+
+} // namespace eos_testing
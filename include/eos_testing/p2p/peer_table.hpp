@@ -0,0 +1,238 @@
+#pragma once
+
+/**
+ * EOS Testing - Peer Table
+ *
+ * Dense, fixed-capacity storage for connected peers:
+ * - Each peer gets a small PeerIndex, stable until it disconnects
+ * - Hot per-tick state (status, counters, ping) is packed in one array,
+ *   cold metadata (display name) in another
+ * - EOS_ProductUserId lookups go through an open-addressing hash
+ *
+ * Slots are allocated once by reset(), so references and the atomic
+ * counters never move. Not thread-safe apart from the atomic counters and
+ * is_current(); P2PManager guards it with its connections mutex.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef EOS_STUB_MODE
+    #include <eos_sdk.h>
+#else
+    using EOS_ProductUserId = void*;
+#endif
+
+namespace eos_testing {
+
+/**
+ * Connection status
+ */
+enum class ConnectionStatus {
+    Disconnected,
+    Connecting,
+    Connected,
+    ConnectionFailed
+};
+
+/**
+ * P2P connection info
+ */
+struct PeerConnection {
+    EOS_ProductUserId peer_id = nullptr;
+    std::string display_name;
+    ConnectionStatus status = ConnectionStatus::Disconnected;
+    bool is_relay = false;      // True if using relay, false if direct
+    uint32_t ping_ms = 0;       // Smoothed RTT, rounded
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    
+    // Link quality from P2PManager's ping/pong probes (0 until measured)
+    float rtt_ms = 0.0f;            // Smoothed round-trip time
+    float rtt_variance_ms = 0.0f;   // Mean deviation of RTT samples
+    float jitter_ms = 0.0f;         // Smoothed change between consecutive samples
+    float packet_loss = 0.0f;       // Fraction of probes lost, 0-1
+};
+
+/**
+ * Per-peer counters for P2PConfig::custom_reliability
+ */
+struct ReliabilityStats {
+    uint64_t packets_sent = 0;          // First transmissions
+    uint64_t retransmits = 0;           // Resends after a timeout
+    uint64_t packets_acked = 0;
+    uint64_t duplicates_received = 0;   // Resends of packets we already had
+    uint32_t in_flight = 0;             // Sent and not yet acked
+    uint32_t backlog = 0;               // Waiting for room in the send window
+    float rtt_ms = 0.0f;                // Smoothed send-to-ack time
+    float rto_ms = 0.0f;                // Current resend timeout
+};
+
+/**
+ * Index of a peer's slot in the PeerTable
+ */
+using PeerIndex = uint16_t;
+constexpr PeerIndex INVALID_PEER_INDEX = 0xFFFF;
+
+/**
+ * A peer's slot as it was when looked up; stale once the slot is reused
+ */
+struct PeerSlot {
+    PeerIndex index = INVALID_PEER_INDEX;
+    uint32_t generation = 0;
+};
+
+/**
+ * Per-tick peer state, kept small and contiguous
+ */
+struct PeerHotState {
+    EOS_ProductUserId peer_id = nullptr;    // nullptr = free slot
+    std::atomic<uint32_t> generation{0};    // Bumped whenever the slot is taken or freed
+    ConnectionStatus status = ConnectionStatus::Disconnected;
+    bool is_relay = false;
+    uint32_t ping_ms = 0;
+    std::atomic<uint64_t> bytes_sent{0};        // Any thread; credit through a current PeerSlot or under the lock
+    std::atomic<uint64_t> bytes_received{0};    // Written by the receive path only
+    float rtt_ms = 0.0f;
+    float rtt_variance_ms = 0.0f;
+    float jitter_ms = 0.0f;
+    float packet_loss = 0.0f;
+};
+
+/**
+ * Outstanding link quality probes for one peer
+ */
+struct PeerPingState {
+    static constexpr uint32_t WINDOW = 16;
+
+    uint16_t next_sequence = 0;
+    uint32_t last_sent_us = 0;
+    bool has_sample = false;
+    float last_sample_ms = 0.0f;
+    uint32_t sent_us[WINDOW] = {};     // Send time by sequence % WINDOW
+    bool pending[WINDOW] = {};
+};
+
+/**
+ * Rarely touched peer metadata
+ */
+struct PeerColdState {
+    std::string display_name;
+    PeerPingState ping;     // Touched once per ping interval
+};
+
+class PeerTable {
+public:
+    PeerTable() = default;
+
+    PeerTable(const PeerTable&) = delete;
+    PeerTable& operator=(const PeerTable&) = delete;
+
+    /**
+     * (Re)allocate slots, discarding all peers.
+     *
+     * @param capacity Maximum simultaneous peers (below INVALID_PEER_INDEX)
+     */
+    void reset(uint32_t capacity);
+
+    /**
+     * Remove all peers, keeping the allocation.
+     */
+    void clear();
+
+    /**
+     * Find a peer's slot.
+     *
+     * @return INVALID_PEER_INDEX if the peer is not in the table
+     */
+    PeerIndex find(EOS_ProductUserId peer_id) const {
+        if (!peer_id || m_buckets.empty()) return INVALID_PEER_INDEX;
+
+        for (size_t bucket = bucket_for(peer_id);; bucket = (bucket + 1) & m_bucket_mask) {
+            PeerIndex index = m_buckets[bucket];
+            if (index == INVALID_PEER_INDEX) return INVALID_PEER_INDEX;
+            if (m_hot[index].peer_id == peer_id) return index;
+        }
+    }
+
+    /**
+     * Find a peer's slot, adding the peer if needed.
+     * New slots start Disconnected with zeroed counters.
+     *
+     * @return INVALID_PEER_INDEX if the table is full
+     */
+    PeerIndex insert(EOS_ProductUserId peer_id);
+
+    /**
+     * Remove a peer, freeing its slot for reuse.
+     *
+     * @return false if the peer was not in the table
+     */
+    bool remove(EOS_ProductUserId peer_id);
+
+    bool is_live(PeerIndex index) const {
+        return index < m_capacity && m_hot[index].peer_id != nullptr;
+    }
+
+    PeerSlot slot(PeerIndex index) const {
+        return {index, m_hot[index].generation.load(std::memory_order_relaxed)};
+    }
+
+    /**
+     * Whether a slot still holds the peer it was looked up for. Safe
+     * without the lock, but the slot can change hands right after, so
+     * only use it for counters where crediting a new peer is harmless.
+     */
+    bool is_current(PeerSlot slot) const {
+        return slot.index < m_capacity &&
+               m_hot[slot.index].generation.load(std::memory_order_acquire) == slot.generation;
+    }
+
+    PeerHotState& hot(PeerIndex index) { return m_hot[index]; }
+    const PeerHotState& hot(PeerIndex index) const { return m_hot[index]; }
+    PeerColdState& cold(PeerIndex index) { return m_cold[index]; }
+    const PeerColdState& cold(PeerIndex index) const { return m_cold[index]; }
+
+    /**
+     * Copy a slot out as a PeerConnection.
+     */
+    PeerConnection to_connection(PeerIndex index) const;
+
+    /**
+     * Call fn(PeerIndex) for every live slot, in index order.
+     */
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (uint32_t i = 0; i < m_capacity; i++) {
+            if (m_hot[i].peer_id) fn(static_cast<PeerIndex>(i));
+        }
+    }
+
+    uint32_t size() const { return m_size; }
+    uint32_t capacity() const { return m_capacity; }
+
+private:
+    size_t bucket_for(EOS_ProductUserId peer_id) const {
+        // Product user ids are pointers; mix the bits so aligned addresses spread out
+        uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(peer_id));
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key) & m_bucket_mask;
+    }
+
+    uint32_t m_capacity = 0;
+    uint32_t m_size = 0;
+    std::unique_ptr<PeerHotState[]> m_hot;
+    std::unique_ptr<PeerColdState[]> m_cold;
+    std::vector<PeerIndex> m_free_slots;    // Stack; lowest index on top
+
+    // Linear-probing hash from peer id to slot
+    std::vector<PeerIndex> m_buckets;
+    size_t m_bucket_mask = 0;
+};
+
+} // namespace eos_testing
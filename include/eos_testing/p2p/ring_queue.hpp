@@ -0,0 +1,137 @@
+#pragma once
+
+/**
+ * EOS Testing - Lock-Free Ring Queue
+ *
+ * Bounded multi-producer queue used to hand packets from network
+ * threads to the game thread:
+ * - Fixed power-of-two capacity, allocated once by reset()
+ * - No locks; producers and the consumer only touch atomics
+ * - try_push fails instead of blocking when full
+ *
+ * Per-cell sequence numbers (Vyukov's bounded queue) make it safe for
+ * any number of producers and consumers; P2PManager uses it as MPSC.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace eos_testing {
+
+template <typename T>
+class RingQueue {
+public:
+    RingQueue() = default;
+    explicit RingQueue(uint32_t capacity) { reset(capacity); }
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    /**
+     * (Re)allocate storage, discarding any queued items.
+     * Not thread-safe: call before producers start.
+     *
+     * @param capacity Minimum capacity, rounded up to a power of two
+     */
+    void reset(uint32_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+
+        m_cells.reset(new Cell[size]);
+        m_mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        m_enqueue_pos.store(0, std::memory_order_relaxed);
+        m_dequeue_pos.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Push an item. Safe from any thread.
+     *
+     * @return false if the queue is full (value is left untouched)
+     */
+    bool try_push(T&& value) {
+        if (!m_cells) return false;
+
+        Cell* cell;
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pop the oldest item.
+     *
+     * @return false if the queue is empty
+     */
+    bool try_pop(T& out) {
+        if (!m_cells) return false;
+
+        Cell* cell;
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = std::move(cell->value);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t capacity() const { return m_cells ? static_cast<uint32_t>(m_mask + 1) : 0; }
+
+    /**
+     * Approximate item count; exact only when no other thread is active.
+     */
+    uint32_t size_approx() const {
+        size_t tail = m_enqueue_pos.load(std::memory_order_relaxed);
+        size_t head = m_dequeue_pos.load(std::memory_order_relaxed);
+        return tail > head ? static_cast<uint32_t>(tail - head) : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask = 0;
+
+    // Keep producer and consumer cursors on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(64) std::atomic<size_t> m_dequeue_pos{0};
+};
+
+} // namespace eos_testing
@@ -0,0 +1,195 @@
+#pragma once
+
+/**
+ * EOS Testing - Send Scheduler
+ *
+ * Per-peer outgoing queues with channel priorities and a bandwidth budget.
+ * Enable it through P2PConfig::send_budget_bytes_per_second; frames are
+ * then queued per peer and channel and released once per tick():
+ * - Each peer has a token bucket refilled at bytes_per_second (or its
+ *   own rate, see set_peer_rate), holding at most burst_bytes
+ * - Channels with a higher priority are served first; channels sharing a
+ *   priority split what is left by weight (deficit round robin)
+ * - Frames keep their order within a channel
+ * - Each socket's channels are queued separately, with their own
+ *   priorities (socket_channel_priorities), so a backlog on one socket
+ *   never sits in front of another's frames
+ * - Unreliable frames that have waited longer than max_unreliable_delay_ms
+ *   are dropped, and a full queue evicts unreliable frames from the
+ *   lowest priority channels first. Reliable frames are never dropped,
+ *   only deferred.
+ *
+ *   config.send_budget_bytes_per_second = 32 * 1024;
+ *   config.channel_priorities = {
+ *       {0, 1},     // Channel 0: positions, lowest
+ *       {2, 1},     // Channel 1: gameplay events, first
+ *   };
+ *
+ * Thread-safe: enqueue() may be called from any thread while the game
+ * thread calls release().
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "eos_testing/p2p/packet_pool.hpp"
+#include "eos_testing/p2p/transport.hpp"
+
+namespace eos_testing {
+
+/**
+ * Scheduling class of a channel
+ */
+struct ChannelPriority {
+    uint8_t priority = 0;   // Higher is sent first
+    uint8_t weight = 1;     // Share of bandwidth among channels with the same priority
+};
+
+/**
+ * Per-peer send queue counters
+ */
+struct SendQueueStats {
+    uint64_t frames_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t frames_deferred = 0;   // Left queued by a release for lack of budget
+    uint64_t frames_dropped = 0;    // Unreliable frames that waited too long or were evicted
+    uint64_t bytes_dropped = 0;
+    uint32_t queued_frames = 0;
+    uint32_t queued_bytes = 0;
+};
+
+/**
+ * Bytes waiting in a peer's queue (see P2PConfig::send_high_water_bytes)
+ */
+struct SendQueueDepth {
+    uint32_t peer_bytes = 0;
+    uint32_t channel_bytes = 0;     // Of which on the channel asked about
+};
+
+class SendScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Settings {
+        uint32_t bytes_per_second = 0;              // 0 = unlimited
+        uint32_t burst_bytes = 8 * 1024;
+        uint32_t max_unreliable_delay_ms = 100;
+        uint32_t max_queued_bytes = 256 * 1024;     // Per peer
+        uint32_t quantum_bytes = 1170;              // Round-robin share per unit of weight
+        std::vector<ChannelPriority> channel_priorities;    // By channel; missing = {0, 1}
+
+        // Sockets 1 and up, by socket then channel; socket 0 uses channel_priorities
+        std::vector<std::vector<ChannelPriority>> socket_channel_priorities;
+    };
+
+    /**
+     * A frame released for sending
+     */
+    struct Frame {
+        EOS_ProductUserId peer = nullptr;
+        uint8_t socket = 0;
+        uint8_t channel = 0;
+        PacketReliability reliability = PacketReliability::UnreliableUnordered;
+        PacketBuffer data;
+    };
+
+    /**
+     * @param settings Budget and channel classes
+     * @param pool Buffers for queued frames
+     */
+    void configure(const Settings& settings, PacketPool* pool);
+
+    void clear();
+    void remove_peer(EOS_ProductUserId peer);
+
+    /**
+     * Queue a frame for the peer.
+     *
+     * @param depth If set, receives the peer's queue depth afterwards
+     * @param socket Socket the frame goes out on
+     * @return false if the frame was dropped straight away (an unreliable
+     *         frame with no room left in the peer's queue)
+     */
+    bool enqueue(EOS_ProductUserId peer,
+                 uint8_t channel,
+                 const uint8_t* data,
+                 uint32_t size,
+                 PacketReliability reliability,
+                 Clock::time_point now,
+                 SendQueueDepth* depth = nullptr,
+                 uint8_t socket = 0);
+
+    /**
+     * Append to `out` every frame the peers' budgets allow, highest
+     * priority first, then drop unreliable frames left waiting too long.
+     */
+    void release(Clock::time_point now, std::vector<Frame>& out);
+
+    /**
+     * Give a peer its own budget instead of Settings::bytes_per_second
+     * (congestion control sets one per peer each tick).
+     *
+     * @param bytes_per_second New budget; 0 goes back to the shared setting
+     */
+    void set_peer_rate(EOS_ProductUserId peer, uint32_t bytes_per_second, Clock::time_point now);
+
+    std::optional<SendQueueStats> get_stats(EOS_ProductUserId peer) const;
+
+    /**
+     * Bytes queued for a peer and, of those, on one socket's channel.
+     */
+    SendQueueDepth get_queue_depth(EOS_ProductUserId peer, uint8_t channel, uint8_t socket = 0) const;
+
+private:
+    struct QueuedFrame {
+        PacketReliability reliability = PacketReliability::UnreliableUnordered;
+        Clock::time_point queued_at;
+        PacketBuffer data;
+    };
+
+    struct ChannelQueue {
+        uint8_t socket = 0;
+        uint8_t channel = 0;
+        ChannelPriority priority;
+        std::deque<QueuedFrame> frames;
+        uint32_t bytes = 0;
+        int64_t deficit = 0;
+    };
+
+    // Orders channels within a priority: by socket, then channel number
+    static uint32_t lane_key(const ChannelQueue& queue) {
+        return static_cast<uint32_t>(queue.socket) << 8 | queue.channel;
+    }
+
+    struct PeerState {
+        std::deque<ChannelQueue> channels;      // One per socket and channel used, in first-use order
+        double tokens = 0.0;
+        Clock::time_point tokens_updated{};
+        uint32_t bytes_per_second = 0;          // 0 = Settings::bytes_per_second
+        SendQueueStats stats;
+    };
+
+    const ChannelPriority& channel_class(uint8_t socket, uint8_t channel) const;
+    PeerState& peer_state(EOS_ProductUserId peer, Clock::time_point now);
+    ChannelQueue& channel_queue(PeerState& state, uint8_t socket, uint8_t channel);
+    static const ChannelQueue* find_channel_queue(const PeerState& state, uint8_t socket, uint8_t channel);
+    bool evict(PeerState& state, uint8_t max_priority);
+    void release_peer(EOS_ProductUserId peer, PeerState& state, Clock::time_point now, std::vector<Frame>& out);
+    void drop_stale(PeerState& state, Clock::time_point now);
+    static SendQueueDepth queue_depth(const PeerState& state, uint8_t socket, uint8_t channel);
+
+    Settings m_settings;
+    PacketPool* m_pool = nullptr;
+    ChannelPriority m_default_class;
+
+    std::unordered_map<EOS_ProductUserId, PeerState> m_peers;
+    std::vector<uint32_t> m_active;     // Scratch: indices of channels with queued frames
+    mutable std::mutex m_mutex;
+};
+
+} // namespace eos_testing
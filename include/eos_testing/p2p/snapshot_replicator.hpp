@@ -0,0 +1,269 @@
+#pragma once
+
+/**
+ * EOS Testing - Snapshot Replicator
+ *
+ * Sends replicated game state as per-tick snapshots, delta-compressed
+ * against the last snapshot each peer acknowledged:
+ * - Entity state is a fixed-layout struct registered with register_type<T>()
+ * - Each tick the authority sets entity state and calls commit(); send()
+ *   then writes only what changed since the peer's acked baseline, down
+ *   to 4-byte words
+ * - Receivers ack every snapshot they complete. Until a baseline is
+ *   acked, or once it is more than HISTORY ticks old (e.g. after a run of
+ *   lost packets), full snapshots are sent instead.
+ * - Snapshots larger than one packet are split into parts of at most
+ *   max_packet_size; a snapshot applies only once every part is in
+ *
+ *   struct PlayerState { float x, y, z, yaw; uint8_t health, flags; };
+ *
+ *   SnapshotReplicator replicator(p2p);
+ *   uint8_t player_type = replicator.register_type<PlayerState>();
+ *
+ *   // Authority, every tick
+ *   replicator.set_entity(player_id, player_type, state);
+ *   replicator.commit();
+ *   replicator.broadcast();
+ *
+ *   // Everyone: route the snapshot channel to the replicator
+ *   p2p.on_packet_view = [&](const PacketView& packet) {
+ *       if (replicator.handle_packet(packet)) return;
+ *       ...
+ *   };
+ *   replicator.get_entity(host_id, player_id, state);
+ *
+ * With an InterestManager attached (set_interest), each peer only gets
+ * the entities in its interest set, and lower-relevance ones only on the
+ * ticks they are due; in between the peer keeps their last sent state.
+ * An update is resent each tick until acked, so lower rates only save
+ * bandwidth when their interval is longer than the round trip.
+ *
+ * With P2PConfig::congestion_control, broadcast() paces each peer's
+ * snapshots to its send rate: a peer on a slow path gets fewer snapshots,
+ * each a delta from the last one it acked, rather than a queue of stale
+ * ones.
+ *
+ * Both sides must register the same types in the same order. Snapshots
+ * and acks travel unreliably on one channel reserved for them. Not
+ * thread-safe; use from the game thread.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "eos_testing/p2p/interest_manager.hpp"
+#include "eos_testing/p2p/p2p_manager.hpp"
+
+namespace eos_testing {
+
+/**
+ * Replicator counters
+ */
+struct SnapshotStats {
+    uint64_t snapshots_sent = 0;        // Per peer
+    uint64_t full_snapshots_sent = 0;   // Of which without a baseline
+    uint64_t snapshots_deferred = 0;    // Peers skipped by broadcast() to stay within their rate
+    uint64_t packets_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t acks_received = 0;
+    uint64_t snapshots_received = 0;    // Completed and applied
+    uint64_t packets_rejected = 0;      // Malformed, stale, or missing their baseline
+};
+
+class SnapshotReplicator {
+public:
+    static constexpr uint32_t HISTORY = 32;             // Ticks a baseline stays usable
+    static constexpr uint32_t MAX_TYPE_SIZE = 1024;
+    static constexpr uint8_t INVALID_TYPE = 0xFF;
+    static constexpr uint32_t NO_TICK = 0;
+    static constexpr double CONGESTION_SHARE = 0.8;     // Of a peer's rate that broadcast() uses
+
+    using SnapshotCallback = std::function<void(EOS_ProductUserId peer, uint32_t tick)>;
+
+    /**
+     * @param p2p Manager to send through (must outlive the replicator)
+     * @param channel Channel reserved for snapshots and their acks
+     */
+    explicit SnapshotReplicator(P2PManager& p2p, uint8_t channel = 3);
+
+    SnapshotReplicator(const SnapshotReplicator&) = delete;
+    SnapshotReplicator& operator=(const SnapshotReplicator&) = delete;
+
+    /**
+     * Register an entity state struct.
+     *
+     * @return Type id for set_entity(), or INVALID_TYPE if the struct is
+     *         larger than MAX_TYPE_SIZE or too many types are registered
+     */
+    template <typename T>
+    uint8_t register_type() {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot state must be trivially copyable");
+        return register_type(static_cast<uint32_t>(sizeof(T)));
+    }
+    uint8_t register_type(uint32_t size);
+
+    // ---- Authority side ----
+
+    /**
+     * Filter what each peer is sent by interest (nullptr to send every
+     * entity to everyone). Only entities in a peer's interest set are
+     * sent to it; the rest are removed on its side. Peers start over
+     * from full snapshots.
+     *
+     * @param interest Updated by the caller before each send (must
+     *        outlive the replicator or be detached)
+     */
+    void set_interest(const InterestManager* interest);
+
+    /**
+     * Set an entity's state for the tick being built.
+     *
+     * @return false if the type is unknown or the size doesn't match it
+     */
+    template <typename T>
+    bool set_entity(uint16_t id, uint8_t type, const T& state) {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot state must be trivially copyable");
+        return set_entity(id, type, &state, static_cast<uint32_t>(sizeof(T)));
+    }
+    bool set_entity(uint16_t id, uint8_t type, const void* state, uint32_t size);
+
+    void remove_entity(uint16_t id);
+
+    /**
+     * Close the tick being built; it becomes what send() transmits.
+     * Entities carry over to the next tick until changed or removed.
+     *
+     * @return The committed tick number
+     */
+    uint32_t commit();
+
+    /**
+     * Send the last committed tick to a peer, as a delta against the
+     * newest snapshot it acknowledged. With an interest manager, what is
+     * sent is the peer's view of the tick.
+     *
+     * @return Bytes sent (0 if nothing was committed or the send failed)
+     */
+    uint32_t send(EOS_ProductUserId peer);
+
+    /**
+     * send() to every connected peer. Under congestion control a peer is
+     * skipped while its snapshots are ahead of CONGESTION_SHARE of its
+     * send rate, leaving the rest for other traffic.
+     *
+     * @return Total bytes sent
+     */
+    uint32_t broadcast();
+
+    // ---- Receiving side ----
+
+    /**
+     * Consume a snapshot or ack. Call from on_packet_view.
+     *
+     * @return true if the packet was on the snapshot channel
+     */
+    bool handle_packet(const PacketView& packet);
+
+    /**
+     * Newest complete tick received from a peer (NO_TICK if none).
+     */
+    uint32_t get_latest_tick(EOS_ProductUserId peer) const;
+
+    /**
+     * Copy an entity's state from the newest snapshot received from a peer.
+     *
+     * @return false if the entity isn't in it or has a different size
+     */
+    template <typename T>
+    bool get_entity(EOS_ProductUserId peer, uint16_t id, T& out) const {
+        static_assert(std::is_trivially_copyable<T>::value, "Snapshot state must be trivially copyable");
+        return get_entity(peer, id, &out, static_cast<uint32_t>(sizeof(T)));
+    }
+    bool get_entity(EOS_ProductUserId peer, uint16_t id, void* out, uint32_t size) const;
+
+    /**
+     * Ids of the entities in the newest snapshot received from a peer.
+     */
+    std::vector<uint16_t> get_entity_ids(EOS_ProductUserId peer) const;
+
+    /**
+     * Forget a disconnected peer (both directions).
+     */
+    void remove_peer(EOS_ProductUserId peer);
+
+    const SnapshotStats& get_stats() const { return m_stats; }
+
+    // A snapshot from a peer was completed and applied
+    SnapshotCallback on_snapshot;
+
+private:
+    struct Entity {
+        uint16_t id = 0;
+        uint8_t type = 0;
+        uint32_t offset = 0;    // Into Snapshot::data
+    };
+
+    struct Snapshot {
+        uint32_t tick = NO_TICK;
+        std::vector<Entity> entities;   // Sorted by id
+        std::vector<uint8_t> data;
+
+        Entity* find(uint16_t id);
+        const Entity* find(uint16_t id) const;
+    };
+
+    struct PeerState {
+        // Sending to the peer
+        uint32_t acked_tick = NO_TICK;
+        Snapshot views[HISTORY];        // What it was sent by tick % HISTORY, with interest
+        uint32_t view_tick = NO_TICK;
+        double send_credit = 0.0;       // Bytes broadcast() may send under congestion control
+        uint32_t last_send_bytes = 0;
+        std::chrono::steady_clock::time_point credit_updated{};
+
+        // Receiving from the peer
+        Snapshot history[HISTORY];      // Complete snapshots by tick % HISTORY
+        uint32_t latest_tick = NO_TICK;
+        Snapshot pending;               // Tick being assembled from parts
+        uint32_t pending_baseline = NO_TICK;
+        std::vector<bool> pending_parts;
+        uint32_t pending_missing = 0;
+    };
+
+    static void compact(const Snapshot& from, Snapshot& to, const std::vector<uint32_t>& sizes);
+
+    void build_view(PeerState& state, EOS_ProductUserId peer);
+    void encode(const Snapshot& current, const Snapshot* baseline);
+    void write_record(const Entity* current, const uint8_t* current_data,
+                      const Entity* baseline, const uint8_t* baseline_data);
+    bool send_parts(EOS_ProductUserId peer, uint32_t baseline_tick, uint32_t& bytes_sent);
+    void handle_snapshot(EOS_ProductUserId peer, const uint8_t* data, uint32_t size);
+    void handle_ack(EOS_ProductUserId peer, const uint8_t* data, uint32_t size);
+    bool apply_records(Snapshot& snapshot, const uint8_t* data, uint32_t size, uint32_t count);
+    void send_ack(EOS_ProductUserId peer, uint32_t tick);
+
+    P2PManager& m_p2p;
+    uint8_t m_channel;
+    std::vector<uint32_t> m_type_sizes;
+    const InterestManager* m_interest = nullptr;
+
+    // Authority side
+    Snapshot m_building;
+    Snapshot m_history[HISTORY];        // Committed snapshots by tick % HISTORY
+    uint32_t m_tick = NO_TICK;
+
+    std::unordered_map<EOS_ProductUserId, PeerState> m_peers;
+
+    // Encoding scratch
+    std::vector<uint8_t> m_records;
+    std::vector<uint32_t> m_record_ends;
+    std::vector<uint8_t> m_packet;
+
+    SnapshotStats m_stats;
+};
+
+} // namespace eos_testing
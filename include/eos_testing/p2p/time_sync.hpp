@@ -0,0 +1,106 @@
+#pragma once
+
+/**
+ * EOS Testing - Clock Synchronization
+ *
+ * Estimates a time authority's clock ("server time") from NTP-style
+ * request/response exchanges:
+ * - Each exchange gives an offset, ((t2 - t1) + (t3 - t4)) / 2, and a
+ *   round trip, t4 - t1. The offset is only wrong by half the difference
+ *   between the two one-way delays, so queueing spikes on one leg show up
+ *   as a long round trip.
+ * - Of the last WINDOW exchanges, the offsets of the quarter with the
+ *   shortest round trips are averaged (NTP's clock filter, smoothed)
+ * - Changes to the estimate are slewed in at max_slew (0.5% by default),
+ *   so server time runs smoothly and never goes backwards. Only an error
+ *   above step_threshold_us, such as the first estimate, is applied at once.
+ *
+ * P2PManager runs this for you:
+ *
+ *   p2p.sync_time_to(host_id);          // Clients; the host does nothing
+ *   if (p2p.is_time_synchronized()) {
+ *       uint64_t now = p2p.get_server_time_us();
+ *   }
+ *
+ * The class itself is plain arithmetic on microsecond timestamps, so it
+ * can be driven directly with any clocks.
+ */
+
+#include <cstdint>
+
+namespace eos_testing {
+
+/**
+ * Clock synchronization state (P2PManager::get_time_sync_stats)
+ */
+struct TimeSyncStats {
+    bool synchronized = false;
+    int64_t offset_us = 0;          // Server time minus local time, as applied now
+    int64_t target_offset_us = 0;   // Current filtered estimate the offset is slewing toward
+    uint32_t best_rtt_us = 0;       // Shortest round trip in the window
+    uint32_t spread_us = 0;         // Range of the offsets that were averaged
+    uint64_t samples = 0;
+    uint64_t steps = 0;             // Times the offset jumped instead of slewing
+};
+
+class TimeSync {
+public:
+    static constexpr uint32_t WINDOW = 16;
+
+    struct Settings {
+        uint32_t min_samples = 4;               // Before the clock counts as synchronized
+        uint32_t step_threshold_us = 50000;     // Larger errors are applied at once
+        double max_slew = 0.005;                // Offset change per unit of elapsed time
+    };
+
+    TimeSync() = default;
+    explicit TimeSync(const Settings& settings) : m_settings(settings) {}
+
+    /**
+     * Forget all samples; server time falls back to local time.
+     */
+    void reset();
+
+    /**
+     * Add one exchange. All times in microseconds.
+     *
+     * @param request_sent_us When the request left (local clock, t1)
+     * @param server_time_us Server time when the reply was written (t2 = t3)
+     * @param reply_received_us When the reply arrived (local clock, t4)
+     */
+    void add_sample(uint64_t request_sent_us, uint64_t server_time_us, uint64_t reply_received_us);
+
+    /**
+     * Server time at a local time. Non-decreasing across calls as long as
+     * local time is.
+     */
+    uint64_t server_time(uint64_t local_us);
+
+    bool is_synchronized() const { return m_samples >= m_settings.min_samples; }
+
+    TimeSyncStats get_stats(uint64_t local_us) const;
+
+private:
+    struct Sample {
+        int64_t offset_us = 0;
+        uint32_t rtt_us = 0;
+    };
+
+    // Offset applied at local_us, part way from m_slew_from to m_target
+    int64_t applied_offset(uint64_t local_us) const;
+
+    Settings m_settings;
+    Sample m_window[WINDOW];
+    uint64_t m_samples = 0;
+    uint64_t m_steps = 0;
+
+    int64_t m_target = 0;
+    int64_t m_slew_from = 0;
+    uint64_t m_slew_start_us = 0;
+    uint32_t m_best_rtt_us = 0;
+    uint32_t m_spread_us = 0;
+
+    uint64_t m_last_server_time = 0;
+};
+
+} // namespace eos_testing
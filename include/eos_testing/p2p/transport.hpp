@@ -0,0 +1,138 @@
+#pragma once
+
+/**
+ * EOS Testing - P2P Transport Interface
+ *
+ * The packet I/O underneath P2PManager. P2PManager does framing,
+ * batching, fragmentation and peer bookkeeping; a Transport only moves
+ * opaque packets between user ids:
+ * - EOS P2P (default in SDK builds)
+ * - Stub (default in stub builds; discards, or echoes with stub_loopback)
+ * - In-process loopback between several P2PManagers (loopback_transport.hpp)
+ * - UDP on localhost, one process per endpoint (udp_transport.hpp)
+ * - Any of these behind simulated latency/loss (network_simulator.hpp)
+ *
+ * Packets travel on a socket, by index into P2PManager's socket list
+ * (0 = P2PConfig::socket_name). Transports without sockets of their own
+ * carry the index alongside the channel.
+ *
+ * send() may be called from any thread. receive() is called from one
+ * thread at a time (the game thread, or the I/O thread if enabled and
+ * supports_threaded_receive()).
+ */
+
+#include <cstdint>
+#include <functional>
+
+#ifndef EOS_STUB_MODE
+    #include <eos_sdk.h>
+#else
+    using EOS_ProductUserId = void*;
+#endif
+
+namespace eos_testing {
+
+/**
+ * P2P packet reliability
+ */
+enum class PacketReliability {
+    UnreliableUnordered,    // Fire and forget (best for position updates)
+    ReliableUnordered,      // Guaranteed delivery, any order
+    ReliableOrdered         // Guaranteed delivery, in order (best for events)
+};
+
+/**
+ * Metadata for a packet returned by Transport::receive
+ */
+struct TransportPacketInfo {
+    EOS_ProductUserId sender = nullptr;
+    uint8_t socket = 0;
+    uint8_t channel = 0;
+    uint32_t size = 0;
+};
+
+class Transport {
+public:
+    using PeerCallback = std::function<void(EOS_ProductUserId peer_id)>;
+
+    virtual ~Transport() = default;
+
+    /**
+     * Called by P2PManager::initialize, after the callbacks are set.
+     */
+    virtual bool open() { return true; }
+
+    /**
+     * Called by P2PManager::shutdown.
+     */
+    virtual void close() {}
+
+    /**
+     * User id this endpoint sends as.
+     */
+    virtual EOS_ProductUserId local_user_id() const = 0;
+
+    /**
+     * Simulated transports have no handshake: P2PManager marks peers
+     * connected as soon as connect_to_peer is called.
+     */
+    virtual bool is_simulated() const { return true; }
+
+    /**
+     * Whether receive() may run on P2PManager's I/O thread
+     * (threaded_receive) while the game thread sends and ticks.
+     */
+    virtual bool supports_threaded_receive() const { return true; }
+
+    /**
+     * Send one packet.
+     *
+     * @param socket Socket index (0 = the first socket)
+     * @return false if the packet could not be queued for sending
+     */
+    virtual bool send(EOS_ProductUserId peer_id,
+                      uint8_t channel,
+                      const uint8_t* data,
+                      uint32_t size,
+                      PacketReliability reliability,
+                      uint8_t socket = 0) = 0;
+
+    /**
+     * Receive the next packet into `buffer`.
+     *
+     * @param info Filled with sender, socket, channel and size on success
+     * @param capacity Size of `buffer`; larger packets are dropped
+     * @return false if nothing is waiting
+     */
+    virtual bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) = 0;
+    
+    /**
+     * Push out packets held back to batch system calls. P2PManager calls
+     * this after each send_packet, broadcast, flush_batches and tick.
+     */
+    virtual void flush() {}
+
+    /**
+     * Bytes accepted by send() that haven't left yet, where the transport
+     * can tell (0 otherwise). Congestion control backs off while it grows.
+     */
+    virtual uint64_t get_outgoing_queue_bytes() const { return 0; }
+
+    /**
+     * Allow connections from a peer (nullptr = anyone).
+     */
+    virtual void accept(EOS_ProductUserId peer_id) {}
+
+    /**
+     * Tear down the connection to a peer.
+     */
+    virtual void disconnect(EOS_ProductUserId peer_id) {}
+
+    // Connection events raised by the transport (EOS notifications), per
+    // peer: established once the first socket opens, closed after the last
+    PeerCallback on_connection_request;
+    PeerCallback on_connection_established;
+    PeerCallback on_connection_closed;
+};
+
+} // namespace eos_testing
@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+ * EOS Testing - Local UDP Transport
+ *
+ * Stand-in for the EOS relay that sends packets over plain UDP sockets on
+ * 127.0.0.1, so eos_host and eos_client can run as separate processes
+ * without Epic credentials while paying real kernel socket costs:
+ *
+ *   P2PConfig config;
+ *   config.transport = std::make_shared<UdpTransport>(7777);
+ *   P2PManager::instance().initialize(config);
+ *   P2PManager::instance().connect_to_peer(UdpTransport::peer_id_for_port(7778));
+ *
+ * Peers are addressed by port: peer_id_for_port() makes a synthetic
+ * EOS_ProductUserId that is never dereferenced. Each datagram carries
+ * [socket][channel][payload]. Delivery is plain UDP - reliability flags are
+ * accepted but not honoured.
+ *
+ * Sends are staged and go out in one sendmmsg() call on Linux when the
+ * batch fills or on flush(); receives drain the socket with recvmmsg().
+ * Other platforms fall back to one sendto()/recvfrom() per packet.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "eos_testing/p2p/transport.hpp"
+
+namespace eos_testing {
+
+class UdpTransport : public Transport {
+public:
+    /**
+     * @param local_port Port to bind on 127.0.0.1 (0 = pick a free one at open())
+     * @param max_packet_size Largest packet send() accepts
+     * @param batch_size Datagrams per sendmmsg()/recvmmsg() call
+     */
+    explicit UdpTransport(uint16_t local_port,
+                          uint32_t max_packet_size = 1170,
+                          uint32_t batch_size = 32);
+    ~UdpTransport() override;
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    /**
+     * User id of the endpoint bound to `port`.
+     */
+    static EOS_ProductUserId peer_id_for_port(uint16_t port);
+
+    /**
+     * @return 0 if `peer_id` was not made by peer_id_for_port()
+     */
+    static uint16_t port_for_peer_id(EOS_ProductUserId peer_id);
+
+    bool open() override;
+    void close() override;
+
+    /**
+     * Valid after open() when binding to port 0.
+     */
+    EOS_ProductUserId local_user_id() const override { return peer_id_for_port(m_local_port); }
+    uint16_t local_port() const { return m_local_port; }
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override;
+
+    void flush() override;
+
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override;
+
+    /**
+     * Datagrams the kernel refused or that arrived malformed or oversize.
+     */
+    uint64_t get_dropped_packet_count() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Send/receive system calls made, to compare batched and unbatched I/O.
+     */
+    uint64_t get_send_call_count() const { return m_send_calls.load(std::memory_order_relaxed); }
+    uint64_t get_receive_call_count() const { return m_receive_calls.load(std::memory_order_relaxed); }
+
+private:
+    struct Batch;   // Datagram slots and the platform's message headers
+
+    void flush_locked();
+
+    uint16_t m_local_port;
+    uint32_t m_max_packet_size;
+    uint32_t m_batch_size;
+    intptr_t m_socket = -1;     // int on POSIX, SOCKET on Windows
+
+    std::unique_ptr<Batch> m_send_batch;        // Guarded by m_send_mutex
+    std::unique_ptr<Batch> m_receive_batch;     // Receive thread only
+    std::mutex m_send_mutex;
+
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_send_calls{0};
+    std::atomic<uint64_t> m_receive_calls{0};
+};
+
+} // namespace eos_testing
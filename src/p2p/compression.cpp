@@ -0,0 +1,343 @@
+/**
+ * EOS Testing - Payload Compression Implementation
+ */
+
+#include "eos_testing/p2p/compression.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace eos_testing {
+
+namespace {
+
+constexpr uint32_t MIN_MATCH = 4;
+constexpr uint32_t MAX_OFFSET = 0xFFFF;
+constexpr uint32_t LENGTH_NIBBLE_MAX = 15;
+constexpr uint32_t MIN_TABLE_BITS = 8;
+constexpr uint32_t MAX_TABLE_BITS = 12;
+
+// Dictionary training
+constexpr uint32_t DMER_SIZE = 8;
+constexpr uint32_t SEGMENT_SIZE = 32;
+
+inline uint32_t read_u32(const uint8_t* in) {
+    uint32_t value;
+    std::memcpy(&value, in, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash_u32(uint32_t value, uint32_t bits) {
+    return (value * 2654435761u) >> (32 - bits);
+}
+
+// Appends a length past its 4-bit token field: 255s, then the remainder
+inline bool write_length(uint8_t*& out, const uint8_t* end, uint32_t length) {
+    while (length >= 255) {
+        if (out == end) return false;
+        *out++ = 255;
+        length -= 255;
+    }
+    if (out == end) return false;
+    *out++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+inline bool read_length(const uint8_t*& in, const uint8_t* end, uint32_t& length) {
+    uint8_t byte;
+    do {
+        if (in == end) return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// One sequence: token, literal extension, literals, and unless match_length
+// is 0, the offset and match extension
+bool write_sequence(uint8_t*& out, const uint8_t* end,
+                    const uint8_t* literals, uint32_t literal_length,
+                    uint32_t offset, uint32_t match_length) {
+    if (out == end) return false;
+    uint32_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    uint8_t* token = out++;
+    *token = static_cast<uint8_t>((std::min(literal_length, LENGTH_NIBBLE_MAX) << 4) |
+                                  std::min(match_code, LENGTH_NIBBLE_MAX));
+
+    if (literal_length >= LENGTH_NIBBLE_MAX && !write_length(out, end, literal_length - LENGTH_NIBBLE_MAX)) {
+        return false;
+    }
+    if (static_cast<uint32_t>(end - out) < literal_length) return false;
+    std::memcpy(out, literals, literal_length);
+    out += literal_length;
+
+    if (match_length == 0) return true;
+    if (end - out < 2) return false;
+    out[0] = static_cast<uint8_t>(offset);
+    out[1] = static_cast<uint8_t>(offset >> 8);
+    out += 2;
+    return match_code < LENGTH_NIBBLE_MAX || write_length(out, end, match_code - LENGTH_NIBBLE_MAX);
+}
+
+uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+CompressionDictionary::CompressionDictionary(std::vector<uint8_t> content)
+    : m_content(std::move(content)) {
+    if (m_content.size() > MAX_SIZE) {
+        m_content.erase(m_content.begin(), m_content.end() - MAX_SIZE);
+    }
+    m_id = fnv1a(m_content.data(), m_content.size());
+
+    // Later positions overwrite earlier ones: nearer the data, shorter offsets
+    m_index.assign(size_t(1) << INDEX_BITS, 0);
+    for (size_t position = 0; position + MIN_MATCH <= m_content.size(); position++) {
+        m_index[hash_u32(read_u32(&m_content[position]), INDEX_BITS)] = static_cast<uint16_t>(position + 1);
+    }
+}
+
+CompressionDictionary CompressionDictionary::train(const std::vector<std::vector<uint8_t>>& samples, uint32_t max_size) {
+    max_size = std::min(max_size, MAX_SIZE);
+
+    // Number each distinct d-mer and count the samples it appears in
+    struct Candidate {
+        const uint8_t* data = nullptr;
+        uint32_t length = 0;
+        uint32_t first_dmer = 0;    // Into dmer_ids
+    };
+    std::unordered_map<uint64_t, uint32_t> ids;
+    std::vector<uint32_t> frequency;
+    std::vector<uint32_t> last_sample;
+    std::vector<uint32_t> dmer_ids;
+    std::vector<Candidate> candidates;
+
+    for (uint32_t sample_index = 0; sample_index < samples.size(); sample_index++) {
+        const std::vector<uint8_t>& sample = samples[sample_index];
+        if (sample.size() < DMER_SIZE) continue;
+
+        uint32_t first_dmer = static_cast<uint32_t>(dmer_ids.size());
+        for (size_t position = 0; position + DMER_SIZE <= sample.size(); position++) {
+            uint64_t dmer;
+            std::memcpy(&dmer, &sample[position], DMER_SIZE);
+            auto inserted = ids.emplace(dmer, static_cast<uint32_t>(frequency.size()));
+            if (inserted.second) {
+                frequency.push_back(0);
+                last_sample.push_back(UINT32_MAX);
+            }
+
+            uint32_t id = inserted.first->second;
+            if (last_sample[id] != sample_index) {
+                last_sample[id] = sample_index;
+                frequency[id]++;
+            }
+            dmer_ids.push_back(id);
+        }
+
+        // Every segment that stays inside the sample
+        uint32_t length = std::min<uint32_t>(SEGMENT_SIZE, static_cast<uint32_t>(sample.size()));
+        for (size_t start = 0; start + length <= sample.size(); start++) {
+            candidates.push_back({&sample[start], length, first_dmer + static_cast<uint32_t>(start)});
+        }
+    }
+    if (candidates.empty() || max_size == 0) return CompressionDictionary();
+
+    // Split the candidates into epochs and take the best segment of each,
+    // zeroing its d-mers so later picks cover something new
+    struct Segment {
+        const uint8_t* data;
+        uint32_t length;
+        uint64_t score;
+    };
+    std::vector<Segment> chosen;
+    uint32_t epochs = std::max<uint32_t>(max_size / SEGMENT_SIZE, 1);
+    size_t epoch_size = std::max<size_t>(candidates.size() / epochs, 1);
+    uint32_t total = 0;
+
+    for (uint32_t pass = 0; pass < 2 && total < max_size; pass++) {
+        for (size_t begin = 0; begin < candidates.size() && total < max_size; begin += epoch_size) {
+            size_t end = std::min(candidates.size(), begin + epoch_size);
+
+            const Candidate* best = nullptr;
+            uint64_t best_score = 0;
+            for (size_t i = begin; i < end; i++) {
+                const Candidate& candidate = candidates[i];
+                uint64_t score = 0;
+                for (uint32_t d = 0; d + DMER_SIZE <= candidate.length; d++) {
+                    score += frequency[dmer_ids[candidate.first_dmer + d]];
+                }
+                if (score > best_score) {
+                    best_score = score;
+                    best = &candidate;
+                }
+            }
+
+            // A d-mer seen in a single sample isn't worth dictionary space
+            if (!best || best_score < 2 * (best->length - DMER_SIZE + 1)) continue;
+            for (uint32_t d = 0; d + DMER_SIZE <= best->length; d++) {
+                frequency[dmer_ids[best->first_dmer + d]] = 0;
+            }
+            chosen.push_back({best->data, best->length, best_score});
+            total += best->length;
+        }
+    }
+
+    // Best segments last, where offsets into the dictionary are shortest
+    std::stable_sort(chosen.begin(), chosen.end(),
+                     [](const Segment& a, const Segment& b) { return a.score < b.score; });
+
+    std::vector<uint8_t> content;
+    content.reserve(total);
+    for (const Segment& segment : chosen) {
+        content.insert(content.end(), segment.data, segment.data + segment.length);
+    }
+    if (content.size() > max_size) {
+        content.erase(content.begin(), content.end() - max_size);
+    }
+    return CompressionDictionary(std::move(content));
+}
+
+uint32_t lz_compress(const uint8_t* source,
+                     uint32_t size,
+                     uint8_t* destination,
+                     uint32_t capacity,
+                     const CompressionDictionary* dictionary) {
+    const uint8_t* dict = nullptr;
+    const uint16_t* dict_index = nullptr;
+    uint32_t dict_size = 0;
+    if (dictionary && !dictionary->empty()) {
+        dict = dictionary->content().data();
+        dict_index = dictionary->index().data();
+        dict_size = static_cast<uint32_t>(dictionary->content().size());
+    }
+
+    // Input positions + 1 by hash, sized to the input so small packets
+    // don't pay for clearing a large table
+    uint32_t table_bits = MIN_TABLE_BITS;
+    while (table_bits < MAX_TABLE_BITS && (1u << table_bits) < size) table_bits++;
+    uint32_t table[1u << MAX_TABLE_BITS];
+    std::memset(table, 0, sizeof(uint32_t) << table_bits);
+
+    uint8_t* out = destination;
+    const uint8_t* out_end = destination + capacity;
+    uint32_t anchor = 0;
+    uint32_t position = 0;
+
+    while (position + MIN_MATCH <= size) {
+        uint32_t sequence = read_u32(source + position);
+        uint32_t hash = hash_u32(sequence, table_bits);
+        uint32_t candidate = table[hash];
+        table[hash] = position + 1;
+
+        uint32_t match_length = 0;
+        uint32_t offset = 0;
+        if (candidate && position - (candidate - 1) <= MAX_OFFSET &&
+            read_u32(source + candidate - 1) == sequence) {
+            const uint8_t* match = source + candidate - 1;
+            match_length = MIN_MATCH;
+            while (position + match_length < size && match[match_length] == source[position + match_length]) {
+                match_length++;
+            }
+            offset = position - (candidate - 1);
+        } else if (dict) {
+            uint32_t dict_candidate = dict_index[hash_u32(sequence, CompressionDictionary::INDEX_BITS)];
+            uint32_t dict_position = dict_candidate - 1;
+            if (dict_candidate && dict_size - dict_position + position <= MAX_OFFSET &&
+                read_u32(dict + dict_position) == sequence) {
+                // The match may run off the end of the dictionary into the input
+                match_length = MIN_MATCH;
+                while (position + match_length < size) {
+                    uint32_t from = dict_position + match_length;
+                    uint8_t byte = from < dict_size ? dict[from] : source[from - dict_size];
+                    if (byte != source[position + match_length]) break;
+                    match_length++;
+                }
+                offset = dict_size - dict_position + position;
+            }
+        }
+
+        if (match_length == 0) {
+            // Skip faster through data that isn't matching
+            position += 1 + ((position - anchor) >> 5);
+            continue;
+        }
+
+        if (!write_sequence(out, out_end, source + anchor, position - anchor, offset, match_length)) return 0;
+        position += match_length;
+        anchor = position;
+
+        // Index inside the match too, so the next repeat finds it
+        if (position >= 2 && position + 2 <= size) {
+            table[hash_u32(read_u32(source + position - 2), table_bits)] = position - 1;
+        }
+    }
+
+    if (!write_sequence(out, out_end, source + anchor, size - anchor, 0, 0)) return 0;
+    return static_cast<uint32_t>(out - destination);
+}
+
+uint32_t lz_decompress(const uint8_t* source,
+                       uint32_t size,
+                       uint8_t* destination,
+                       uint32_t capacity,
+                       const CompressionDictionary* dictionary) {
+    const uint8_t* dict = nullptr;
+    uint32_t dict_size = 0;
+    if (dictionary) {
+        dict = dictionary->content().data();
+        dict_size = static_cast<uint32_t>(dictionary->content().size());
+    }
+
+    const uint8_t* in = source;
+    const uint8_t* in_end = source + size;
+    uint32_t written = 0;
+
+    while (in < in_end) {
+        uint8_t token = *in++;
+
+        uint32_t literal_length = token >> 4;
+        if (literal_length == LENGTH_NIBBLE_MAX && !read_length(in, in_end, literal_length)) return 0;
+        if (literal_length > static_cast<uint32_t>(in_end - in) || literal_length > capacity - written) return 0;
+        std::memcpy(destination + written, in, literal_length);
+        in += literal_length;
+        written += literal_length;
+
+        // The last sequence has no match
+        if (in == in_end) break;
+
+        if (in_end - in < 2) return 0;
+        uint32_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        uint32_t match_length = (token & 0x0F) + MIN_MATCH;
+        if ((token & 0x0F) == LENGTH_NIBBLE_MAX && !read_length(in, in_end, match_length)) return 0;
+        if (offset == 0 || offset > written + dict_size || match_length > capacity - written) return 0;
+
+        // Part of the match in the dictionary's tail
+        if (offset > written) {
+            uint32_t from_dict = std::min(offset - written, match_length);
+            std::memcpy(destination + written, dict + dict_size - (offset - written), from_dict);
+            written += from_dict;
+            match_length -= from_dict;
+            if (match_length == 0) continue;
+        }
+
+        // Overlapping copies repeat the last `offset` bytes, so go bytewise
+        const uint8_t* match = destination + written - offset;
+        if (offset >= match_length) {
+            std::memcpy(destination + written, match, match_length);
+        } else {
+            for (uint32_t i = 0; i < match_length; i++) destination[written + i] = match[i];
+        }
+        written += match_length;
+    }
+
+    return written;
+}
+
+} // namespace eos_testing
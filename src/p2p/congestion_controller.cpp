@@ -0,0 +1,182 @@
+/**
+ * EOS Testing - Congestion Control Implementation
+ */
+
+#include "eos_testing/p2p/congestion_controller.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace eos_testing {
+
+namespace {
+
+// Time constant of the measured send rate
+constexpr double SEND_RATE_SMOOTHING_US = 250000.0;
+
+// Below this share of the rate, with nothing queued, the rate isn't raised
+constexpr double APP_LIMITED_SHARE = 0.5;
+
+// Queuing delay, in thresholds, past which a cut halves the rate
+constexpr uint32_t OVERSHOOT_THRESHOLDS = 4;
+
+} // namespace
+
+void CongestionController::reset(uint64_t now_us) {
+    m_rate = std::min(std::max(m_settings.initial_bytes_per_second, m_settings.min_bytes_per_second),
+                      m_settings.max_bytes_per_second);
+    m_send_rate = 0.0;
+    m_slow_start = true;
+    m_app_limited = false;
+    m_last_update_us = now_us;
+    m_last_decrease_us = 0;
+    m_has_decreased = false;
+    m_base_rtt_us[0] = 0;
+    m_base_rtt_us[1] = 0;
+    m_base_rtt_started_us = now_us;
+    m_srtt_us = 0;
+    m_recent_rtt_us = 0;
+    m_last_sample_us = 0;
+    m_delay_reference_us = 0;
+    m_delay_reference_at_us = 0;
+    m_stats = CongestionStats();
+}
+
+uint64_t CongestionController::response_time_us() const {
+    return static_cast<uint64_t>(m_srtt_us) + m_settings.probe_interval_us;
+}
+
+uint32_t CongestionController::base_rtt_us() const {
+    uint32_t base = m_base_rtt_us[0];
+    if (base == 0 || (m_base_rtt_us[1] != 0 && m_base_rtt_us[1] < base)) base = m_base_rtt_us[1];
+    return base;
+}
+
+uint32_t CongestionController::queuing_delay_us() const {
+    uint32_t base = base_rtt_us();
+    if (base == 0 || m_recent_rtt_us <= base) return 0;
+    return m_recent_rtt_us - base;
+}
+
+void CongestionController::on_rtt_sample(uint32_t rtt_us, uint64_t now_us) {
+    rtt_us = std::max<uint32_t>(rtt_us, 1);
+
+    // The base is the minimum over the last half window or two, so it
+    // follows a route change within base_rtt_window_us
+    if (now_us - m_base_rtt_started_us >= m_settings.base_rtt_window_us / 2) {
+        m_base_rtt_us[1] = m_base_rtt_us[0];
+        m_base_rtt_us[0] = 0;
+        m_base_rtt_started_us = now_us;
+    }
+    if (m_base_rtt_us[0] == 0 || rtt_us < m_base_rtt_us[0]) m_base_rtt_us[0] = rtt_us;
+
+    if (m_srtt_us == 0) {
+        m_srtt_us = rtt_us;
+    } else {
+        m_srtt_us = static_cast<uint32_t>(static_cast<int64_t>(m_srtt_us) +
+                                          (static_cast<int64_t>(rtt_us) - static_cast<int64_t>(m_srtt_us)) / 8);
+    }
+
+    // One slow probe isn't a queue; two in a row are
+    m_recent_rtt_us = m_last_sample_us != 0 ? std::min(rtt_us, m_last_sample_us) : rtt_us;
+    m_last_sample_us = rtt_us;
+
+    // Slow start stops short of the threshold, as in HyStart, and on one
+    // sample: doubling would overshoot far past it before the next
+    if (rtt_us > base_rtt_us() + m_settings.delay_threshold_us / 2) m_slow_start = false;
+
+    uint32_t delay = queuing_delay_us();
+
+    if (delay <= m_settings.delay_threshold_us) {
+        m_delay_reference_us = 0;
+        return;
+    }
+
+    // A new episode cuts at once. After that the queue has to drain by
+    // half the threshold per response time, or it is cut again.
+    if (m_delay_reference_us == 0) {
+        m_stats.delay_events++;
+        decrease(now_us);
+    } else if (now_us - m_delay_reference_at_us >= response_time_us()) {
+        if (delay + m_settings.delay_threshold_us / 2 > m_delay_reference_us) {
+            m_stats.delay_events++;
+            decrease(now_us);
+        }
+    } else {
+        return;
+    }
+    m_delay_reference_us = delay;
+    m_delay_reference_at_us = now_us;
+}
+
+void CongestionController::on_loss(uint64_t now_us) {
+    m_stats.loss_events++;
+    decrease(now_us);
+}
+
+void CongestionController::on_backlog(uint64_t now_us) {
+    m_stats.backlog_events++;
+    decrease(now_us);
+}
+
+bool CongestionController::decrease(uint64_t now_us) {
+    if (m_has_decreased && now_us - m_last_decrease_us < response_time_us()) return false;
+
+    // Cut from what was actually sent when that is less, so a peer that
+    // wasn't using its budget doesn't keep most of it
+    double basis = m_rate;
+    if (m_send_rate > 0.0) basis = std::min(basis, std::max<double>(m_send_rate, m_settings.min_bytes_per_second));
+
+    double factor = m_settings.decrease_factor;
+    if (queuing_delay_us() > m_settings.delay_threshold_us * OVERSHOOT_THRESHOLDS) factor = std::min(factor, 0.5);
+
+    m_rate = std::max<double>(basis * factor, m_settings.min_bytes_per_second);
+    m_slow_start = false;
+    m_has_decreased = true;
+    m_last_decrease_us = now_us;
+    m_stats.decreases++;
+    return true;
+}
+
+void CongestionController::update(uint64_t bytes_sent, uint32_t bytes_queued, uint64_t now_us) {
+    if (now_us <= m_last_update_us) return;
+    uint64_t elapsed_us = now_us - m_last_update_us;
+    m_last_update_us = now_us;
+
+    double gain = std::min(1.0, static_cast<double>(elapsed_us) / SEND_RATE_SMOOTHING_US);
+    double instant = static_cast<double>(bytes_sent) * 1e6 / static_cast<double>(elapsed_us);
+    m_send_rate += (instant - m_send_rate) * gain;
+
+    m_app_limited = bytes_queued == 0 && m_send_rate < m_rate * APP_LIMITED_SHARE;
+    if (m_app_limited) return;
+
+    // Hold while there is a queue, and give a cut one response time to show
+    if (queuing_delay_us() > m_settings.delay_threshold_us) return;
+    uint64_t response_us = response_time_us();
+    if (m_has_decreased && now_us - m_last_decrease_us < response_us) return;
+
+    double response = static_cast<double>(response_us) / 1e6;
+    double elapsed = std::min(static_cast<double>(elapsed_us) / 1e6, response);
+    if (m_slow_start) {
+        m_rate *= std::exp2(elapsed / response);
+    } else {
+        m_rate += m_settings.increase_bytes_per_second * elapsed;
+    }
+
+    if (m_rate >= m_settings.max_bytes_per_second) {
+        m_rate = m_settings.max_bytes_per_second;
+        m_slow_start = false;
+    }
+}
+
+CongestionStats CongestionController::get_stats() const {
+    CongestionStats stats = m_stats;
+    stats.rate_bytes_per_second = rate();
+    stats.send_rate_bytes_per_second = static_cast<uint32_t>(m_send_rate);
+    stats.base_rtt_ms = static_cast<float>(base_rtt_us()) / 1000.0f;
+    stats.queuing_delay_ms = static_cast<float>(queuing_delay_us()) / 1000.0f;
+    stats.slow_start = m_slow_start;
+    stats.app_limited = m_app_limited;
+    return stats;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,259 @@
+/**
+ * EOS Testing - EOS P2P Transport Implementation
+ */
+
+#include "eos_transport.hpp"
+
+#ifndef EOS_STUB_MODE
+
+#include "eos_testing/core/platform.hpp"
+#include "eos_testing/auth/auth_manager.hpp"
+#include <cstring>
+
+namespace eos_testing {
+
+EOSTransport::EOSTransport(std::vector<std::string> socket_names, bool allow_delayed_delivery)
+    : m_allow_delayed_delivery(allow_delayed_delivery) {
+    for (auto& name : socket_names) {
+        SocketContext socket;
+        socket.name = std::move(name);
+        m_sockets.push_back(std::move(socket));
+    }
+}
+
+bool EOSTransport::open() {
+    auto platform = Platform::instance().get_handle();
+    m_p2p_handle = platform ? EOS_Platform_GetP2PInterface(platform) : nullptr;
+    if (!m_p2p_handle || m_sockets.empty()) return false;
+    
+    m_local_user_id = AuthManager::instance().get_product_user_id();
+    
+    // m_sockets no longer changes size, so the SocketId pointers stay valid.
+    // Names were validated (1-32 characters) by P2PManager.
+    for (auto& socket : m_sockets) {
+        socket.socket_id = {};
+        socket.socket_id.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
+        std::memcpy(socket.socket_id.SocketName, socket.name.c_str(), socket.name.size() + 1);
+        
+        socket.send_options = {};
+        socket.send_options.ApiVersion = EOS_P2P_SENDPACKET_API_LATEST;
+        socket.send_options.LocalUserId = m_local_user_id;
+        socket.send_options.SocketId = &socket.socket_id;
+        socket.send_options.bAllowDelayedDelivery = m_allow_delayed_delivery ? EOS_TRUE : EOS_FALSE;
+    }
+    
+    register_callbacks();
+    return true;
+}
+
+void EOSTransport::close() {
+    unregister_callbacks();
+    m_open_sockets.clear();
+    m_p2p_handle = nullptr;
+}
+
+bool EOSTransport::send(EOS_ProductUserId peer_id,
+                        uint8_t channel,
+                        const uint8_t* data,
+                        uint32_t size,
+                        PacketReliability reliability,
+                        uint8_t socket) {
+    if (!m_p2p_handle || socket >= m_sockets.size()) return false;
+    
+    // Everything but the per-packet fields was filled in at open()
+    EOS_P2P_SendPacketOptions options = m_sockets[socket].send_options;
+    options.RemoteUserId = peer_id;
+    options.Channel = channel;
+    options.DataLengthBytes = size;
+    options.Data = data;
+    
+    switch (reliability) {
+        case PacketReliability::UnreliableUnordered:
+            options.Reliability = EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
+            break;
+        case PacketReliability::ReliableUnordered:
+            options.Reliability = EOS_EPacketReliability::EOS_PR_ReliableUnordered;
+            break;
+        case PacketReliability::ReliableOrdered:
+            options.Reliability = EOS_EPacketReliability::EOS_PR_ReliableOrdered;
+            break;
+    }
+    
+    return EOS_P2P_SendPacket(m_p2p_handle, &options) == EOS_EResult::EOS_Success;
+}
+
+bool EOSTransport::receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) {
+    if (!m_p2p_handle) return false;
+    
+    // EOS reports EOS_NotFound once the queue is empty, so no separate
+    // size query is needed
+    EOS_P2P_ReceivePacketOptions recv_options = {};
+    recv_options.ApiVersion = EOS_P2P_RECEIVEPACKET_API_LATEST;
+    recv_options.LocalUserId = m_local_user_id;
+    recv_options.MaxDataSizeBytes = capacity;
+    
+    // One queue holds every socket's packets; the name says which it was
+    // on. Anything on a socket we didn't register is skipped.
+    while (true) {
+        EOS_P2P_SocketId socket_id;
+        uint32_t bytes_received = 0;
+        EOS_EResult result = EOS_P2P_ReceivePacket(m_p2p_handle, &recv_options,
+            &info.sender, &socket_id, &info.channel, buffer, &bytes_received);
+        
+        if (result != EOS_EResult::EOS_Success) {
+            return false;
+        }
+        
+        int index = find_socket(&socket_id);
+        if (index >= 0) {
+            info.socket = static_cast<uint8_t>(index);
+            info.size = bytes_received;
+            return true;
+        }
+    }
+}
+
+int EOSTransport::find_socket(const EOS_P2P_SocketId* socket_id) const {
+    if (!socket_id) return -1;
+    
+    for (size_t index = 0; index < m_sockets.size(); index++) {
+        if (std::strncmp(m_sockets[index].socket_id.SocketName, socket_id->SocketName,
+                         sizeof(socket_id->SocketName)) == 0) {
+            return static_cast<int>(index);
+        }
+    }
+    return -1;
+}
+
+void EOSTransport::socket_established(EOS_ProductUserId peer_id, const EOS_P2P_SocketId* socket_id) {
+    int index = find_socket(socket_id);
+    if (index < 0) return;
+    
+    uint32_t& open = m_open_sockets[peer_id];
+    bool first = open == 0;
+    open |= uint32_t(1) << index;
+    
+    if (first && on_connection_established) on_connection_established(peer_id);
+}
+
+void EOSTransport::socket_closed(EOS_ProductUserId peer_id, const EOS_P2P_SocketId* socket_id) {
+    int index = find_socket(socket_id);
+    if (index < 0) return;
+    
+    // A close while other sockets are still open only ends that socket.
+    // With none open (the last one, or a connection that never opened)
+    // the peer is gone.
+    auto it = m_open_sockets.find(peer_id);
+    if (it != m_open_sockets.end()) {
+        it->second &= ~(uint32_t(1) << index);
+        if (it->second != 0) return;
+        m_open_sockets.erase(it);
+    }
+    
+    if (on_connection_closed) on_connection_closed(peer_id);
+}
+
+uint64_t EOSTransport::get_outgoing_queue_bytes() const {
+    if (!m_p2p_handle) return 0;
+    
+    // Covers every peer and socket: EOS keeps one outgoing queue
+    EOS_P2P_GetPacketQueueInfoOptions options = {};
+    options.ApiVersion = EOS_P2P_GETPACKETQUEUEINFO_API_LATEST;
+    
+    EOS_P2P_PacketQueueInfo info = {};
+    if (EOS_P2P_GetPacketQueueInfo(m_p2p_handle, &options, &info) != EOS_EResult::EOS_Success) {
+        return 0;
+    }
+    return info.OutgoingPacketQueueCurrentSizeBytes;
+}
+
+void EOSTransport::accept(EOS_ProductUserId peer_id) {
+    if (!m_p2p_handle) return;
+    
+    EOS_P2P_AcceptConnectionOptions options = {};
+    options.ApiVersion = EOS_P2P_ACCEPTCONNECTION_API_LATEST;
+    options.LocalUserId = m_local_user_id;
+    options.RemoteUserId = peer_id;
+    
+    for (const auto& socket : m_sockets) {
+        options.SocketId = &socket.socket_id;
+        EOS_P2P_AcceptConnection(m_p2p_handle, &options);
+    }
+}
+
+void EOSTransport::disconnect(EOS_ProductUserId peer_id) {
+    if (!m_p2p_handle) return;
+    
+    EOS_P2P_CloseConnectionOptions options = {};
+    options.ApiVersion = EOS_P2P_CLOSECONNECTION_API_LATEST;
+    options.LocalUserId = m_local_user_id;
+    options.RemoteUserId = peer_id;
+    
+    for (const auto& socket : m_sockets) {
+        options.SocketId = &socket.socket_id;
+        EOS_P2P_CloseConnection(m_p2p_handle, &options);
+    }
+}
+
+void EOSTransport::register_callbacks() {
+    for (auto& socket : m_sockets) {
+        // Register for connection requests
+        EOS_P2P_AddNotifyPeerConnectionRequestOptions request_options = {};
+        request_options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONREQUEST_API_LATEST;
+        request_options.LocalUserId = m_local_user_id;
+        request_options.SocketId = &socket.socket_id;
+        
+        socket.request_notification = EOS_P2P_AddNotifyPeerConnectionRequest(m_p2p_handle,
+            &request_options, this,
+            [](const EOS_P2P_OnIncomingConnectionRequestInfo* data) {
+                auto* self = static_cast<EOSTransport*>(data->ClientData);
+                if (self->on_connection_request) self->on_connection_request(data->RemoteUserId);
+            }
+        );
+        
+        // Register for connection state changes
+        EOS_P2P_AddNotifyPeerConnectionEstablishedOptions established_options = {};
+        established_options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONESTABLISHED_API_LATEST;
+        established_options.LocalUserId = m_local_user_id;
+        established_options.SocketId = &socket.socket_id;
+        
+        socket.established_notification = EOS_P2P_AddNotifyPeerConnectionEstablished(m_p2p_handle,
+            &established_options, this,
+            [](const EOS_P2P_OnPeerConnectionEstablishedInfo* data) {
+                auto* self = static_cast<EOSTransport*>(data->ClientData);
+                self->socket_established(data->RemoteUserId, data->SocketId);
+            }
+        );
+        
+        // Register for connection closed
+        EOS_P2P_AddNotifyPeerConnectionClosedOptions closed_options = {};
+        closed_options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONCLOSED_API_LATEST;
+        closed_options.LocalUserId = m_local_user_id;
+        closed_options.SocketId = &socket.socket_id;
+        
+        socket.closed_notification = EOS_P2P_AddNotifyPeerConnectionClosed(m_p2p_handle,
+            &closed_options, this,
+            [](const EOS_P2P_OnRemoteConnectionClosedInfo* data) {
+                auto* self = static_cast<EOSTransport*>(data->ClientData);
+                self->socket_closed(data->RemoteUserId, data->SocketId);
+            }
+        );
+    }
+}
+
+void EOSTransport::unregister_callbacks() {
+    if (!m_p2p_handle) return;
+    
+    for (auto& socket : m_sockets) {
+        EOS_P2P_RemoveNotifyPeerConnectionRequest(m_p2p_handle, socket.request_notification);
+        EOS_P2P_RemoveNotifyPeerConnectionEstablished(m_p2p_handle, socket.established_notification);
+        EOS_P2P_RemoveNotifyPeerConnectionClosed(m_p2p_handle, socket.closed_notification);
+        socket.request_notification = EOS_INVALID_NOTIFICATIONID;
+        socket.established_notification = EOS_INVALID_NOTIFICATIONID;
+        socket.closed_notification = EOS_INVALID_NOTIFICATIONID;
+    }
+}
+
+} // namespace eos_testing
+
+#endif // EOS_STUB_MODE
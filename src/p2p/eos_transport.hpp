@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * EOS Testing - EOS P2P Transport (internal)
+ *
+ * Transport over the EOS P2P interface. Socket ids, send options and the
+ * interface handle are built once by open(), so the send path does no
+ * string work or handle lookups.
+ *
+ * EOS raises connection notifications per socket. They are merged per
+ * peer: established is reported when the first socket opens, closed when
+ * the last one does.
+ */
+
+#include "eos_testing/p2p/transport.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef EOS_STUB_MODE
+    #include <eos_p2p.h>
+
+namespace eos_testing {
+
+class EOSTransport : public Transport {
+public:
+    /**
+     * @param socket_names Sockets to register and accept on, in socket index order
+     * @param allow_delayed_delivery Let EOS hold sends until a peer's connection opens
+     */
+    explicit EOSTransport(std::vector<std::string> socket_names, bool allow_delayed_delivery = true);
+
+    bool open() override;
+    void close() override;
+    EOS_ProductUserId local_user_id() const override { return m_local_user_id; }
+    bool is_simulated() const override { return false; }
+    
+    // EOS SDK calls belong on the thread that ticks the platform
+    bool supports_threaded_receive() const override { return false; }
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override;
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override;
+    uint64_t get_outgoing_queue_bytes() const override;
+
+    void accept(EOS_ProductUserId peer_id) override;
+    void disconnect(EOS_ProductUserId peer_id) override;
+
+private:
+    // Per-socket EOS state; index 0 is the primary socket
+    struct SocketContext {
+        std::string name;
+        EOS_P2P_SocketId socket_id = {};
+        EOS_P2P_SendPacketOptions send_options = {};    // Per-packet fields left blank
+        EOS_NotificationId request_notification = EOS_INVALID_NOTIFICATIONID;
+        EOS_NotificationId established_notification = EOS_INVALID_NOTIFICATIONID;
+        EOS_NotificationId closed_notification = EOS_INVALID_NOTIFICATIONID;
+    };
+
+    void register_callbacks();
+    void unregister_callbacks();
+    
+    // Index of a socket by its id, or -1 if it isn't one of ours
+    int find_socket(const EOS_P2P_SocketId* socket_id) const;
+    
+    // Connection notifications for one socket, merged per peer
+    void socket_established(EOS_ProductUserId peer_id, const EOS_P2P_SocketId* socket_id);
+    void socket_closed(EOS_ProductUserId peer_id, const EOS_P2P_SocketId* socket_id);
+
+    std::vector<SocketContext> m_sockets;
+    
+    // Open sockets per peer, bit n = socket n. Only touched from
+    // notifications, which EOS runs inside EOS_Platform_Tick.
+    std::unordered_map<EOS_ProductUserId, uint32_t> m_open_sockets;
+    EOS_HP2P m_p2p_handle = nullptr;
+    EOS_ProductUserId m_local_user_id = nullptr;
+    bool m_allow_delayed_delivery = true;
+};
+
+} // namespace eos_testing
+
+#endif // EOS_STUB_MODE
@@ -0,0 +1,135 @@
+/**
+ * EOS Testing - Fragment Reassembler Implementation
+ */
+
+#include "fragment_reassembler.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace eos_testing {
+
+void FragmentReassembler::configure(uint32_t max_bytes_per_peer, uint32_t timeout_ms) {
+    m_max_bytes_per_peer = max_bytes_per_peer;
+    m_timeout = std::chrono::milliseconds(timeout_ms);
+    m_messages.clear();
+}
+
+bool FragmentReassembler::add_fragment(EOS_ProductUserId peer,
+                                       uint8_t channel,
+                                       const uint8_t* frame,
+                                       uint32_t frame_size,
+                                       Clock::time_point now,
+                                       std::vector<uint8_t>& completed) {
+    if (frame_size < wire::FRAGMENT_HEADER_SIZE) return false;
+    
+    wire::FragmentHeader header = wire::read_fragment_header(frame);
+    const uint8_t* payload = frame + wire::FRAGMENT_HEADER_SIZE;
+    uint32_t payload_size = frame_size - wire::FRAGMENT_HEADER_SIZE;
+    
+    if (header.count == 0 || header.index >= header.count || header.total_size == 0) {
+        std::cout << "[P2P] Warning: Malformed fragment header, dropping\n";
+        return false;
+    }
+    
+    // Every fragment but the last carries the same amount, so offsets follow
+    // from the index; the last one ends exactly at total_size.
+    uint32_t offset;
+    if (header.index + 1 == header.count) {
+        if (payload_size > header.total_size) return false;
+        offset = header.total_size - payload_size;
+    } else {
+        offset = static_cast<uint32_t>(header.index) * payload_size;
+    }
+    if (static_cast<uint64_t>(offset) + payload_size > header.total_size) {
+        std::cout << "[P2P] Warning: Fragment outside message bounds, dropping\n";
+        return false;
+    }
+    
+    auto it = std::find_if(m_messages.begin(), m_messages.end(), [&](const PendingMessage& m) {
+        return m.peer == peer && m.channel == channel && m.message_id == header.message_id;
+    });
+    
+    if (it == m_messages.end()) {
+        if (pending_bytes(peer) + static_cast<uint64_t>(header.total_size) > m_max_bytes_per_peer) {
+            // Every fragment of the message lands here; only log the first
+            if (header.index == 0) {
+                std::cout << "[P2P] Warning: Reassembly budget exceeded for peer, dropping "
+                          << header.total_size << " byte message\n";
+            }
+            return false;
+        }
+        
+        // Reuse a finished message's buffers when there is one
+        PendingMessage message;
+        if (!m_spare.empty()) {
+            message = std::move(m_spare.back());
+            m_spare.pop_back();
+        }
+        message.peer = peer;
+        message.channel = channel;
+        message.message_id = header.message_id;
+        message.fragment_count = header.count;
+        message.fragments_received = 0;
+        message.data.resize(header.total_size);
+        message.received.assign(header.count, false);
+        m_messages.push_back(std::move(message));
+        it = m_messages.end() - 1;
+    }
+    
+    if (it->fragment_count != header.count || it->data.size() != header.total_size) {
+        std::cout << "[P2P] Warning: Fragment does not match message in progress, dropping\n";
+        return false;
+    }
+    
+    it->last_update = now;
+    if (it->received[header.index]) {
+        return false; // Duplicate
+    }
+    
+    std::memcpy(it->data.data() + offset, payload, payload_size);
+    it->received[header.index] = true;
+    it->fragments_received++;
+    
+    if (it->fragments_received < it->fragment_count) {
+        return false;
+    }
+    
+    // The caller's previous message buffer goes back for the next message
+    completed.swap(it->data);
+    if (m_spare.size() < MAX_SPARE_MESSAGES) {
+        m_spare.push_back(std::move(*it));
+    }
+    m_messages.erase(it);
+    return true;
+}
+
+uint32_t FragmentReassembler::expire(Clock::time_point now) {
+    auto expired = std::remove_if(m_messages.begin(), m_messages.end(), [&](const PendingMessage& m) {
+        return now - m.last_update > m_timeout;
+    });
+    
+    uint32_t count = static_cast<uint32_t>(m_messages.end() - expired);
+    if (count > 0) {
+        std::cout << "[P2P] Warning: Discarded " << count << " incomplete fragmented message(s)\n";
+    }
+    m_messages.erase(expired, m_messages.end());
+    return count;
+}
+
+void FragmentReassembler::remove_peer(EOS_ProductUserId peer) {
+    m_messages.erase(std::remove_if(m_messages.begin(), m_messages.end(),
+        [peer](const PendingMessage& m) { return m.peer == peer; }), m_messages.end());
+}
+
+uint32_t FragmentReassembler::pending_bytes(EOS_ProductUserId peer) const {
+    uint32_t total = 0;
+    for (const auto& message : m_messages) {
+        if (message.peer == peer) {
+            total += static_cast<uint32_t>(message.data.size());
+        }
+    }
+    return total;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,96 @@
+#pragma once
+
+/**
+ * EOS Testing - Fragment Reassembler (internal)
+ *
+ * Collects the fragments of large reliable messages per peer:
+ * - Fragments may arrive in any order (ReliableUnordered)
+ * - In-flight bytes per peer are capped; messages over budget are dropped
+ * - Incomplete messages are discarded after a timeout
+ *
+ * Only touched from the game thread (receive_packets / tick).
+ */
+
+#include "wire_format.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#ifndef EOS_STUB_MODE
+    #include <eos_sdk.h>
+#else
+    using EOS_ProductUserId = void*;
+#endif
+
+namespace eos_testing {
+
+class FragmentReassembler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param max_bytes_per_peer Cap on in-flight reassembly memory per peer
+     * @param timeout_ms Drop incomplete messages idle for this long
+     */
+    void configure(uint32_t max_bytes_per_peer, uint32_t timeout_ms);
+
+    /**
+     * Add one fragment frame (including its header).
+     *
+     * @param completed Receives the whole message when this fragment completes it
+     * @return true if `completed` now holds a full message
+     */
+    bool add_fragment(EOS_ProductUserId peer,
+                      uint8_t channel,
+                      const uint8_t* frame,
+                      uint32_t frame_size,
+                      Clock::time_point now,
+                      std::vector<uint8_t>& completed);
+
+    /**
+     * Discard incomplete messages that have timed out.
+     *
+     * @return Number of messages discarded
+     */
+    uint32_t expire(Clock::time_point now);
+
+    /**
+     * Discard everything pending from a peer (e.g. on disconnect).
+     */
+    void remove_peer(EOS_ProductUserId peer);
+
+    void clear() {
+        m_messages.clear();
+        m_spare.clear();
+    }
+
+    /**
+     * Bytes currently reserved for a peer's incomplete messages.
+     */
+    uint32_t pending_bytes(EOS_ProductUserId peer) const;
+
+private:
+    struct PendingMessage {
+        EOS_ProductUserId peer = nullptr;
+        uint8_t channel = 0;
+        uint16_t message_id = 0;
+        uint16_t fragment_count = 0;
+        uint16_t fragments_received = 0;
+        std::vector<uint8_t> data;
+        std::vector<bool> received;
+        Clock::time_point last_update;
+    };
+
+    uint32_t m_max_bytes_per_peer = 0;
+    std::chrono::milliseconds m_timeout{0};
+
+    // Few messages are in flight at once, so a flat list is fine
+    std::vector<PendingMessage> m_messages;
+    
+    // Completed messages kept for their buffers, so steady-state
+    // reassembly does not allocate
+    static constexpr size_t MAX_SPARE_MESSAGES = 4;
+    std::vector<PendingMessage> m_spare;
+};
+
+} // namespace eos_testing
@@ -0,0 +1,216 @@
+/**
+ * EOS Testing - Interest Management Implementation
+ */
+
+#include "eos_testing/p2p/interest_manager.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace eos_testing {
+
+namespace {
+
+// Cell coordinates are clamped so far-out (or garbage) positions still map somewhere
+constexpr float MAX_CELL = 1 << 30;
+
+int32_t cell_coordinate(float position, float cell_size) {
+    float cell = std::floor(position / cell_size);
+    if (!(cell > -MAX_CELL)) return static_cast<int32_t>(-MAX_CELL);   // Also NaN
+    if (cell > MAX_CELL) return static_cast<int32_t>(MAX_CELL);
+    return static_cast<int32_t>(cell);
+}
+
+uint64_t cell_key(int32_t cx, int32_t cy) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+}
+
+} // namespace
+
+uint64_t InterestManager::cell_of(float x, float y) const {
+    return cell_key(cell_coordinate(x, m_settings.cell_size), cell_coordinate(y, m_settings.cell_size));
+}
+
+void InterestManager::set_entity(uint16_t id, float x, float y) {
+    if (id >= m_entities.size()) m_entities.resize(static_cast<size_t>(id) + 1);
+
+    Entity& entity = m_entities[id];
+    uint64_t cell = cell_of(x, y);
+    if (!entity.active) {
+        entity.active = true;
+        m_cells[cell].push_back(id);
+        m_entity_count++;
+    } else if (cell != entity.cell) {
+        remove_from_cell(id, entity.cell);
+        m_cells[cell].push_back(id);
+    }
+
+    entity.x = x;
+    entity.y = y;
+    entity.cell = cell;
+}
+
+void InterestManager::remove_entity(uint16_t id) {
+    if (id >= m_entities.size() || !m_entities[id].active) return;
+
+    Entity& entity = m_entities[id];
+    remove_from_cell(id, entity.cell);
+    if (entity.always_relevant) {
+        m_always_relevant.erase(std::find(m_always_relevant.begin(), m_always_relevant.end(), id));
+    }
+    entity = Entity();
+    m_entity_count--;
+}
+
+void InterestManager::remove_from_cell(uint16_t id, uint64_t cell) {
+    auto it = m_cells.find(cell);
+    if (it == m_cells.end()) return;
+
+    auto& ids = it->second;
+    auto position = std::find(ids.begin(), ids.end(), id);
+    if (position != ids.end()) {
+        *position = ids.back();
+        ids.pop_back();
+    }
+    if (ids.empty()) m_cells.erase(it);
+}
+
+void InterestManager::set_always_relevant(uint16_t id, bool always) {
+    if (id >= m_entities.size()) m_entities.resize(static_cast<size_t>(id) + 1);
+
+    Entity& entity = m_entities[id];
+    if (entity.always_relevant == always) return;
+    entity.always_relevant = always;
+
+    if (always) {
+        m_always_relevant.push_back(id);
+    } else {
+        m_always_relevant.erase(std::find(m_always_relevant.begin(), m_always_relevant.end(), id));
+    }
+}
+
+void InterestManager::set_peer(EOS_ProductUserId peer, float x, float y) {
+    Peer& state = m_peers[peer];
+    state.x = x;
+    state.y = y;
+}
+
+void InterestManager::set_peer_callback(EOS_ProductUserId peer, RelevanceCallback callback) {
+    auto it = m_peers.find(peer);
+    if (it != m_peers.end()) it->second.callback = std::move(callback);
+}
+
+void InterestManager::remove_peer(EOS_ProductUserId peer) {
+    m_peers.erase(peer);
+}
+
+uint32_t InterestManager::interval_of(Relevance relevance) const {
+    if (relevance == Relevance::Medium) return m_settings.medium_interval;
+    if (relevance == Relevance::Low) return m_settings.low_interval;
+    return 1;
+}
+
+bool InterestManager::was_due(uint16_t id, Relevance relevance, uint32_t ticks) const {
+    uint32_t interval = interval_of(relevance);
+    if (interval <= 1 || ticks >= interval) return true;
+
+    // Staggered by id, so a tier's updates don't all land on one tick
+    for (uint32_t back = 0; back < ticks; back++) {
+        if ((m_tick - back + id) % interval == 0) return true;
+    }
+    return false;
+}
+
+void InterestManager::update() {
+    m_tick++;
+    m_stats = InterestStats();
+    m_stats.tick = m_tick;
+    m_stats.peers = static_cast<uint32_t>(m_peers.size());
+    m_stats.entities = m_entity_count;
+
+    const float high_squared = m_settings.high_radius * m_settings.high_radius;
+    const float medium_squared = m_settings.medium_radius * m_settings.medium_radius;
+    const float view_squared = m_settings.view_radius * m_settings.view_radius;
+
+    auto spatial = [&](const Peer& viewer, const Entity& entity) {
+        float dx = entity.x - viewer.x;
+        float dy = entity.y - viewer.y;
+        float distance_squared = dx * dx + dy * dy;
+        if (distance_squared <= high_squared) return Relevance::High;
+        if (distance_squared <= medium_squared) return Relevance::Medium;
+        if (distance_squared <= view_squared) return Relevance::Low;
+        return Relevance::None;
+    };
+
+    for (auto& item : m_peers) {
+        EOS_ProductUserId peer = item.first;
+        Peer& viewer = item.second;
+        viewer.entries.clear();
+
+        auto add = [&](uint16_t id, Relevance relevance) {
+            if (viewer.callback) relevance = viewer.callback(peer, id, relevance);
+            if (relevance == Relevance::None) return;
+
+            InterestEntry entry;
+            entry.id = id;
+            entry.relevance = relevance;
+            entry.due = was_due(id, relevance, 1);
+            viewer.entries.push_back(entry);
+        };
+
+        // Cells overlapping the view circle's bounding square
+        int32_t x0 = cell_coordinate(viewer.x - m_settings.view_radius, m_settings.cell_size);
+        int32_t x1 = cell_coordinate(viewer.x + m_settings.view_radius, m_settings.cell_size);
+        int32_t y0 = cell_coordinate(viewer.y - m_settings.view_radius, m_settings.cell_size);
+        int32_t y1 = cell_coordinate(viewer.y + m_settings.view_radius, m_settings.cell_size);
+        for (int64_t cx = x0; cx <= x1; cx++) {
+            for (int64_t cy = y0; cy <= y1; cy++) {
+                auto cell = m_cells.find(cell_key(static_cast<int32_t>(cx), static_cast<int32_t>(cy)));
+                if (cell == m_cells.end()) continue;
+
+                m_stats.candidates += cell->second.size();
+                for (uint16_t id : cell->second) {
+                    const Entity& entity = m_entities[id];
+                    if (entity.always_relevant) continue;   // Added below
+
+                    Relevance relevance = spatial(viewer, entity);
+                    if (relevance != Relevance::None) add(id, relevance);
+                }
+            }
+        }
+
+        for (uint16_t id : m_always_relevant) {
+            const Entity& entity = m_entities[id];
+            if (entity.active) add(id, std::max(spatial(viewer, entity), Relevance::Low));
+        }
+
+        std::sort(viewer.entries.begin(), viewer.entries.end(),
+                  [](const InterestEntry& a, const InterestEntry& b) { return a.id < b.id; });
+
+        m_stats.entries += viewer.entries.size();
+        for (const auto& entry : viewer.entries) m_stats.due += entry.due;
+    }
+}
+
+const std::vector<InterestEntry>& InterestManager::get_interest(EOS_ProductUserId peer) const {
+    static const std::vector<InterestEntry> empty;
+    auto it = m_peers.find(peer);
+    return it != m_peers.end() ? it->second.entries : empty;
+}
+
+Relevance InterestManager::get_relevance(EOS_ProductUserId peer, uint16_t id) const {
+    const auto& entries = get_interest(peer);
+    auto it = std::lower_bound(entries.begin(), entries.end(), id,
+                               [](const InterestEntry& entry, uint16_t key) { return entry.id < key; });
+    return it != entries.end() && it->id == id ? it->relevance : Relevance::None;
+}
+
+void InterestManager::get_interested_peers(uint16_t id, Relevance min_relevance,
+                                           std::vector<EOS_ProductUserId>& out) const {
+    out.clear();
+    for (const auto& item : m_peers) {
+        Relevance relevance = get_relevance(item.first, id);
+        if (relevance != Relevance::None && relevance >= min_relevance) out.push_back(item.first);
+    }
+}
+
+} // namespace eos_testing
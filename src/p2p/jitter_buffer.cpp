@@ -0,0 +1,83 @@
+/**
+ * EOS Testing - Playout Clock Implementation
+ */
+
+#include "eos_testing/p2p/jitter_buffer.hpp"
+
+namespace eos_testing {
+
+namespace {
+
+constexpr uint64_t MAX_INTERVAL_US = 1000000;
+
+} // namespace
+
+void PlayoutClock::reset() {
+    m_arrivals = 0;
+    m_interval_us = 0;
+    m_jitter_us = 0;
+    m_target_delay = 0;
+    m_delay = 0;
+    m_last_now = 0;
+    m_last_render = 0;
+    m_rendering = false;
+}
+
+void PlayoutClock::on_arrival(uint64_t timestamp_us, uint64_t arrival_us) {
+    m_transit[m_arrivals % WINDOW] = static_cast<int64_t>(arrival_us) - static_cast<int64_t>(timestamp_us);
+    m_timestamps[m_arrivals % WINDOW] = timestamp_us;
+    m_arrivals++;
+    uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(m_arrivals, WINDOW));
+
+    // Span over count: unlike gaps between arrivals, not thrown off by
+    // reordering, and losses only make it more cautious
+    if (count > 1) {
+        auto range = std::minmax_element(m_timestamps, m_timestamps + count);
+        m_interval_us = static_cast<uint32_t>(std::min<uint64_t>((*range.second - *range.first) / (count - 1),
+                                                                 MAX_INTERVAL_US));
+    }
+
+    // The delay that covers on_time_fraction of recent arrivals, measured
+    // from the fastest; the clock offset between the two sides cancels out
+    int64_t sorted[WINDOW];
+    std::copy(m_transit, m_transit + count, sorted);
+
+    float fraction = std::min(std::max(m_settings.on_time_fraction, 0.0f), 1.0f);
+    uint32_t rank = static_cast<uint32_t>(std::ceil(fraction * count));
+    rank = std::min(std::max(rank, 1u), count) - 1;
+    std::nth_element(sorted, sorted + rank, sorted + count);
+    int64_t covered = sorted[rank];
+    int64_t fastest = *std::min_element(sorted, sorted + count);
+
+    m_jitter_us = static_cast<uint32_t>(std::min<int64_t>(covered - fastest, m_settings.max_jitter_us));
+
+    // One interval on top, so the snapshot after the render time is in
+    m_target_delay = fastest + m_jitter_us + m_interval_us + m_settings.safety_margin_us;
+}
+
+uint64_t PlayoutClock::render_time(uint64_t now_us) {
+    int64_t error = m_target_delay - m_delay;
+    if (!m_rendering || m_arrivals <= SETTLE_ARRIVALS || error > m_settings.step_threshold_us ||
+        -error > m_settings.step_threshold_us) {
+        m_delay = m_target_delay;
+        m_rendering = true;
+    } else if (now_us > m_last_now) {
+        // Play slightly slower or faster until the delay is on target
+        int64_t limit = static_cast<int64_t>(static_cast<double>(now_us - m_last_now) * m_settings.max_rate_change);
+        m_delay += std::min(std::max(error, -limit), limit);
+    }
+    m_last_now = now_us;
+
+    int64_t render = static_cast<int64_t>(now_us) - m_delay;
+    m_last_render = std::max(m_last_render, render > 0 ? static_cast<uint64_t>(render) : 0);
+    return m_last_render;
+}
+
+void PlayoutClock::fill_stats(JitterStats& stats) const {
+    stats.delay_us = m_delay;
+    stats.target_delay_us = m_target_delay;
+    stats.jitter_us = m_jitter_us;
+    stats.interval_us = m_interval_us;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,120 @@
+/**
+ * EOS Testing - In-Process Loopback Transport Implementation
+ */
+
+#include "eos_testing/p2p/loopback_transport.hpp"
+#include <cstring>
+#include <iostream>
+
+namespace eos_testing {
+
+/**
+ * One endpoint on a LoopbackNetwork
+ */
+class LoopbackTransport : public Transport {
+public:
+    LoopbackTransport(std::shared_ptr<LoopbackNetwork> network,
+                      std::shared_ptr<LoopbackNetwork::Inbox> inbox)
+        : m_network(std::move(network)), m_inbox(std::move(inbox)) {}
+
+    ~LoopbackTransport() override {
+        m_network->remove_endpoint(m_inbox->id);
+    }
+
+    EOS_ProductUserId local_user_id() const override { return m_inbox->id; }
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override {
+        return m_network->deliver(m_inbox->id, peer_id, socket, channel, data, size);
+    }
+
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override {
+        LoopbackNetwork::Packet packet;
+        while (m_inbox->packets.try_pop(packet)) {
+            if (packet.data.size() > capacity) {
+                m_network->m_dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            info.sender = packet.sender;
+            info.socket = packet.socket;
+            info.channel = packet.channel;
+            info.size = packet.data.size();
+            std::memcpy(buffer, packet.data.data(), packet.data.size());
+            return true;
+        }
+        return false;
+    }
+
+private:
+    // Network first: the inbox's buffers belong to its pool
+    std::shared_ptr<LoopbackNetwork> m_network;
+    std::shared_ptr<LoopbackNetwork::Inbox> m_inbox;
+};
+
+LoopbackNetwork::LoopbackNetwork(uint32_t inbox_capacity, uint32_t max_packet_size)
+    : m_inbox_capacity(inbox_capacity)
+    , m_max_packet_size(max_packet_size)
+    , m_inboxes(std::make_shared<InboxMap>()) {
+    // Enough for a few full inboxes; beyond that the pool falls back to the heap
+    m_pool.reset(max_packet_size, inbox_capacity * 4);
+}
+
+std::shared_ptr<Transport> LoopbackNetwork::create_endpoint(EOS_ProductUserId local_user_id) {
+    std::lock_guard<std::mutex> lock(m_endpoints_mutex);
+
+    auto current = std::atomic_load(&m_inboxes);
+    if (!local_user_id || current->count(local_user_id) > 0) {
+        std::cout << "[P2P] Error: Loopback endpoint id " << local_user_id << " is invalid or taken\n";
+        return nullptr;
+    }
+
+    auto inbox = std::make_shared<Inbox>();
+    inbox->id = local_user_id;
+    inbox->packets.reset(m_inbox_capacity);
+
+    auto updated = std::make_shared<InboxMap>(*current);
+    (*updated)[local_user_id] = inbox;
+    std::atomic_store(&m_inboxes, std::shared_ptr<const InboxMap>(std::move(updated)));
+
+    return std::make_shared<LoopbackTransport>(shared_from_this(), std::move(inbox));
+}
+
+void LoopbackNetwork::remove_endpoint(EOS_ProductUserId local_user_id) {
+    std::lock_guard<std::mutex> lock(m_endpoints_mutex);
+
+    auto updated = std::make_shared<InboxMap>(*std::atomic_load(&m_inboxes));
+    updated->erase(local_user_id);
+    std::atomic_store(&m_inboxes, std::shared_ptr<const InboxMap>(std::move(updated)));
+}
+
+bool LoopbackNetwork::deliver(EOS_ProductUserId sender, EOS_ProductUserId target,
+                              uint8_t socket, uint8_t channel, const uint8_t* data, uint32_t size) {
+    auto inboxes = std::atomic_load(&m_inboxes);
+    auto it = inboxes->find(target);
+    if (it == inboxes->end() || size > m_max_packet_size) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Packet packet;
+    packet.sender = sender;
+    packet.socket = socket;
+    packet.channel = channel;
+    packet.data = m_pool.acquire(size);
+    std::memcpy(packet.data.data(), data, size);
+
+    if (!it->second->packets.try_push(std::move(packet))) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    m_delivered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,215 @@
+/**
+ * EOS Testing - Network Condition Simulator Implementation
+ */
+
+#include "eos_testing/p2p/network_simulator.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace eos_testing {
+
+namespace {
+
+// Bound on delayed packets, so a stalled receiver can't grow the heap forever
+constexpr size_t MAX_DELAYED_PACKETS = 1 << 16;
+
+constexpr uint32_t POOL_SLABS = 1024;
+
+} // namespace
+
+NetworkSimulator::NetworkSimulator(std::shared_ptr<Transport> inner,
+                                   const NetworkConditions& conditions,
+                                   uint32_t max_packet_size,
+                                   ClockSource clock)
+    : m_inner(std::move(inner))
+    , m_conditions(conditions)
+    , m_clock(clock ? std::move(clock) : ClockSource([] { return Clock::now(); }))
+    , m_scratch(max_packet_size)
+    , m_rng(conditions.seed) {
+    m_pool.reset(max_packet_size, POOL_SLABS);
+
+    // Gilbert-Elliott: leaving a burst with probability 1/length gives the
+    // mean burst length; entering is then chosen to hit the overall rate
+    float loss = std::min(std::max(conditions.loss_rate, 0.0f), 0.99f);
+    if (conditions.loss_burst_length > 1.0f) {
+        m_leave_burst_probability = 1.0f / conditions.loss_burst_length;
+        m_enter_burst_probability = loss * m_leave_burst_probability / (1.0f - loss);
+    } else {
+        m_enter_burst_probability = loss;
+    }
+
+    m_bytes_per_second = conditions.bandwidth_kbps * 1000.0 / 8.0;
+    m_tokens = conditions.bandwidth_burst_bytes;
+    m_tokens_updated = m_clock();
+}
+
+NetworkSimulator::~NetworkSimulator() {
+    // The wrapped transport may outlive us (it can be shared with the caller)
+    m_inner->on_connection_request = nullptr;
+    m_inner->on_connection_established = nullptr;
+    m_inner->on_connection_closed = nullptr;
+}
+
+bool NetworkSimulator::open() {
+    // Connection events aren't impaired; pass them straight up
+    m_inner->on_connection_request = [this](EOS_ProductUserId peer_id) {
+        if (on_connection_request) on_connection_request(peer_id);
+    };
+    m_inner->on_connection_established = [this](EOS_ProductUserId peer_id) {
+        if (on_connection_established) on_connection_established(peer_id);
+    };
+    m_inner->on_connection_closed = [this](EOS_ProductUserId peer_id) {
+        if (on_connection_closed) on_connection_closed(peer_id);
+    };
+
+    return m_inner->open();
+}
+
+void NetworkSimulator::close() {
+    m_inner->close();
+    m_inner->on_connection_request = nullptr;
+    m_inner->on_connection_established = nullptr;
+    m_inner->on_connection_closed = nullptr;
+
+    m_delayed.clear();
+    m_in_flight.store(0, std::memory_order_relaxed);
+}
+
+bool NetworkSimulator::receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) {
+    Clock::time_point now = m_clock();
+
+    TransportPacketInfo incoming;
+    while (m_inner->receive(incoming, m_scratch.data(), static_cast<uint32_t>(m_scratch.size()))) {
+        admit(incoming, m_scratch.data(), now);
+    }
+
+    while (!m_delayed.empty() && m_delayed.front().due <= now) {
+        std::pop_heap(m_delayed.begin(), m_delayed.end(), Later());
+        DelayedPacket packet = std::move(m_delayed.back());
+        m_delayed.pop_back();
+        m_in_flight.fetch_sub(1, std::memory_order_relaxed);
+
+        if (packet.data.size() > capacity) continue;
+
+        info.sender = packet.sender;
+        info.socket = packet.socket;
+        info.channel = packet.channel;
+        info.size = packet.data.size();
+        std::memcpy(buffer, packet.data.data(), packet.data.size());
+        m_delivered.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+
+NetworkSimulatorStats NetworkSimulator::get_stats() const {
+    NetworkSimulatorStats stats;
+    stats.received = m_received.load(std::memory_order_relaxed);
+    stats.delivered = m_delivered.load(std::memory_order_relaxed);
+    stats.lost = m_lost.load(std::memory_order_relaxed);
+    stats.bandwidth_dropped = m_bandwidth_dropped.load(std::memory_order_relaxed);
+    stats.duplicated = m_duplicated.load(std::memory_order_relaxed);
+    stats.reordered = m_reordered.load(std::memory_order_relaxed);
+    stats.in_flight = m_in_flight.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void NetworkSimulator::admit(const TransportPacketInfo& info, const uint8_t* data, Clock::time_point now) {
+    m_received.fetch_add(1, std::memory_order_relaxed);
+
+    if (is_lost()) {
+        m_lost.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Clock::time_point departure;
+    if (m_delayed.size() >= MAX_DELAYED_PACKETS || !take_bandwidth(info.size, now, departure)) {
+        m_bandwidth_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Clock::time_point due = departure + std::chrono::milliseconds(m_conditions.latency_ms) + random_jitter();
+
+    bool reordered = m_conditions.reorder_rate > 0.0f && random_unit() < m_conditions.reorder_rate;
+    if (reordered) {
+        due += std::chrono::milliseconds(m_conditions.reorder_delay_ms);
+        m_reordered.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // Jitter varies the delay, not the order
+        due = std::max(due, m_last_due);
+        m_last_due = due;
+    }
+    schedule(info, data, due);
+
+    if (m_conditions.duplicate_rate > 0.0f && random_unit() < m_conditions.duplicate_rate) {
+        m_duplicated.fetch_add(1, std::memory_order_relaxed);
+        schedule(info, data, due);
+    }
+}
+
+void NetworkSimulator::schedule(const TransportPacketInfo& info, const uint8_t* data, Clock::time_point due) {
+    DelayedPacket packet;
+    packet.due = due;
+    packet.order = m_next_order++;
+    packet.sender = info.sender;
+    packet.socket = info.socket;
+    packet.channel = info.channel;
+    packet.data = m_pool.acquire(info.size);
+    std::memcpy(packet.data.data(), data, info.size);
+
+    m_delayed.push_back(std::move(packet));
+    std::push_heap(m_delayed.begin(), m_delayed.end(), Later());
+    m_in_flight.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool NetworkSimulator::is_lost() {
+    if (m_enter_burst_probability <= 0.0f) return false;
+
+    if (m_in_loss_burst) {
+        if (random_unit() < m_leave_burst_probability) m_in_loss_burst = false;
+    } else {
+        if (random_unit() < m_enter_burst_probability) m_in_loss_burst = true;
+    }
+
+    // Independent losses never stay in the burst state
+    bool lost = m_in_loss_burst;
+    if (m_conditions.loss_burst_length <= 1.0f) m_in_loss_burst = false;
+    return lost;
+}
+
+bool NetworkSimulator::take_bandwidth(uint32_t size, Clock::time_point now, Clock::time_point& departure) {
+    departure = now;
+    if (m_bytes_per_second <= 0.0) return true;
+
+    double elapsed = std::chrono::duration<double>(now - m_tokens_updated).count();
+    m_tokens_updated = now;
+    m_tokens = std::min<double>(m_conditions.bandwidth_burst_bytes, m_tokens + elapsed * m_bytes_per_second);
+
+    // Out of tokens: the packet waits for the bucket to refill behind
+    // everything already queued
+    double remaining = m_tokens - size;
+    if (remaining < 0.0) {
+        double wait_seconds = -remaining / m_bytes_per_second;
+        if (wait_seconds * 1000.0 > m_conditions.bandwidth_queue_ms) return false;
+        departure += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait_seconds));
+    }
+
+    m_tokens = remaining;
+    return true;
+}
+
+float NetworkSimulator::random_unit() {
+    // mt19937 output is specified by the standard, unlike the distributions,
+    // so a seed gives the same run on every platform
+    return static_cast<float>(m_rng() >> 8) * (1.0f / 16777216.0f);
+}
+
+NetworkSimulator::Clock::duration NetworkSimulator::random_jitter() {
+    if (m_conditions.jitter_ms == 0) return Clock::duration::zero();
+
+    double offset_ms = (random_unit() * 2.0 - 1.0) * m_conditions.jitter_ms;
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(offset_ms));
+}
+
+} // namespace eos_testing
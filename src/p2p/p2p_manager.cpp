@@ -5,59 +5,274 @@
 #include "eos_testing/p2p/p2p_manager.hpp"
 #include "eos_testing/core/platform.hpp"
 #include "eos_testing/auth/auth_manager.hpp"
+#include "wire_format.hpp"
+#include "fragment_reassembler.hpp"
+#include "reliability_layer.hpp"
+#include "stub_transport.hpp"
+#include "eos_transport.hpp"
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
 namespace eos_testing {
 
+namespace {
+// Largest packet EOS will ever hand us
+constexpr uint32_t EOS_MAX_PACKET_SIZE = 1170;
+
+// Time sync exchange interval until the first estimate settles
+constexpr uint64_t TIME_SYNC_SETTLE_INTERVAL_US = 100 * 1000;
+
+// Packets the I/O thread reads before checking whether it should stop
+constexpr uint32_t MAX_PACKETS_PER_POLL = 4096;
+
+// Backpressure turns on over the mark and off back under half of it;
+// returns whether it changed
+bool update_mark(bool& active, uint64_t queued, uint64_t mark) {
+    bool next = active ? queued > mark / 2 : queued > mark;
+    if (next == active) return false;
+    active = next;
+    return true;
+}
+}
+
+IncomingPacket PacketView::retain() const {
+    IncomingPacket packet;
+    packet.sender = sender;
+    packet.socket = socket;
+    packet.channel = channel;
+    packet.data = pool ? pool->acquire(size) : PacketBuffer::allocate(size);
+    if (size > 0) {
+        std::memcpy(packet.data.data(), data, size);
+    }
+    return packet;
+}
+
 P2PManager& P2PManager::instance() {
     static P2PManager instance;
     return instance;
 }
 
+P2PManager::P2PManager() = default;
+
+P2PManager::~P2PManager() {
+    // The shared instance may outlive the EOS platform, so don't call into
+    // the SDK here; just make sure nothing calls back into us
+    stop_io_thread();
+    if (m_transport) {
+        m_transport->on_connection_request = nullptr;
+        m_transport->on_connection_established = nullptr;
+        m_transport->on_connection_closed = nullptr;
+    }
+}
+
 bool P2PManager::initialize(const P2PConfig& config) {
     if (m_initialized) {
         std::cout << "[P2P] Already initialized\n";
         return true;
     }
     
-    if (!AuthManager::instance().is_logged_in()) {
+    // A custom transport brings its own identity
+    if (!config.transport && !AuthManager::instance().is_logged_in()) {
         std::cout << "[P2P] Error: Must be logged in before initializing P2P\n";
         return false;
     }
     
+    // Socket 0 is socket_name with the top-level channel settings
+    std::vector<SocketConfig> sockets(1);
+    sockets[0].name = config.socket_name;
+    sockets[0].channel_priorities = config.channel_priorities;
+    sockets[0].channel_compression = config.channel_compression;
+    sockets[0].incoming_queue_capacity = config.incoming_queue_capacity;
+    sockets.insert(sockets.end(), config.sockets.begin(), config.sockets.end());
+    for (const auto& name : config.additional_sockets) {
+        sockets.emplace_back();
+        sockets.back().name = name;
+    }
+    if (sockets.size() > MAX_SOCKETS) {
+        std::cout << "[P2P] Error: Too many sockets (" << sockets.size() << " > " << MAX_SOCKETS << ")\n";
+        return false;
+    }
+    
+    std::vector<std::string> socket_names;
+    for (const auto& socket : sockets) {
+        // EOS socket names are 1-32 characters; reject rather than truncate
+        if (socket.name.empty() || socket.name.size() > 32) {
+            std::cout << "[P2P] Error: Invalid socket name '" << socket.name << "' (must be 1-32 characters)\n";
+            return false;
+        }
+        if (std::find(socket_names.begin(), socket_names.end(), socket.name) != socket_names.end()) {
+            std::cout << "[P2P] Error: Duplicate socket name '" << socket.name << "'\n";
+            return false;
+        }
+        socket_names.push_back(socket.name);
+    }
+    
     m_config = config;
+    m_receive_buffer.resize(std::max(config.max_packet_size, EOS_MAX_PACKET_SIZE));
+    m_decompressed_frame.resize(m_receive_buffer.size());
+    m_packet_pool.reset(static_cast<uint32_t>(m_receive_buffer.size()), config.packet_pool_slabs);
+    m_sockets.clear();
+    for (auto& socket_config : sockets) {
+        auto socket = std::make_unique<SocketState>();
+        socket->config = std::move(socket_config);
+        socket->incoming.reset(socket->config.incoming_queue_capacity);
+        m_sockets.push_back(std::move(socket));
+    }
+    m_dropped_packets.store(0, std::memory_order_relaxed);
+    for (auto* counter : {&m_frames_compressed, &m_frames_incompressible, &m_compression_bytes_in,
+                          &m_compression_bytes_out, &m_frames_decompressed, &m_decompress_failures}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+    m_epoch = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_time_mutex);
+        m_time_sync.reset();
+        m_time_authority = nullptr;
+    }
     
+    if (!m_reassembler) m_reassembler = std::make_unique<FragmentReassembler>();
+    m_reassembler->configure(config.max_reassembly_bytes_per_peer, config.reassembly_timeout_ms);
+    
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_peers.reset(config.max_peers);
+        publish_peer_snapshot();
+        
+        CongestionController::Settings congestion;
+        congestion.min_bytes_per_second = config.congestion_min_bytes_per_second;
+        congestion.initial_bytes_per_second = config.congestion_initial_bytes_per_second;
+        congestion.max_bytes_per_second = config.congestion_max_bytes_per_second;
+        congestion.delay_threshold_us = config.congestion_delay_threshold_ms * 1000;
+        congestion.probe_interval_us = config.congestion_probe_interval_ms * 1000;
+        m_congestion.assign(config.congestion_control ? config.max_peers : 0,
+                            CongestionSlot{nullptr, CongestionController(congestion), 0});
+        m_transport_queue_bytes = 0;
+        
+        m_backpressure.assign(config.send_high_water_bytes > 0 ? config.max_peers : 0, BackpressureSlot());
+        m_transport_backpressure = false;
+    }
+    
+    m_transport = config.transport;
+    if (!m_transport) {
 #ifdef EOS_STUB_MODE
-    std::cout << "[EOS-STUB] P2P initialized with socket: " << config.socket_name << "\n";
-    std::cout << "[EOS-STUB] Relay enabled: " << (config.allow_relay ? "yes" : "no") << "\n";
-    m_initialized = true;
-    return true;
+        m_transport = std::make_shared<StubTransport>(config.stub_loopback, config.incoming_queue_capacity,
+                                                      static_cast<uint32_t>(m_receive_buffer.size()));
 #else
-    auto platform = Platform::instance().get_handle();
-    if (!platform) {
+        m_transport = std::make_shared<EOSTransport>(socket_names, config.allow_delayed_delivery);
+#endif
+    }
+    
+    if (config.network_conditions.is_active()) {
+        const NetworkConditions& conditions = config.network_conditions;
+        m_network_simulator = std::make_shared<NetworkSimulator>(m_transport, conditions,
+                                                                 static_cast<uint32_t>(m_receive_buffer.size()));
+        m_transport = m_network_simulator;
+        std::cout << "[P2P] Simulating network: " << conditions.latency_ms << " ms +/- "
+                  << conditions.jitter_ms << " ms, " << conditions.loss_rate * 100.0f << "% loss";
+        if (conditions.bandwidth_kbps > 0) std::cout << ", " << conditions.bandwidth_kbps << " kbps";
+        std::cout << "\n";
+    }
+    
+    // Outside the simulator, so the capture holds what the game saw
+    if (!config.capture_path.empty()) {
+        m_capture = std::make_shared<CaptureTransport>(m_transport, config.capture_path,
+                                                       config.capture_max_buffered_bytes);
+        m_transport = m_capture;
+    }
+    
+    m_transport->on_connection_request = [this](EOS_ProductUserId peer_id) { handle_connection_request(peer_id); };
+    m_transport->on_connection_established = [this](EOS_ProductUserId peer_id) { handle_connection_established(peer_id); };
+    m_transport->on_connection_closed = [this](EOS_ProductUserId peer_id) { handle_connection_closed(peer_id); };
+    
+    if (config.threaded_receive && !m_transport->supports_threaded_receive()) {
+        std::cout << "[P2P] Error: threaded_receive isn't supported by this transport (EOS calls stay on the tick thread)\n";
+        m_transport.reset();
+        m_network_simulator.reset();
+        m_capture.reset();
+        return false;
+    }
+    
+    if (!m_transport->open()) {
         std::cout << "[P2P] Error: Platform not initialized\n";
+        m_transport.reset();
+        m_network_simulator.reset();
+        m_capture.reset();
         return false;
     }
+    m_local_user_id = m_transport->local_user_id();
+    
+    for (size_t index = 0; index < m_sockets.size(); index++) {
+        auto& reliability = m_sockets[index]->reliability;
+        reliability = std::make_unique<ReliabilityLayer>();
+        reliability->configure(m_transport.get(), &m_packet_pool, config.reliability_min_rto_ms,
+                               config.reliability_max_rto_ms, static_cast<uint8_t>(index));
+    }
+    
+    SendScheduler::Settings schedule;
+    schedule.bytes_per_second = config.congestion_control ? config.congestion_initial_bytes_per_second
+                                                          : config.send_budget_bytes_per_second;
+    schedule.burst_bytes = config.send_budget_burst_bytes;
+    schedule.max_unreliable_delay_ms = config.send_max_unreliable_delay_ms;
+    schedule.max_queued_bytes = config.send_max_queued_bytes_per_peer;
+    schedule.quantum_bytes = config.max_packet_size;
+    schedule.channel_priorities = config.channel_priorities;
+    schedule.socket_channel_priorities.resize(m_sockets.size());
+    for (size_t index = 1; index < m_sockets.size(); index++) {
+        schedule.socket_channel_priorities[index] = m_sockets[index]->config.channel_priorities;
+    }
+    m_scheduler.configure(schedule, &m_packet_pool);
     
-    register_callbacks();
     m_initialized = true;
+    if (config.threaded_receive) start_io_thread();
+    
+#ifdef EOS_STUB_MODE
+    std::cout << "[EOS-STUB] P2P initialized with socket: " << config.socket_name << "\n";
+    std::cout << "[EOS-STUB] Relay enabled: " << (config.allow_relay ? "yes" : "no") << "\n";
+#else
     std::cout << "[EOS] P2P initialized\n";
-    return true;
 #endif
+    return true;
 }
 
 void P2PManager::shutdown() {
     if (!m_initialized) return;
     
+    stop_io_thread();
+    
+    {
+        std::lock_guard<std::mutex> lock(m_batches_mutex);
+        m_batches.clear();
+    }
+    
+    if (!m_transport->is_simulated()) {
+        disconnect_all();
+    }
+    m_scheduler.clear();
+    m_released_frames.clear();
+    for (auto& socket : m_sockets) {
+        socket->reliability->clear();
+    }
+    m_transport->close();
+    m_transport->on_connection_request = nullptr;
+    m_transport->on_connection_established = nullptr;
+    m_transport->on_connection_closed = nullptr;
+    m_transport.reset();
+    m_network_simulator.reset();
+    m_capture.reset();
+    m_config.transport.reset();
+    
 #ifdef EOS_STUB_MODE
     std::cout << "[EOS-STUB] P2P shutdown\n";
-#else
-    disconnect_all();
-    unregister_callbacks();
 #endif
     
-    m_connections.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_peers.clear();
+        publish_peer_snapshot();
+    }
     m_initialized = false;
 }
 
@@ -70,50 +285,39 @@ void P2PManager::accept_connections(EOS_ProductUserId peer_id) {
     } else {
         std::cout << "[EOS-STUB] Accepting connections from all peers\n";
     }
-#else
-    auto platform = Platform::instance().get_handle();
-    if (!platform) return;
-    
-    EOS_P2P_AcceptConnectionOptions options = {};
-    options.ApiVersion = EOS_P2P_ACCEPTCONNECTION_API_LATEST;
-    options.LocalUserId = AuthManager::instance().get_product_user_id();
-    options.RemoteUserId = peer_id;
-    
-    EOS_P2P_SocketId socket_id = {};
-    socket_id.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
-    strncpy(socket_id.SocketName, m_config.socket_name.c_str(), 
-            sizeof(socket_id.SocketName) - 1);
-    options.SocketId = &socket_id;
-    
-    EOS_P2P_AcceptConnection(EOS_Platform_GetP2PInterface(platform), &options);
 #endif
+    m_transport->accept(peer_id);
 }
 
 void P2PManager::connect_to_peer(EOS_ProductUserId peer_id) {
     if (!m_initialized || !peer_id) return;
     
+    if (m_transport->is_simulated()) {
 #ifdef EOS_STUB_MODE
-    std::cout << "[EOS-STUB] Connecting to peer: " << peer_id << "\n";
-    
-    // Simulate connection
-    PeerConnection conn;
-    conn.peer_id = peer_id;
-    conn.display_name = "StubPeer";
-    conn.status = ConnectionStatus::Connected;
-    conn.is_relay = false;
-    conn.ping_ms = 25;
-    
-    {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        m_connections[peer_id] = conn;
+        std::cout << "[EOS-STUB] Connecting to peer: " << peer_id << "\n";
+#endif
+        
+        // Simulate connection
+        {
+            std::lock_guard<std::mutex> lock(m_connections_mutex);
+            PeerIndex index = add_peer(peer_id, ConnectionStatus::Connected);
+            if (index == INVALID_PEER_INDEX) return;
+            
+            m_peers.cold(index).display_name = "StubPeer";
+            m_peers.hot(index).is_relay = false;
+            m_peers.hot(index).ping_ms = 25;
+        }
+        
+#ifdef EOS_STUB_MODE
+        std::cout << "[EOS-STUB] Connected to peer (simulated)\n";
+#endif
+        
+        if (on_connection_established) {
+            on_connection_established(peer_id, ConnectionStatus::Connected);
+        }
+        return;
     }
     
-    std::cout << "[EOS-STUB] Connected to peer (simulated)\n";
-    
-    if (on_connection_established) {
-        on_connection_established(peer_id, ConnectionStatus::Connected);
-    }
-#else
     // Send a "hello" packet to initiate connection
     uint8_t hello[] = {0x01}; // Connection request marker
     send_packet(peer_id, hello, sizeof(hello), 0, PacketReliability::ReliableOrdered);
@@ -121,12 +325,8 @@ void P2PManager::connect_to_peer(EOS_ProductUserId peer_id) {
     // Mark as connecting
     {
         std::lock_guard<std::mutex> lock(m_connections_mutex);
-        PeerConnection conn;
-        conn.peer_id = peer_id;
-        conn.status = ConnectionStatus::Connecting;
-        m_connections[peer_id] = conn;
+        add_peer(peer_id, ConnectionStatus::Connecting);
     }
-#endif
 }
 
 void P2PManager::disconnect_from_peer(EOS_ProductUserId peer_id) {
@@ -134,37 +334,25 @@ void P2PManager::disconnect_from_peer(EOS_ProductUserId peer_id) {
     
 #ifdef EOS_STUB_MODE
     std::cout << "[EOS-STUB] Disconnecting from peer: " << peer_id << "\n";
+#endif
+    
+    m_transport->disconnect(peer_id);
     
     {
         std::lock_guard<std::mutex> lock(m_connections_mutex);
-        m_connections.erase(peer_id);
+        if (m_peers.remove(peer_id)) publish_peer_snapshot();
     }
-    
-    if (on_connection_closed) {
-        on_connection_closed(peer_id, ConnectionStatus::Disconnected);
+    m_reassembler->remove_peer(peer_id);
+    for (auto& socket : m_sockets) {
+        socket->reliability->remove_peer(peer_id);
     }
-#else
-    auto platform = Platform::instance().get_handle();
-    if (!platform) return;
+    m_scheduler.remove_peer(peer_id);
+    drop_batches(peer_id);
     
-    EOS_P2P_CloseConnectionOptions options = {};
-    options.ApiVersion = EOS_P2P_CLOSECONNECTION_API_LATEST;
-    options.LocalUserId = AuthManager::instance().get_product_user_id();
-    options.RemoteUserId = peer_id;
-    
-    EOS_P2P_SocketId socket_id = {};
-    socket_id.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
-    strncpy(socket_id.SocketName, m_config.socket_name.c_str(),
-            sizeof(socket_id.SocketName) - 1);
-    options.SocketId = &socket_id;
-    
-    EOS_P2P_CloseConnection(EOS_Platform_GetP2PInterface(platform), &options);
-    
-    {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        m_connections.erase(peer_id);
+    // EOS raises its own closed notification; simulated transports don't
+    if (m_transport->is_simulated() && on_connection_closed) {
+        on_connection_closed(peer_id, ConnectionStatus::Disconnected);
     }
-#endif
 }
 
 void P2PManager::disconnect_all() {
@@ -172,9 +360,9 @@ void P2PManager::disconnect_all() {
     
     {
         std::lock_guard<std::mutex> lock(m_connections_mutex);
-        for (const auto& pair : m_connections) {
-            peers.push_back(pair.first);
-        }
+        m_peers.for_each([&](PeerIndex index) {
+            peers.push_back(m_peers.hot(index).peer_id);
+        });
     }
     
     for (auto peer_id : peers) {
@@ -182,194 +370,1094 @@ void P2PManager::disconnect_all() {
     }
 }
 
-bool P2PManager::send_packet(EOS_ProductUserId peer_id,
-                              const void* data,
-                              uint32_t size,
-                              uint8_t channel,
-                              PacketReliability reliability) {
-    if (!m_initialized || !peer_id || !data || size == 0) return false;
+SendResult P2PManager::send_packet(EOS_ProductUserId peer_id,
+                                    const void* data,
+                                    uint32_t size,
+                                    uint8_t channel,
+                                    PacketReliability reliability) {
+    return send_on_socket(0, peer_id, data, size, channel, reliability);
+}
+
+SendResult P2PManager::send_on_socket(uint8_t socket,
+                                       EOS_ProductUserId peer_id,
+                                       const void* data,
+                                       uint32_t size,
+                                       uint8_t channel,
+                                       std::optional<PacketReliability> requested) {
+    SendResult result;
+    if (!m_initialized || !peer_id || !data || size == 0) return result;
+    if (socket >= m_sockets.size()) {
+        std::cout << "[P2P] Error: Unknown socket " << static_cast<int>(socket) << "\n";
+        return result;
+    }
+    PacketReliability reliability = requested.value_or(m_sockets[socket]->config.default_reliability);
     
-    if (size > m_config.max_packet_size) {
+    uint32_t max_payload = max_frame_size(reliability) - wire::FRAME_HEADER_SIZE;
+    if (size > max_payload && reliability == PacketReliability::UnreliableUnordered) {
         std::cout << "[P2P] Error: Packet too large (" << size << " > " 
-                  << m_config.max_packet_size << ")\n";
+                  << max_payload << ")\n";
+        return result;
+    }
+    
+    result.transport_queued_bytes = m_transport_queue_bytes.load(std::memory_order_relaxed);
+    if (is_backpressured(peer_id, socket, channel, result)) {
+        m_backpressure_rejected.fetch_add(1, std::memory_order_relaxed);
+        result.status = SendStatus::Rejected;
+        return result;
+    }
+    
+    bool sent = false;
+    SendQueueDepth depth;
+    if (size > max_payload) {
+        sent = send_fragmented(socket, peer_id, static_cast<const uint8_t*>(data), size, channel, reliability);
+        if (uses_scheduler()) depth = m_scheduler.get_queue_depth(peer_id, channel, socket);
+    } else {
+        // Stage [frame type][payload] in a pooled buffer
+        PacketBuffer frame = m_packet_pool.acquire(wire::FRAME_HEADER_SIZE + size);
+        frame[0] = static_cast<uint8_t>(wire::FrameType::Data);
+        std::memcpy(frame.data() + wire::FRAME_HEADER_SIZE, data, size);
+        
+        sent = send_wire(socket, peer_id, frame.data(), frame.size(), channel, reliability, PeerSlot(), &depth);
+    }
+    m_transport->flush();
+    
+    result.peer_queued_bytes = depth.peer_bytes;
+    result.channel_queued_bytes = depth.channel_bytes;
+    if (sent) result.status = uses_scheduler() ? SendStatus::Queued : SendStatus::Sent;
+    return result;
+}
+
+bool P2PManager::send_fragmented(uint8_t socket,
+                                  EOS_ProductUserId peer_id,
+                                  const uint8_t* data,
+                                  uint32_t size,
+                                  uint8_t channel,
+                                  PacketReliability reliability) {
+    uint32_t chunk_size = max_frame_size(reliability) - wire::FRAGMENT_HEADER_SIZE;
+    uint32_t count = (size + chunk_size - 1) / chunk_size;
+    if (count > wire::MAX_FRAGMENT_COUNT) {
+        std::cout << "[P2P] Error: Message too large to fragment (" << size << " bytes)\n";
         return false;
     }
     
-#ifdef EOS_STUB_MODE
-    // Just pretend we sent it
-    {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        auto it = m_connections.find(peer_id);
-        if (it != m_connections.end()) {
-            it->second.bytes_sent += size;
+    wire::FragmentHeader header;
+    header.message_id = m_next_message_id.fetch_add(1, std::memory_order_relaxed);
+    header.count = static_cast<uint16_t>(count);
+    header.total_size = size;
+    
+    PacketBuffer frame = m_packet_pool.acquire(m_config.max_packet_size);
+    for (uint32_t index = 0; index < count; index++) {
+        uint32_t offset = index * chunk_size;
+        uint32_t length = std::min(chunk_size, size - offset);
+        
+        header.index = static_cast<uint16_t>(index);
+        wire::write_fragment_header(frame.data(), header);
+        std::memcpy(frame.data() + wire::FRAGMENT_HEADER_SIZE, data + offset, length);
+        
+        if (!send_wire(socket, peer_id, frame.data(), wire::FRAGMENT_HEADER_SIZE + length, channel, reliability)) {
+            return false;
         }
     }
+    
     return true;
-#else
-    auto platform = Platform::instance().get_handle();
-    if (!platform) return false;
-    
-    EOS_P2P_SendPacketOptions options = {};
-    options.ApiVersion = EOS_P2P_SENDPACKET_API_LATEST;
-    options.LocalUserId = AuthManager::instance().get_product_user_id();
-    options.RemoteUserId = peer_id;
-    options.Channel = channel;
-    options.DataLengthBytes = size;
-    options.Data = data;
-    options.bAllowDelayedDelivery = EOS_TRUE;
-    
-    EOS_P2P_SocketId socket_id = {};
-    socket_id.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
-    strncpy(socket_id.SocketName, m_config.socket_name.c_str(),
-            sizeof(socket_id.SocketName) - 1);
-    options.SocketId = &socket_id;
-    
-    switch (reliability) {
-        case PacketReliability::UnreliableUnordered:
-            options.Reliability = EOS_EPacketReliability::EOS_PR_UnreliableUnordered;
-            break;
-        case PacketReliability::ReliableUnordered:
-            options.Reliability = EOS_EPacketReliability::EOS_PR_ReliableUnordered;
-            break;
-        case PacketReliability::ReliableOrdered:
-            options.Reliability = EOS_EPacketReliability::EOS_PR_ReliableOrdered;
+}
+
+bool P2PManager::send_wire(uint8_t socket,
+                            EOS_ProductUserId peer_id,
+                            const uint8_t* data,
+                            uint32_t size,
+                            uint8_t channel,
+                            PacketReliability reliability,
+                            PeerSlot slot,
+                            SendQueueDepth* depth) {
+    // Compress into a pooled buffer; keep the original unless it shrinks
+    PacketBuffer compressed;
+    const auto& channel_compression = m_sockets[socket]->config.channel_compression;
+    if (channel < channel_compression.size() && size >= m_config.compression_min_frame_size &&
+        size > wire::COMPRESSED_HEADER_SIZE + 1 && size <= 0xFFFF) {
+        const ChannelCompression& setting = channel_compression[channel];
+        const CompressionDictionary* dictionary =
+            setting.mode == CompressionMode::Dictionary ? setting.dictionary.get() : nullptr;
+        if (setting.mode == CompressionMode::Fast || dictionary) {
+            compressed = m_packet_pool.acquire(size);
+            uint32_t capacity = size - 1 - wire::COMPRESSED_HEADER_SIZE;
+            uint32_t length = lz_compress(data, size, compressed.data() + wire::COMPRESSED_HEADER_SIZE,
+                                          capacity, dictionary);
+            if (length > 0) {
+                compressed[0] = static_cast<uint8_t>(wire::FrameType::Compressed);
+                compressed[1] = static_cast<uint8_t>(setting.mode);
+                compressed[2] = static_cast<uint8_t>(dictionary ? dictionary->id() : 0);
+                wire::write_u16(compressed.data() + 3, static_cast<uint16_t>(size));
+                
+                m_frames_compressed.fetch_add(1, std::memory_order_relaxed);
+                m_compression_bytes_in.fetch_add(size, std::memory_order_relaxed);
+                size = wire::COMPRESSED_HEADER_SIZE + length;
+                m_compression_bytes_out.fetch_add(size, std::memory_order_relaxed);
+                data = compressed.data();
+            } else {
+                m_frames_incompressible.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    
+    if (uses_scheduler()) {
+        return m_scheduler.enqueue(peer_id, channel, data, size, reliability, SendScheduler::Clock::now(), depth,
+                                   socket);
+    }
+    
+    return transmit_wire(socket, peer_id, data, size, channel, reliability, slot);
+}
+
+bool P2PManager::transmit_wire(uint8_t socket,
+                                EOS_ProductUserId peer_id,
+                                const uint8_t* data,
+                                uint32_t size,
+                                uint8_t channel,
+                                PacketReliability reliability,
+                                PeerSlot slot) {
+    bool sent = uses_custom_reliability(reliability)
+        ? m_sockets[socket]->reliability->send(peer_id, channel, data, size,
+                                               reliability == PacketReliability::ReliableOrdered,
+                                               ReliabilityLayer::Clock::now())
+        : m_transport->send(peer_id, channel, data, size, reliability, socket);
+    if (!sent) {
+        return false;
+    }
+    
+    // Broadcast passes the slot in from its snapshot, so while that is
+    // still current no lock is needed. Unicast sends, and slots reused
+    // since the snapshot, look the peer up.
+    if (m_peers.is_current(slot)) {
+        m_peers.hot(slot.index).bytes_sent.fetch_add(size, std::memory_order_relaxed);
+        return true;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    PeerIndex index = m_peers.find(peer_id);
+    if (index != INVALID_PEER_INDEX) {
+        m_peers.hot(index).bytes_sent.fetch_add(size, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool P2PManager::queue_packet(EOS_ProductUserId peer_id,
+                               const void* data,
+                               uint32_t size,
+                               uint8_t channel,
+                               PacketReliability reliability) {
+    if (!m_initialized || !peer_id || !data || size == 0) return false;
+    
+    uint32_t max_frame = max_frame_size(reliability);
+    uint32_t max_payload = max_frame - wire::FRAME_HEADER_SIZE - wire::BATCH_LENGTH_SIZE;
+    if (size > max_payload) {
+        std::cout << "[P2P] Error: Message too large to batch (" << size << " > " 
+                  << max_payload << ")\n";
+        return false;
+    }
+    
+    SendResult depth;
+    if (is_backpressured(peer_id, 0, channel, depth)) {
+        m_backpressure_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_batches_mutex);
+    
+    PendingBatch* batch = nullptr;
+    for (auto& pending : m_batches) {
+        if (pending.peer_id == peer_id && pending.channel == channel &&
+            pending.reliability == reliability) {
+            batch = &pending;
             break;
+        }
     }
     
-    EOS_EResult result = EOS_P2P_SendPacket(EOS_Platform_GetP2PInterface(platform), &options);
+    if (!batch) {
+        m_batches.emplace_back();
+        batch = &m_batches.back();
+        batch->peer_id = peer_id;
+        batch->channel = channel;
+        batch->reliability = reliability;
+    }
     
-    if (result == EOS_EResult::EOS_Success) {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        auto it = m_connections.find(peer_id);
-        if (it != m_connections.end()) {
-            it->second.bytes_sent += size;
+    // Full: send what we have and start a new packet
+    uint32_t entry_size = wire::BATCH_LENGTH_SIZE + size;
+    if (batch->message_count > 0 && batch->buffer.size() + entry_size > max_frame) {
+        send_batch(*batch);
+    }
+    
+    if (batch->message_count == 0) {
+        batch->buffer = m_packet_pool.acquire(m_config.max_packet_size);
+        batch->buffer[0] = static_cast<uint8_t>(wire::FrameType::Batch);
+        batch->buffer.resize(wire::FRAME_HEADER_SIZE);
+    }
+    
+    uint32_t offset = batch->buffer.size();
+    batch->buffer.resize(offset + entry_size);
+    wire::write_u16(batch->buffer.data() + offset, static_cast<uint16_t>(size));
+    std::memcpy(batch->buffer.data() + offset + wire::BATCH_LENGTH_SIZE, data, size);
+    batch->message_count++;
+    
+    return true;
+}
+
+void P2PManager::flush_batches() {
+    std::lock_guard<std::mutex> lock(m_batches_mutex);
+    
+    for (auto& batch : m_batches) {
+        if (batch.message_count > 0) {
+            send_batch(batch);
         }
-        return true;
     }
     
-    return false;
+    // Every batch is empty now; dropping them keeps the list to the pairs
+    // used since the last flush rather than every pair ever seen
+    m_batches.clear();
+    
+    if (m_initialized) m_transport->flush();
+}
+
+void P2PManager::tick() {
+    if (!m_initialized) return;
+    
+    flush_batches();
+    uint64_t transport_queued = m_transport->get_outgoing_queue_bytes();
+    update_congestion(transport_queued);
+    release_scheduled();
+    update_backpressure(transport_queued);
+    send_pings();
+    send_time_request();
+    for (auto& socket : m_sockets) {
+        socket->reliability->update(ReliabilityLayer::Clock::now());
+    }
+    m_transport->flush();
+    m_reassembler->expire(FragmentReassembler::Clock::now());
+}
+
+void P2PManager::send_batch(PendingBatch& batch) {
+    uint8_t* frame = batch.buffer.data();
+    uint32_t frame_size = batch.buffer.size();
+    
+    // A lone message goes out as a plain data frame, saving the length prefix
+    if (batch.message_count == 1) {
+        frame += wire::BATCH_LENGTH_SIZE;
+        frame_size -= wire::BATCH_LENGTH_SIZE;
+        frame[0] = static_cast<uint8_t>(wire::FrameType::Data);
+    }
+    
+    send_wire(0, batch.peer_id, frame, frame_size, batch.channel, batch.reliability);
+    
+    batch.buffer.reset();
+    batch.message_count = 0;
+}
+
+void P2PManager::drop_batches(EOS_ProductUserId peer_id) {
+    std::lock_guard<std::mutex> lock(m_batches_mutex);
+    m_batches.erase(std::remove_if(m_batches.begin(), m_batches.end(),
+                                   [&](const PendingBatch& batch) { return batch.peer_id == peer_id; }),
+                    m_batches.end());
+}
+
+void P2PManager::release_scheduled() {
+    if (!uses_scheduler()) return;
+    
+    m_scheduler.release(SendScheduler::Clock::now(), m_released_frames);
+    for (auto& frame : m_released_frames) {
+        transmit_wire(frame.socket, frame.peer, frame.data.data(), frame.data.size(), frame.channel,
+                      frame.reliability);
+    }
+    m_released_frames.clear();
+}
+
+void P2PManager::update_congestion(uint64_t transport_queued) {
+    // EOS has one send queue for all peers, so everyone backs off
+    uint64_t previous = m_transport_queue_bytes.exchange(transport_queued, std::memory_order_relaxed);
+    if (!m_config.congestion_control) return;
+    bool backlog = transport_queued > m_config.congestion_max_transport_queue_bytes && transport_queued > previous;
+    
+    uint64_t now = time_us();
+    m_congestion_rates.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_peers.for_each([&](PeerIndex index) {
+            const PeerHotState& hot = m_peers.hot(index);
+            if (hot.status != ConnectionStatus::Connected) return;
+            
+            CongestionSlot& slot = m_congestion[index];
+            uint64_t bytes_sent = hot.bytes_sent.load(std::memory_order_relaxed);
+            if (slot.peer_id != hot.peer_id) {
+                slot.peer_id = hot.peer_id;
+                slot.controller.reset(now);
+                slot.bytes_sent = bytes_sent;
+            }
+            
+            auto stats = m_scheduler.get_stats(hot.peer_id);
+            if (backlog) slot.controller.on_backlog(now);
+            slot.controller.update(bytes_sent - slot.bytes_sent, stats ? stats->queued_bytes : 0, now);
+            slot.bytes_sent = bytes_sent;
+            m_congestion_rates.emplace_back(hot.peer_id, slot.controller.rate());
+        });
+    }
+    
+    auto scheduler_now = SendScheduler::Clock::now();
+    for (const auto& rate : m_congestion_rates) {
+        m_scheduler.set_peer_rate(rate.first, rate.second, scheduler_now);
+    }
+}
+
+bool P2PManager::is_backpressured(EOS_ProductUserId peer_id,
+                                  uint8_t socket,
+                                  uint8_t channel,
+                                  SendResult& result) const {
+    bool peer_mark = m_config.send_high_water_bytes > 0 && uses_scheduler();
+    if (!peer_mark && m_config.transport_high_water_bytes == 0) return false;
+    
+    if (peer_mark) {
+        SendQueueDepth depth = m_scheduler.get_queue_depth(peer_id, channel, socket);
+        result.peer_queued_bytes = depth.peer_bytes;
+        result.channel_queued_bytes = depth.channel_bytes;
+    }
+    
+    const auto& channel_priorities = m_sockets[socket]->config.channel_priorities;
+    uint8_t priority = channel < channel_priorities.size() ? channel_priorities[channel].priority : 0;
+    if (priority >= m_config.backpressure_min_priority) return false;
+    
+    return (peer_mark && result.peer_queued_bytes > m_config.send_high_water_bytes) ||
+           (m_config.transport_high_water_bytes > 0 &&
+            m_transport_queue_bytes.load(std::memory_order_relaxed) > m_config.transport_high_water_bytes);
+}
+
+void P2PManager::update_backpressure(uint64_t transport_queued) {
+    m_backpressure_events.clear();
+    
+    if (m_config.transport_high_water_bytes > 0 &&
+        update_mark(m_transport_backpressure, transport_queued, m_config.transport_high_water_bytes)) {
+        m_backpressure_events.push_back({nullptr, m_transport_backpressure, transport_queued});
+    }
+    
+    if (!m_backpressure.empty() && uses_scheduler()) {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_peers.for_each([&](PeerIndex index) {
+            const PeerHotState& hot = m_peers.hot(index);
+            BackpressureSlot& slot = m_backpressure[index];
+            if (slot.peer_id != hot.peer_id) slot = BackpressureSlot{hot.peer_id, false};
+            
+            auto stats = m_scheduler.get_stats(hot.peer_id);
+            uint64_t queued = stats ? stats->queued_bytes : 0;
+            if (update_mark(slot.active, queued, m_config.send_high_water_bytes)) {
+                m_backpressure_events.push_back({hot.peer_id, slot.active, queued});
+            }
+        });
+    }
+    
+    if (!on_backpressure) return;
+    for (const auto& event : m_backpressure_events) {
+        on_backpressure(event.peer_id, event.active, event.queued_bytes);
+    }
+}
+
+std::optional<CongestionStats> P2PManager::get_congestion_stats(EOS_ProductUserId peer_id) const {
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    PeerIndex index = m_peers.find(peer_id);
+    if (index == INVALID_PEER_INDEX || index >= m_congestion.size()) return std::nullopt;
+    
+    const CongestionSlot& slot = m_congestion[index];
+    if (slot.peer_id != peer_id) return std::nullopt;
+    return slot.controller.get_stats();
+}
+
+uint32_t P2PManager::now_us() const {
+    auto elapsed = std::chrono::steady_clock::now() - m_epoch;
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+uint32_t P2PManager::ping_interval_ms() const {
+    if (!m_config.congestion_control) return m_config.ping_interval_ms;
+    if (m_config.ping_interval_ms == 0) return m_config.congestion_probe_interval_ms;
+    return std::min(m_config.ping_interval_ms, m_config.congestion_probe_interval_ms);
+}
+
+void P2PManager::send_pings() {
+    if (ping_interval_ms() == 0) return;
+    
+#ifdef EOS_STUB_MODE
+    // Nobody would answer the stub transport; keep the simulated ping_ms
+    if (!m_config.transport && !m_config.stub_loopback) return;
 #endif
+    
+    struct Probe {
+        EOS_ProductUserId peer_id;
+        PeerSlot slot;
+        uint8_t frame[wire::PING_FRAME_SIZE];
+    };
+    std::vector<Probe> probes;
+    
+    uint32_t now = now_us();
+    uint32_t interval_us = ping_interval_ms() * 1000;
+    uint32_t timeout_us = m_config.ping_timeout_ms * 1000;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        m_peers.for_each([&](PeerIndex index) {
+            PeerHotState& hot = m_peers.hot(index);
+            if (hot.status != ConnectionStatus::Connected) return;
+            
+            PeerPingState& ping = m_peers.cold(index).ping;
+            
+            // Unanswered probes past the timeout count as lost
+            for (uint32_t slot = 0; slot < PeerPingState::WINDOW; slot++) {
+                if (ping.pending[slot] && now - ping.sent_us[slot] > timeout_us) {
+                    ping.pending[slot] = false;
+                    hot.packet_loss += (1.0f - hot.packet_loss) / 16.0f;
+                    if (index < m_congestion.size() && m_congestion[index].peer_id == hot.peer_id) {
+                        m_congestion[index].controller.on_loss(time_us());
+                    }
+                }
+            }
+            
+            if (ping.next_sequence != 0 && now - ping.last_sent_us < interval_us) return;
+            
+            uint16_t sequence = ping.next_sequence++;
+            uint32_t slot = sequence % PeerPingState::WINDOW;
+            ping.sent_us[slot] = now;
+            ping.pending[slot] = true;
+            ping.last_sent_us = now;
+            
+            Probe probe;
+            probe.peer_id = hot.peer_id;
+            probe.slot = m_peers.slot(index);
+            probe.frame[0] = static_cast<uint8_t>(wire::FrameType::Ping);
+            wire::write_u16(probe.frame + 1, sequence);
+            wire::write_u32(probe.frame + 3, now);
+            probes.push_back(probe);
+        });
+    }
+    
+    // Probes skip the send scheduler so queueing doesn't skew the RTT
+    for (const auto& probe : probes) {
+        transmit_wire(0, probe.peer_id, probe.frame, wire::PING_FRAME_SIZE, m_config.ping_channel,
+                      PacketReliability::UnreliableUnordered, probe.slot);
+    }
+}
+
+void P2PManager::handle_ping(const PacketView& packet) {
+    if (packet.size < wire::PING_FRAME_SIZE) return;
+    
+    // Echo sequence and timestamp straight back; the sender does the math
+    uint8_t pong[wire::PING_FRAME_SIZE];
+    std::memcpy(pong, packet.data, wire::PING_FRAME_SIZE);
+    pong[0] = static_cast<uint8_t>(wire::FrameType::Pong);
+    transmit_wire(packet.socket, packet.sender, pong, wire::PING_FRAME_SIZE, packet.channel,
+                  PacketReliability::UnreliableUnordered);
+}
+
+void P2PManager::handle_pong(const PacketView& packet) {
+    if (packet.size < wire::PING_FRAME_SIZE) return;
+    
+    uint16_t sequence = wire::read_u16(packet.data + 1);
+    uint32_t sent_us = wire::read_u32(packet.data + 3);
+    uint32_t slot = sequence % PeerPingState::WINDOW;
+    uint32_t sample_us = now_us() - sent_us;
+    float sample_ms = static_cast<float>(sample_us) / 1000.0f;
+    
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    PeerIndex index = m_peers.find(packet.sender);
+    if (index == INVALID_PEER_INDEX) return;
+    
+    PeerPingState& ping = m_peers.cold(index).ping;
+    if (!ping.pending[slot] || ping.sent_us[slot] != sent_us) return;   // Late or duplicate
+    ping.pending[slot] = false;
+    
+    // RTT smoothing as in RFC 6298, jitter as in RFC 3550
+    PeerHotState& hot = m_peers.hot(index);
+    if (!ping.has_sample) {
+        hot.rtt_ms = sample_ms;
+        hot.rtt_variance_ms = sample_ms / 2.0f;
+        hot.jitter_ms = 0.0f;
+        ping.has_sample = true;
+    } else {
+        float change = std::fabs(sample_ms - hot.rtt_ms);
+        hot.jitter_ms += (std::fabs(sample_ms - ping.last_sample_ms) - hot.jitter_ms) / 16.0f;
+        hot.rtt_variance_ms += (change - hot.rtt_variance_ms) / 4.0f;
+        hot.rtt_ms += (sample_ms - hot.rtt_ms) / 8.0f;
+    }
+    ping.last_sample_ms = sample_ms;
+    hot.packet_loss -= hot.packet_loss / 16.0f;
+    hot.ping_ms = static_cast<uint32_t>(hot.rtt_ms + 0.5f);
+    
+    if (index >= m_congestion.size() || m_congestion[index].peer_id != packet.sender) return;
+    CongestionController& congestion = m_congestion[index].controller;
+    uint64_t now = time_us();
+    congestion.on_rtt_sample(sample_us, now);
+    
+    // Probes sent three or more before an answered one won't come back:
+    // count them now rather than after ping_timeout_ms, which would be
+    // far too late to react to
+    for (uint16_t behind = 3; behind < PeerPingState::WINDOW; behind++) {
+        uint32_t earlier = static_cast<uint16_t>(sequence - behind) % PeerPingState::WINDOW;
+        if (ping.pending[earlier] && static_cast<int32_t>(sent_us - ping.sent_us[earlier]) > 0) {
+            ping.pending[earlier] = false;
+            hot.packet_loss += (1.0f - hot.packet_loss) / 16.0f;
+            congestion.on_loss(now);
+        }
+    }
+}
+
+uint64_t P2PManager::time_us() const {
+    auto elapsed = std::chrono::steady_clock::now() - m_epoch;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+void P2PManager::sync_time_to(EOS_ProductUserId authority) {
+    std::lock_guard<std::mutex> lock(m_time_mutex);
+    if (authority == m_time_authority) return;
+    
+    m_time_authority = authority;
+    m_time_sync.reset();
+    m_last_time_request_us = 0;
+}
+
+uint64_t P2PManager::get_server_time_us() const {
+    uint64_t now = time_us();
+    std::lock_guard<std::mutex> lock(m_time_mutex);
+    return m_time_authority ? m_time_sync.server_time(now) : now;
+}
+
+bool P2PManager::is_time_synchronized() const {
+    std::lock_guard<std::mutex> lock(m_time_mutex);
+    return !m_time_authority || m_time_sync.is_synchronized();
+}
+
+TimeSyncStats P2PManager::get_time_sync_stats() const {
+    uint64_t now = time_us();
+    std::lock_guard<std::mutex> lock(m_time_mutex);
+    return m_time_sync.get_stats(now);
+}
+
+void P2PManager::send_time_request() {
+    uint64_t now = time_us();
+    EOS_ProductUserId authority;
+    {
+        std::lock_guard<std::mutex> lock(m_time_mutex);
+        authority = m_time_authority;
+        uint64_t interval_us = m_time_sync.is_synchronized()
+            ? static_cast<uint64_t>(m_config.time_sync_interval_ms) * 1000
+            : std::min<uint64_t>(TIME_SYNC_SETTLE_INTERVAL_US, m_config.time_sync_interval_ms * 1000ull);
+        if (!authority || (m_last_time_request_us != 0 && now - m_last_time_request_us < interval_us)) return;
+        m_last_time_request_us = now;
+    }
+    
+    // Like pings, bypass the scheduler so queueing doesn't skew the round trip
+    uint8_t request[wire::TIME_REQUEST_SIZE];
+    request[0] = static_cast<uint8_t>(wire::FrameType::TimeRequest);
+    wire::write_u64(request + 1, now);
+    transmit_wire(0, authority, request, wire::TIME_REQUEST_SIZE, m_config.ping_channel,
+                  PacketReliability::UnreliableUnordered);
+}
+
+void P2PManager::handle_time_request(const PacketView& packet) {
+    if (packet.size < wire::TIME_REQUEST_SIZE) return;
+    
+    // Only answer once our server time means something
+    if (!is_time_synchronized()) return;
+    
+    uint8_t response[wire::TIME_RESPONSE_SIZE];
+    response[0] = static_cast<uint8_t>(wire::FrameType::TimeResponse);
+    std::memcpy(response + 1, packet.data + 1, 8);
+    wire::write_u64(response + 9, get_server_time_us());
+    transmit_wire(packet.socket, packet.sender, response, wire::TIME_RESPONSE_SIZE, packet.channel,
+                  PacketReliability::UnreliableUnordered);
+}
+
+void P2PManager::handle_time_response(const PacketView& packet) {
+    if (packet.size < wire::TIME_RESPONSE_SIZE) return;
+    
+    uint64_t now = time_us();
+    std::lock_guard<std::mutex> lock(m_time_mutex);
+    if (packet.sender != m_time_authority) return;
+    m_time_sync.add_sample(wire::read_u64(packet.data + 1), wire::read_u64(packet.data + 9), now);
 }
 
 void P2PManager::broadcast_packet(const void* data,
                                    uint32_t size,
                                    uint8_t channel,
-                                   PacketReliability reliability) {
-    std::vector<EOS_ProductUserId> peers;
+                                   PacketReliability reliability,
+                                   const std::vector<EOS_ProductUserId>& exclude) {
+    broadcast_on_socket(0, data, size, channel, reliability, exclude);
+}
+
+void P2PManager::broadcast_on_socket(uint8_t socket,
+                                      const void* data,
+                                      uint32_t size,
+                                      uint8_t channel,
+                                      std::optional<PacketReliability> requested,
+                                      const std::vector<EOS_ProductUserId>& exclude) {
+    if (!m_initialized || !data || size == 0) return;
+    if (socket >= m_sockets.size()) {
+        std::cout << "[P2P] Error: Unknown socket " << static_cast<int>(socket) << "\n";
+        return;
+    }
+    PacketReliability reliability = requested.value_or(m_sockets[socket]->config.default_reliability);
     
-    {
-        std::lock_guard<std::mutex> lock(m_connections_mutex);
-        for (const auto& pair : m_connections) {
-            if (pair.second.status == ConnectionStatus::Connected) {
-                peers.push_back(pair.first);
+    auto snapshot = std::atomic_load(&m_peer_snapshot);
+    if (!snapshot || snapshot->peers.empty()) return;
+    
+    auto excluded = [&exclude](EOS_ProductUserId peer_id) {
+        return std::find(exclude.begin(), exclude.end(), peer_id) != exclude.end();
+    };
+    
+    // Oversize messages need per-peer fragmentation (and its error path)
+    if (size > max_frame_size(reliability) - wire::FRAME_HEADER_SIZE) {
+        for (const auto& peer : snapshot->peers) {
+            if (!excluded(peer.peer_id)) {
+                send_on_socket(socket, peer.peer_id, data, size, channel, reliability);
             }
         }
+        return;
     }
     
-    for (auto peer_id : peers) {
-        send_packet(peer_id, data, size, channel, reliability);
+    // Frame once, send the same bytes to everyone
+    PacketBuffer frame = m_packet_pool.acquire(wire::FRAME_HEADER_SIZE + size);
+    frame[0] = static_cast<uint8_t>(wire::FrameType::Data);
+    std::memcpy(frame.data() + wire::FRAME_HEADER_SIZE, data, size);
+    
+    SendResult depth;
+    for (const auto& peer : snapshot->peers) {
+        if (excluded(peer.peer_id)) continue;
+        if (is_backpressured(peer.peer_id, socket, channel, depth)) {
+            m_backpressure_rejected.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        send_wire(socket, peer.peer_id, frame.data(), frame.size(), channel, reliability, peer.slot);
     }
+    m_transport->flush();
 }
 
-uint32_t P2PManager::receive_packets(uint32_t max_packets) {
+uint32_t P2PManager::receive_packets(uint32_t max_packets, SocketMask sockets) {
     if (!m_initialized) return 0;
     
     uint32_t packets_received = 0;
     
-#ifdef EOS_STUB_MODE
-    // In stub mode, just process any queued test packets
-    std::lock_guard<std::mutex> lock(m_packets_mutex);
-    while (!m_incoming_packets.empty() && packets_received < max_packets) {
-        IncomingPacket packet = std::move(m_incoming_packets.front());
-        m_incoming_packets.pop();
+    // Packets handed over by the I/O thread, queued from other threads or
+    // set aside by an earlier call that didn't take their socket. The ring
+    // holds the older ones; its overflow list is only used while the ring
+    // is full, so draining the ring first keeps arrival order. Only take
+    // what was queued before this call, so a busy producer can't stretch
+    // the frame. Popped one at a time so callbacks run without any lock held.
+    for (size_t index = 0; index < m_sockets.size() && packets_received < max_packets; index++) {
+        if (!(sockets & socket_bit(static_cast<uint8_t>(index)))) continue;
+        SocketState& socket = *m_sockets[index];
         
-        if (on_packet_received) {
-            on_packet_received(packet);
+        uint32_t queued = socket.incoming.size_approx();
+        uint32_t overflowed = socket.overflow_size.load(std::memory_order_acquire);
+        IncomingPacket packet;
+        while (packets_received < max_packets && (queued > 0 || overflowed > 0)) {
+            if (queued > 0) {
+                if (!socket.incoming.try_pop(packet)) {
+                    queued = 0;
+                    continue;
+                }
+                queued--;
+            } else {
+                std::lock_guard<std::mutex> lock(socket.overflow_mutex);
+                if (socket.overflow.empty()) break;
+                packet = std::move(socket.overflow.front());
+                socket.overflow.pop_front();
+                socket.overflow_size.store(static_cast<uint32_t>(socket.overflow.size()), std::memory_order_release);
+                overflowed--;
+            }
+            
+            PacketView view;
+            view.sender = packet.sender;
+            view.socket = packet.socket;
+            view.channel = packet.channel;
+            view.data = packet.data.data();
+            view.size = packet.data.size();
+            view.pool = &m_packet_pool;
+            dispatch_packet(view);
+            packet.data.reset();
+            
+            packets_received++;
+            socket.packets_received.fetch_add(1, std::memory_order_relaxed);
         }
-        
-        packets_received++;
     }
-#else
-    auto platform = Platform::instance().get_handle();
-    if (!platform) return 0;
     
-    auto p2p = EOS_Platform_GetP2PInterface(platform);
+    if (m_config.threaded_receive) {
+        m_transport->flush();   // Acks sent while dispatching
+        return packets_received;
+    }
     
+    // Receive straight into the reusable buffer. The transport can't be
+    // read by socket, so packets for sockets not taken now are copied to
+    // their socket's queue, overflowing rather than blocking the sockets
+    // being read.
     while (packets_received < max_packets) {
-        // Check for next packet size
-        EOS_P2P_GetNextReceivedPacketSizeOptions size_options = {};
-        size_options.ApiVersion = EOS_P2P_GETNEXTRECEIVEDPACKETSIZE_API_LATEST;
-        size_options.LocalUserId = AuthManager::instance().get_product_user_id();
-        
-        uint32_t packet_size = 0;
-        if (EOS_P2P_GetNextReceivedPacketSize(p2p, &size_options, &packet_size) 
-            != EOS_EResult::EOS_Success) {
+        TransportPacketInfo info;
+        if (!m_transport->receive(info, m_receive_buffer.data(), static_cast<uint32_t>(m_receive_buffer.size()))) {
             break; // No more packets
         }
         
-        // Receive the packet
-        IncomingPacket packet;
-        packet.data.resize(packet_size);
-        
-        EOS_P2P_ReceivePacketOptions recv_options = {};
-        recv_options.ApiVersion = EOS_P2P_RECEIVEPACKET_API_LATEST;
-        recv_options.LocalUserId = AuthManager::instance().get_product_user_id();
-        recv_options.MaxDataSizeBytes = packet_size;
+        if (info.socket >= m_sockets.size()) {
+            m_dropped_packets.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
         
-        uint32_t bytes_received = 0;
-        EOS_P2P_SocketId socket_id;
+        if (!(sockets & socket_bit(info.socket))) {
+            IncomingPacket packet;
+            packet.sender = info.sender;
+            packet.socket = info.socket;
+            packet.channel = info.channel;
+            packet.data = m_packet_pool.acquire(info.size);
+            std::memcpy(packet.data.data(), m_receive_buffer.data(), info.size);
+            set_aside_packet(std::move(packet));
+            continue;
+        }
         
-        EOS_EResult result = EOS_P2P_ReceivePacket(p2p, &recv_options,
-            &packet.sender, &socket_id, &packet.channel,
-            packet.data.data(), &bytes_received);
+        PacketView view;
+        view.sender = info.sender;
+        view.socket = info.socket;
+        view.channel = info.channel;
+        view.data = m_receive_buffer.data();
+        view.size = info.size;
+        view.pool = &m_packet_pool;
+        dispatch_packet(view);
         
-        if (result == EOS_EResult::EOS_Success) {
-            packet.data.resize(bytes_received);
+        packets_received++;
+        m_sockets[info.socket]->packets_received.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    m_transport->flush();   // Acks sent while dispatching
+    return packets_received;
+}
+
+bool P2PManager::queue_incoming_packet(IncomingPacket&& packet) {
+    if (packet.socket < m_sockets.size()) {
+        // Not behind packets already overflowed, which are older
+        SocketState& socket = *m_sockets[packet.socket];
+        if (socket.overflow_size.load(std::memory_order_acquire) == 0 &&
+            socket.incoming.try_push(std::move(packet))) {
+            return true;
+        }
+        socket.packets_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    m_dropped_packets.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void P2PManager::set_aside_packet(IncomingPacket&& packet) {
+    if (packet.socket >= m_sockets.size()) {
+        m_dropped_packets.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    // Once anything has overflowed, later packets queue behind it until
+    // receive_packets() has drained the list
+    SocketState& socket = *m_sockets[packet.socket];
+    if (socket.overflow_size.load(std::memory_order_acquire) == 0 &&
+        socket.incoming.try_push(std::move(packet))) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(socket.overflow_mutex);
+    socket.overflow.push_back(std::move(packet));
+    socket.overflow_size.store(static_cast<uint32_t>(socket.overflow.size()), std::memory_order_release);
+    socket.packets_overflowed.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::optional<uint8_t> P2PManager::get_socket_index(const std::string& name) const {
+    for (size_t index = 0; index < m_sockets.size(); index++) {
+        if (m_sockets[index]->config.name == name) return static_cast<uint8_t>(index);
+    }
+    return std::nullopt;
+}
+
+std::optional<SocketStats> P2PManager::get_socket_stats(uint8_t socket) const {
+    if (socket >= m_sockets.size()) return std::nullopt;
+    
+    const SocketState& state = *m_sockets[socket];
+    SocketStats stats;
+    stats.packets_received = state.packets_received.load(std::memory_order_relaxed);
+    stats.packets_dropped = state.packets_dropped.load(std::memory_order_relaxed);
+    stats.packets_overflowed = state.packets_overflowed.load(std::memory_order_relaxed);
+    stats.queued_packets = state.incoming.size_approx() + state.overflow_size.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void P2PManager::dispatch_packet(const PacketView& packet) {
+    // Check if this is a new peer we haven't seen before
+    bool is_new_peer = false;
+    {
+        std::lock_guard<std::mutex> lock(m_connections_mutex);
+        PeerIndex index = m_peers.find(packet.sender);
+        if (index == INVALID_PEER_INDEX) {
+            // New peer! Add them to connections
+            std::cout << "[P2P] New peer detected from received packet - adding to connections\n";
+            index = add_peer(packet.sender, ConnectionStatus::Connected);
+            is_new_peer = index != INVALID_PEER_INDEX;
+        }
+        if (index != INVALID_PEER_INDEX) {
+            // Single writer, so a plain load/store instead of a locked add
+            auto& bytes_received = m_peers.hot(index).bytes_received;
+            bytes_received.store(bytes_received.load(std::memory_order_relaxed) + packet.size,
+                                 std::memory_order_relaxed);
+        }
+    }
+    
+    // Trigger connection callback for new peers
+    if (is_new_peer && on_connection_established) {
+        std::cout << "[P2P] Triggering on_connection_established for new peer\n";
+        on_connection_established(packet.sender, ConnectionStatus::Connected);
+    }
+    
+    dispatch_frame(packet);
+}
+
+void P2PManager::dispatch_frame(const PacketView& packet) {
+    if (packet.size < wire::FRAME_HEADER_SIZE) return;
+    
+    PacketView message = packet;
+    message.data = packet.data + wire::FRAME_HEADER_SIZE;
+    message.size = packet.size - wire::FRAME_HEADER_SIZE;
+    
+    switch (static_cast<wire::FrameType>(packet.data[0])) {
+        case wire::FrameType::Data:
+            deliver_message(message);
+            break;
             
-            // Check if this is a new peer we haven't seen before
-            bool is_new_peer = false;
-            {
-                std::lock_guard<std::mutex> lock(m_connections_mutex);
-                auto it = m_connections.find(packet.sender);
-                if (it != m_connections.end()) {
-                    it->second.bytes_received += bytes_received;
-                } else {
-                    // New peer! Add them to connections
-                    std::cout << "[P2P] New peer detected from received packet - adding to connections\n";
-                    PeerConnection conn;
-                    conn.peer_id = packet.sender;
-                    conn.status = ConnectionStatus::Connected;
-                    conn.bytes_received = bytes_received;
-                    m_connections[packet.sender] = conn;
-                    is_new_peer = true;
+        case wire::FrameType::Batch: {
+            // Split back into the individual messages
+            const uint8_t* cursor = message.data;
+            const uint8_t* end = message.data + message.size;
+            while (end - cursor >= static_cast<ptrdiff_t>(wire::BATCH_LENGTH_SIZE)) {
+                uint16_t length = wire::read_u16(cursor);
+                cursor += wire::BATCH_LENGTH_SIZE;
+                if (length > end - cursor) {
+                    std::cout << "[P2P] Warning: Truncated batch from peer, dropping remainder\n";
+                    break;
                 }
+                
+                message.data = cursor;
+                message.size = length;
+                deliver_message(message);
+                cursor += length;
             }
-            
-            // Trigger connection callback for new peers
-            if (is_new_peer && on_connection_established) {
-                std::cout << "[P2P] Triggering on_connection_established for new peer\n";
-                on_connection_established(packet.sender, ConnectionStatus::Connected);
+            break;
+        }
+        
+        case wire::FrameType::Fragment:
+            if (m_reassembler->add_fragment(packet.sender, packet.channel, packet.data, packet.size,
+                                            FragmentReassembler::Clock::now(), m_reassembled_message)) {
+                message.data = m_reassembled_message.data();
+                message.size = static_cast<uint32_t>(m_reassembled_message.size());
+                deliver_message(message);
             }
+            break;
+        
+        case wire::FrameType::Ping:
+            handle_ping(packet);
+            break;
             
-            if (on_packet_received) {
-                on_packet_received(packet);
-            }
+        case wire::FrameType::Pong:
+            handle_pong(packet);
+            break;
             
-            packets_received++;
-        } else {
+        case wire::FrameType::Reliable:
+            dispatch_reliable(packet);
+            break;
+            
+        case wire::FrameType::Ack:
+            m_sockets[packet.socket]->reliability->receive_ack(packet.sender, packet.data, packet.size,
+                                                               ReliabilityLayer::Clock::now());
+            break;
+            
+        case wire::FrameType::Compressed:
+            dispatch_compressed(packet);
+            break;
+            
+        case wire::FrameType::TimeRequest:
+            handle_time_request(packet);
+            break;
+            
+        case wire::FrameType::TimeResponse:
+            handle_time_response(packet);
             break;
+        
+        default:
+            std::cout << "[P2P] Warning: Unknown frame type " << static_cast<int>(packet.data[0]) << "\n";
+            break;
+    }
+}
+
+void P2PManager::dispatch_reliable(const PacketView& packet) {
+    ReliabilityLayer& reliability = *m_sockets[packet.socket]->reliability;
+    PacketView inner = packet;
+    if (reliability.receive(packet.sender, packet.channel, packet.data, packet.size,
+                            ReliabilityLayer::Clock::now(), inner.data, inner.size)) {
+        dispatch_frame(inner);
+    }
+    
+    // Ordered frames this one unblocked
+    ReliabilityLayer::ReadyFrame ready;
+    while (reliability.pop_ready(ready)) {
+        PacketView view = packet;
+        view.sender = ready.peer;
+        view.channel = ready.channel;
+        view.data = ready.frame.data();
+        view.size = ready.frame.size();
+        dispatch_frame(view);
+    }
+}
+
+void P2PManager::dispatch_compressed(const PacketView& packet) {
+    const CompressionDictionary* dictionary = nullptr;
+    bool valid = packet.size > wire::COMPRESSED_HEADER_SIZE;
+    if (valid && packet.data[1] == static_cast<uint8_t>(CompressionMode::Dictionary)) {
+        // Needs the same dictionary on our end of the channel
+        const auto& channel_compression = m_sockets[packet.socket]->config.channel_compression;
+        if (packet.channel < channel_compression.size()) {
+            dictionary = channel_compression[packet.channel].dictionary.get();
         }
+        valid = dictionary && static_cast<uint8_t>(dictionary->id()) == packet.data[2];
+    } else if (valid) {
+        valid = packet.data[1] == static_cast<uint8_t>(CompressionMode::Fast);
     }
-#endif
     
-    return packets_received;
+    // Too short to hold a frame type: the check below would read a byte
+    // left over from an earlier frame
+    uint32_t original_size = valid ? wire::read_u16(packet.data + 3) : 0;
+    if (valid) {
+        valid = original_size >= wire::FRAME_HEADER_SIZE && original_size <= m_decompressed_frame.size() &&
+                lz_decompress(packet.data + wire::COMPRESSED_HEADER_SIZE,
+                              packet.size - wire::COMPRESSED_HEADER_SIZE,
+                              m_decompressed_frame.data(), original_size, dictionary) == original_size;
+    }
+    
+    // Only user frames are ever compressed
+    auto type = valid ? static_cast<wire::FrameType>(m_decompressed_frame[0]) : wire::FrameType::Compressed;
+    if (type != wire::FrameType::Data && type != wire::FrameType::Batch && type != wire::FrameType::Fragment) {
+        m_decompress_failures.fetch_add(1, std::memory_order_relaxed);
+        std::cout << "[P2P] Warning: Undecodable compressed frame on channel "
+                  << static_cast<int>(packet.channel) << ", dropping\n";
+        return;
+    }
+    m_frames_decompressed.fetch_add(1, std::memory_order_relaxed);
+    
+    PacketView inner = packet;
+    inner.data = m_decompressed_frame.data();
+    inner.size = original_size;
+    dispatch_frame(inner);
+}
+
+void P2PManager::deliver_message(const PacketView& message) {
+    if (on_packet_view) {
+        on_packet_view(message);
+    }
+    
+    // Owning callback needs its own copy of the bytes
+    if (on_packet_received) {
+        on_packet_received(message.retain());
+    }
+}
+
+void P2PManager::start_io_thread() {
+    if (m_io_thread.joinable()) return;
+    
+    m_io_running.store(true, std::memory_order_release);
+    m_io_thread = std::thread(&P2PManager::io_thread_main, this);
+    std::cout << "[P2P] Network I/O thread started\n";
+}
+
+void P2PManager::stop_io_thread() {
+    if (!m_io_thread.joinable()) return;
+    
+    m_io_running.store(false, std::memory_order_release);
+    m_io_thread.join();
+    std::cout << "[P2P] Network I/O thread stopped\n";
+}
+
+void P2PManager::io_thread_main() {
+    auto idle_sleep = std::chrono::microseconds(m_config.io_poll_interval_us);
+    
+    while (m_io_running.load(std::memory_order_acquire)) {
+        if (poll_transport() == 0) {
+            std::this_thread::sleep_for(idle_sleep);
+        }
+    }
+}
+
+uint32_t P2PManager::poll_transport() {
+    uint32_t packets_queued = 0;
+    
+    // A socket whose handoff queue is full overflows instead of stopping
+    // the read, so the others keep flowing. Bounded per call so a flood
+    // can't keep the thread from seeing stop_io_thread().
+    while (packets_queued < MAX_PACKETS_PER_POLL) {
+        IncomingPacket packet;
+        packet.data = m_packet_pool.acquire(m_packet_pool.slab_size());
+        
+        TransportPacketInfo info;
+        if (!m_transport->receive(info, packet.data.data(), packet.data.size())) {
+            break; // No more packets
+        }
+        
+        packet.sender = info.sender;
+        packet.socket = info.socket;
+        packet.channel = info.channel;
+        packet.data.resize(info.size);
+        set_aside_packet(std::move(packet));
+        packets_queued++;
+    }
+    
+    return packets_queued;
+}
+
+std::optional<ReliabilityStats> P2PManager::get_reliability_stats(EOS_ProductUserId peer_id, uint8_t socket) const {
+    if (socket >= m_sockets.size()) return std::nullopt;
+    return m_sockets[socket]->reliability->get_stats(peer_id);
+}
+
+std::optional<SendQueueStats> P2PManager::get_send_queue_stats(EOS_ProductUserId peer_id) const {
+    return m_scheduler.get_stats(peer_id);
+}
+
+CompressionStats P2PManager::get_compression_stats() const {
+    CompressionStats stats;
+    stats.frames_compressed = m_frames_compressed.load(std::memory_order_relaxed);
+    stats.frames_incompressible = m_frames_incompressible.load(std::memory_order_relaxed);
+    stats.bytes_in = m_compression_bytes_in.load(std::memory_order_relaxed);
+    stats.bytes_out = m_compression_bytes_out.load(std::memory_order_relaxed);
+    stats.frames_decompressed = m_frames_decompressed.load(std::memory_order_relaxed);
+    stats.decompress_failures = m_decompress_failures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+CaptureStats P2PManager::get_capture_stats() const {
+    return m_capture ? m_capture->get_stats() : CaptureStats{};
+}
+
+NetworkSimulatorStats P2PManager::get_network_simulator_stats() const {
+    return m_network_simulator ? m_network_simulator->get_stats() : NetworkSimulatorStats{};
 }
 
 std::optional<PeerConnection> P2PManager::get_peer_connection(EOS_ProductUserId peer_id) const {
     std::lock_guard<std::mutex> lock(m_connections_mutex);
-    auto it = m_connections.find(peer_id);
-    if (it != m_connections.end()) {
-        return it->second;
+    PeerIndex index = m_peers.find(peer_id);
+    if (index != INVALID_PEER_INDEX) {
+        return m_peers.to_connection(index);
+    }
+    return std::nullopt;
+}
+
+PeerIndex P2PManager::get_peer_index(EOS_ProductUserId peer_id) const {
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    return m_peers.find(peer_id);
+}
+
+std::optional<PeerConnection> P2PManager::get_peer_connection_by_index(PeerIndex index) const {
+    std::lock_guard<std::mutex> lock(m_connections_mutex);
+    if (m_peers.is_live(index)) {
+        return m_peers.to_connection(index);
     }
     return std::nullopt;
 }
@@ -377,87 +1465,62 @@ std::optional<PeerConnection> P2PManager::get_peer_connection(EOS_ProductUserId
 std::vector<PeerConnection> P2PManager::get_all_connections() const {
     std::vector<PeerConnection> result;
     std::lock_guard<std::mutex> lock(m_connections_mutex);
-    for (const auto& pair : m_connections) {
-        result.push_back(pair.second);
-    }
+    result.reserve(m_peers.size());
+    m_peers.for_each([&](PeerIndex index) {
+        result.push_back(m_peers.to_connection(index));
+    });
     return result;
 }
 
 bool P2PManager::is_connected_to(EOS_ProductUserId peer_id) const {
     std::lock_guard<std::mutex> lock(m_connections_mutex);
-    auto it = m_connections.find(peer_id);
-    return it != m_connections.end() && it->second.status == ConnectionStatus::Connected;
+    PeerIndex index = m_peers.find(peer_id);
+    return index != INVALID_PEER_INDEX && m_peers.hot(index).status == ConnectionStatus::Connected;
 }
 
 uint32_t P2PManager::get_peer_count() const {
     std::lock_guard<std::mutex> lock(m_connections_mutex);
     uint32_t count = 0;
-    for (const auto& pair : m_connections) {
-        if (pair.second.status == ConnectionStatus::Connected) {
+    m_peers.for_each([&](PeerIndex index) {
+        if (m_peers.hot(index).status == ConnectionStatus::Connected) {
             count++;
         }
-    }
+    });
     return count;
 }
 
-void P2PManager::register_callbacks() {
-#ifndef EOS_STUB_MODE
-    auto platform = Platform::instance().get_handle();
-    if (!platform) return;
-    
-    // Register for connection requests
-    EOS_P2P_AddNotifyPeerConnectionRequestOptions request_options = {};
-    request_options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONREQUEST_API_LATEST;
-    request_options.LocalUserId = AuthManager::instance().get_product_user_id();
-    
-    EOS_P2P_SocketId socket_id = {};
-    socket_id.ApiVersion = EOS_P2P_SOCKETID_API_LATEST;
-    strncpy(socket_id.SocketName, m_config.socket_name.c_str(),
-            sizeof(socket_id.SocketName) - 1);
-    request_options.SocketId = &socket_id;
+uint32_t P2PManager::max_frame_size(PacketReliability reliability) const {
+    // Leave room for the sequence/ack header
+    if (uses_custom_reliability(reliability)) {
+        return m_config.max_packet_size - wire::RELIABLE_HEADER_SIZE;
+    }
+    return m_config.max_packet_size;
+}
+
+PeerIndex P2PManager::add_peer(EOS_ProductUserId peer_id, ConnectionStatus status) {
+    PeerIndex index = m_peers.insert(peer_id);
+    if (index == INVALID_PEER_INDEX) {
+        std::cout << "[P2P] Warning: Peer table full (" << m_peers.capacity() << " peers), ignoring peer\n";
+        return INVALID_PEER_INDEX;
+    }
     
-    EOS_P2P_AddNotifyPeerConnectionRequest(EOS_Platform_GetP2PInterface(platform),
-        &request_options, this,
-        [](const EOS_P2P_OnIncomingConnectionRequestInfo* data) {
-            auto* self = static_cast<P2PManager*>(data->ClientData);
-            self->handle_connection_request(data->RemoteUserId);
-        }
-    );
-    
-    // Register for connection state changes
-    EOS_P2P_AddNotifyPeerConnectionEstablishedOptions established_options = {};
-    established_options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONESTABLISHED_API_LATEST;
-    established_options.LocalUserId = AuthManager::instance().get_product_user_id();
-    established_options.SocketId = &socket_id;
-    
-    EOS_P2P_AddNotifyPeerConnectionEstablished(EOS_Platform_GetP2PInterface(platform),
-        &established_options, this,
-        [](const EOS_P2P_OnPeerConnectionEstablishedInfo* data) {
-            auto* self = static_cast<P2PManager*>(data->ClientData);
-            self->handle_connection_established(data->RemoteUserId);
-        }
-    );
-    
-    // Register for connection closed
-    EOS_P2P_AddNotifyPeerConnectionClosedOptions closed_options = {};
-    closed_options.ApiVersion = EOS_P2P_ADDNOTIFYPEERCONNECTIONCLOSED_API_LATEST;
-    closed_options.LocalUserId = AuthManager::instance().get_product_user_id();
-    closed_options.SocketId = &socket_id;
-    
-    EOS_P2P_AddNotifyPeerConnectionClosed(EOS_Platform_GetP2PInterface(platform),
-        &closed_options, this,
-        [](const EOS_P2P_OnRemoteConnectionClosedInfo* data) {
-            auto* self = static_cast<P2PManager*>(data->ClientData);
-            self->handle_connection_closed(data->RemoteUserId);
-        }
-    );
-#endif
+    m_peers.hot(index).status = status;
+    publish_peer_snapshot();
+    return index;
 }
 
-void P2PManager::unregister_callbacks() {
-#ifndef EOS_STUB_MODE
-    // Remove notification handlers
-#endif
+void P2PManager::publish_peer_snapshot() {
+    auto snapshot = std::make_shared<PeerSnapshot>();
+    snapshot->peers.reserve(m_peers.size());
+    
+    m_peers.for_each([&](PeerIndex index) {
+        const PeerHotState& hot = m_peers.hot(index);
+        if (hot.status == ConnectionStatus::Connected) {
+            snapshot->peers.push_back({hot.peer_id, m_peers.slot(index)});
+        }
+    });
+    
+    std::atomic_store(&m_peer_snapshot, std::shared_ptr<const PeerSnapshot>(std::move(snapshot)));
 }
 
 void P2PManager::handle_connection_request(EOS_ProductUserId peer_id) {
@@ -471,14 +1534,12 @@ void P2PManager::handle_connection_established(EOS_ProductUserId peer_id) {
     
     {
         std::lock_guard<std::mutex> lock(m_connections_mutex);
-        auto it = m_connections.find(peer_id);
-        if (it != m_connections.end()) {
-            it->second.status = ConnectionStatus::Connected;
+        PeerIndex index = m_peers.find(peer_id);
+        if (index != INVALID_PEER_INDEX) {
+            m_peers.hot(index).status = ConnectionStatus::Connected;
+            publish_peer_snapshot();
         } else {
-            PeerConnection conn;
-            conn.peer_id = peer_id;
-            conn.status = ConnectionStatus::Connected;
-            m_connections[peer_id] = conn;
+            add_peer(peer_id, ConnectionStatus::Connected);
         }
     }
     
@@ -495,8 +1556,14 @@ void P2PManager::handle_connection_closed(EOS_ProductUserId peer_id) {
     
     {
         std::lock_guard<std::mutex> lock(m_connections_mutex);
-        m_connections.erase(peer_id);
+        if (m_peers.remove(peer_id)) publish_peer_snapshot();
+    }
+    m_reassembler->remove_peer(peer_id);
+    for (auto& socket : m_sockets) {
+        socket->reliability->remove_peer(peer_id);
     }
+    m_scheduler.remove_peer(peer_id);
+    drop_batches(peer_id);
     
     if (on_connection_closed) {
         on_connection_closed(peer_id, ConnectionStatus::Disconnected);
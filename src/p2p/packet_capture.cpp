@@ -0,0 +1,312 @@
+/**
+ * EOS Testing - Packet Capture and Replay Implementation
+ */
+
+#include "eos_testing/p2p/packet_capture.hpp"
+#include "wire_format.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace eos_testing {
+
+namespace {
+
+constexpr uint32_t FILE_HEADER_SIZE = 4 + 2 + 2;
+constexpr uint32_t RECORD_HEADER_SIZE = 1 + 1 + 1 + 1 + 2 + 4 + 2;
+constexpr uint32_t V1_RECORD_HEADER_SIZE = RECORD_HEADER_SIZE - 1;     // No socket byte
+constexpr uint32_t MAX_RECORD_DATA = 0xFFFF;
+
+// Wake the writer early once this much is waiting
+constexpr size_t WRITER_WAKE_BYTES = 64 * 1024;
+constexpr auto WRITER_INTERVAL = std::chrono::milliseconds(50);
+
+} // namespace
+
+// ============================================================================
+// CaptureTransport
+// ============================================================================
+
+CaptureTransport::CaptureTransport(std::shared_ptr<Transport> inner, std::string path, uint32_t max_buffered_bytes)
+    : m_inner(std::move(inner))
+    , m_path(std::move(path))
+    , m_max_buffered_bytes(max_buffered_bytes) {
+}
+
+CaptureTransport::~CaptureTransport() {
+    close();
+}
+
+bool CaptureTransport::open() {
+    m_file = std::fopen(m_path.c_str(), "wb");
+    if (!m_file) {
+        std::cout << "[P2P] Error: Can't create capture file " << m_path << "\n";
+        return false;
+    }
+
+    uint8_t header[FILE_HEADER_SIZE] = {};
+    wire::write_u32(header, CAPTURE_MAGIC);
+    wire::write_u16(header + 4, CAPTURE_VERSION);
+    if (std::fwrite(header, 1, sizeof(header), m_file) != sizeof(header)) {
+        m_write_failed.store(true, std::memory_order_relaxed);
+    }
+    m_bytes_written.store(sizeof(header), std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = false;
+        m_pending.clear();
+        m_peer_numbers.clear();
+        m_last_record = Clock::now();
+    }
+    m_writer = std::thread(&CaptureTransport::writer_main, this);
+
+    m_inner->on_connection_request = [this](EOS_ProductUserId peer_id) {
+        if (on_connection_request) on_connection_request(peer_id);
+    };
+    m_inner->on_connection_established = [this](EOS_ProductUserId peer_id) {
+        if (on_connection_established) on_connection_established(peer_id);
+    };
+    m_inner->on_connection_closed = [this](EOS_ProductUserId peer_id) {
+        if (on_connection_closed) on_connection_closed(peer_id);
+    };
+
+    std::cout << "[P2P] Capturing packets to " << m_path << "\n";
+    return m_inner->open();
+}
+
+void CaptureTransport::close() {
+    if (!m_file) return;
+
+    m_inner->close();
+    m_inner->on_connection_request = nullptr;
+    m_inner->on_connection_established = nullptr;
+    m_inner->on_connection_closed = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    if (m_writer.joinable()) m_writer.join();
+
+    std::FILE* file = m_file;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_file = nullptr;   // Late sends are counted as dropped
+    }
+    std::fclose(file);
+}
+
+bool CaptureTransport::send(EOS_ProductUserId peer_id,
+                            uint8_t channel,
+                            const uint8_t* data,
+                            uint32_t size,
+                            PacketReliability reliability,
+                            uint8_t socket) {
+    if (!m_inner->send(peer_id, channel, data, size, reliability, socket)) return false;
+    record(CaptureDirection::Sent, peer_id, socket, channel, static_cast<uint8_t>(reliability), data, size);
+    return true;
+}
+
+bool CaptureTransport::receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) {
+    if (!m_inner->receive(info, buffer, capacity)) return false;
+    record(CaptureDirection::Received, info.sender, info.socket, info.channel, CAPTURE_RELIABILITY_UNKNOWN,
+           buffer, info.size);
+    return true;
+}
+
+void CaptureTransport::record(CaptureDirection direction,
+                              EOS_ProductUserId peer_id,
+                              uint8_t socket,
+                              uint8_t channel,
+                              uint8_t reliability,
+                              const uint8_t* data,
+                              uint32_t size) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file || size > MAX_RECORD_DATA ||
+            m_pending.size() + RECORD_HEADER_SIZE + size > m_max_buffered_bytes) {
+            m_packets_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto peer = m_peer_numbers.emplace(peer_id, static_cast<uint16_t>(m_peer_numbers.size())).first->second;
+
+        // Timestamped under the lock so deltas never go negative
+        Clock::time_point now = Clock::now();
+        auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - m_last_record).count();
+        m_last_record = now;
+
+        size_t offset = m_pending.size();
+        m_pending.resize(offset + RECORD_HEADER_SIZE + size);
+        uint8_t* out = m_pending.data() + offset;
+        out[0] = static_cast<uint8_t>(direction);
+        out[1] = reliability;
+        out[2] = channel;
+        out[3] = socket;
+        wire::write_u16(out + 4, peer);
+        wire::write_u32(out + 6, static_cast<uint32_t>(std::min<int64_t>(delta, UINT32_MAX)));
+        wire::write_u16(out + 10, static_cast<uint16_t>(size));
+        std::memcpy(out + RECORD_HEADER_SIZE, data, size);
+
+        wake = m_pending.size() >= WRITER_WAKE_BYTES;
+    }
+
+    m_packets_captured.fetch_add(1, std::memory_order_relaxed);
+    if (wake) m_wake.notify_one();
+}
+
+void CaptureTransport::writer_main() {
+    std::vector<uint8_t> writing;
+    bool stopping = false;
+
+    while (!stopping) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait_for(lock, WRITER_INTERVAL,
+                            [this] { return m_stopping || m_pending.size() >= WRITER_WAKE_BYTES; });
+            stopping = m_stopping;
+            writing.swap(m_pending);
+        }
+
+        // Written outside the lock; senders keep filling the other buffer
+        if (!writing.empty()) {
+            if (std::fwrite(writing.data(), 1, writing.size(), m_file) != writing.size()) {
+                m_write_failed.store(true, std::memory_order_relaxed);
+            }
+            m_bytes_written.fetch_add(writing.size(), std::memory_order_relaxed);
+            writing.clear();
+        }
+    }
+
+    std::fflush(m_file);
+}
+
+CaptureStats CaptureTransport::get_stats() const {
+    CaptureStats stats;
+    stats.packets_captured = m_packets_captured.load(std::memory_order_relaxed);
+    stats.packets_dropped = m_packets_dropped.load(std::memory_order_relaxed);
+    stats.bytes_written = m_bytes_written.load(std::memory_order_relaxed);
+    stats.write_failed = m_write_failed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+bool read_capture(const std::string& path, std::vector<CaptureRecord>& records) {
+    records.clear();
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    uint8_t header[RECORD_HEADER_SIZE > FILE_HEADER_SIZE ? RECORD_HEADER_SIZE : FILE_HEADER_SIZE];
+    if (std::fread(header, 1, FILE_HEADER_SIZE, file) != FILE_HEADER_SIZE ||
+        wire::read_u32(header) != CAPTURE_MAGIC ||
+        wire::read_u16(header + 4) == 0 || wire::read_u16(header + 4) > CAPTURE_VERSION) {
+        std::fclose(file);
+        return false;
+    }
+
+    // Version 1 records have no socket byte, so the fields after it sit
+    // one byte earlier
+    bool has_socket = wire::read_u16(header + 4) >= 2;
+    size_t record_header_size = has_socket ? RECORD_HEADER_SIZE : V1_RECORD_HEADER_SIZE;
+    size_t shift = has_socket ? 0 : 1;
+
+    uint64_t timestamp_us = 0;
+    bool complete = true;
+    size_t header_bytes;
+    while ((header_bytes = std::fread(header, 1, record_header_size, file)) > 0) {
+        CaptureRecord record;
+        if (header_bytes != record_header_size || header[0] > static_cast<uint8_t>(CaptureDirection::Received)) {
+            complete = false;
+            break;
+        }
+
+        timestamp_us += wire::read_u32(header + 6 - shift);
+        record.timestamp_us = timestamp_us;
+        record.direction = static_cast<CaptureDirection>(header[0]);
+        record.reliability = header[1];
+        record.channel = header[2];
+        record.socket = has_socket ? header[3] : 0;
+        record.peer = wire::read_u16(header + 4 - shift);
+        record.data.resize(wire::read_u16(header + 10 - shift));
+        if (std::fread(record.data.data(), 1, record.data.size(), file) != record.data.size()) {
+            complete = false;
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+
+    std::fclose(file);
+    return complete;
+}
+
+// ============================================================================
+// ReplayTransport
+// ============================================================================
+
+ReplayTransport::ReplayTransport(std::vector<CaptureRecord> records, double speed)
+    : m_records(std::move(records))
+    , m_speed(speed) {
+    skip_sent();
+}
+
+void ReplayTransport::skip_sent() {
+    while (m_next < m_records.size() && m_records[m_next].direction != CaptureDirection::Received) {
+        m_next++;
+    }
+}
+
+void ReplayTransport::rewind() {
+    m_next = 0;
+    m_started = false;
+    skip_sent();
+}
+
+bool ReplayTransport::send(EOS_ProductUserId peer_id,
+                           uint8_t channel,
+                           const uint8_t* data,
+                           uint32_t size,
+                           PacketReliability reliability,
+                           uint8_t socket) {
+    m_discarded_sends.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ReplayTransport::receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) {
+    while (!finished()) {
+        const CaptureRecord& record = m_records[m_next];
+        if (m_speed > 0.0) {
+            // Time 0 is the first packet of this pass
+            Clock::time_point now = Clock::now();
+            auto offset = std::chrono::microseconds(static_cast<int64_t>(record.timestamp_us / m_speed));
+            if (!m_started) {
+                m_started = true;
+                m_start = now - offset;
+            }
+            if (now < m_start + offset) return false;
+        }
+
+        m_next++;
+        skip_sent();
+        if (record.data.size() > capacity) continue;   // Larger than this receiver takes
+
+        std::memcpy(buffer, record.data.data(), record.data.size());
+        info.sender = peer_id(record.peer);
+        info.socket = record.socket;
+        info.channel = record.channel;
+        info.size = static_cast<uint32_t>(record.data.size());
+        m_replayed_packets++;
+        m_replayed_bytes += info.size;
+        return true;
+    }
+    
+    return false;
+}
+
+} // namespace eos_testing
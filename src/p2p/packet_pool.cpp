@@ -0,0 +1,118 @@
+/**
+ * EOS Testing - Packet Buffer Pool Implementation
+ */
+
+#include "eos_testing/p2p/packet_pool.hpp"
+#include <iostream>
+
+namespace eos_testing {
+
+PacketBuffer& PacketBuffer::operator=(PacketBuffer&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_pool = other.m_pool;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_pool = nullptr;
+        other.m_data = nullptr;
+        other.m_size = 0;
+        other.m_capacity = 0;
+    }
+    return *this;
+}
+
+PacketBuffer PacketBuffer::allocate(uint32_t size) {
+    PacketBuffer buffer;
+    buffer.m_data = new uint8_t[size > 0 ? size : 1];
+    buffer.m_size = size;
+    buffer.m_capacity = size;
+    return buffer;
+}
+
+void PacketBuffer::reset() {
+    if (m_data) {
+        if (m_pool) {
+            m_pool->release(m_data);
+        } else {
+            delete[] m_data;
+        }
+    }
+    m_pool = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_capacity = 0;
+}
+
+bool PacketPool::reset(uint32_t slab_size, uint32_t slab_count) {
+    uint32_t in_use = m_in_use.load(std::memory_order_acquire);
+    if (in_use > 0) {
+        std::cout << "[P2P] Warning: Packet pool still has " << in_use
+                  << " buffers in use, keeping existing arena\n";
+        return false;
+    }
+    
+    m_slab_size = slab_size;
+    m_slab_count = slab_count;
+    m_arena.assign(static_cast<size_t>(slab_size) * slab_count, 0);
+    
+    m_free_slabs.reset(slab_count);
+    for (uint32_t i = 0; i < slab_count; i++) {
+        m_free_slabs.try_push(m_arena.data() + static_cast<size_t>(i) * slab_size);
+    }
+    
+    m_in_use.store(0, std::memory_order_relaxed);
+    m_high_water_mark.store(0, std::memory_order_relaxed);
+    m_acquisitions.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+    m_oversize.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+PacketBuffer PacketPool::acquire(uint32_t size) {
+    m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    
+    if (size > m_slab_size) {
+        m_oversize.fetch_add(1, std::memory_order_relaxed);
+        return PacketBuffer::allocate(size);
+    }
+    
+    uint8_t* slab = nullptr;
+    if (!m_free_slabs.try_pop(slab)) {
+        // Heap fallback, released with delete[]
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return PacketBuffer::allocate(size);
+    }
+    
+    uint32_t in_use = m_in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+    uint32_t high = m_high_water_mark.load(std::memory_order_relaxed);
+    while (in_use > high &&
+           !m_high_water_mark.compare_exchange_weak(high, in_use, std::memory_order_relaxed)) {}
+    
+    PacketBuffer buffer;
+    buffer.m_pool = this;
+    buffer.m_data = slab;
+    buffer.m_size = size;
+    buffer.m_capacity = m_slab_size;
+    return buffer;
+}
+
+PacketPoolStats PacketPool::get_stats() const {
+    PacketPoolStats stats;
+    stats.slab_size = m_slab_size;
+    stats.slab_count = m_slab_count;
+    stats.in_use = m_in_use.load(std::memory_order_relaxed);
+    stats.high_water_mark = m_high_water_mark.load(std::memory_order_relaxed);
+    stats.acquisitions = m_acquisitions.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.oversize = m_oversize.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PacketPool::release(uint8_t* slab) {
+    // Can't fail: the ring holds every slab of the arena
+    m_free_slabs.try_push(std::move(slab));
+    m_in_use.fetch_sub(1, std::memory_order_release);
+}
+
+} // namespace eos_testing
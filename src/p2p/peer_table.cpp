@@ -0,0 +1,129 @@
+/**
+ * EOS Testing - Peer Table Implementation
+ */
+
+#include "eos_testing/p2p/peer_table.hpp"
+#include <algorithm>
+
+namespace eos_testing {
+
+void PeerTable::reset(uint32_t capacity) {
+    if (capacity >= INVALID_PEER_INDEX) capacity = INVALID_PEER_INDEX - 1;
+
+    m_capacity = capacity;
+    m_hot.reset(new PeerHotState[capacity]);
+    m_cold.reset(new PeerColdState[capacity]);
+
+    // At most a quarter full keeps probe runs to ~1 bucket; 64 peers is 512 bytes
+    size_t buckets = 2;
+    while (buckets < static_cast<size_t>(capacity) * 4) buckets <<= 1;
+    m_buckets.assign(buckets, INVALID_PEER_INDEX);
+    m_bucket_mask = buckets - 1;
+
+    clear();
+}
+
+void PeerTable::clear() {
+    for (uint32_t i = 0; i < m_capacity; i++) {
+        if (m_hot[i].peer_id) m_hot[i].generation.fetch_add(1, std::memory_order_release);
+        m_hot[i].peer_id = nullptr;
+        m_cold[i] = PeerColdState{};
+    }
+    std::fill(m_buckets.begin(), m_buckets.end(), INVALID_PEER_INDEX);
+
+    m_free_slots.clear();
+    for (uint32_t i = m_capacity; i > 0; i--) {
+        m_free_slots.push_back(static_cast<PeerIndex>(i - 1));
+    }
+    m_size = 0;
+}
+
+PeerIndex PeerTable::insert(EOS_ProductUserId peer_id) {
+    if (!peer_id || m_buckets.empty()) return INVALID_PEER_INDEX;
+
+    size_t bucket = bucket_for(peer_id);
+    for (;; bucket = (bucket + 1) & m_bucket_mask) {
+        PeerIndex index = m_buckets[bucket];
+        if (index == INVALID_PEER_INDEX) break;
+        if (m_hot[index].peer_id == peer_id) return index;
+    }
+
+    if (m_free_slots.empty()) return INVALID_PEER_INDEX;
+
+    PeerIndex index = m_free_slots.back();
+    m_free_slots.pop_back();
+    m_buckets[bucket] = index;
+    m_size++;
+
+    PeerHotState& hot = m_hot[index];
+    hot.peer_id = peer_id;
+    hot.status = ConnectionStatus::Disconnected;
+    hot.is_relay = false;
+    hot.ping_ms = 0;
+    hot.bytes_sent.store(0, std::memory_order_relaxed);
+    hot.bytes_received.store(0, std::memory_order_relaxed);
+    hot.rtt_ms = 0.0f;
+    hot.rtt_variance_ms = 0.0f;
+    hot.jitter_ms = 0.0f;
+    hot.packet_loss = 0.0f;
+    hot.generation.fetch_add(1, std::memory_order_release);
+    m_cold[index] = PeerColdState{};
+
+    return index;
+}
+
+bool PeerTable::remove(EOS_ProductUserId peer_id) {
+    if (!peer_id || m_buckets.empty()) return false;
+
+    size_t bucket = bucket_for(peer_id);
+    for (;; bucket = (bucket + 1) & m_bucket_mask) {
+        PeerIndex index = m_buckets[bucket];
+        if (index == INVALID_PEER_INDEX) return false;
+        if (m_hot[index].peer_id == peer_id) break;
+    }
+
+    PeerIndex index = m_buckets[bucket];
+    m_hot[index].generation.fetch_add(1, std::memory_order_release);
+    m_hot[index].peer_id = nullptr;
+    m_cold[index] = PeerColdState{};
+    m_free_slots.push_back(index);
+    m_size--;
+
+    // Backward-shift deletion: pull later entries of the probe run into
+    // the hole so lookups never need tombstones
+    size_t hole = bucket;
+    for (size_t next = (hole + 1) & m_bucket_mask;; next = (next + 1) & m_bucket_mask) {
+        PeerIndex moved = m_buckets[next];
+        if (moved == INVALID_PEER_INDEX) break;
+
+        size_t home = bucket_for(m_hot[moved].peer_id);
+        // Move it if its home bucket is not in (hole, next]
+        if (((next - home) & m_bucket_mask) >= ((next - hole) & m_bucket_mask)) {
+            m_buckets[hole] = moved;
+            hole = next;
+        }
+    }
+    m_buckets[hole] = INVALID_PEER_INDEX;
+
+    return true;
+}
+
+PeerConnection PeerTable::to_connection(PeerIndex index) const {
+    const PeerHotState& hot = m_hot[index];
+
+    PeerConnection conn;
+    conn.peer_id = hot.peer_id;
+    conn.display_name = m_cold[index].display_name;
+    conn.status = hot.status;
+    conn.is_relay = hot.is_relay;
+    conn.ping_ms = hot.ping_ms;
+    conn.bytes_sent = hot.bytes_sent.load(std::memory_order_relaxed);
+    conn.bytes_received = hot.bytes_received.load(std::memory_order_relaxed);
+    conn.rtt_ms = hot.rtt_ms;
+    conn.rtt_variance_ms = hot.rtt_variance_ms;
+    conn.jitter_ms = hot.jitter_ms;
+    conn.packet_loss = hot.packet_loss;
+    return conn;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,378 @@
+/**
+ * EOS Testing - Reliability Layer Implementation
+ */
+
+#include "reliability_layer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace eos_testing {
+
+namespace {
+
+constexpr uint32_t RECEIVED_BIT = 0x10000;
+
+// Until the first ack arrives
+constexpr float INITIAL_RTO_MS = 250.0f;
+
+// Resend timeouts stop doubling after this many resends
+constexpr uint32_t MAX_BACKOFF_SHIFT = 4;
+
+// Fraction of SRTT a frame may trail an acked one before it counts as lost
+constexpr float REORDER_WINDOW = 0.25f;
+
+// Field offsets in a Reliable frame
+constexpr uint32_t RELIABLE_SEQUENCE_OFFSET = 1;
+constexpr uint32_t RELIABLE_ACK_OFFSET = 3;
+constexpr uint32_t RELIABLE_ACK_BITS_OFFSET = 5;
+constexpr uint32_t RELIABLE_ORDER_OFFSET = 9;
+constexpr uint32_t RELIABLE_FLAGS_OFFSET = 11;
+
+// Set when the ack fields are meaningful (we have received something)
+constexpr uint8_t RELIABLE_FLAG_HAS_ACK = 0x02;
+
+/**
+ * a is newer than b, allowing for wraparound
+ */
+bool sequence_greater(uint16_t a, uint16_t b) {
+    return a != b && static_cast<uint16_t>(a - b) < 0x8000;
+}
+
+float elapsed_ms(ReliabilityLayer::Clock::time_point from, ReliabilityLayer::Clock::time_point to) {
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+} // namespace
+
+ReliabilityLayer::PeerState::PeerState()
+    : sent(new SentFrame[WINDOW]) {
+    std::memset(received, 0, sizeof(received));
+}
+
+void ReliabilityLayer::configure(Transport* transport, PacketPool* pool, uint32_t min_rto_ms, uint32_t max_rto_ms,
+                                 uint8_t socket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_transport = transport;
+    m_pool = pool;
+    m_socket = socket;
+    m_min_rto_ms = static_cast<float>(min_rto_ms);
+    m_max_rto_ms = static_cast<float>(std::max(max_rto_ms, min_rto_ms));
+    m_peers.clear();
+    m_ready.clear();
+}
+
+void ReliabilityLayer::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peers.clear();
+    m_ready.clear();
+}
+
+void ReliabilityLayer::remove_peer(EOS_ProductUserId peer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peers.erase(peer);
+    m_ready.erase(std::remove_if(m_ready.begin(), m_ready.end(),
+                                 [peer](const ReadyFrame& ready) { return ready.peer == peer; }),
+                  m_ready.end());
+}
+
+ReliabilityLayer::PeerState& ReliabilityLayer::peer_state(EOS_ProductUserId peer) {
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) {
+        it = m_peers.emplace(peer, PeerState()).first;
+        it->second.rto_ms = std::min(std::max(INITIAL_RTO_MS, m_min_rto_ms), m_max_rto_ms);
+    }
+    return it->second;
+}
+
+bool ReliabilityLayer::send(EOS_ProductUserId peer,
+                            uint8_t channel,
+                            const uint8_t* frame,
+                            uint32_t size,
+                            bool ordered,
+                            Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_transport) return false;
+
+    PeerState& state = peer_state(peer);
+    if (state.backlog.size() >= MAX_BACKLOG) return false;
+
+    QueuedFrame queued;
+    queued.channel = channel;
+    queued.frame = m_pool->acquire(wire::RELIABLE_HEADER_SIZE + size);
+    uint8_t* out = queued.frame.data();
+    out[0] = static_cast<uint8_t>(wire::FrameType::Reliable);
+    out[RELIABLE_FLAGS_OFFSET] = 0;
+    wire::write_u16(out + RELIABLE_ORDER_OFFSET, 0);
+    if (ordered) {
+        // Numbered now, so the backlog can't change the order
+        wire::write_u16(out + RELIABLE_ORDER_OFFSET, state.streams[channel].next_send++);
+        out[RELIABLE_FLAGS_OFFSET] = wire::RELIABLE_FLAG_ORDERED;
+    }
+    std::memcpy(out + wire::RELIABLE_HEADER_SIZE, frame, size);
+
+    if (state.backlog.empty() && transmit(peer, state, queued, now)) {
+        return true;
+    }
+
+    state.backlog.push_back(std::move(queued));
+    return true;
+}
+
+bool ReliabilityLayer::transmit(EOS_ProductUserId peer, PeerState& state, QueuedFrame& queued, Clock::time_point now) {
+    SentFrame& slot = state.sent[state.next_sequence % WINDOW];
+    if (slot.frame.data()) return false;   // Window full
+
+    uint8_t* frame = queued.frame.data();
+    wire::write_u16(frame + RELIABLE_SEQUENCE_OFFSET, state.next_sequence);
+    write_acks(state, frame);
+    m_transport->send(peer, queued.channel, frame, queued.frame.size(), PacketReliability::UnreliableUnordered,
+                      m_socket);
+
+    slot.frame = std::move(queued.frame);
+    slot.sequence = state.next_sequence;
+    slot.channel = queued.channel;
+    slot.transmissions = 1;
+    slot.first_sent = now;
+    slot.last_sent = now;
+
+    state.next_sequence++;
+    state.in_flight++;
+    state.stats.packets_sent++;
+    return true;
+}
+
+void ReliabilityLayer::write_acks(PeerState& state, uint8_t* frame) {
+    if (!state.has_received) {
+        frame[RELIABLE_FLAGS_OFFSET] &= ~RELIABLE_FLAG_HAS_ACK;
+        return;
+    }
+
+    wire::write_u16(frame + RELIABLE_ACK_OFFSET, state.latest_received);
+    wire::write_u32(frame + RELIABLE_ACK_BITS_OFFSET, ack_bits(state, state.latest_received));
+    frame[RELIABLE_FLAGS_OFFSET] |= RELIABLE_FLAG_HAS_ACK;
+    state.unacked = 0;
+}
+
+bool ReliabilityLayer::has_received(const PeerState& state, uint16_t sequence) const {
+    return state.received[sequence % WINDOW] == (RECEIVED_BIT | sequence);
+}
+
+uint32_t ReliabilityLayer::ack_bits(const PeerState& state, uint16_t ack) const {
+    // Bit n set = (ack - n - 1) received
+    uint32_t bits = 0;
+    for (uint32_t n = 0; n < 32; n++) {
+        if (has_received(state, static_cast<uint16_t>(ack - n - 1))) bits |= 1u << n;
+    }
+    return bits;
+}
+
+void ReliabilityLayer::send_ack(EOS_ProductUserId peer, PeerState& state, uint16_t ack) {
+    uint8_t frame[wire::ACK_FRAME_SIZE];
+    frame[0] = static_cast<uint8_t>(wire::FrameType::Ack);
+    wire::write_u16(frame + 1, ack);
+    wire::write_u32(frame + 3, ack_bits(state, ack));
+    m_transport->send(peer, state.ack_channel, frame, sizeof(frame), PacketReliability::UnreliableUnordered,
+                      m_socket);
+    state.unacked = 0;
+}
+
+bool ReliabilityLayer::receive(EOS_ProductUserId peer,
+                               uint8_t channel,
+                               const uint8_t* frame,
+                               uint32_t size,
+                               Clock::time_point now,
+                               const uint8_t*& inner,
+                               uint32_t& inner_size) {
+    if (size <= wire::RELIABLE_HEADER_SIZE) return false;
+
+    uint16_t sequence = wire::read_u16(frame + RELIABLE_SEQUENCE_OFFSET);
+    uint16_t order = wire::read_u16(frame + RELIABLE_ORDER_OFFSET);
+    uint8_t flags = frame[RELIABLE_FLAGS_OFFSET];
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_transport) return false;
+
+    PeerState& state = peer_state(peer);
+    state.ack_channel = channel;
+
+    if (flags & RELIABLE_FLAG_HAS_ACK) {
+        process_acks(state, wire::read_u16(frame + RELIABLE_ACK_OFFSET),
+                     wire::read_u32(frame + RELIABLE_ACK_BITS_OFFSET), now);
+        drain_backlog(peer, state, now);
+    }
+
+    // The sender can't be a full window ahead of anything it still needs
+    // acked, so anything older than that was received before
+    bool too_old = state.has_received && sequence_greater(state.latest_received, sequence) &&
+                   static_cast<uint16_t>(state.latest_received - sequence) >= WINDOW;
+    if (too_old || has_received(state, sequence)) {
+        // Our ack was lost; repeat it for exactly this frame
+        state.stats.duplicates_received++;
+        send_ack(peer, state, sequence);
+        return false;
+    }
+
+    state.received[sequence % WINDOW] = RECEIVED_BIT | sequence;
+    if (!state.has_received || sequence_greater(sequence, state.latest_received)) {
+        state.latest_received = sequence;
+    }
+    state.has_received = true;
+    if (++state.unacked >= ACK_EVERY) {
+        send_ack(peer, state, state.latest_received);
+    }
+
+    const uint8_t* payload = frame + wire::RELIABLE_HEADER_SIZE;
+    uint32_t payload_size = size - wire::RELIABLE_HEADER_SIZE;
+
+    if (!(flags & wire::RELIABLE_FLAG_ORDERED)) {
+        inner = payload;
+        inner_size = payload_size;
+        return true;
+    }
+
+    OrderedStream& stream = state.streams[channel];
+    if (order != stream.next_deliver) {
+        if (sequence_greater(order, stream.next_deliver)) {
+            PacketBuffer held = m_pool->acquire(payload_size);
+            std::memcpy(held.data(), payload, payload_size);
+            stream.held.emplace_back(order, std::move(held));
+        }
+        return false;
+    }
+
+    // In order: deliver it, then whatever it unblocked
+    stream.next_deliver++;
+    for (bool released = true; released && !stream.held.empty();) {
+        released = false;
+        for (auto it = stream.held.begin(); it != stream.held.end(); ++it) {
+            if (it->first == stream.next_deliver) {
+                m_ready.push_back({peer, channel, std::move(it->second)});
+                stream.held.erase(it);
+                stream.next_deliver++;
+                released = true;
+                break;
+            }
+        }
+    }
+
+    inner = payload;
+    inner_size = payload_size;
+    return true;
+}
+
+void ReliabilityLayer::receive_ack(EOS_ProductUserId peer, const uint8_t* frame, uint32_t size, Clock::time_point now) {
+    if (size < wire::ACK_FRAME_SIZE) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_transport) return;
+
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) return;
+
+    process_acks(it->second, wire::read_u16(frame + 1), wire::read_u32(frame + 3), now);
+    drain_backlog(peer, it->second, now);
+}
+
+void ReliabilityLayer::process_acks(PeerState& state, uint16_t ack, uint32_t bits, Clock::time_point now) {
+    auto acknowledge = [&](uint16_t sequence) {
+        SentFrame& slot = state.sent[sequence % WINDOW];
+        if (!slot.frame.data() || slot.sequence != sequence) return;
+
+        // Karn: only frames sent once give an unambiguous sample
+        if (slot.transmissions == 1) {
+            float sample = elapsed_ms(slot.first_sent, now);
+            if (!state.has_rtt) {
+                state.srtt_ms = sample;
+                state.rttvar_ms = sample / 2.0f;
+                state.has_rtt = true;
+            } else {
+                state.rttvar_ms = 0.75f * state.rttvar_ms + 0.25f * std::fabs(state.srtt_ms - sample);
+                state.srtt_ms = 0.875f * state.srtt_ms + 0.125f * sample;
+            }
+            state.rto_ms = std::min(std::max(state.srtt_ms + 4.0f * state.rttvar_ms, m_min_rto_ms), m_max_rto_ms);
+        }
+
+        state.newest_acked_send = std::max(state.newest_acked_send, slot.last_sent);
+        slot.frame.reset();
+        state.in_flight--;
+        state.stats.packets_acked++;
+    };
+
+    acknowledge(ack);
+    for (uint32_t n = 0; n < 32; n++) {
+        if (bits & (1u << n)) acknowledge(static_cast<uint16_t>(ack - n - 1));
+    }
+}
+
+void ReliabilityLayer::drain_backlog(EOS_ProductUserId peer, PeerState& state, Clock::time_point now) {
+    while (!state.backlog.empty() && transmit(peer, state, state.backlog.front(), now)) {
+        state.backlog.pop_front();
+    }
+}
+
+bool ReliabilityLayer::pop_ready(ReadyFrame& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ready.empty()) return false;
+
+    out = std::move(m_ready.front());
+    m_ready.pop_front();
+    return true;
+}
+
+void ReliabilityLayer::update(Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_transport) return;
+
+    for (auto& entry : m_peers) {
+        EOS_ProductUserId peer = entry.first;
+        PeerState& state = entry.second;
+
+        if (state.in_flight > 0) {
+            for (uint32_t i = 0; i < WINDOW; i++) {
+                SentFrame& slot = state.sent[i];
+                if (!slot.frame.data()) continue;
+
+                uint32_t shift = std::min(slot.transmissions - 1, MAX_BACKOFF_SHIFT);
+                float timeout = std::min(state.rto_ms * static_cast<float>(1u << shift), m_max_rto_ms);
+                bool timed_out = elapsed_ms(slot.last_sent, now) >= timeout;
+
+                // A frame sent more than a reordering window before one
+                // that has since been acked is taken as lost without
+                // waiting out the RTO (RFC 8985 RACK)
+                bool overtaken = state.has_rtt &&
+                                 elapsed_ms(slot.last_sent, state.newest_acked_send) > state.srtt_ms * REORDER_WINDOW;
+                if (!timed_out && !overtaken) continue;
+
+                write_acks(state, slot.frame.data());
+                m_transport->send(peer, slot.channel, slot.frame.data(), slot.frame.size(),
+                                  PacketReliability::UnreliableUnordered, m_socket);
+                slot.transmissions++;
+                slot.last_sent = now;
+                state.stats.retransmits++;
+            }
+        }
+
+        drain_backlog(peer, state, now);
+
+        if (state.unacked > 0) {
+            send_ack(peer, state, state.latest_received);
+        }
+    }
+}
+
+std::optional<ReliabilityStats> ReliabilityLayer::get_stats(EOS_ProductUserId peer) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) return std::nullopt;
+
+    const PeerState& state = it->second;
+    ReliabilityStats stats = state.stats;
+    stats.in_flight = state.in_flight;
+    stats.backlog = static_cast<uint32_t>(state.backlog.size());
+    stats.rtt_ms = state.srtt_ms;
+    stats.rto_ms = state.rto_ms;
+    return stats;
+}
+
+} // namespace eos_testing
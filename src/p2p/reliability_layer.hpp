@@ -0,0 +1,183 @@
+#pragma once
+
+/**
+ * EOS Testing - Reliability Layer (internal)
+ *
+ * P2PManager's own reliable delivery over unreliable packets, used when
+ * P2PConfig::custom_reliability is set:
+ * - Every reliable frame gets a 16-bit sequence number and is kept until
+ *   acked, at most WINDOW per peer; the rest wait in a backlog
+ * - Receivers ack with the latest sequence plus a 32-bit bitfield of the
+ *   ones before it, piggybacked on their own reliable frames, otherwise
+ *   sent as Ack frames every ACK_EVERY packets or on update()
+ * - Unacked frames are resent after an RTO from smoothed ack RTT
+ *   (RFC 6298), doubling per resend up to the configured maximum, or
+ *   straight away once a frame sent after them is acked
+ * - ReliableOrdered frames carry a per-channel order number; the
+ *   receiver holds early ones back until the gap is filled
+ *
+ * P2PManager runs one per socket, so a backlog on one socket doesn't
+ * hold up another's ordered frames.
+ *
+ * Thread-safe. Nothing is called back: deliverable frames are returned
+ * from receive() and pop_ready(), so no lock is held while the game
+ * handles them.
+ */
+
+#include "wire_format.hpp"
+#include "eos_testing/p2p/packet_pool.hpp"
+#include "eos_testing/p2p/peer_table.hpp"
+#include "eos_testing/p2p/transport.hpp"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace eos_testing {
+
+class ReliabilityLayer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr uint32_t WINDOW = 256;         // Unacked frames per peer
+    static constexpr uint32_t ACK_EVERY = 16;       // Received frames between forced acks
+    static constexpr uint32_t MAX_BACKLOG = 65536;  // Frames waiting per peer before send() fails
+
+    /**
+     * A ReliableOrdered frame that became deliverable when a gap filled
+     */
+    struct ReadyFrame {
+        EOS_ProductUserId peer = nullptr;
+        uint8_t channel = 0;
+        PacketBuffer frame;
+    };
+
+    /**
+     * @param transport Where frames and acks go (sent as UnreliableUnordered)
+     * @param pool Buffers for frames kept for resending
+     * @param socket Transport socket the frames and acks are sent on
+     */
+    void configure(Transport* transport, PacketPool* pool, uint32_t min_rto_ms, uint32_t max_rto_ms,
+                   uint8_t socket = 0);
+
+    void clear();
+    void remove_peer(EOS_ProductUserId peer);
+
+    /**
+     * Send a frame (Data/Batch/Fragment) reliably. It goes out now if the
+     * window has room, otherwise when acks free a slot.
+     *
+     * @return false if the backlog is full
+     */
+    bool send(EOS_ProductUserId peer,
+              uint8_t channel,
+              const uint8_t* frame,
+              uint32_t size,
+              bool ordered,
+              Clock::time_point now);
+
+    /**
+     * Handle a Reliable frame.
+     *
+     * @param inner Set to the wrapped frame when it should be dispatched now
+     * @return true if `inner` is set. Either way, follow with pop_ready():
+     *         this frame may have released held-back ordered frames.
+     */
+    bool receive(EOS_ProductUserId peer,
+                 uint8_t channel,
+                 const uint8_t* frame,
+                 uint32_t size,
+                 Clock::time_point now,
+                 const uint8_t*& inner,
+                 uint32_t& inner_size);
+
+    /**
+     * Handle an Ack frame.
+     */
+    void receive_ack(EOS_ProductUserId peer, const uint8_t* frame, uint32_t size, Clock::time_point now);
+
+    /**
+     * Take the next ordered frame released by receive().
+     */
+    bool pop_ready(ReadyFrame& out);
+
+    /**
+     * Resend timed-out frames, send what the window now allows and ack
+     * anything not yet acked. Call once per tick.
+     */
+    void update(Clock::time_point now);
+
+    std::optional<ReliabilityStats> get_stats(EOS_ProductUserId peer) const;
+
+private:
+    struct SentFrame {
+        PacketBuffer frame;     // Empty = free slot
+        uint16_t sequence = 0;
+        uint8_t channel = 0;
+        uint32_t transmissions = 0;
+        Clock::time_point first_sent;
+        Clock::time_point last_sent;
+    };
+
+    struct QueuedFrame {
+        PacketBuffer frame;
+        uint8_t channel = 0;
+    };
+
+    struct OrderedStream {
+        uint16_t next_send = 0;
+        uint16_t next_deliver = 0;
+        std::vector<std::pair<uint16_t, PacketBuffer>> held;   // Arrived ahead of a gap
+    };
+
+    struct PeerState {
+        PeerState();
+
+        // Sending
+        std::unique_ptr<SentFrame[]> sent;      // By sequence % WINDOW
+        uint16_t next_sequence = 0;
+        uint32_t in_flight = 0;
+        std::deque<QueuedFrame> backlog;
+        bool has_rtt = false;
+        float srtt_ms = 0.0f;
+        float rttvar_ms = 0.0f;
+        float rto_ms = 0.0f;
+        Clock::time_point newest_acked_send{};  // Latest last_sent among acked frames
+
+        // Receiving
+        bool has_received = false;
+        uint16_t latest_received = 0;
+        uint32_t received[WINDOW];      // sequence | RECEIVED_BIT, by sequence % WINDOW
+        uint32_t unacked = 0;           // Frames received since we last sent acks
+        uint8_t ack_channel = 0;
+        std::unordered_map<uint8_t, OrderedStream> streams;
+
+        ReliabilityStats stats;
+    };
+
+    PeerState& peer_state(EOS_ProductUserId peer);
+    bool has_received(const PeerState& state, uint16_t sequence) const;
+    uint32_t ack_bits(const PeerState& state, uint16_t ack) const;
+
+    bool transmit(EOS_ProductUserId peer, PeerState& state, QueuedFrame& queued, Clock::time_point now);
+    void write_acks(PeerState& state, uint8_t* frame);
+    void send_ack(EOS_ProductUserId peer, PeerState& state, uint16_t ack);
+    void process_acks(PeerState& state, uint16_t ack, uint32_t bits, Clock::time_point now);
+    void drain_backlog(EOS_ProductUserId peer, PeerState& state, Clock::time_point now);
+
+    Transport* m_transport = nullptr;
+    PacketPool* m_pool = nullptr;
+    uint8_t m_socket = 0;
+    float m_min_rto_ms = 0.0f;
+    float m_max_rto_ms = 0.0f;
+
+    std::unordered_map<EOS_ProductUserId, PeerState> m_peers;
+    std::deque<ReadyFrame> m_ready;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace eos_testing
@@ -0,0 +1,294 @@
+/**
+ * EOS Testing - Send Scheduler Implementation
+ */
+
+#include "eos_testing/p2p/send_scheduler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace eos_testing {
+
+namespace {
+
+bool is_reliable(PacketReliability reliability) {
+    return reliability != PacketReliability::UnreliableUnordered;
+}
+
+} // namespace
+
+void SendScheduler::configure(const Settings& settings, PacketPool* pool) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_settings = settings;
+    m_settings.quantum_bytes = std::max<uint32_t>(settings.quantum_bytes, 1);
+    m_pool = pool;
+    m_peers.clear();
+}
+
+void SendScheduler::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peers.clear();
+}
+
+void SendScheduler::remove_peer(EOS_ProductUserId peer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_peers.erase(peer);
+}
+
+const ChannelPriority& SendScheduler::channel_class(uint8_t socket, uint8_t channel) const {
+    const std::vector<ChannelPriority>* classes = &m_settings.channel_priorities;
+    if (socket > 0) {
+        if (socket >= m_settings.socket_channel_priorities.size()) return m_default_class;
+        classes = &m_settings.socket_channel_priorities[socket];
+    }
+    if (channel < classes->size()) return (*classes)[channel];
+    return m_default_class;
+}
+
+SendScheduler::PeerState& SendScheduler::peer_state(EOS_ProductUserId peer, Clock::time_point now) {
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) {
+        it = m_peers.emplace(peer, PeerState()).first;
+        it->second.tokens = m_settings.burst_bytes;
+        it->second.tokens_updated = now;
+    }
+    return it->second;
+}
+
+SendScheduler::ChannelQueue& SendScheduler::channel_queue(PeerState& state, uint8_t socket, uint8_t channel) {
+    for (auto& queue : state.channels) {
+        if (queue.socket == socket && queue.channel == channel) return queue;
+    }
+
+    state.channels.emplace_back();
+    ChannelQueue& queue = state.channels.back();
+    queue.socket = socket;
+    queue.channel = channel;
+    queue.priority = channel_class(socket, channel);
+    return queue;
+}
+
+const SendScheduler::ChannelQueue* SendScheduler::find_channel_queue(const PeerState& state,
+                                                                     uint8_t socket,
+                                                                     uint8_t channel) {
+    for (const auto& queue : state.channels) {
+        if (queue.socket == socket && queue.channel == channel) return &queue;
+    }
+    return nullptr;
+}
+
+bool SendScheduler::enqueue(EOS_ProductUserId peer,
+                            uint8_t channel,
+                            const uint8_t* data,
+                            uint32_t size,
+                            PacketReliability reliability,
+                            Clock::time_point now,
+                            SendQueueDepth* depth,
+                            uint8_t socket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_pool) return false;
+
+    PeerState& state = peer_state(peer, now);
+
+    // Make room by shedding unreliable traffic that matters less than
+    // this frame; reliable frames may shed any of it
+    if (m_settings.max_queued_bytes > 0) {
+        uint8_t priority = is_reliable(reliability) ? 255 : channel_class(socket, channel).priority;
+        while (state.stats.queued_bytes + size > m_settings.max_queued_bytes && evict(state, priority)) {
+        }
+
+        if (state.stats.queued_bytes + size > m_settings.max_queued_bytes && !is_reliable(reliability)) {
+            state.stats.frames_dropped++;
+            state.stats.bytes_dropped += size;
+            if (depth) *depth = queue_depth(state, socket, channel);
+            return false;
+        }
+    }
+
+    ChannelQueue& queue = channel_queue(state, socket, channel);
+
+    QueuedFrame frame;
+    frame.reliability = reliability;
+    frame.queued_at = now;
+    frame.data = m_pool->acquire(size);
+    std::memcpy(frame.data.data(), data, size);
+    queue.frames.push_back(std::move(frame));
+    queue.bytes += size;
+
+    state.stats.queued_frames++;
+    state.stats.queued_bytes += size;
+    if (depth) *depth = queue_depth(state, socket, channel);
+    return true;
+}
+
+bool SendScheduler::evict(PeerState& state, uint8_t max_priority) {
+    // Oldest unreliable frame on the lowest priority channel that has one,
+    // lowest socket and channel number first among equals
+    ChannelQueue* victim_queue = nullptr;
+    std::deque<QueuedFrame>::iterator victim;
+    int lowest = max_priority + 1;
+
+    for (auto& queue : state.channels) {
+        int priority = queue.priority.priority;
+        if (priority > lowest) continue;
+        if (priority == lowest && (!victim_queue || lane_key(queue) > lane_key(*victim_queue))) continue;
+
+        auto& frames = queue.frames;
+        auto found = std::find_if(frames.begin(), frames.end(),
+                                  [](const QueuedFrame& frame) { return !is_reliable(frame.reliability); });
+        if (found != frames.end()) {
+            victim_queue = &queue;
+            victim = found;
+            lowest = priority;
+        }
+    }
+
+    if (!victim_queue) return false;
+
+    state.stats.queued_frames--;
+    state.stats.queued_bytes -= victim->data.size();
+    state.stats.frames_dropped++;
+    state.stats.bytes_dropped += victim->data.size();
+    victim_queue->bytes -= victim->data.size();
+    victim_queue->frames.erase(victim);
+    return true;
+}
+
+void SendScheduler::release(Clock::time_point now, std::vector<Frame>& out) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& entry : m_peers) {
+        if (entry.second.stats.queued_frames > 0) {
+            release_peer(entry.first, entry.second, now, out);
+        }
+    }
+}
+
+void SendScheduler::set_peer_rate(EOS_ProductUserId peer, uint32_t bytes_per_second, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    peer_state(peer, now).bytes_per_second = bytes_per_second;
+}
+
+void SendScheduler::release_peer(EOS_ProductUserId peer,
+                                 PeerState& state,
+                                 Clock::time_point now,
+                                 std::vector<Frame>& out) {
+    uint32_t bytes_per_second = state.bytes_per_second > 0 ? state.bytes_per_second : m_settings.bytes_per_second;
+    if (bytes_per_second > 0) {
+        double elapsed = std::chrono::duration<double>(now - state.tokens_updated).count();
+        state.tokens = std::min<double>(m_settings.burst_bytes, state.tokens + elapsed * bytes_per_second);
+    } else {
+        state.tokens = std::numeric_limits<double>::max();
+    }
+    state.tokens_updated = now;
+
+    m_active.clear();
+    for (size_t index = 0; index < state.channels.size(); index++) {
+        if (!state.channels[index].frames.empty()) m_active.push_back(static_cast<uint32_t>(index));
+    }
+    std::sort(m_active.begin(), m_active.end(), [&state](uint32_t a, uint32_t b) {
+        const ChannelQueue& first = state.channels[a];
+        const ChannelQueue& second = state.channels[b];
+        if (first.priority.priority != second.priority.priority) {
+            return first.priority.priority > second.priority.priority;
+        }
+        return lane_key(first) < lane_key(second);
+    });
+
+    // Strict priority between levels, deficit round robin within one.
+    // The budget may go negative by one frame, so a frame larger than the
+    // burst still goes out; the debt delays the next release.
+    size_t level_begin = 0;
+    while (level_begin < m_active.size() && state.tokens > 0.0) {
+        uint8_t priority = state.channels[m_active[level_begin]].priority.priority;
+        size_t level_end = level_begin;
+        uint32_t level_frames = 0;
+        while (level_end < m_active.size() && state.channels[m_active[level_end]].priority.priority == priority) {
+            level_frames += static_cast<uint32_t>(state.channels[m_active[level_end]].frames.size());
+            level_end++;
+        }
+
+        while (level_frames > 0 && state.tokens > 0.0) {
+            for (size_t i = level_begin; i < level_end && state.tokens > 0.0; i++) {
+                ChannelQueue& queue = state.channels[m_active[i]];
+                if (queue.frames.empty()) continue;
+
+                uint32_t weight = std::max<uint32_t>(queue.priority.weight, 1);
+                queue.deficit += static_cast<int64_t>(weight) * m_settings.quantum_bytes;
+
+                while (!queue.frames.empty() && state.tokens > 0.0 &&
+                       static_cast<int64_t>(queue.frames.front().data.size()) <= queue.deficit) {
+                    QueuedFrame& queued = queue.frames.front();
+                    uint32_t size = queued.data.size();
+                    queue.deficit -= size;
+                    queue.bytes -= size;
+                    state.tokens -= size;
+
+                    Frame frame;
+                    frame.peer = peer;
+                    frame.socket = queue.socket;
+                    frame.channel = queue.channel;
+                    frame.reliability = queued.reliability;
+                    frame.data = std::move(queued.data);
+                    out.push_back(std::move(frame));
+                    queue.frames.pop_front();
+                    level_frames--;
+
+                    state.stats.frames_sent++;
+                    state.stats.bytes_sent += size;
+                    state.stats.queued_frames--;
+                    state.stats.queued_bytes -= size;
+                }
+
+                // An idle channel doesn't bank credit
+                if (queue.frames.empty()) queue.deficit = 0;
+            }
+        }
+
+        level_begin = level_end;
+    }
+
+    state.stats.frames_deferred += state.stats.queued_frames;
+    drop_stale(state, now);
+}
+
+void SendScheduler::drop_stale(PeerState& state, Clock::time_point now) {
+    if (m_settings.max_unreliable_delay_ms == 0 || state.stats.queued_frames == 0) return;
+
+    Clock::time_point cutoff = now - std::chrono::milliseconds(m_settings.max_unreliable_delay_ms);
+    for (auto& queue : state.channels) {
+        auto stale = std::remove_if(queue.frames.begin(), queue.frames.end(), [&](const QueuedFrame& frame) {
+            if (is_reliable(frame.reliability) || frame.queued_at >= cutoff) return false;
+            state.stats.queued_frames--;
+            state.stats.queued_bytes -= frame.data.size();
+            state.stats.frames_dropped++;
+            state.stats.bytes_dropped += frame.data.size();
+            queue.bytes -= frame.data.size();
+            return true;
+        });
+        queue.frames.erase(stale, queue.frames.end());
+    }
+}
+
+std::optional<SendQueueStats> SendScheduler::get_stats(EOS_ProductUserId peer) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) return std::nullopt;
+    return it->second.stats;
+}
+
+SendQueueDepth SendScheduler::get_queue_depth(EOS_ProductUserId peer, uint8_t channel, uint8_t socket) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end()) return SendQueueDepth();
+    return queue_depth(it->second, socket, channel);
+}
+
+SendQueueDepth SendScheduler::queue_depth(const PeerState& state, uint8_t socket, uint8_t channel) {
+    SendQueueDepth depth;
+    depth.peer_bytes = state.stats.queued_bytes;
+    if (const ChannelQueue* queue = find_channel_queue(state, socket, channel)) depth.channel_bytes = queue->bytes;
+    return depth;
+}
+
+} // namespace eos_testing
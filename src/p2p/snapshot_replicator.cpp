@@ -0,0 +1,573 @@
+/**
+ * EOS Testing - Snapshot Replicator Implementation
+ */
+
+#include "eos_testing/p2p/snapshot_replicator.hpp"
+#include "wire_format.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace eos_testing {
+
+namespace {
+
+// Packet kinds on the snapshot channel
+constexpr uint8_t KIND_SNAPSHOT = 1;
+constexpr uint8_t KIND_ACK = 2;
+
+// [kind][u32 tick][u32 baseline tick][u8 part][u8 part count][u16 record count]
+constexpr uint32_t SNAPSHOT_HEADER_SIZE = 1 + 4 + 4 + 1 + 1 + 2;
+
+// [kind][u32 tick]
+constexpr uint32_t ACK_SIZE = 1 + 4;
+
+constexpr uint32_t MAX_PARTS = 255;
+
+// Records: [u16 entity id][u8 op] followed by
+//   Removed: nothing
+//   Full:    [u8 type][state]
+//   Delta:   [changed-word bitmask][changed words], against the baseline
+constexpr uint8_t OP_REMOVED = 0;
+constexpr uint8_t OP_FULL = 1;
+constexpr uint8_t OP_DELTA = 2;
+constexpr uint32_t RECORD_HEADER_SIZE = 3;
+
+constexpr uint32_t WORD_SIZE = 4;
+
+uint32_t word_count(uint32_t size) {
+    return (size + WORD_SIZE - 1) / WORD_SIZE;
+}
+
+uint32_t mask_size(uint32_t size) {
+    return (word_count(size) + 7) / 8;
+}
+
+// Bytes of word `word` in a state of `size` bytes (the last may be short)
+uint32_t word_length(uint32_t size, uint32_t word) {
+    return std::min(WORD_SIZE, size - word * WORD_SIZE);
+}
+
+} // namespace
+
+SnapshotReplicator::Entity* SnapshotReplicator::Snapshot::find(uint16_t id) {
+    auto it = std::lower_bound(entities.begin(), entities.end(), id,
+                               [](const Entity& entity, uint16_t key) { return entity.id < key; });
+    return it != entities.end() && it->id == id ? &*it : nullptr;
+}
+
+const SnapshotReplicator::Entity* SnapshotReplicator::Snapshot::find(uint16_t id) const {
+    return const_cast<Snapshot*>(this)->find(id);
+}
+
+SnapshotReplicator::SnapshotReplicator(P2PManager& p2p, uint8_t channel)
+    : m_p2p(p2p)
+    , m_channel(channel) {
+}
+
+uint8_t SnapshotReplicator::register_type(uint32_t size) {
+    if (size == 0 || size > MAX_TYPE_SIZE || m_type_sizes.size() >= INVALID_TYPE) {
+        std::cout << "[P2P] Error: Can't register snapshot type of " << size << " bytes\n";
+        return INVALID_TYPE;
+    }
+    m_type_sizes.push_back(size);
+    return static_cast<uint8_t>(m_type_sizes.size() - 1);
+}
+
+bool SnapshotReplicator::set_entity(uint16_t id, uint8_t type, const void* state, uint32_t size) {
+    if (type >= m_type_sizes.size() || m_type_sizes[type] != size) return false;
+
+    Entity* entity = m_building.find(id);
+    if (!entity) {
+        Entity added;
+        added.id = id;
+        auto it = std::lower_bound(m_building.entities.begin(), m_building.entities.end(), id,
+                                   [](const Entity& e, uint16_t key) { return e.id < key; });
+        entity = &*m_building.entities.insert(it, added);
+        entity->offset = static_cast<uint32_t>(m_building.data.size());
+        m_building.data.resize(m_building.data.size() + size);
+    } else if (m_type_sizes[entity->type] != size) {
+        // Changed to a type of another size; the old bytes are left for commit() to drop
+        entity->offset = static_cast<uint32_t>(m_building.data.size());
+        m_building.data.resize(m_building.data.size() + size);
+    }
+
+    entity->type = type;
+    std::memcpy(m_building.data.data() + entity->offset, state, size);
+    return true;
+}
+
+void SnapshotReplicator::remove_entity(uint16_t id) {
+    Entity* entity = m_building.find(id);
+    if (entity) m_building.entities.erase(m_building.entities.begin() + (entity - m_building.entities.data()));
+}
+
+void SnapshotReplicator::compact(const Snapshot& from, Snapshot& to, const std::vector<uint32_t>& sizes) {
+    to.tick = from.tick;
+    to.entities = from.entities;
+    to.data.clear();
+    for (auto& entity : to.entities) {
+        uint32_t size = sizes[entity.type];
+        const uint8_t* bytes = from.data.data() + entity.offset;
+        entity.offset = static_cast<uint32_t>(to.data.size());
+        to.data.insert(to.data.end(), bytes, bytes + size);
+    }
+}
+
+uint32_t SnapshotReplicator::commit() {
+    m_tick++;
+    Snapshot& committed = m_history[m_tick % HISTORY];
+    compact(m_building, committed, m_type_sizes);
+    committed.tick = m_tick;
+
+    // Drop bytes left behind by removed or retyped entities
+    if (m_building.data.size() > 2 * committed.data.size()) {
+        m_building.entities = committed.entities;
+        m_building.data = committed.data;
+    }
+
+    return m_tick;
+}
+
+void SnapshotReplicator::set_interest(const InterestManager* interest) {
+    if (interest == m_interest) return;
+    m_interest = interest;
+
+    // Acked baselines are views with interest and committed ticks without
+    for (auto& item : m_peers) {
+        item.second.acked_tick = NO_TICK;
+        item.second.view_tick = NO_TICK;
+    }
+}
+
+uint32_t SnapshotReplicator::send(EOS_ProductUserId peer) {
+    if (m_tick == NO_TICK || !peer) return 0;
+
+    PeerState& state = m_peers[peer];
+    const Snapshot* current = &m_history[m_tick % HISTORY];
+    const Snapshot* sent = m_history;
+    if (m_interest) {
+        build_view(state, peer);
+        current = &state.views[m_tick % HISTORY];
+        sent = state.views;
+    }
+
+    const Snapshot* baseline = nullptr;
+    if (state.acked_tick != NO_TICK && m_tick - state.acked_tick < HISTORY) {
+        const Snapshot& candidate = sent[state.acked_tick % HISTORY];
+        if (candidate.tick == state.acked_tick) baseline = &candidate;
+    }
+
+    encode(*current, baseline);
+
+    uint32_t bytes_sent = 0;
+    if (!send_parts(peer, baseline ? baseline->tick : NO_TICK, bytes_sent)) return 0;
+
+    m_stats.snapshots_sent++;
+    if (!baseline) m_stats.full_snapshots_sent++;
+    return bytes_sent;
+}
+
+void SnapshotReplicator::build_view(PeerState& state, EOS_ProductUserId peer) {
+    // Sent this tick already: the view stands
+    if (state.view_tick == m_tick) return;
+
+    const Snapshot& current = m_history[m_tick % HISTORY];
+    const Snapshot* previous = nullptr;
+    if (state.view_tick != NO_TICK && m_tick - state.view_tick < HISTORY) {
+        previous = &state.views[state.view_tick % HISTORY];
+    }
+
+    Snapshot& view = state.views[m_tick % HISTORY];
+    view.tick = m_tick;
+    view.entities.clear();
+    view.data.clear();
+
+    // Entities in the interest set take their current state when due or
+    // new to the peer, and keep what the peer was last sent otherwise.
+    // After skipped ticks, due on any of them counts.
+    uint32_t ticks = previous ? m_tick - state.view_tick : 1;
+    for (const auto& entry : m_interest->get_interest(peer)) {
+        const Entity* now = current.find(entry.id);
+        if (!now) continue;
+
+        const Entity* source = now;
+        const uint8_t* source_data = current.data.data();
+        bool due = entry.due || (ticks > 1 && m_interest->was_due(entry.id, entry.relevance, ticks));
+        if (!due && previous) {
+            const Entity* before = previous->find(entry.id);
+            if (before && before->type == now->type) {
+                source = before;
+                source_data = previous->data.data();
+            }
+        }
+
+        uint32_t size = m_type_sizes[source->type];
+        Entity entity = *source;
+        entity.offset = static_cast<uint32_t>(view.data.size());
+        view.entities.push_back(entity);
+        view.data.insert(view.data.end(), source_data + source->offset, source_data + source->offset + size);
+    }
+
+    state.view_tick = m_tick;
+}
+
+void SnapshotReplicator::encode(const Snapshot& current, const Snapshot* baseline) {
+    m_records.clear();
+    m_record_ends.clear();
+
+    // Both entity lists are sorted by id: walk them together
+    size_t i = 0;
+    size_t j = 0;
+    size_t baseline_count = baseline ? baseline->entities.size() : 0;
+    while (i < current.entities.size() || j < baseline_count) {
+        const Entity* now = i < current.entities.size() ? &current.entities[i] : nullptr;
+        const Entity* before = j < baseline_count ? &baseline->entities[j] : nullptr;
+
+        if (now && (!before || now->id < before->id)) {
+            write_record(now, current.data.data(), nullptr, nullptr);
+            i++;
+        } else if (before && (!now || before->id < now->id)) {
+            write_record(nullptr, nullptr, before, nullptr);
+            j++;
+        } else {
+            write_record(now, current.data.data(), before, baseline->data.data());
+            i++;
+            j++;
+        }
+    }
+}
+
+uint32_t SnapshotReplicator::broadcast() {
+    auto now = std::chrono::steady_clock::now();
+    uint32_t bytes_sent = 0;
+    for (const auto& connection : m_p2p.get_all_connections()) {
+        if (connection.status != ConnectionStatus::Connected) continue;
+
+        auto congestion = m_p2p.get_congestion_stats(connection.peer_id);
+        if (!congestion) {
+            bytes_sent += send(connection.peer_id);
+            continue;
+        }
+
+        // Credit accrues at the peer's share of the rate; banking at most
+        // one snapshot's worth, so a quiet spell doesn't become a burst
+        PeerState& state = m_peers[connection.peer_id];
+        if (state.credit_updated != std::chrono::steady_clock::time_point{}) {
+            double elapsed = std::chrono::duration<double>(now - state.credit_updated).count();
+            state.send_credit += elapsed * congestion->rate_bytes_per_second * CONGESTION_SHARE;
+            state.send_credit = std::min<double>(state.send_credit, state.last_send_bytes);
+        }
+        state.credit_updated = now;
+        if (state.send_credit < 0.0) {
+            m_stats.snapshots_deferred++;
+            continue;
+        }
+
+        uint32_t bytes = send(connection.peer_id);
+        state.send_credit -= bytes;
+        state.last_send_bytes = bytes;
+        bytes_sent += bytes;
+    }
+    return bytes_sent;
+}
+
+void SnapshotReplicator::write_record(const Entity* current, const uint8_t* current_data,
+                                      const Entity* baseline, const uint8_t* baseline_data) {
+    auto begin = [this](uint16_t id, uint8_t op) {
+        size_t offset = m_records.size();
+        m_records.resize(offset + RECORD_HEADER_SIZE);
+        wire::write_u16(m_records.data() + offset, id);
+        m_records[offset + 2] = op;
+    };
+
+    if (!current) {
+        begin(baseline->id, OP_REMOVED);
+        m_record_ends.push_back(static_cast<uint32_t>(m_records.size()));
+        return;
+    }
+
+    uint32_t size = m_type_sizes[current->type];
+    const uint8_t* state = current_data + current->offset;
+
+    if (baseline && baseline->type == current->type) {
+        const uint8_t* old_state = baseline_data + baseline->offset;
+        if (std::memcmp(state, old_state, size) == 0) return;
+
+        // Mask of changed words, then the words themselves
+        uint32_t words = word_count(size);
+        uint32_t mask_bytes = mask_size(size);
+        size_t start = m_records.size();
+        begin(current->id, OP_DELTA);
+        m_records.resize(m_records.size() + mask_bytes, 0);
+        size_t mask_offset = start + RECORD_HEADER_SIZE;
+
+        for (uint32_t word = 0; word < words; word++) {
+            uint32_t offset = word * WORD_SIZE;
+            uint32_t length = word_length(size, word);
+            if (std::memcmp(state + offset, old_state + offset, length) == 0) continue;
+
+            m_records[mask_offset + word / 8] |= static_cast<uint8_t>(1u << (word % 8));
+            m_records.insert(m_records.end(), state + offset, state + offset + length);
+        }
+
+        // Mostly changed: the full state is no bigger
+        if (m_records.size() - start < RECORD_HEADER_SIZE + 1 + size) {
+            m_record_ends.push_back(static_cast<uint32_t>(m_records.size()));
+            return;
+        }
+        m_records.resize(start);
+    }
+
+    begin(current->id, OP_FULL);
+    m_records.push_back(current->type);
+    m_records.insert(m_records.end(), state, state + size);
+    m_record_ends.push_back(static_cast<uint32_t>(m_records.size()));
+}
+
+bool SnapshotReplicator::send_parts(EOS_ProductUserId peer, uint32_t baseline_tick, uint32_t& bytes_sent) {
+    // Records never span parts; send_packet() adds its one-byte frame header
+    uint32_t capacity = m_p2p.get_config().max_packet_size - 1 - SNAPSHOT_HEADER_SIZE;
+
+    // Greedy split: index of the first record of each part
+    std::vector<uint32_t> part_starts(1, 0);
+    uint32_t part_begin = 0;
+    for (uint32_t r = 0; r < m_record_ends.size(); r++) {
+        uint32_t record_begin = r > 0 ? m_record_ends[r - 1] : 0;
+        if (m_record_ends[r] - part_begin > capacity && record_begin > part_begin) {
+            part_starts.push_back(r);
+            part_begin = record_begin;
+        }
+    }
+
+    if (part_starts.size() > MAX_PARTS) {
+        std::cout << "[P2P] Error: Snapshot too large (" << m_records.size() << " bytes of changes)\n";
+        return false;
+    }
+
+    uint32_t parts = static_cast<uint32_t>(part_starts.size());
+    for (uint32_t part = 0; part < parts; part++) {
+        uint32_t first = part_starts[part];
+        uint32_t last = part + 1 < parts ? part_starts[part + 1] : static_cast<uint32_t>(m_record_ends.size());
+        uint32_t begin = first > 0 ? m_record_ends[first - 1] : 0;
+        uint32_t end = last > 0 ? m_record_ends[last - 1] : 0;
+
+        m_packet.resize(SNAPSHOT_HEADER_SIZE + (end - begin));
+        m_packet[0] = KIND_SNAPSHOT;
+        wire::write_u32(m_packet.data() + 1, m_tick);
+        wire::write_u32(m_packet.data() + 5, baseline_tick);
+        m_packet[9] = static_cast<uint8_t>(part);
+        m_packet[10] = static_cast<uint8_t>(parts);
+        wire::write_u16(m_packet.data() + 11, static_cast<uint16_t>(last - first));
+        if (end > begin) {
+            std::memcpy(m_packet.data() + SNAPSHOT_HEADER_SIZE, m_records.data() + begin, end - begin);
+        }
+
+        if (!m_p2p.send_packet(peer, m_packet.data(), static_cast<uint32_t>(m_packet.size()), m_channel,
+                               PacketReliability::UnreliableUnordered)) {
+            return false;
+        }
+        m_stats.packets_sent++;
+        m_stats.bytes_sent += m_packet.size();
+        bytes_sent += static_cast<uint32_t>(m_packet.size());
+    }
+
+    return true;
+}
+
+bool SnapshotReplicator::handle_packet(const PacketView& packet) {
+    if (packet.channel != m_channel) return false;
+    if (packet.size == 0) return true;
+
+    if (packet.data[0] == KIND_SNAPSHOT) {
+        handle_snapshot(packet.sender, packet.data, packet.size);
+    } else if (packet.data[0] == KIND_ACK) {
+        handle_ack(packet.sender, packet.data, packet.size);
+    } else {
+        m_stats.packets_rejected++;
+    }
+    return true;
+}
+
+void SnapshotReplicator::handle_snapshot(EOS_ProductUserId peer, const uint8_t* data, uint32_t size) {
+    if (size < SNAPSHOT_HEADER_SIZE) {
+        m_stats.packets_rejected++;
+        return;
+    }
+
+    uint32_t tick = wire::read_u32(data + 1);
+    uint32_t baseline_tick = wire::read_u32(data + 5);
+    uint32_t part = data[9];
+    uint32_t parts = data[10];
+    uint32_t count = wire::read_u16(data + 11);
+    if (tick == NO_TICK || part >= parts) {
+        m_stats.packets_rejected++;
+        return;
+    }
+
+    PeerState& state = m_peers[peer];
+    if (tick <= state.latest_tick || (state.pending.tick != NO_TICK && tick < state.pending.tick)) {
+        // Our ack for the latest one may have been lost
+        if (tick == state.latest_tick) send_ack(peer, tick);
+        else m_stats.packets_rejected++;
+        return;
+    }
+
+    if (state.pending.tick != tick) {
+        // First part of a newer tick: start from its baseline
+        const Snapshot* baseline = nullptr;
+        if (baseline_tick != NO_TICK) {
+            baseline = &state.history[baseline_tick % HISTORY];
+            if (baseline->tick != baseline_tick) {
+                m_stats.packets_rejected++;
+                return;
+            }
+        }
+
+        state.pending.tick = tick;
+        state.pending.entities.clear();
+        state.pending.data.clear();
+        if (baseline) {
+            state.pending.entities = baseline->entities;
+            state.pending.data = baseline->data;
+        }
+        state.pending_baseline = baseline_tick;
+        state.pending_parts.assign(parts, false);
+        state.pending_missing = parts;
+    }
+
+    if (baseline_tick != state.pending_baseline || parts != state.pending_parts.size()) {
+        m_stats.packets_rejected++;
+        return;
+    }
+    if (state.pending_parts[part]) return;
+
+    if (!apply_records(state.pending, data + SNAPSHOT_HEADER_SIZE, size - SNAPSHOT_HEADER_SIZE, count)) {
+        m_stats.packets_rejected++;
+        state.pending.tick = NO_TICK;
+        return;
+    }
+    state.pending_parts[part] = true;
+    if (--state.pending_missing > 0) return;
+
+    compact(state.pending, state.history[tick % HISTORY], m_type_sizes);
+    state.latest_tick = tick;
+    state.pending.tick = NO_TICK;
+    m_stats.snapshots_received++;
+    send_ack(peer, tick);
+
+    if (on_snapshot) on_snapshot(peer, tick);
+}
+
+bool SnapshotReplicator::apply_records(Snapshot& snapshot, const uint8_t* data, uint32_t size, uint32_t count) {
+    uint32_t offset = 0;
+    for (uint32_t r = 0; r < count; r++) {
+        if (size - offset < RECORD_HEADER_SIZE) return false;
+        uint16_t id = wire::read_u16(data + offset);
+        uint8_t op = data[offset + 2];
+        offset += RECORD_HEADER_SIZE;
+
+        Entity* entity = snapshot.find(id);
+        if (op == OP_REMOVED) {
+            if (entity) snapshot.entities.erase(snapshot.entities.begin() + (entity - snapshot.entities.data()));
+        } else if (op == OP_FULL) {
+            if (size - offset < 1) return false;
+            uint8_t type = data[offset++];
+            if (type >= m_type_sizes.size()) return false;
+            uint32_t type_size = m_type_sizes[type];
+            if (size - offset < type_size) return false;
+
+            if (!entity) {
+                Entity added;
+                added.id = id;
+                auto it = std::lower_bound(snapshot.entities.begin(), snapshot.entities.end(), id,
+                                           [](const Entity& e, uint16_t key) { return e.id < key; });
+                entity = &*snapshot.entities.insert(it, added);
+                entity->offset = static_cast<uint32_t>(snapshot.data.size());
+                snapshot.data.resize(snapshot.data.size() + type_size);
+            } else if (m_type_sizes[entity->type] != type_size) {
+                entity->offset = static_cast<uint32_t>(snapshot.data.size());
+                snapshot.data.resize(snapshot.data.size() + type_size);
+            }
+            entity->type = type;
+            std::memcpy(snapshot.data.data() + entity->offset, data + offset, type_size);
+            offset += type_size;
+        } else if (op == OP_DELTA) {
+            if (!entity) return false;
+            uint32_t type_size = m_type_sizes[entity->type];
+            uint32_t mask_bytes = mask_size(type_size);
+            if (size - offset < mask_bytes) return false;
+            const uint8_t* mask = data + offset;
+            offset += mask_bytes;
+
+            for (uint32_t word = 0; word < word_count(type_size); word++) {
+                if (!(mask[word / 8] & (1u << (word % 8)))) continue;
+                uint32_t length = word_length(type_size, word);
+                if (size - offset < length) return false;
+                std::memcpy(snapshot.data.data() + entity->offset + word * WORD_SIZE, data + offset, length);
+                offset += length;
+            }
+        } else {
+            return false;
+        }
+    }
+    return offset == size;
+}
+
+void SnapshotReplicator::handle_ack(EOS_ProductUserId peer, const uint8_t* data, uint32_t size) {
+    if (size < ACK_SIZE) {
+        m_stats.packets_rejected++;
+        return;
+    }
+
+    uint32_t tick = wire::read_u32(data + 1);
+    m_stats.acks_received++;
+
+    // Only ticks we still hold can serve as a baseline
+    PeerState& state = m_peers[peer];
+    const Snapshot* sent = m_interest ? state.views : m_history;
+    if (tick > state.acked_tick && tick <= m_tick && sent[tick % HISTORY].tick == tick) {
+        state.acked_tick = tick;
+    }
+}
+
+void SnapshotReplicator::send_ack(EOS_ProductUserId peer, uint32_t tick) {
+    uint8_t ack[ACK_SIZE];
+    ack[0] = KIND_ACK;
+    wire::write_u32(ack + 1, tick);
+    m_p2p.send_packet(peer, ack, ACK_SIZE, m_channel, PacketReliability::UnreliableUnordered);
+}
+
+uint32_t SnapshotReplicator::get_latest_tick(EOS_ProductUserId peer) const {
+    auto it = m_peers.find(peer);
+    return it != m_peers.end() ? it->second.latest_tick : NO_TICK;
+}
+
+bool SnapshotReplicator::get_entity(EOS_ProductUserId peer, uint16_t id, void* out, uint32_t size) const {
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end() || it->second.latest_tick == NO_TICK) return false;
+
+    const Snapshot& snapshot = it->second.history[it->second.latest_tick % HISTORY];
+    const Entity* entity = snapshot.find(id);
+    if (!entity || m_type_sizes[entity->type] != size) return false;
+
+    std::memcpy(out, snapshot.data.data() + entity->offset, size);
+    return true;
+}
+
+std::vector<uint16_t> SnapshotReplicator::get_entity_ids(EOS_ProductUserId peer) const {
+    std::vector<uint16_t> ids;
+    auto it = m_peers.find(peer);
+    if (it == m_peers.end() || it->second.latest_tick == NO_TICK) return ids;
+
+    const Snapshot& snapshot = it->second.history[it->second.latest_tick % HISTORY];
+    ids.reserve(snapshot.entities.size());
+    for (const auto& entity : snapshot.entities) ids.push_back(entity.id);
+    return ids;
+}
+
+void SnapshotReplicator::remove_peer(EOS_ProductUserId peer) {
+    m_peers.erase(peer);
+}
+
+} // namespace eos_testing
@@ -0,0 +1,57 @@
+/**
+ * EOS Testing - Stub Transport Implementation
+ */
+
+#include "stub_transport.hpp"
+#include "eos_testing/core/platform.hpp"
+#include "eos_testing/auth/auth_manager.hpp"
+#include <cstring>
+
+namespace eos_testing {
+
+StubTransport::StubTransport(bool echo, uint32_t capacity, uint32_t max_packet_size)
+    : m_echo(echo) {
+    if (m_echo) {
+        m_pool.reset(max_packet_size, capacity);
+        m_echoed.reset(capacity);
+    }
+}
+
+EOS_ProductUserId StubTransport::local_user_id() const {
+    return AuthManager::instance().get_product_user_id();
+}
+
+bool StubTransport::send(EOS_ProductUserId peer_id,
+                         uint8_t channel,
+                         const uint8_t* data,
+                         uint32_t size,
+                         PacketReliability reliability,
+                         uint8_t socket) {
+    // Otherwise just pretend we sent it
+    if (!m_echo) return true;
+    
+    Packet packet;
+    packet.sender = peer_id;
+    packet.socket = socket;
+    packet.channel = channel;
+    packet.data = m_pool.acquire(size);
+    std::memcpy(packet.data.data(), data, size);
+    return m_echoed.try_push(std::move(packet));
+}
+
+bool StubTransport::receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) {
+    Packet packet;
+    while (m_echoed.try_pop(packet)) {
+        if (packet.data.size() > capacity) continue;
+        
+        info.sender = packet.sender;
+        info.socket = packet.socket;
+        info.channel = packet.channel;
+        info.size = packet.data.size();
+        std::memcpy(buffer, packet.data.data(), packet.data.size());
+        return true;
+    }
+    return false;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * EOS Testing - Stub Transport (internal)
+ *
+ * Default transport when built without the EOS SDK. Pretends every send
+ * succeeded; with echo enabled (P2PConfig::stub_loopback) each packet is
+ * instead delivered back as if the destination peer had sent it.
+ */
+
+#include "eos_testing/p2p/transport.hpp"
+#include "eos_testing/p2p/packet_pool.hpp"
+#include "eos_testing/p2p/ring_queue.hpp"
+
+namespace eos_testing {
+
+class StubTransport : public Transport {
+public:
+    /**
+     * @param echo Deliver sent packets back to ourselves
+     * @param capacity Echoed packets that can be waiting
+     * @param max_packet_size Largest packet to echo
+     */
+    StubTransport(bool echo, uint32_t capacity, uint32_t max_packet_size);
+
+    EOS_ProductUserId local_user_id() const override;
+
+    bool send(EOS_ProductUserId peer_id,
+              uint8_t channel,
+              const uint8_t* data,
+              uint32_t size,
+              PacketReliability reliability,
+              uint8_t socket = 0) override;
+    bool receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) override;
+
+private:
+    struct Packet {
+        EOS_ProductUserId sender = nullptr;
+        uint8_t socket = 0;
+        uint8_t channel = 0;
+        PacketBuffer data;
+    };
+
+    bool m_echo;
+
+    // Declared before the queue so it outlives the queued buffers
+    PacketPool m_pool;
+    RingQueue<Packet> m_echoed;
+};
+
+} // namespace eos_testing
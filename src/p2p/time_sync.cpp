@@ -0,0 +1,97 @@
+/**
+ * EOS Testing - Clock Synchronization Implementation
+ */
+
+#include "eos_testing/p2p/time_sync.hpp"
+#include <algorithm>
+
+namespace eos_testing {
+
+void TimeSync::reset() {
+    m_samples = 0;
+    m_steps = 0;
+    m_target = 0;
+    m_slew_from = 0;
+    m_slew_start_us = 0;
+    m_best_rtt_us = 0;
+    m_spread_us = 0;
+    m_last_server_time = 0;
+}
+
+void TimeSync::add_sample(uint64_t request_sent_us, uint64_t server_time_us, uint64_t reply_received_us) {
+    if (reply_received_us < request_sent_us) return;
+
+    // t2 = t3: the server replies as it reads the request
+    Sample sample;
+    sample.rtt_us = static_cast<uint32_t>(std::min<uint64_t>(reply_received_us - request_sent_us, UINT32_MAX));
+    sample.offset_us = static_cast<int64_t>(server_time_us) -
+                       static_cast<int64_t>(request_sent_us + (reply_received_us - request_sent_us) / 2);
+    m_window[m_samples % WINDOW] = sample;
+    m_samples++;
+
+    // Average the quarter of the window with the shortest round trips,
+    // newest first on ties so drift is followed
+    uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(m_samples, WINDOW));
+    Sample sorted[WINDOW];
+    for (uint32_t i = 0; i < count; i++) sorted[i] = m_window[(m_samples - 1 - i) % WINDOW];
+    std::stable_sort(sorted, sorted + count, [](const Sample& a, const Sample& b) { return a.rtt_us < b.rtt_us; });
+
+    uint32_t used = std::max<uint32_t>(count / 4, 1);
+    int64_t sum = 0;
+    int64_t lowest = sorted[0].offset_us;
+    int64_t highest = sorted[0].offset_us;
+    for (uint32_t i = 0; i < used; i++) {
+        sum += sorted[i].offset_us;
+        lowest = std::min(lowest, sorted[i].offset_us);
+        highest = std::max(highest, sorted[i].offset_us);
+    }
+    m_best_rtt_us = sorted[0].rtt_us;
+    m_spread_us = static_cast<uint32_t>(highest - lowest);
+
+    // Restart the slew from wherever it has got to
+    int64_t current = applied_offset(reply_received_us);
+    m_slew_from = current;
+    m_slew_start_us = reply_received_us;
+    m_target = sum / static_cast<int64_t>(used);
+
+    // Step while the first samples come in: server time isn't meaningful
+    // yet, so it may also go back
+    bool settling = m_samples <= m_settings.min_samples;
+    int64_t error = m_target - current;
+    if (settling || error > m_settings.step_threshold_us || -error > m_settings.step_threshold_us) {
+        m_slew_from = m_target;
+        m_steps++;
+        if (settling) m_last_server_time = 0;
+    }
+}
+
+int64_t TimeSync::applied_offset(uint64_t local_us) const {
+    if (local_us <= m_slew_start_us) return m_slew_from;
+
+    int64_t limit = static_cast<int64_t>(static_cast<double>(local_us - m_slew_start_us) * m_settings.max_slew);
+    int64_t change = std::min(std::max(m_target - m_slew_from, -limit), limit);
+    return m_slew_from + change;
+}
+
+uint64_t TimeSync::server_time(uint64_t local_us) {
+    int64_t time = static_cast<int64_t>(local_us) + applied_offset(local_us);
+    uint64_t server = time > 0 ? static_cast<uint64_t>(time) : 0;
+
+    // A backward step holds the clock still until it catches up
+    m_last_server_time = std::max(m_last_server_time, server);
+    return m_last_server_time;
+}
+
+TimeSyncStats TimeSync::get_stats(uint64_t local_us) const {
+    TimeSyncStats stats;
+    stats.synchronized = is_synchronized();
+    stats.offset_us = applied_offset(local_us);
+    stats.target_offset_us = m_target;
+    stats.best_rtt_us = m_best_rtt_us;
+    stats.spread_us = m_spread_us;
+    stats.samples = m_samples;
+    stats.steps = m_steps;
+    return stats;
+}
+
+} // namespace eos_testing
@@ -0,0 +1,341 @@
+/**
+ * EOS Testing - Local UDP Transport Implementation
+ */
+
+#include "eos_testing/p2p/udp_transport.hpp"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace eos_testing {
+
+namespace {
+
+// Synthetic user ids: tag in the high bits, port in the low 16
+constexpr uintptr_t PEER_ID_TAG = 0x7F000000u;
+
+// Receive slots hold one spare byte so oversize datagrams show up as
+// too long rather than silently truncated
+constexpr uint32_t DATAGRAM_HEADER_SIZE = 2;
+constexpr uint32_t DATAGRAM_SLACK = 1;
+
+constexpr int SOCKET_BUFFER_SIZE = 1 << 20;
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr intptr_t NO_SOCKET = -1;
+
+bool would_block() {
+    int error = WSAGetLastError();
+    // WSAECONNRESET: ICMP port unreachable from an earlier send; not fatal for UDP
+    return error == WSAEWOULDBLOCK || error == WSAECONNRESET;
+}
+
+void close_socket(intptr_t socket) { closesocket(static_cast<SOCKET>(socket)); }
+#else
+using SocketHandle = int;
+constexpr intptr_t NO_SOCKET = -1;
+
+bool would_block() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+void close_socket(intptr_t socket) { ::close(static_cast<int>(socket)); }
+#endif
+
+sockaddr_in loopback_address(uint16_t port) {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+} // namespace
+
+struct UdpTransport::Batch {
+    Batch(uint32_t capacity, uint32_t slot_size)
+        : capacity(capacity)
+        , slot_size(slot_size)
+        , data(static_cast<size_t>(capacity) * slot_size)
+        , sizes(capacity)
+        , addresses(capacity) {
+#ifdef __linux__
+        iovecs.resize(capacity);
+        headers.resize(capacity);
+        for (uint32_t i = 0; i < capacity; i++) {
+            iovecs[i].iov_base = slot(i);
+            headers[i].msg_hdr.msg_iov = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+            headers[i].msg_hdr.msg_name = &addresses[i];
+        }
+#endif
+    }
+
+    uint8_t* slot(uint32_t index) { return data.data() + static_cast<size_t>(index) * slot_size; }
+
+    uint32_t capacity;
+    uint32_t slot_size;
+    uint32_t count = 0;     // Filled slots
+    uint32_t next = 0;      // Receive: next slot to hand out
+
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> sizes;
+    std::vector<sockaddr_in> addresses;
+#ifdef __linux__
+    std::vector<iovec> iovecs;
+    std::vector<mmsghdr> headers;
+#endif
+};
+
+UdpTransport::UdpTransport(uint16_t local_port, uint32_t max_packet_size, uint32_t batch_size)
+    : m_local_port(local_port)
+    , m_max_packet_size(max_packet_size)
+    , m_batch_size(batch_size > 0 ? batch_size : 1) {
+}
+
+UdpTransport::~UdpTransport() {
+    close();
+}
+
+EOS_ProductUserId UdpTransport::peer_id_for_port(uint16_t port) {
+    return reinterpret_cast<EOS_ProductUserId>(PEER_ID_TAG | port);
+}
+
+uint16_t UdpTransport::port_for_peer_id(EOS_ProductUserId peer_id) {
+    uintptr_t value = reinterpret_cast<uintptr_t>(peer_id);
+    if ((value & ~static_cast<uintptr_t>(0xFFFF)) != PEER_ID_TAG) return 0;
+    return static_cast<uint16_t>(value & 0xFFFF);
+}
+
+bool UdpTransport::open() {
+    if (m_socket != NO_SOCKET) return true;
+
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        std::cout << "[P2P] Error: WSAStartup failed\n";
+        return false;
+    }
+#endif
+
+    SocketHandle handle = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    if (handle == INVALID_SOCKET) {
+        WSACleanup();
+#else
+    if (handle < 0) {
+#endif
+        std::cout << "[P2P] Error: Failed to create UDP socket\n";
+        return false;
+    }
+    m_socket = static_cast<intptr_t>(handle);
+
+    // Bursts of a few hundred packets shouldn't overflow the default buffers
+    int buffer_size = SOCKET_BUFFER_SIZE;
+    setsockopt(handle, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&buffer_size), sizeof(buffer_size));
+    setsockopt(handle, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&buffer_size), sizeof(buffer_size));
+
+    sockaddr_in address = loopback_address(m_local_port);
+    if (::bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cout << "[P2P] Error: Failed to bind UDP port " << m_local_port << "\n";
+        close();
+        return false;
+    }
+
+    socklen_t address_size = sizeof(address);
+    getsockname(handle, reinterpret_cast<sockaddr*>(&address), &address_size);
+    m_local_port = ntohs(address.sin_port);
+
+#ifdef _WIN32
+    u_long non_blocking = 1;
+    ioctlsocket(handle, FIONBIO, &non_blocking);
+#else
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    uint32_t slot_size = DATAGRAM_HEADER_SIZE + m_max_packet_size + DATAGRAM_SLACK;
+    m_send_batch = std::make_unique<Batch>(m_batch_size, slot_size);
+    m_receive_batch = std::make_unique<Batch>(m_batch_size, slot_size);
+
+    std::cout << "[P2P] UDP transport bound to 127.0.0.1:" << m_local_port << "\n";
+    return true;
+}
+
+void UdpTransport::close() {
+    if (m_socket == NO_SOCKET) return;
+
+    flush();
+    close_socket(m_socket);
+    m_socket = NO_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool UdpTransport::send(EOS_ProductUserId peer_id,
+                        uint8_t channel,
+                        const uint8_t* data,
+                        uint32_t size,
+                        PacketReliability reliability,
+                        uint8_t socket) {
+    uint16_t port = port_for_peer_id(peer_id);
+    if (m_socket == NO_SOCKET || port == 0 || size > m_max_packet_size) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+
+    Batch& batch = *m_send_batch;
+    if (batch.count == batch.capacity) {
+        flush_locked();
+    }
+
+    uint32_t index = batch.count++;
+    uint8_t* slot = batch.slot(index);
+    slot[0] = socket;
+    slot[1] = channel;
+    std::memcpy(slot + DATAGRAM_HEADER_SIZE, data, size);
+    batch.sizes[index] = DATAGRAM_HEADER_SIZE + size;
+    batch.addresses[index] = loopback_address(port);
+    return true;
+}
+
+void UdpTransport::flush() {
+    std::lock_guard<std::mutex> lock(m_send_mutex);
+    if (m_send_batch) flush_locked();
+}
+
+void UdpTransport::flush_locked() {
+    Batch& batch = *m_send_batch;
+    if (batch.count == 0 || m_socket == NO_SOCKET) {
+        batch.count = 0;
+        return;
+    }
+
+    SocketHandle handle = static_cast<SocketHandle>(m_socket);
+
+#ifdef __linux__
+    for (uint32_t i = 0; i < batch.count; i++) {
+        batch.iovecs[i].iov_len = batch.sizes[i];
+        batch.headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    }
+
+    uint32_t sent = 0;
+    while (sent < batch.count) {
+        m_send_calls.fetch_add(1, std::memory_order_relaxed);
+        int result = sendmmsg(handle, &batch.headers[sent], batch.count - sent, 0);
+        if (result > 0) {
+            sent += static_cast<uint32_t>(result);
+        } else if (result < 0 && errno == EINTR) {
+            continue;
+        } else if (result < 0 && (would_block() || errno == ENOBUFS)) {
+            // Socket buffer full: drop the rest, as a congested link would
+            m_dropped.fetch_add(batch.count - sent, std::memory_order_relaxed);
+            break;
+        } else {
+            // The first message failed on its own; skip it and carry on
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            sent++;
+        }
+    }
+#else
+    for (uint32_t i = 0; i < batch.count; i++) {
+        m_send_calls.fetch_add(1, std::memory_order_relaxed);
+        auto result = ::sendto(handle, reinterpret_cast<const char*>(batch.slot(i)), static_cast<int>(batch.sizes[i]), 0,
+                               reinterpret_cast<const sockaddr*>(&batch.addresses[i]), sizeof(sockaddr_in));
+        if (result < 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+#endif
+
+    batch.count = 0;
+}
+
+bool UdpTransport::receive(TransportPacketInfo& info, uint8_t* buffer, uint32_t capacity) {
+    if (m_socket == NO_SOCKET) return false;
+
+    Batch& batch = *m_receive_batch;
+    SocketHandle handle = static_cast<SocketHandle>(m_socket);
+
+    for (;;) {
+        // Refill from the socket once everything buffered has been handed out
+        if (batch.next == batch.count) {
+            batch.next = 0;
+            batch.count = 0;
+
+#ifdef __linux__
+            for (uint32_t i = 0; i < batch.capacity; i++) {
+                batch.iovecs[i].iov_len = batch.slot_size;
+                batch.headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                batch.headers[i].msg_hdr.msg_flags = 0;
+            }
+
+            m_receive_calls.fetch_add(1, std::memory_order_relaxed);
+            int result = recvmmsg(handle, batch.headers.data(), batch.capacity, MSG_DONTWAIT, nullptr);
+            if (result <= 0) return false;
+
+            batch.count = static_cast<uint32_t>(result);
+            for (uint32_t i = 0; i < batch.count; i++) {
+                batch.sizes[i] = batch.headers[i].msg_len;
+            }
+#else
+            while (batch.count < batch.capacity) {
+                sockaddr_in& address = batch.addresses[batch.count];
+                socklen_t address_size = sizeof(address);
+
+                m_receive_calls.fetch_add(1, std::memory_order_relaxed);
+                auto result = ::recvfrom(handle, reinterpret_cast<char*>(batch.slot(batch.count)), static_cast<int>(batch.slot_size), 0,
+                                         reinterpret_cast<sockaddr*>(&address), &address_size);
+                if (result < 0) {
+                    if (would_block()) break;
+                    // Oversize (WSAEMSGSIZE) or otherwise unreadable datagram
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                batch.sizes[batch.count++] = static_cast<uint32_t>(result);
+            }
+            if (batch.count == 0) return false;
+#endif
+        }
+
+        uint32_t index = batch.next++;
+        uint32_t datagram_size = batch.sizes[index];
+        if (datagram_size < DATAGRAM_HEADER_SIZE) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        uint32_t payload_size = datagram_size - DATAGRAM_HEADER_SIZE;
+        if (payload_size > m_max_packet_size || payload_size > capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        const uint8_t* slot = batch.slot(index);
+        info.sender = peer_id_for_port(ntohs(batch.addresses[index].sin_port));
+        info.socket = slot[0];
+        info.channel = slot[1];
+        info.size = payload_size;
+        std::memcpy(buffer, slot + DATAGRAM_HEADER_SIZE, payload_size);
+        return true;
+    }
+}
+
+} // namespace eos_testing
@@ -0,0 +1,118 @@
+#pragma once
+
+/**
+ * EOS Testing - P2P Wire Format (internal)
+ *
+ * Every packet P2PManager puts on the wire starts with a one-byte
+ * frame type so the receiver knows how to unpack it:
+ *
+ *   Data      [type][payload]                    one user message
+ *   Batch     [type]([u16 length][payload])...   coalesced user messages
+ *   Fragment  [type][u16 message id][u16 index][u16 count][u32 total size][payload]
+ *             one piece of a large reliable message
+ *   Ping      [type][u16 sequence][u32 sender timestamp us]
+ *   Pong      [type][u16 sequence][u32 echoed timestamp us]
+ *             link quality probes, never delivered to the game
+ *   Reliable  [type][u16 sequence][u16 ack][u32 ack bits][u16 order][u8 flags][frame]
+ *             a Data/Batch/Fragment frame sent through P2PManager's own
+ *             reliability protocol, with the sender's acks piggybacked
+ *   Ack       [type][u16 ack][u32 ack bits]
+ *             acks with no reliable traffic to ride on
+ *   Compressed [type][u8 mode][u8 dictionary tag][u16 original size][lz data]
+ *             a Data/Batch/Fragment frame compressed per the channel's
+ *             setting; the tag is the low byte of the dictionary id
+ *   TimeRequest  [type][u64 requester time us]
+ *   TimeResponse [type][u64 echoed requester time us][u64 server time us]
+ *             clock synchronization exchanges, never delivered to the game
+ *
+ * Multi-byte fields are little-endian.
+ */
+
+#include <cstdint>
+
+namespace eos_testing {
+namespace wire {
+
+enum class FrameType : uint8_t {
+    Data = 0,
+    Batch = 1,
+    Fragment = 2,
+    Ping = 3,
+    Pong = 4,
+    Reliable = 5,
+    Ack = 6,
+    Compressed = 7,
+    TimeRequest = 8,
+    TimeResponse = 9,
+};
+
+constexpr uint32_t FRAME_HEADER_SIZE = 1;
+constexpr uint32_t BATCH_LENGTH_SIZE = 2;
+constexpr uint32_t FRAGMENT_HEADER_SIZE = FRAME_HEADER_SIZE + 2 + 2 + 2 + 4;
+constexpr uint32_t MAX_FRAGMENT_COUNT = 0xFFFF;
+constexpr uint32_t PING_FRAME_SIZE = FRAME_HEADER_SIZE + 2 + 4;
+constexpr uint32_t RELIABLE_HEADER_SIZE = FRAME_HEADER_SIZE + 2 + 2 + 4 + 2 + 1;
+constexpr uint32_t ACK_FRAME_SIZE = FRAME_HEADER_SIZE + 2 + 4;
+constexpr uint32_t COMPRESSED_HEADER_SIZE = FRAME_HEADER_SIZE + 1 + 1 + 2;
+constexpr uint32_t TIME_REQUEST_SIZE = FRAME_HEADER_SIZE + 8;
+constexpr uint32_t TIME_RESPONSE_SIZE = FRAME_HEADER_SIZE + 8 + 8;
+
+// Reliable frame flags
+constexpr uint8_t RELIABLE_FLAG_ORDERED = 0x01;
+
+inline void write_u16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline uint16_t read_u16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline void write_u32(uint8_t* out, uint32_t value) {
+    write_u16(out, static_cast<uint16_t>(value));
+    write_u16(out + 2, static_cast<uint16_t>(value >> 16));
+}
+
+inline uint32_t read_u32(const uint8_t* in) {
+    return static_cast<uint32_t>(read_u16(in)) | (static_cast<uint32_t>(read_u16(in + 2)) << 16);
+}
+
+inline void write_u64(uint8_t* out, uint64_t value) {
+    write_u32(out, static_cast<uint32_t>(value));
+    write_u32(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+inline uint64_t read_u64(const uint8_t* in) {
+    return static_cast<uint64_t>(read_u32(in)) | (static_cast<uint64_t>(read_u32(in + 4)) << 32);
+}
+
+/**
+ * Fragment header fields, after the frame type byte
+ */
+struct FragmentHeader {
+    uint16_t message_id = 0;
+    uint16_t index = 0;
+    uint16_t count = 0;
+    uint32_t total_size = 0;
+};
+
+inline void write_fragment_header(uint8_t* out, const FragmentHeader& header) {
+    out[0] = static_cast<uint8_t>(FrameType::Fragment);
+    write_u16(out + 1, header.message_id);
+    write_u16(out + 3, header.index);
+    write_u16(out + 5, header.count);
+    write_u32(out + 7, header.total_size);
+}
+
+inline FragmentHeader read_fragment_header(const uint8_t* in) {
+    FragmentHeader header;
+    header.message_id = read_u16(in + 1);
+    header.index = read_u16(in + 3);
+    header.count = read_u16(in + 5);
+    header.total_size = read_u32(in + 7);
+    return header;
+}
+
+} // namespace wire
+} // namespace eos_testing
@@ -2,14 +2,25 @@
  * EOS Testing - Client Application
  * 
  * Searches for a lobby, joins it, and establishes P2P connection with host.
- * Responds to pings with pongs.
+ * Responds to pings with pongs and keeps its clock synchronized to the host.
+ * The host's demo object is rendered through a jitter buffer, smoothly
+ * and a little behind, whatever the timing of its packets.
  * 
- * Usage: eos_client.exe
+ * Usage: eos_client.exe [--udp <port> <host port>]
+ *
+ * --udp skips EOS login and lobbies and connects straight to an
+ * eos_host started with --udp <host port> (start the host first).
  */
 
 #include "eos_testing/eos_testing.hpp"
+#include "eos_testing/p2p/bit_stream.hpp"
+#include "eos_testing/p2p/jitter_buffer.hpp"
+#include "eos_testing/p2p/udp_transport.hpp"
 #include "../config/credentials.hpp"
 #include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
 #include <thread>
 #include <chrono>
 #include <atomic>
@@ -27,85 +38,134 @@ void signal_handler(int) {
 enum class PacketType : uint8_t {
     Ping = 1,
     Pong = 2,
-    Chat = 3
+    Chat = 3,
+    State = 4       // Demo object position, timestamped in server time
 };
 
 struct TestPacket {
-    PacketType type;
-    uint32_t sequence;
-    char message[256];
+    PacketType type = PacketType::Ping;
+    uint32_t sequence = 0;
+    char message[256] = {};
+    uint64_t timestamp_us = 0;
+    Vec3 position;
 };
 
-int main() {
+// Bit-packed on the wire: [type: 3 bits][sequence: varint][chat text or
+// timestamp + position], so a ping is 2-6 bytes rather than the whole struct
+uint32_t write_test_packet(const TestPacket& packet, uint8_t* out, uint32_t capacity) {
+    BitWriter writer(out, capacity);
+    writer.write_int(static_cast<int32_t>(packet.type), 0, 7);
+    writer.write_varint(packet.sequence);
+    if (packet.type == PacketType::Chat) {
+        writer.write_string(packet.message, sizeof(packet.message) - 1);
+    } else if (packet.type == PacketType::State) {
+        writer.write_bits(static_cast<uint32_t>(packet.timestamp_us), 32);
+        writer.write_bits(static_cast<uint32_t>(packet.timestamp_us >> 32), 32);
+        writer.write_vec3(packet.position, -512.0f, 512.0f, 18);
+    }
+    return writer.finish();
+}
+
+bool read_test_packet(const uint8_t* data, uint32_t size, TestPacket& packet) {
+    BitReader reader(data, size);
+    packet.type = static_cast<PacketType>(reader.read_int(0, 7));
+    packet.sequence = reader.read_varint();
+    packet.message[0] = '\0';
+    if (packet.type == PacketType::Chat) {
+        reader.read_string(packet.message, sizeof(packet.message));
+    } else if (packet.type == PacketType::State) {
+        packet.timestamp_us = reader.read_bits(32);
+        packet.timestamp_us |= static_cast<uint64_t>(reader.read_bits(32)) << 32;
+        packet.position = reader.read_vec3(-512.0f, 512.0f, 18);
+    }
+    return !reader.overflowed();
+}
+
+int main(int argc, char* argv[]) {
     std::signal(SIGINT, signal_handler);
     
+    // --udp <port> <host port>: localhost UDP instead of EOS, no credentials needed
+    uint16_t udp_port = 0;
+    uint16_t udp_host_port = 0;
+    for (int i = 1; i + 2 < argc; i++) {
+        if (std::strcmp(argv[i], "--udp") == 0) {
+            udp_port = static_cast<uint16_t>(std::atoi(argv[i + 1]));
+            udp_host_port = static_cast<uint16_t>(std::atoi(argv[i + 2]));
+        }
+    }
+    EOS_ProductUserId my_user_id = nullptr;
+    
     std::cout << "==============================================\n";
     std::cout << "        EOS P2P Test - CLIENT MODE\n";
     std::cout << "==============================================\n\n";
     
-    // Initialize platform
-    std::cout << "[CLIENT] Initializing EOS Platform...\n";
-    
-    PlatformConfig config;
-    config.product_name = config::PRODUCT_NAME;
-    config.product_version = config::PRODUCT_VERSION;
-    config.product_id = config::PRODUCT_ID;
-    config.sandbox_id = config::SANDBOX_ID;
-    config.deployment_id = config::DEPLOYMENT_ID;
-    config.client_id = config::CLIENT_ID;
-    config.client_secret = config::CLIENT_SECRET;
-    
-    bool init_done = false;
-    eos_testing::initialize(config, [&](bool success, const std::string& msg) {
-        if (success) {
-            std::cout << "[CLIENT] Platform initialized!\n";
-        } else {
-            std::cout << "[CLIENT] Platform init failed: " << msg << "\n";
-            g_running = false;
+    if (udp_port == 0) {
+        // Initialize platform
+        std::cout << "[CLIENT] Initializing EOS Platform...\n";
+        
+        PlatformConfig config;
+        config.product_name = config::PRODUCT_NAME;
+        config.product_version = config::PRODUCT_VERSION;
+        config.product_id = config::PRODUCT_ID;
+        config.sandbox_id = config::SANDBOX_ID;
+        config.deployment_id = config::DEPLOYMENT_ID;
+        config.client_id = config::CLIENT_ID;
+        config.client_secret = config::CLIENT_SECRET;
+        
+        bool init_done = false;
+        eos_testing::initialize(config, [&](bool success, const std::string& msg) {
+            if (success) {
+                std::cout << "[CLIENT] Platform initialized!\n";
+            } else {
+                std::cout << "[CLIENT] Platform init failed: " << msg << "\n";
+                g_running = false;
+            }
+            init_done = true;
+        });
+        
+        while (!init_done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
         }
-        init_done = true;
-    });
-    
-    while (!init_done) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-    }
-    
-    if (!Platform::instance().is_ready()) {
-        return 1;
-    }
-    
-    // Login with Device ID (different display name)
-    std::cout << "[CLIENT] Logging in...\n";
-    
-    bool login_done = false;
-    EOS_ProductUserId my_user_id = nullptr;
-    
-    // IMPORTANT: Delete existing device ID to create new identity (separate from host on same machine)
-    AuthManager::instance().login_device_id_with_model("Client", "ClientPC", true, [&](const AuthResult& result) {
-        if (result.success) {
-            std::cout << "[CLIENT] Logged in as '" << result.display_name << "'\n";
-            std::cout << "[CLIENT] User ID: " << result.product_user_id << "\n";
-            my_user_id = AuthManager::instance().get_product_user_id();
-        } else {
-            std::cout << "[CLIENT] Login failed: " << result.error_message << "\n";
-            g_running = false;
+        
+        if (!Platform::instance().is_ready()) {
+            return 1;
         }
-        login_done = true;
-    });
-    
-    while (!login_done && g_running) {
-        Platform::instance().tick();
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        
+        // Login with Device ID (different display name)
+        std::cout << "[CLIENT] Logging in...\n";
+        
+        bool login_done = false;
+        
+        // IMPORTANT: Delete existing device ID to create new identity (separate from host on same machine)
+        AuthManager::instance().login_device_id_with_model("Client", "ClientPC", true, [&](const AuthResult& result) {
+            if (result.success) {
+                std::cout << "[CLIENT] Logged in as '" << result.display_name << "'\n";
+                std::cout << "[CLIENT] User ID: " << result.product_user_id << "\n";
+                my_user_id = AuthManager::instance().get_product_user_id();
+            } else {
+                std::cout << "[CLIENT] Login failed: " << result.error_message << "\n";
+                g_running = false;
+            }
+            login_done = true;
+        });
+        
+        while (!login_done && g_running) {
+            Platform::instance().tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        }
+        
+        if (!g_running) return 1;
     }
     
-    if (!g_running) return 1;
-    
     // Initialize P2P
     std::cout << "[CLIENT] Initializing P2P...\n";
     
     P2PConfig p2p_config;
     p2p_config.socket_name = "P2PTestSocket";  // Must match host
     p2p_config.allow_relay = true;
+    if (udp_port != 0) {
+        p2p_config.transport = std::make_shared<UdpTransport>(udp_port);
+    }
     
     if (!P2PManager::instance().initialize(p2p_config)) {
         std::cout << "[CLIENT] P2P init failed!\n";
@@ -117,18 +177,27 @@ int main() {
     uint32_t pings_received = 0;
     uint32_t pongs_sent = 0;
     
+    // The host's demo object, played out at an adaptive delay
+    JitterBuffer<Vec3> object_buffer([](const Vec3& from, const Vec3& to, float t) { return lerp(from, to, t); });
+    
     // Set up P2P callbacks
     P2PManager::instance().on_connection_established = [&](EOS_ProductUserId peer, ConnectionStatus status) {
         if (status == ConnectionStatus::Connected) {
             std::cout << "[CLIENT] Connected to host via P2P!\n";
             connected_host = peer;
             
+            // Share the host's clock for timestamps
+            P2PManager::instance().sync_time_to(peer);
+            
             // Send initial chat message
             TestPacket chat;
             chat.type = PacketType::Chat;
             chat.sequence = 0;
             snprintf(chat.message, sizeof(chat.message), "Hello from client!");
-            P2PManager::instance().send_packet(peer, &chat, sizeof(chat), 0, PacketReliability::ReliableOrdered);
+            
+            uint8_t wire[sizeof(TestPacket) + 8];
+            uint32_t size = write_test_packet(chat, wire, sizeof(wire));
+            P2PManager::instance().send_packet(peer, wire, size, 0, PacketReliability::ReliableOrdered);
         }
     };
     
@@ -140,21 +209,27 @@ int main() {
     };
     
     P2PManager::instance().on_packet_received = [&](const IncomingPacket& packet) {
-        if (packet.data.size() >= sizeof(TestPacket)) {
-            TestPacket* pkt = (TestPacket*)packet.data.data();
-            
-            switch (pkt->type) {
+        TestPacket pkt;
+        if (read_test_packet(packet.data.data(), packet.data.size(), pkt)) {
+            switch (pkt.type) {
                 case PacketType::Ping: {
                     pings_received++;
-                    std::cout << "[CLIENT] Received PING #" << pkt->sequence << "\n";
+                    TimeSyncStats clock = P2PManager::instance().get_time_sync_stats();
+                    std::cout << "[CLIENT] Received PING #" << pkt.sequence << " at server time "
+                              << std::fixed << std::setprecision(6)
+                              << P2PManager::instance().get_server_time_us() / 1e6 << " s"
+                              << (clock.synchronized ? "" : " (not yet synchronized)")
+                              << ", offset " << std::setprecision(3) << clock.offset_us / 1000.0
+                              << " ms, best RTT " << clock.best_rtt_us / 1000.0 << " ms\n";
                     
                     // Send pong back
                     TestPacket pong;
                     pong.type = PacketType::Pong;
-                    pong.sequence = pkt->sequence;
-                    snprintf(pong.message, sizeof(pong.message), "Pong!");
+                    pong.sequence = pkt.sequence;
                     
-                    if (P2PManager::instance().send_packet(packet.sender, &pong, sizeof(pong), 
+                    uint8_t wire[sizeof(TestPacket) + 8];
+                    uint32_t size = write_test_packet(pong, wire, sizeof(wire));
+                    if (P2PManager::instance().send_packet(packet.sender, wire, size, 
                                                             0, PacketReliability::ReliableOrdered)) {
                         pongs_sent++;
                         std::cout << "[CLIENT] Sent PONG #" << pong.sequence << "\n";
@@ -163,8 +238,15 @@ int main() {
                 }
                     
                 case PacketType::Chat:
-                    std::cout << "[CLIENT] Host says: " << pkt->message << "\n";
+                    std::cout << "[CLIENT] Host says: " << pkt.message << "\n";
+                    break;
+                    
+                case PacketType::State: {
+                    JitterBuffer<Vec3>::Entity object;
+                    object.state = pkt.position;
+                    object_buffer.push(pkt.timestamp_us, P2PManager::instance().get_server_time_us(), &object, 1);
                     break;
+                }
                     
                 default:
                     break;
@@ -176,108 +258,130 @@ int main() {
     P2PManager::instance().accept_connections();
     std::cout << "[CLIENT] Accepting P2P connections...\n";
     
-    // Search for host's lobby
-    std::cout << "[CLIENT] Searching for lobbies...\n";
-    
-    bool search_done = false;
-    bool found_lobby = false;
-    std::string target_lobby_id;
-    EOS_ProductUserId host_user_id = nullptr;
-    
-    // Search with the same bucket_id as host
-    std::string bucket_id = "p2ptest:global";  // Must match host's bucket_id
-    std::unordered_map<std::string, std::string> filters;
-    // Empty filters = find all lobbies in bucket
-    
-    LobbyManager::instance().search_lobbies(bucket_id, 10, filters, [&](bool success, const std::vector<LobbySearchResult>& results) {
-        if (success && !results.empty()) {
-            std::cout << "[CLIENT] Found " << results.size() << " lobby(ies):\n";
-            for (const auto& lobby : results) {
-                std::cout << "  - " << lobby.lobby_name << " (" << lobby.current_members << "/" << lobby.max_members << ")\n";
+    if (udp_port == 0) {
+        // Search for host's lobby
+        std::cout << "[CLIENT] Searching for lobbies...\n";
+        
+        bool search_done = false;
+        bool found_lobby = false;
+        std::string target_lobby_id;
+        EOS_ProductUserId host_user_id = nullptr;
+        
+        // Search with the same bucket_id as host
+        std::string bucket_id = "p2ptest:global";  // Must match host's bucket_id
+        std::unordered_map<std::string, std::string> filters;
+        // Empty filters = find all lobbies in bucket
+        
+        LobbyManager::instance().search_lobbies(bucket_id, 10, filters, [&](bool success, const std::vector<LobbySearchResult>& results) {
+            if (success && !results.empty()) {
+                std::cout << "[CLIENT] Found " << results.size() << " lobby(ies):\n";
+                for (const auto& lobby : results) {
+                    std::cout << "  - " << lobby.lobby_name << " (" << lobby.current_members << "/" << lobby.max_members << ")\n";
+                }
+                
+                // Join the first one
+                target_lobby_id = results[0].lobby_id;
+                found_lobby = true;
+            } else {
+                std::cout << "[CLIENT] No lobbies found. Make sure host is running!\n";
+            }
+            search_done = true;
+        });
+        
+        // Wait for search with timeout
+        int search_attempts = 0;
+        while (!found_lobby && g_running && search_attempts < 30) {  // 30 second timeout
+            while (!search_done && g_running) {
+                Platform::instance().tick();
+                std::this_thread::sleep_for(std::chrono::milliseconds(16));
             }
             
-            // Join the first one
-            target_lobby_id = results[0].lobby_id;
-            found_lobby = true;
-        } else {
-            std::cout << "[CLIENT] No lobbies found. Make sure host is running!\n";
+            if (!found_lobby && g_running) {
+                std::cout << "[CLIENT] Retrying search...\n";
+                search_done = false;
+                search_attempts++;
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                
+                LobbyManager::instance().search_lobbies(bucket_id, 10, filters, [&](bool success, const std::vector<LobbySearchResult>& results) {
+                    if (success && !results.empty()) {
+                        target_lobby_id = results[0].lobby_id;
+                        found_lobby = true;
+                        std::cout << "[CLIENT] Found lobby: " << results[0].lobby_name << "\n";
+                    }
+                    search_done = true;
+                });
+            }
         }
-        search_done = true;
-    });
-    
-    // Wait for search with timeout
-    int search_attempts = 0;
-    while (!found_lobby && g_running && search_attempts < 30) {  // 30 second timeout
-        while (!search_done && g_running) {
-            Platform::instance().tick();
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        
+        if (!found_lobby) {
+            std::cout << "[CLIENT] Could not find host lobby. Exiting.\n";
+            eos_testing::shutdown();
+            return 1;
         }
         
-        if (!found_lobby && g_running) {
-            std::cout << "[CLIENT] Retrying search...\n";
-            search_done = false;
-            search_attempts++;
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            
-            LobbyManager::instance().search_lobbies(bucket_id, 10, filters, [&](bool success, const std::vector<LobbySearchResult>& results) {
-                if (success && !results.empty()) {
-                    target_lobby_id = results[0].lobby_id;
-                    found_lobby = true;
-                    std::cout << "[CLIENT] Found lobby: " << results[0].lobby_name << "\n";
+        // Join the lobby
+        std::cout << "[CLIENT] Joining lobby: " << target_lobby_id << "\n";
+        
+        bool join_done = false;
+        LobbyManager::instance().join_lobby(target_lobby_id, [&](bool success, const LobbyInfo& lobby, const std::string& error) {
+            if (success) {
+                std::cout << "[CLIENT] Joined lobby!\n";
+                std::cout << "[CLIENT] Host: " << (lobby.owner_id ? "found" : "unknown") << "\n";
+                
+                // Connect P2P to the host (owner)
+                if (lobby.owner_id) {
+                    host_user_id = lobby.owner_id;
+                    std::cout << "[CLIENT] Connecting P2P to host...\n";
+                    P2PManager::instance().connect_to_peer(lobby.owner_id);
                 }
-                search_done = true;
-            });
-        }
-    }
-    
-    if (!found_lobby) {
-        std::cout << "[CLIENT] Could not find host lobby. Exiting.\n";
-        eos_testing::shutdown();
-        return 1;
-    }
-    
-    // Join the lobby
-    std::cout << "[CLIENT] Joining lobby: " << target_lobby_id << "\n";
-    
-    bool join_done = false;
-    LobbyManager::instance().join_lobby(target_lobby_id, [&](bool success, const LobbyInfo& lobby, const std::string& error) {
-        if (success) {
-            std::cout << "[CLIENT] Joined lobby!\n";
-            std::cout << "[CLIENT] Host: " << (lobby.owner_id ? "found" : "unknown") << "\n";
-            
-            // Connect P2P to the host (owner)
-            if (lobby.owner_id) {
-                host_user_id = lobby.owner_id;
-                std::cout << "[CLIENT] Connecting P2P to host...\n";
-                P2PManager::instance().connect_to_peer(lobby.owner_id);
-            }
-            
-            // Also try connecting to all members
-            for (const auto& member : lobby.members) {
-                if (member.user_id != my_user_id) {
-                    std::cout << "[CLIENT] Found member: " << member.display_name << "\n";
-                    P2PManager::instance().connect_to_peer(member.user_id);
+                
+                // Also try connecting to all members
+                for (const auto& member : lobby.members) {
+                    if (member.user_id != my_user_id) {
+                        std::cout << "[CLIENT] Found member: " << member.display_name << "\n";
+                        P2PManager::instance().connect_to_peer(member.user_id);
+                    }
                 }
+            } else {
+                std::cout << "[CLIENT] Failed to join lobby: " << error << "\n";
+                g_running = false;
             }
-        } else {
-            std::cout << "[CLIENT] Failed to join lobby: " << error << "\n";
-            g_running = false;
+            join_done = true;
+        });
+        
+        while (!join_done && g_running) {
+            Platform::instance().tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
         }
-        join_done = true;
-    });
-    
-    while (!join_done && g_running) {
-        Platform::instance().tick();
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    } else {
+        std::cout << "[CLIENT] UDP mode: connecting to host on port " << udp_host_port << "...\n";
+        P2PManager::instance().connect_to_peer(UdpTransport::peer_id_for_port(udp_host_port));
     }
     
     // Main loop
     std::cout << "\n[CLIENT] Running... Press Ctrl+C to stop.\n";
     std::cout << "[CLIENT] Waiting for pings from host...\n\n";
     
+    auto last_report = std::chrono::steady_clock::now();
+    
     while (g_running) {
         Platform::instance().tick();
         P2PManager::instance().receive_packets();
+        P2PManager::instance().tick();
+        
+        // "Render" the demo object once per frame, reporting every 2 seconds
+        uint64_t render_time = object_buffer.advance(P2PManager::instance().get_server_time_us());
+        Vec3 object;
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::seconds(2) && object_buffer.sample(render_time, 0, object)) {
+            JitterStats stats = object_buffer.get_stats();
+            std::cout << "[CLIENT] Object at (" << std::fixed << std::setprecision(1) << object.x << ", "
+                      << object.z << "), rendered " << stats.delay_us / 1000.0 << " ms behind (jitter "
+                      << stats.jitter_us / 1000.0 << " ms), " << stats.snapshots_late << " late, "
+                      << stats.frames_extrapolated << " frames extrapolated\n";
+            last_report = now;
+        }
+        
         std::this_thread::sleep_for(std::chrono::milliseconds(16));
     }
     
@@ -2,14 +2,24 @@
  * EOS Testing - Host Application
  * 
  * Creates a lobby and waits for clients to connect.
- * Once a client joins, establishes P2P connection and exchanges messages.
+ * Once a client joins, establishes P2P connection and exchanges messages,
+ * and streams a moving demo object for the client to render.
  * 
- * Usage: eos_host.exe
+ * Usage: eos_host.exe [--udp <port>]
+ *
+ * --udp skips EOS login and lobbies and listens on 127.0.0.1:<port>;
+ * start eos_client with --udp <its port> <port> to connect.
  */
 
 #include "eos_testing/eos_testing.hpp"
+#include "eos_testing/p2p/bit_stream.hpp"
+#include "eos_testing/p2p/udp_transport.hpp"
 #include "../config/credentials.hpp"
 #include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
 #include <thread>
 #include <chrono>
 #include <atomic>
@@ -27,85 +37,132 @@ void signal_handler(int) {
 enum class PacketType : uint8_t {
     Ping = 1,
     Pong = 2,
-    Chat = 3
+    Chat = 3,
+    State = 4       // Demo object position, timestamped in server time
 };
 
 struct TestPacket {
-    PacketType type;
-    uint32_t sequence;
-    char message[256];
+    PacketType type = PacketType::Ping;
+    uint32_t sequence = 0;
+    char message[256] = {};
+    uint64_t timestamp_us = 0;
+    Vec3 position;
 };
 
-int main() {
+// Bit-packed on the wire: [type: 3 bits][sequence: varint][chat text or
+// timestamp + position], so a ping is 2-6 bytes rather than the whole struct
+uint32_t write_test_packet(const TestPacket& packet, uint8_t* out, uint32_t capacity) {
+    BitWriter writer(out, capacity);
+    writer.write_int(static_cast<int32_t>(packet.type), 0, 7);
+    writer.write_varint(packet.sequence);
+    if (packet.type == PacketType::Chat) {
+        writer.write_string(packet.message, sizeof(packet.message) - 1);
+    } else if (packet.type == PacketType::State) {
+        writer.write_bits(static_cast<uint32_t>(packet.timestamp_us), 32);
+        writer.write_bits(static_cast<uint32_t>(packet.timestamp_us >> 32), 32);
+        writer.write_vec3(packet.position, -512.0f, 512.0f, 18);
+    }
+    return writer.finish();
+}
+
+bool read_test_packet(const uint8_t* data, uint32_t size, TestPacket& packet) {
+    BitReader reader(data, size);
+    packet.type = static_cast<PacketType>(reader.read_int(0, 7));
+    packet.sequence = reader.read_varint();
+    packet.message[0] = '\0';
+    if (packet.type == PacketType::Chat) {
+        reader.read_string(packet.message, sizeof(packet.message));
+    } else if (packet.type == PacketType::State) {
+        packet.timestamp_us = reader.read_bits(32);
+        packet.timestamp_us |= static_cast<uint64_t>(reader.read_bits(32)) << 32;
+        packet.position = reader.read_vec3(-512.0f, 512.0f, 18);
+    }
+    return !reader.overflowed();
+}
+
+int main(int argc, char* argv[]) {
     std::signal(SIGINT, signal_handler);
     
+    // --udp <port>: localhost UDP instead of EOS, no credentials needed
+    uint16_t udp_port = 0;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], "--udp") == 0) {
+            udp_port = static_cast<uint16_t>(std::atoi(argv[i + 1]));
+        }
+    }
+    
     std::cout << "==============================================\n";
     std::cout << "         EOS P2P Test - HOST MODE\n";
     std::cout << "==============================================\n\n";
     
-    // Initialize platform
-    std::cout << "[HOST] Initializing EOS Platform...\n";
-    
-    PlatformConfig config;
-    config.product_name = config::PRODUCT_NAME;
-    config.product_version = config::PRODUCT_VERSION;
-    config.product_id = config::PRODUCT_ID;
-    config.sandbox_id = config::SANDBOX_ID;
-    config.deployment_id = config::DEPLOYMENT_ID;
-    config.client_id = config::CLIENT_ID;
-    config.client_secret = config::CLIENT_SECRET;
-    
-    bool init_done = false;
-    eos_testing::initialize(config, [&](bool success, const std::string& msg) {
-        if (success) {
-            std::cout << "[HOST] Platform initialized!\n";
-        } else {
-            std::cout << "[HOST] Platform init failed: " << msg << "\n";
-            g_running = false;
+    if (udp_port == 0) {
+        // Initialize platform
+        std::cout << "[HOST] Initializing EOS Platform...\n";
+        
+        PlatformConfig config;
+        config.product_name = config::PRODUCT_NAME;
+        config.product_version = config::PRODUCT_VERSION;
+        config.product_id = config::PRODUCT_ID;
+        config.sandbox_id = config::SANDBOX_ID;
+        config.deployment_id = config::DEPLOYMENT_ID;
+        config.client_id = config::CLIENT_ID;
+        config.client_secret = config::CLIENT_SECRET;
+        
+        bool init_done = false;
+        eos_testing::initialize(config, [&](bool success, const std::string& msg) {
+            if (success) {
+                std::cout << "[HOST] Platform initialized!\n";
+            } else {
+                std::cout << "[HOST] Platform init failed: " << msg << "\n";
+                g_running = false;
+            }
+            init_done = true;
+        });
+        
+        while (!init_done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
         }
-        init_done = true;
-    });
-    
-    while (!init_done) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-    }
-    
-    if (!Platform::instance().is_ready()) {
-        return 1;
-    }
-    
-    // Login with Device ID
-    std::cout << "[HOST] Logging in...\n";
-    
-    bool login_done = false;
-    EOS_ProductUserId my_user_id = nullptr;
-    
-    // Use unique device model for host to get separate identity
-    AuthManager::instance().login_device_id_with_model("Host", "HostPC", [&](const AuthResult& result) {
-        if (result.success) {
-            std::cout << "[HOST] Logged in as '" << result.display_name << "'\n";
-            std::cout << "[HOST] User ID: " << result.product_user_id << "\n";
-            my_user_id = AuthManager::instance().get_product_user_id();
-        } else {
-            std::cout << "[HOST] Login failed: " << result.error_message << "\n";
-            g_running = false;
+        
+        if (!Platform::instance().is_ready()) {
+            return 1;
         }
-        login_done = true;
-    });
-    
-    while (!login_done && g_running) {
-        Platform::instance().tick();
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        
+        // Login with Device ID
+        std::cout << "[HOST] Logging in...\n";
+        
+        bool login_done = false;
+        EOS_ProductUserId my_user_id = nullptr;
+        
+        // Use unique device model for host to get separate identity
+        AuthManager::instance().login_device_id_with_model("Host", "HostPC", [&](const AuthResult& result) {
+            if (result.success) {
+                std::cout << "[HOST] Logged in as '" << result.display_name << "'\n";
+                std::cout << "[HOST] User ID: " << result.product_user_id << "\n";
+                my_user_id = AuthManager::instance().get_product_user_id();
+            } else {
+                std::cout << "[HOST] Login failed: " << result.error_message << "\n";
+                g_running = false;
+            }
+            login_done = true;
+        });
+        
+        while (!login_done && g_running) {
+            Platform::instance().tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        }
+        
+        if (!g_running) return 1;
     }
     
-    if (!g_running) return 1;
-    
     // Initialize P2P
     std::cout << "[HOST] Initializing P2P...\n";
     
     P2PConfig p2p_config;
     p2p_config.socket_name = "P2PTestSocket";
     p2p_config.allow_relay = true;
+    if (udp_port != 0) {
+        p2p_config.transport = std::make_shared<UdpTransport>(udp_port);
+    }
     
     if (!P2PManager::instance().initialize(p2p_config)) {
         std::cout << "[HOST] P2P init failed!\n";
@@ -134,18 +191,17 @@ int main() {
     };
     
     P2PManager::instance().on_packet_received = [&](const IncomingPacket& packet) {
-        if (packet.data.size() >= sizeof(TestPacket)) {
-            TestPacket* pkt = (TestPacket*)packet.data.data();
-            
-            switch (pkt->type) {
+        TestPacket pkt;
+        if (read_test_packet(packet.data.data(), packet.data.size(), pkt)) {
+            switch (pkt.type) {
                 case PacketType::Pong:
                     pongs_received++;
-                    std::cout << "[HOST] Received PONG #" << pkt->sequence 
+                    std::cout << "[HOST] Received PONG #" << pkt.sequence 
                               << " (RTT measured by client)\n";
                     break;
                     
                 case PacketType::Chat:
-                    std::cout << "[HOST] Client says: " << pkt->message << "\n";
+                    std::cout << "[HOST] Client says: " << pkt.message << "\n";
                     break;
                     
                 default:
@@ -158,58 +214,66 @@ int main() {
     P2PManager::instance().accept_connections();
     std::cout << "[HOST] Accepting P2P connections...\n";
     
-    // Create a lobby so client can find us
-    std::cout << "[HOST] Creating lobby...\n";
-    
-    bool lobby_created = false;
-    std::string lobby_id;
-    
-    CreateLobbyOptions lobby_opts;
-    lobby_opts.lobby_name = "P2P Test Lobby";
-    lobby_opts.bucket_id = "p2ptest:global";
-    lobby_opts.max_members = 2;
-    lobby_opts.permission = LobbyPermission::PublicAdvertised;
-    lobby_opts.attributes["test"] = "true";
-    
-    LobbyManager::instance().create_lobby(lobby_opts, [&](bool success, const std::string& id, const std::string& error) {
-        if (success) {
-            lobby_id = id;
-            std::cout << "[HOST] Lobby created: " << id << "\n";
-            std::cout << "[HOST] Waiting for client to join...\n";
-        } else {
-            std::cout << "[HOST] Failed to create lobby: " << error << "\n";
-            g_running = false;
+    if (udp_port == 0) {
+        // Create a lobby so client can find us
+        std::cout << "[HOST] Creating lobby...\n";
+        
+        bool lobby_created = false;
+        std::string lobby_id;
+        
+        CreateLobbyOptions lobby_opts;
+        lobby_opts.lobby_name = "P2P Test Lobby";
+        lobby_opts.bucket_id = "p2ptest:global";
+        lobby_opts.max_members = 2;
+        lobby_opts.permission = LobbyPermission::PublicAdvertised;
+        lobby_opts.attributes["test"] = "true";
+        
+        LobbyManager::instance().create_lobby(lobby_opts, [&](bool success, const std::string& id, const std::string& error) {
+            if (success) {
+                lobby_id = id;
+                std::cout << "[HOST] Lobby created: " << id << "\n";
+                std::cout << "[HOST] Waiting for client to join...\n";
+            } else {
+                std::cout << "[HOST] Failed to create lobby: " << error << "\n";
+                g_running = false;
+            }
+            lobby_created = true;
+        });
+        
+        while (!lobby_created && g_running) {
+            Platform::instance().tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
         }
-        lobby_created = true;
-    });
-    
-    while (!lobby_created && g_running) {
-        Platform::instance().tick();
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-    }
-    
-    // Set up lobby callbacks
-    LobbyManager::instance().on_member_joined = [&](const std::string& lid, const LobbyMember& member) {
-        std::cout << "[HOST] Player joined lobby: " << member.display_name << "\n";
-        std::cout << "[HOST] Attempting P2P connection to client...\n";
         
-        // Try to connect P2P to the new member
-        P2PManager::instance().connect_to_peer(member.user_id);
-    };
-    
-    LobbyManager::instance().on_member_left = [&](const std::string& lid, EOS_ProductUserId user_id) {
-        std::cout << "[HOST] Player left lobby.\n";
-    };
+        // Set up lobby callbacks
+        LobbyManager::instance().on_member_joined = [&](const std::string& lid, const LobbyMember& member) {
+            std::cout << "[HOST] Player joined lobby: " << member.display_name << "\n";
+            std::cout << "[HOST] Attempting P2P connection to client...\n";
+            
+            // Try to connect P2P to the new member
+            P2PManager::instance().connect_to_peer(member.user_id);
+        };
+        
+        LobbyManager::instance().on_member_left = [&](const std::string& lid, EOS_ProductUserId user_id) {
+            std::cout << "[HOST] Player left lobby.\n";
+        };
+    } else {
+        std::cout << "[HOST] UDP mode: waiting for a client to send to port " << udp_port << "...\n";
+    }
     
     // Main loop
     std::cout << "\n[HOST] Running... Press Ctrl+C to stop.\n";
-    std::cout << "[HOST] Will send PING every 2 seconds once client connects.\n\n";
+    std::cout << "[HOST] Will send PING every 2 seconds once client connects.\n";
+    std::cout << "[HOST] Will stream the demo object 20 times a second.\n\n";
     
     auto last_ping = std::chrono::steady_clock::now();
+    auto last_state = last_ping;
+    uint32_t state_sequence = 0;
     
     while (g_running) {
         Platform::instance().tick();
         P2PManager::instance().receive_packets();
+        P2PManager::instance().tick();
         
         // Send periodic pings if client is connected
         if (connected_client) {
@@ -220,16 +284,36 @@ int main() {
                 TestPacket ping;
                 ping.type = PacketType::Ping;
                 ping.sequence = ++ping_sequence;
-                snprintf(ping.message, sizeof(ping.message), "Ping from host!");
                 
-                if (P2PManager::instance().send_packet(connected_client, &ping, sizeof(ping), 
+                uint8_t wire[sizeof(TestPacket) + 8];
+                uint32_t size = write_test_packet(ping, wire, sizeof(wire));
+                if (P2PManager::instance().send_packet(connected_client, wire, size, 
                                                         0, PacketReliability::ReliableOrdered)) {
                     pings_sent++;
-                    std::cout << "[HOST] Sent PING #" << ping.sequence << "\n";
+                    std::cout << "[HOST] Sent PING #" << ping.sequence << " at server time "
+                              << std::fixed << std::setprecision(6)
+                              << P2PManager::instance().get_server_time_us() / 1e6 << " s\n";
                 }
                 
                 last_ping = now;
             }
+            
+            // Stream a demo object circling the origin at 20 Hz; the client
+            // renders it through a jitter buffer
+            if (now - last_state >= std::chrono::milliseconds(50)) {
+                TestPacket state;
+                state.type = PacketType::State;
+                state.sequence = ++state_sequence;
+                state.timestamp_us = P2PManager::instance().get_server_time_us();
+                float angle = static_cast<float>(state.timestamp_us % 6283185) / 1e6f;
+                state.position = {100.0f * std::cos(angle), 0.0f, 100.0f * std::sin(angle)};
+                
+                uint8_t wire[sizeof(TestPacket) + 8];
+                uint32_t size = write_test_packet(state, wire, sizeof(wire));
+                P2PManager::instance().send_packet(connected_client, wire, size,
+                                                   1, PacketReliability::UnreliableUnordered);
+                last_state = now;
+            }
         }
         
         std::this_thread::sleep_for(std::chrono::milliseconds(16));
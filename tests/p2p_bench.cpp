@@ -0,0 +1,1578 @@
+/**
+ * EOS Testing - P2P Microbenchmarks
+ *
+ * Measures the P2P hot paths in isolation. No credentials or network
+ * needed (the udp benchmark uses localhost sockets), so it runs in stub
+ * mode and on CI machines.
+ *
+ * Usage: eos_p2p_bench [benchmark]   (no argument runs everything)
+ */
+
+#include "eos_testing/core/platform.hpp"
+#include "eos_testing/auth/auth_manager.hpp"
+#include "eos_testing/p2p/p2p_manager.hpp"
+#include "eos_testing/p2p/bit_stream.hpp"
+#include "eos_testing/p2p/compression.hpp"
+#include "eos_testing/p2p/interest_manager.hpp"
+#include "eos_testing/p2p/jitter_buffer.hpp"
+#include "eos_testing/p2p/loopback_transport.hpp"
+#include "eos_testing/p2p/ring_queue.hpp"
+#include "eos_testing/p2p/snapshot_replicator.hpp"
+#include "eos_testing/p2p/udp_transport.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cmath>
+
+using namespace eos_testing;
+using Clock = std::chrono::steady_clock;
+
+void print_header(const std::string& title) {
+    std::cout << "\n========================================\n";
+    std::cout << "  " << title << "\n";
+    std::cout << "========================================\n\n";
+}
+
+// Results are written here so the optimizer can't drop the measured work
+volatile uint64_t g_sink = 0;
+
+double elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// ============================================================================
+// Incoming queue: std::mutex + std::queue vs lock-free RingQueue
+// ============================================================================
+
+// Roughly the size of a small gameplay packet header + payload
+struct QueueItem {
+    uint64_t sequence = 0;
+    uint8_t payload[48] = {};
+};
+
+constexpr uint32_t QUEUE_ITEMS = 2000000;
+constexpr uint32_t QUEUE_DRAIN_BATCH = 100;   // receive_packets() default
+
+/**
+ * The previous design: producers lock to push, consumer holds the lock
+ * while draining a batch (as receive_packets did in stub mode).
+ */
+double run_mutex_queue(uint32_t producers) {
+    std::queue<QueueItem> queue;
+    std::mutex mutex;
+    std::atomic<bool> start{false};
+
+    std::vector<std::thread> threads;
+    uint32_t per_producer = QUEUE_ITEMS / producers;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            while (!start.load(std::memory_order_acquire)) {}
+            for (uint32_t i = 0; i < per_producer; i++) {
+                QueueItem item;
+                item.sequence = (static_cast<uint64_t>(p) << 32) | i;
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push(item);
+            }
+        });
+    }
+
+    auto begin = Clock::now();
+    start.store(true, std::memory_order_release);
+
+    uint64_t consumed = 0;
+    uint64_t checksum = 0;
+    uint64_t total = static_cast<uint64_t>(per_producer) * producers;
+    while (consumed < total) {
+        uint32_t drained = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (; drained < QUEUE_DRAIN_BATCH && !queue.empty(); drained++) {
+                checksum += queue.front().sequence;
+                queue.pop();
+            }
+        }
+        consumed += drained;
+        if (drained == 0) std::this_thread::yield();
+    }
+    double ms = elapsed_ms(begin);
+
+    for (auto& t : threads) t.join();
+    g_sink = checksum;
+    return ms;
+}
+
+double run_ring_queue(uint32_t producers) {
+    RingQueue<QueueItem> queue(4096);
+    std::atomic<bool> start{false};
+
+    std::vector<std::thread> threads;
+    uint32_t per_producer = QUEUE_ITEMS / producers;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            while (!start.load(std::memory_order_acquire)) {}
+            for (uint32_t i = 0; i < per_producer; i++) {
+                QueueItem item;
+                item.sequence = (static_cast<uint64_t>(p) << 32) | i;
+                while (!queue.try_push(std::move(item))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto begin = Clock::now();
+    start.store(true, std::memory_order_release);
+
+    uint64_t consumed = 0;
+    uint64_t checksum = 0;
+    uint64_t total = static_cast<uint64_t>(per_producer) * producers;
+    QueueItem item;
+    while (consumed < total) {
+        uint32_t drained = 0;
+        for (; drained < QUEUE_DRAIN_BATCH && queue.try_pop(item); drained++) {
+            checksum += item.sequence;
+        }
+        consumed += drained;
+        if (drained == 0) std::this_thread::yield();
+    }
+    double ms = elapsed_ms(begin);
+
+    for (auto& t : threads) t.join();
+    g_sink = checksum;
+    return ms;
+}
+
+void bench_incoming_queue() {
+    print_header("Incoming queue contention (" + std::to_string(QUEUE_ITEMS) + " items)");
+
+    std::cout << std::left << std::setw(12) << "producers"
+              << std::setw(18) << "mutex (Mops/s)"
+              << std::setw(18) << "ring (Mops/s)"
+              << "speedup\n";
+
+    for (uint32_t producers : {1u, 2u, 4u, 8u}) {
+        double mutex_ms = run_mutex_queue(producers);
+        double ring_ms = run_ring_queue(producers);
+        double items = static_cast<double>(QUEUE_ITEMS / producers * producers);
+
+        std::cout << std::left << std::setw(12) << producers
+                  << std::setw(18) << std::fixed << std::setprecision(2) << items / mutex_ms / 1000.0
+                  << std::setw(18) << items / ring_ms / 1000.0
+                  << mutex_ms / ring_ms << "x\n";
+    }
+}
+
+// ============================================================================
+// Send setup: per-call socket/options rebuild vs cached prefilled options
+// ============================================================================
+
+// Local look-alikes of EOS_P2P_SocketId / EOS_P2P_SendPacketOptions, so
+// this runs without the SDK. It compares the two ways of filling the
+// structs (strncpy and lookups per call vs copying a template), not
+// EOSTransport::send itself, which only builds against the SDK.
+struct BenchSocketId {
+    int32_t api_version;
+    char socket_name[33];
+};
+
+struct BenchSendOptions {
+    int32_t api_version;
+    const void* local_user_id;
+    const void* remote_user_id;
+    const BenchSocketId* socket_id;
+    uint8_t channel;
+    uint32_t data_length;
+    const void* data;
+    int32_t allow_delayed_delivery;
+    int32_t reliability;
+};
+
+#ifdef _MSC_VER
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+// Stand-ins for EOS_Platform_GetP2PInterface / get_product_user_id, which
+// are out-of-line SDK calls
+BENCH_NOINLINE const void* bench_get_p2p_handle() {
+    static int handle;
+    return &handle;
+}
+
+BENCH_NOINLINE const void* bench_get_local_user() {
+    static int user;
+    return &user;
+}
+
+BENCH_NOINLINE void bench_send(const BenchSendOptions& options) {
+    g_sink = g_sink + options.data_length + options.socket_id->socket_name[0];
+}
+
+constexpr uint32_t SEND_ITERATIONS = 10000000;
+
+void bench_send_setup() {
+    print_header("Send setup, mock option structs (" + std::to_string(SEND_ITERATIONS) + " sends)");
+
+    const std::string socket_name = "GameSocket";
+    uint8_t payload[64] = {};
+
+    // Rebuild everything for every packet
+    auto begin = Clock::now();
+    for (uint32_t i = 0; i < SEND_ITERATIONS; i++) {
+        g_sink = g_sink + reinterpret_cast<uintptr_t>(bench_get_p2p_handle());
+
+        BenchSocketId socket_id = {};
+        socket_id.api_version = 1;
+        std::strncpy(socket_id.socket_name, socket_name.c_str(), 32);
+
+        BenchSendOptions options = {};
+        options.api_version = 2;
+        options.local_user_id = bench_get_local_user();
+        options.remote_user_id = payload;
+        options.socket_id = &socket_id;
+        options.channel = 0;
+        options.data_length = sizeof(payload);
+        options.data = payload;
+        options.allow_delayed_delivery = 1;
+        options.reliability = 0;
+        bench_send(options);
+    }
+    double rebuild_ms = elapsed_ms(begin);
+
+    // Socket and constant fields built once, copied per packet
+    BenchSocketId cached_socket = {};
+    cached_socket.api_version = 1;
+    std::memcpy(cached_socket.socket_name, socket_name.c_str(), socket_name.size() + 1);
+
+    BenchSendOptions cached_options = {};
+    cached_options.api_version = 2;
+    cached_options.local_user_id = bench_get_local_user();
+    cached_options.socket_id = &cached_socket;
+    cached_options.allow_delayed_delivery = 1;
+
+    begin = Clock::now();
+    for (uint32_t i = 0; i < SEND_ITERATIONS; i++) {
+        BenchSendOptions options = cached_options;
+        options.remote_user_id = payload;
+        options.channel = 0;
+        options.data_length = sizeof(payload);
+        options.data = payload;
+        options.reliability = 0;
+        bench_send(options);
+    }
+    double cached_ms = elapsed_ms(begin);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "rebuild per call: " << rebuild_ms * 1e6 / SEND_ITERATIONS << " ns/send\n"
+              << "template copy:    " << cached_ms * 1e6 / SEND_ITERATIONS << " ns/send\n"
+              << "speedup:          " << std::setprecision(2) << rebuild_ms / cached_ms << "x\n"
+              << "(struct setup only; the SDK send itself isn't included)\n";
+
+#ifdef EOS_STUB_MODE
+    // Whole send_packet path (framing + pool + stats); stub backend discards
+    PlatformConfig platform_config;
+    platform_config.product_name = "P2PBench";
+    platform_config.product_version = "1.0.0";
+    Platform::instance().initialize(platform_config);
+    AuthManager::instance().login_device_id("Bench", nullptr);
+
+    auto& p2p = P2PManager::instance();
+    p2p.initialize(P2PConfig{});
+    auto peer = reinterpret_cast<EOS_ProductUserId>(0x1001);
+    p2p.connect_to_peer(peer);
+
+    const uint32_t packets = SEND_ITERATIONS / 10;
+    begin = Clock::now();
+    for (uint32_t i = 0; i < packets; i++) {
+        p2p.send_packet(peer, payload, sizeof(payload));
+    }
+    double send_ms = elapsed_ms(begin);
+
+    std::cout << "send_packet:      " << std::setprecision(1) << send_ms * 1e6 / packets << " ns/send\n";
+
+    p2p.shutdown();
+    Platform::instance().shutdown();
+#endif
+}
+
+// ============================================================================
+// Broadcast: per-peer send_packet vs cached peer snapshot
+// ============================================================================
+
+constexpr uint32_t BROADCAST_ROUNDS = 20000;
+
+void bench_broadcast() {
+    print_header("Broadcast fan-out (" + std::to_string(BROADCAST_ROUNDS) + " broadcasts)");
+
+#ifdef EOS_STUB_MODE
+    PlatformConfig platform_config;
+    platform_config.product_name = "P2PBench";
+    platform_config.product_version = "1.0.0";
+    Platform::instance().initialize(platform_config);
+    AuthManager::instance().login_device_id("Bench", nullptr);
+
+    auto& p2p = P2PManager::instance();
+    uint8_t payload[64] = {};
+
+    std::cout << std::left << std::setw(8) << "peers"
+              << std::setw(22) << "send loop (ns/peer)"
+              << std::setw(22) << "broadcast (ns/peer)"
+              << "speedup\n";
+
+    for (uint32_t peer_count : {8u, 32u, 64u}) {
+        p2p.initialize(P2PConfig{});
+        for (uint32_t i = 0; i < peer_count; i++) {
+            p2p.connect_to_peer(reinterpret_cast<EOS_ProductUserId>(static_cast<uintptr_t>(0x1000 + i)));
+        }
+
+        // What broadcast_packet used to do: copy the peer list, then send_packet each
+        auto begin = Clock::now();
+        for (uint32_t round = 0; round < BROADCAST_ROUNDS; round++) {
+            std::vector<EOS_ProductUserId> peers;
+            for (const auto& conn : p2p.get_all_connections()) {
+                peers.push_back(conn.peer_id);
+            }
+            for (auto peer : peers) {
+                p2p.send_packet(peer, payload, sizeof(payload));
+            }
+        }
+        double loop_ms = elapsed_ms(begin);
+
+        begin = Clock::now();
+        for (uint32_t round = 0; round < BROADCAST_ROUNDS; round++) {
+            p2p.broadcast_packet(payload, sizeof(payload));
+        }
+        double broadcast_ms = elapsed_ms(begin);
+
+        double sends = static_cast<double>(BROADCAST_ROUNDS) * peer_count;
+        std::cout << std::left << std::setw(8) << peer_count
+                  << std::setw(22) << std::fixed << std::setprecision(1) << loop_ms * 1e6 / sends
+                  << std::setw(22) << broadcast_ms * 1e6 / sends
+                  << std::setprecision(2) << loop_ms / broadcast_ms << "x\n";
+
+        p2p.shutdown();
+    }
+
+    Platform::instance().shutdown();
+#else
+    std::cout << "Skipped: needs a stub-mode build (no real peers to send to)\n";
+#endif
+}
+
+// ============================================================================
+// Peer lookup: unordered_map<id, PeerConnection> vs PeerTable
+// ============================================================================
+
+constexpr uint32_t LOOKUP_ITERATIONS = 10000000;
+
+void bench_peer_lookup() {
+    print_header("Peer lookup + counter update (" + std::to_string(LOOKUP_ITERATIONS) + " lookups)");
+
+    std::cout << std::left << std::setw(8) << "peers"
+              << std::setw(22) << "unordered_map (ns)"
+              << std::setw(22) << "PeerTable (ns)"
+              << "speedup\n";
+
+    for (uint32_t peer_count : {8u, 32u, 64u}) {
+        std::vector<EOS_ProductUserId> ids;
+        for (uint32_t i = 0; i < peer_count; i++) {
+            ids.push_back(reinterpret_cast<EOS_ProductUserId>(static_cast<uintptr_t>(0x7f0000001000ULL + i * 48)));
+        }
+
+        std::unordered_map<EOS_ProductUserId, PeerConnection> map;
+        PeerTable table;
+        table.reset(peer_count);
+        for (auto id : ids) {
+            map[id].peer_id = id;
+            map[id].display_name = "Player with a long display name";
+            table.insert(id);
+        }
+
+        // Same pseudo-random access pattern for both
+        auto begin = Clock::now();
+        uint32_t state = 1;
+        for (uint32_t i = 0; i < LOOKUP_ITERATIONS; i++) {
+            state = state * 1664525u + 1013904223u;
+            auto it = map.find(ids[(state >> 16) % peer_count]);
+            if (it != map.end()) it->second.bytes_received += 64;
+        }
+        double map_ms = elapsed_ms(begin);
+
+        begin = Clock::now();
+        state = 1;
+        for (uint32_t i = 0; i < LOOKUP_ITERATIONS; i++) {
+            state = state * 1664525u + 1013904223u;
+            PeerIndex index = table.find(ids[(state >> 16) % peer_count]);
+            if (index != INVALID_PEER_INDEX) {
+                // As dispatch_packet does it: single writer, no locked add
+                auto& bytes_received = table.hot(index).bytes_received;
+                bytes_received.store(bytes_received.load(std::memory_order_relaxed) + 64,
+                                     std::memory_order_relaxed);
+            }
+        }
+        double table_ms = elapsed_ms(begin);
+
+        g_sink = map.begin()->second.bytes_received + table.hot(0).bytes_received.load();
+
+        std::cout << std::left << std::setw(8) << peer_count
+                  << std::setw(22) << std::fixed << std::setprecision(1) << map_ms * 1e6 / LOOKUP_ITERATIONS
+                  << std::setw(22) << table_ms * 1e6 / LOOKUP_ITERATIONS
+                  << std::setprecision(2) << map_ms / table_ms << "x\n";
+    }
+}
+
+// ============================================================================
+// Loopback: whole send/receive pipeline between two in-process managers
+// ============================================================================
+
+constexpr uint32_t LOOPBACK_MESSAGES = 200000;
+constexpr uint32_t LOOPBACK_ROUND_TRIPS = 50000;
+
+void bench_loopback() {
+    print_header("Loopback pipeline (" + std::to_string(LOOPBACK_MESSAGES) + " messages)");
+
+    const auto id_a = reinterpret_cast<EOS_ProductUserId>(0xA);
+    const auto id_b = reinterpret_cast<EOS_ProductUserId>(0xB);
+
+    std::cout << std::left << std::setw(10) << "payload"
+              << std::setw(16) << "send_packet"
+              << std::setw(16) << "queue_packet"
+              << "\n";
+
+    for (uint32_t payload_size : {16u, 64u, 256u, 1024u}) {
+        std::vector<uint8_t> payload(payload_size, 0x5A);
+        double rates[2] = {};
+
+        for (int batched = 0; batched < 2; batched++) {
+            auto network = std::make_shared<LoopbackNetwork>(8192);
+            P2PManager a;
+            P2PManager b;
+
+            P2PConfig config;
+            config.ping_interval_ms = 0;
+            config.incoming_queue_capacity = 8192;
+            config.transport = network->create_endpoint(id_a);
+            a.initialize(config);
+            config.transport = network->create_endpoint(id_b);
+            b.initialize(config);
+            a.connect_to_peer(id_b);
+
+            uint64_t received = 0;
+            b.on_packet_view = [&](const PacketView& packet) { received += packet.size; };
+
+            // Send in frame-sized bursts, receive after each burst
+            const uint32_t burst = 256;
+            auto begin = Clock::now();
+            for (uint32_t sent = 0; sent < LOOPBACK_MESSAGES; sent += burst) {
+                for (uint32_t i = 0; i < burst; i++) {
+                    if (batched) {
+                        a.queue_packet(id_b, payload.data(), payload_size);
+                    } else {
+                        a.send_packet(id_b, payload.data(), payload_size);
+                    }
+                }
+                a.tick();
+                while (b.receive_packets(1024) > 0) {}
+            }
+            double ms = elapsed_ms(begin);
+
+            g_sink = received;
+            rates[batched] = LOOPBACK_MESSAGES / ms / 1000.0;
+        }
+
+        std::cout << std::left << std::setw(10) << payload_size
+                  << std::setw(16) << (std::to_string(static_cast<int>(rates[0] * 1000)) + "k msg/s")
+                  << std::setw(16) << (std::to_string(static_cast<int>(rates[1] * 1000)) + "k msg/s")
+                  << "\n";
+    }
+
+    // Round trip: A sends, B echoes from its callback, A receives
+    auto network = std::make_shared<LoopbackNetwork>();
+    P2PManager a;
+    P2PManager b;
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = network->create_endpoint(id_a);
+    a.initialize(config);
+    config.transport = network->create_endpoint(id_b);
+    b.initialize(config);
+    a.connect_to_peer(id_b);
+
+    b.on_packet_view = [&](const PacketView& packet) {
+        b.send_packet(packet.sender, packet.data, packet.size);
+    };
+    uint32_t replies = 0;
+    a.on_packet_view = [&](const PacketView&) { replies++; };
+
+    uint8_t message[64] = {};
+    auto begin = Clock::now();
+    for (uint32_t i = 0; i < LOOPBACK_ROUND_TRIPS; i++) {
+        a.send_packet(id_b, message, sizeof(message));
+        b.receive_packets();
+        a.receive_packets();
+    }
+    double ms = elapsed_ms(begin);
+    g_sink = replies;
+
+    std::cout << "\nRound trip (64 B): " << std::fixed << std::setprecision(2)
+              << ms * 1000.0 / LOOPBACK_ROUND_TRIPS << " us\n";
+}
+
+// ============================================================================
+// Reliability: transport reliable mode vs custom ack/resend layer under loss
+// ============================================================================
+
+constexpr uint32_t RELIABLE_MESSAGES = 5000;
+constexpr uint32_t RELIABLE_PER_FRAME = 50;
+
+void bench_reliability() {
+    print_header("Reliable delivery under loss (" + std::to_string(RELIABLE_MESSAGES) +
+                 " x 64 B ReliableOrdered, 10 ms latency)");
+
+    // The in-process transports carry "reliable" packets like any other, so
+    // the native row shows what an unprotected link loses; on EOS the relay
+    // resends them out of our sight
+    std::cout << std::left << std::setw(8) << "loss"
+              << std::setw(10) << "mode"
+              << std::setw(12) << "delivered"
+              << std::setw(12) << "complete"
+              << std::setw(12) << "resends"
+              << std::setw(12) << "packets"
+              << "\n";
+
+    const auto id_a = reinterpret_cast<EOS_ProductUserId>(0xA);
+    const auto id_b = reinterpret_cast<EOS_ProductUserId>(0xB);
+    uint8_t message[64] = {};
+
+    for (float loss : {0.0f, 0.01f, 0.05f, 0.2f}) {
+        for (int custom = 0; custom < 2; custom++) {
+            auto network = std::make_shared<LoopbackNetwork>(16384);
+            P2PManager a;
+            P2PManager b;
+
+            P2PConfig config;
+            config.ping_interval_ms = 0;
+            config.custom_reliability = custom != 0;
+            config.network_conditions.latency_ms = 10;
+            config.network_conditions.loss_rate = loss;
+            config.network_conditions.loss_burst_length = 2.0f;
+            config.transport = network->create_endpoint(id_a);
+            a.initialize(config);
+            config.network_conditions.seed = 2;
+            config.transport = network->create_endpoint(id_b);
+            b.initialize(config);
+            a.connect_to_peer(id_b);
+
+            uint32_t delivered = 0;
+            b.on_packet_view = [&](const PacketView&) { delivered++; };
+
+            // One burst per 1 ms "frame"; stop once everything is in or
+            // nothing has arrived for longer than the maximum RTO
+            auto begin = Clock::now();
+            auto last_progress = begin;
+            uint32_t sent = 0;
+            while (delivered < RELIABLE_MESSAGES && Clock::now() - last_progress < std::chrono::seconds(3)) {
+                for (uint32_t i = 0; i < RELIABLE_PER_FRAME && sent < RELIABLE_MESSAGES; i++, sent++) {
+                    std::memcpy(message, &sent, sizeof(sent));
+                    a.send_packet(id_b, message, sizeof(message), 0, PacketReliability::ReliableOrdered);
+                }
+                a.tick();
+                uint32_t before = delivered;
+                b.receive_packets(1000);
+                b.tick();
+                a.receive_packets(1000);
+                if (delivered != before) last_progress = Clock::now();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            double ms = std::chrono::duration<double, std::milli>(last_progress - begin).count();
+
+            auto stats = a.get_reliability_stats(id_b);
+            // Everything either side put on the wire, resends and acks included
+            uint64_t packets = a.get_network_simulator_stats().received + b.get_network_simulator_stats().received;
+            std::cout << std::left << std::setw(8) << (std::to_string(static_cast<int>(loss * 100)) + "%")
+                      << std::setw(10) << (custom ? "custom" : "native")
+                      << std::setw(12) << (std::to_string(delivered * 100 / RELIABLE_MESSAGES) + "%")
+                      << std::setw(12) << (std::to_string(static_cast<int>(ms)) + " ms")
+                      << std::setw(12) << (stats ? std::to_string(stats->retransmits) : "-")
+                      << std::setw(12) << packets
+                      << "\n";
+        }
+    }
+}
+
+// ============================================================================
+// Snapshots: full vs delta bytes per tick, encode/decode cost
+// ============================================================================
+
+// A typical replicated player
+struct BenchEntity {
+    float position[3];
+    float velocity[3];
+    float rotation[4];
+    uint16_t health;
+    uint16_t ammo;
+    uint32_t flags;
+};
+
+constexpr uint32_t SNAPSHOT_TICKS = 600;
+
+void bench_snapshot() {
+    print_header("Snapshot replication (" + std::to_string(sizeof(BenchEntity)) + " B entities, " +
+                 std::to_string(SNAPSHOT_TICKS) + " ticks, all moving)");
+
+    std::cout << std::left << std::setw(10) << "entities"
+              << std::setw(14) << "full B/tick"
+              << std::setw(14) << "delta B/tick"
+              << std::setw(12) << "ratio"
+              << std::setw(14) << "encode us"
+              << std::setw(14) << "decode us"
+              << "\n";
+
+    const auto id_a = reinterpret_cast<EOS_ProductUserId>(0xA);
+    const auto id_b = reinterpret_cast<EOS_ProductUserId>(0xB);
+
+    for (uint32_t count : {16u, 32u, 64u}) {
+        auto network = std::make_shared<LoopbackNetwork>(16384);
+        P2PManager a;
+        P2PManager b;
+
+        P2PConfig config;
+        config.ping_interval_ms = 0;
+        config.transport = network->create_endpoint(id_a);
+        a.initialize(config);
+        config.transport = network->create_endpoint(id_b);
+        b.initialize(config);
+        a.connect_to_peer(id_b);
+
+        SnapshotReplicator sender(a);
+        SnapshotReplicator receiver(b);
+        uint8_t type = sender.register_type<BenchEntity>();
+        receiver.register_type<BenchEntity>();
+        a.on_packet_view = [&](const PacketView& packet) { sender.handle_packet(packet); };
+        b.on_packet_view = [&](const PacketView& packet) { receiver.handle_packet(packet); };
+
+        std::vector<BenchEntity> world(count);
+        for (uint32_t i = 0; i < count; i++) {
+            world[i] = {{i * 3.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.5f}, {0.0f, 0.0f, 0.0f, 1.0f}, 100, 30, 0};
+        }
+
+        // Movement changes position every tick; the rest changes now and then
+        double encode_us = 0.0;
+        double decode_us = 0.0;
+        uint64_t delta_bytes = 0;
+        uint32_t full_bytes = 0;
+        for (uint32_t tick = 0; tick < SNAPSHOT_TICKS; tick++) {
+            for (uint32_t i = 0; i < count; i++) {
+                BenchEntity& entity = world[i];
+                for (int axis = 0; axis < 3; axis++) entity.position[axis] += entity.velocity[axis] / 60.0f;
+                if ((tick + i) % 15 == 0) entity.rotation[1] += 0.05f;
+                if ((tick + i) % 90 == 0) entity.ammo--;
+                sender.set_entity(static_cast<uint16_t>(i), type, entity);
+            }
+            sender.commit();
+
+            auto begin = Clock::now();
+            uint32_t bytes = sender.send(id_b);
+            encode_us += elapsed_ms(begin) * 1000.0;
+
+            begin = Clock::now();
+            b.receive_packets(1000);
+            decode_us += elapsed_ms(begin) * 1000.0;
+            a.receive_packets(1000);
+
+            if (tick == 0) full_bytes = bytes;
+            else delta_bytes += bytes;
+        }
+
+        // Every tick arrived intact
+        BenchEntity last;
+        g_sink += receiver.get_entity(id_a, static_cast<uint16_t>(count - 1), last) &&
+                  std::memcmp(&last, &world[count - 1], sizeof(last)) == 0;
+
+        double delta_per_tick = static_cast<double>(delta_bytes) / (SNAPSHOT_TICKS - 1);
+        std::cout << std::left << std::setw(10) << count
+                  << std::setw(14) << full_bytes
+                  << std::setw(14) << std::fixed << std::setprecision(1) << delta_per_tick
+                  << std::setw(12) << std::setprecision(2) << full_bytes / delta_per_tick
+                  << std::setw(14) << std::setprecision(2) << encode_us / SNAPSHOT_TICKS
+                  << std::setw(14) << decode_us / SNAPSHOT_TICKS
+                  << "\n";
+    }
+    std::cout << "(encode = send(), decode = receive_packets() incl. the loopback hop)\n";
+}
+
+// ============================================================================
+// Interest management: host upload for growing lobbies
+// ============================================================================
+
+constexpr uint32_t INTEREST_TICKS = 300;
+
+/**
+ * Host upload per tick with every player's entity sent to every client,
+ * versus filtered by InterestManager. The map grows with the lobby so
+ * player density stays the same, as it does in practice.
+ */
+void bench_interest() {
+    print_header("Interest management (host upload, " + std::to_string(INTEREST_TICKS) +
+                 " ticks, constant player density)");
+
+    std::cout << std::left << std::setw(10) << "players"
+              << std::setw(14) << "all B/tick"
+              << std::setw(18) << "interest B/tick"
+              << std::setw(10) << "ratio"
+              << std::setw(14) << "in view"
+              << std::setw(14) << "update us"
+              << "\n";
+
+    const auto host_id = reinterpret_cast<EOS_ProductUserId>(0xA);
+
+    for (uint32_t players : {16u, 32u, 64u, 128u}) {
+        float map_size = 128.0f * std::sqrt(static_cast<float>(players));
+        double bytes_per_tick[2] = {};
+        double update_us = 0.0;
+        double in_view = 0.0;
+
+        for (int filtered = 0; filtered < 2; filtered++) {
+            auto network = std::make_shared<LoopbackNetwork>(16384);
+            P2PManager host;
+            P2PConfig config;
+            config.ping_interval_ms = 0;
+            config.max_peers = players;
+            config.transport = network->create_endpoint(host_id);
+            host.initialize(config);
+
+            SnapshotReplicator sender(host);
+            uint8_t type = sender.register_type<BenchEntity>();
+            host.on_packet_view = [&](const PacketView& packet) { sender.handle_packet(packet); };
+
+            // Player 0 is the host; the rest are clients
+            std::vector<EOS_ProductUserId> ids(players);
+            std::vector<std::unique_ptr<P2PManager>> clients(players);
+            std::vector<std::unique_ptr<SnapshotReplicator>> receivers(players);
+            for (uint32_t i = 1; i < players; i++) {
+                ids[i] = reinterpret_cast<EOS_ProductUserId>(static_cast<uintptr_t>(0x1000 + i));
+                clients[i] = std::make_unique<P2PManager>();
+                config.transport = network->create_endpoint(ids[i]);
+                clients[i]->initialize(config);
+                receivers[i] = std::make_unique<SnapshotReplicator>(*clients[i]);
+                receivers[i]->register_type<BenchEntity>();
+                SnapshotReplicator* receiver = receivers[i].get();
+                clients[i]->on_packet_view = [receiver](const PacketView& packet) { receiver->handle_packet(packet); };
+                host.connect_to_peer(ids[i]);
+            }
+
+            InterestManager interest;
+            if (filtered) sender.set_interest(&interest);
+
+            // Same walk both runs: straight lines, bouncing off the map edge
+            std::vector<BenchEntity> world(players);
+            uint32_t seed = 12345;
+            auto random = [&seed]() {
+                seed = seed * 1664525u + 1013904223u;
+                return static_cast<float>(seed >> 8) / 16777216.0f;
+            };
+            for (auto& entity : world) {
+                entity = {{random() * map_size, random() * map_size, 0.0f},
+                          {random() * 10.0f - 5.0f, random() * 10.0f - 5.0f, 0.0f},
+                          {0.0f, 0.0f, 0.0f, 1.0f}, 100, 30, 0};
+            }
+
+            uint64_t bytes = 0;
+            for (uint32_t tick = 0; tick < INTEREST_TICKS; tick++) {
+                for (uint32_t i = 0; i < players; i++) {
+                    BenchEntity& entity = world[i];
+                    for (int axis = 0; axis < 2; axis++) {
+                        entity.position[axis] += entity.velocity[axis] / 60.0f;
+                        if (entity.position[axis] < 0.0f || entity.position[axis] > map_size) {
+                            entity.velocity[axis] = -entity.velocity[axis];
+                        }
+                    }
+                    sender.set_entity(static_cast<uint16_t>(i), type, entity);
+                    interest.set_entity(static_cast<uint16_t>(i), entity.position[0], entity.position[1]);
+                    if (i > 0) interest.set_peer(ids[i], entity.position[0], entity.position[1]);
+                }
+
+                if (filtered) {
+                    auto begin = Clock::now();
+                    interest.update();
+                    update_us += elapsed_ms(begin) * 1000.0;
+                    in_view += static_cast<double>(interest.get_stats().entries) / (players - 1);
+                }
+                sender.commit();
+
+                uint32_t sent = sender.broadcast();
+                if (tick > 0) bytes += sent;    // Leave out the full snapshots
+
+                for (uint32_t i = 1; i < players; i++) clients[i]->receive_packets(1000);
+                host.receive_packets(10000);
+            }
+            bytes_per_tick[filtered] = static_cast<double>(bytes) / (INTEREST_TICKS - 1);
+        }
+
+        std::cout << std::left << std::setw(10) << players
+                  << std::setw(14) << std::fixed << std::setprecision(0) << bytes_per_tick[0]
+                  << std::setw(18) << bytes_per_tick[1]
+                  << std::setw(10) << std::setprecision(2) << bytes_per_tick[0] / bytes_per_tick[1]
+                  << std::setw(14) << std::setprecision(1) << in_view / INTEREST_TICKS
+                  << std::setw(14) << std::setprecision(2) << update_us / INTEREST_TICKS
+                  << "\n";
+    }
+    std::cout << "(in view = average interest set size per client)\n";
+}
+
+// ============================================================================
+// Jitter buffer: push and interpolation cost with thousands of entities
+// ============================================================================
+
+struct BenchTransform {
+    Vec3 position;
+    Quat rotation;
+};
+
+BenchTransform interpolate_transform(const BenchTransform& from, const BenchTransform& to, float t) {
+    return {lerp(from.position, to.position, t), nlerp(from.rotation, to.rotation, t)};
+}
+
+constexpr uint32_t JITTER_SECONDS = 10;
+
+/**
+ * A client receiving 20 Hz snapshots with 0-60 ms of jitter and rendering
+ * at 144 Hz: cost of buffering each snapshot, and of interpolating every
+ * entity each frame.
+ */
+void bench_jitter() {
+    print_header("Jitter buffer (20 Hz snapshots, 144 Hz rendering, " + std::to_string(JITTER_SECONDS) + " s)");
+
+    std::cout << std::left << std::setw(10) << "entities"
+              << std::setw(14) << "push us"
+              << std::setw(16) << "sample_all us"
+              << std::setw(16) << "ns/entity"
+              << std::setw(14) << "delay ms"
+              << "extrapolated\n";
+
+    for (uint32_t count : {1000u, 4000u, 16000u}) {
+        JitterBuffer<BenchTransform> buffer(interpolate_transform);
+        std::vector<JitterBuffer<BenchTransform>::Entity> snapshot(count);
+        std::vector<JitterBuffer<BenchTransform>::Entity> rendered;
+        rendered.reserve(count);
+
+        uint32_t seed = 99;
+        auto jitter = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<uint64_t>(seed >> 8) % 60000;
+        };
+
+        std::vector<std::pair<uint64_t, uint64_t>> in_flight;   // Timestamp, arrival
+        const uint64_t frame_us = 1000000 / 144;
+        uint64_t next_send = 0;
+        double push_us = 0.0;
+        double sample_us = 0.0;
+        uint32_t pushes = 0;
+        uint32_t frames = 0;
+
+        for (uint64_t now = 0; now < JITTER_SECONDS * 1000000ull; now += frame_us) {
+            while (next_send <= now) {
+                in_flight.push_back({next_send, next_send + 20000 + jitter()});
+                next_send += 50000;
+            }
+
+            for (size_t i = 0; i < in_flight.size();) {
+                if (in_flight[i].second > now) {
+                    i++;
+                    continue;
+                }
+                float time = in_flight[i].first / 1e6f;
+                for (uint32_t e = 0; e < count; e++) {
+                    float angle = time * 0.5f + e;
+                    snapshot[e].id = static_cast<uint16_t>(e);
+                    snapshot[e].state.position = {std::cos(angle) * 50.0f, 0.0f, std::sin(angle) * 50.0f};
+                    snapshot[e].state.rotation = {0.0f, std::sin(angle * 0.5f), 0.0f, std::cos(angle * 0.5f)};
+                }
+
+                auto begin = Clock::now();
+                buffer.push(in_flight[i].first, now, snapshot.data(), count);
+                push_us += elapsed_ms(begin) * 1000.0;
+                pushes++;
+
+                in_flight[i] = in_flight.back();
+                in_flight.pop_back();
+            }
+
+            auto begin = Clock::now();
+            uint64_t render_time = buffer.advance(now);
+            buffer.sample_all(render_time, rendered);
+            sample_us += elapsed_ms(begin) * 1000.0;
+            frames++;
+            g_sink += rendered.size();
+        }
+
+        JitterStats stats = buffer.get_stats();
+        double per_frame = sample_us / frames;
+        std::cout << std::left << std::setw(10) << count
+                  << std::setw(14) << std::fixed << std::setprecision(1) << push_us / pushes
+                  << std::setw(16) << per_frame
+                  << std::setw(16) << std::setprecision(2) << per_frame * 1000.0 / count
+                  << std::setw(14) << std::setprecision(1) << stats.delay_us / 1000.0
+                  << std::setprecision(1) << 100.0 * stats.frames_extrapolated / stats.frames_rendered << "%\n";
+    }
+}
+
+// ============================================================================
+// Congestion control: flooding a narrow link with and without it
+// ============================================================================
+
+constexpr uint32_t CONGESTION_RUN_MS = 3000;
+
+void bench_congestion() {
+    print_header("Congestion control (1000 B unreliable at 4 MB/s into a capped link, " +
+                 std::to_string(CONGESTION_RUN_MS / 1000) + " s)");
+
+    std::cout << std::left << std::setw(10) << "link"
+              << std::setw(8) << "mode"
+              << std::setw(14) << "delivered"
+              << std::setw(14) << "link drops"
+              << std::setw(12) << "rtt"
+              << std::setw(12) << "rate"
+              << "\n";
+
+    const auto id_a = reinterpret_cast<EOS_ProductUserId>(0xA);
+    const auto id_b = reinterpret_cast<EOS_ProductUserId>(0xB);
+    uint8_t message[1000] = {};
+
+    for (uint32_t kbps : {400u, 2000u}) {
+        for (int controlled = 0; controlled < 2; controlled++) {
+            auto network = std::make_shared<LoopbackNetwork>(16384);
+            P2PManager a;
+            P2PManager b;
+
+            P2PConfig config;
+            config.ping_interval_ms = 100;
+            config.congestion_control = controlled != 0;
+            config.transport = network->create_endpoint(id_a);
+            a.initialize(config);
+            config.congestion_control = false;
+            config.network_conditions.latency_ms = 20;
+            config.network_conditions.bandwidth_kbps = kbps;
+            config.transport = network->create_endpoint(id_b);
+            b.initialize(config);
+            a.connect_to_peer(id_b);
+            b.connect_to_peer(id_a);
+
+            uint64_t delivered = 0;
+            b.on_packet_view = [&](const PacketView& packet) {
+                if (packet.channel == 0) delivered += packet.size;
+            };
+
+            // Four packets per 1 ms frame; RTT is averaged over the second half
+            auto begin = Clock::now();
+            double rtt_sum = 0.0;
+            uint32_t rtt_samples = 0;
+            for (uint32_t frame = 0; Clock::now() - begin < std::chrono::milliseconds(CONGESTION_RUN_MS); frame++) {
+                for (int i = 0; i < 4; i++) a.send_packet(id_b, message, sizeof(message), 0);
+                a.tick();
+                b.receive_packets(1000);
+                b.tick();
+                a.receive_packets(1000);
+                if (frame % 50 == 0 && Clock::now() - begin > std::chrono::milliseconds(CONGESTION_RUN_MS / 2)) {
+                    rtt_sum += a.get_peer_connection(id_b)->rtt_ms;
+                    rtt_samples++;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            double seconds = elapsed_ms(begin) / 1000.0;
+
+            NetworkSimulatorStats link = b.get_network_simulator_stats();
+            auto congestion = a.get_congestion_stats(id_b);
+            std::cout << std::left << std::setw(10) << (std::to_string(kbps) + " kbps")
+                      << std::setw(8) << (controlled ? "aimd" : "off")
+                      << std::setw(14) << (std::to_string(static_cast<int>(delivered / 1024 / seconds)) + " KB/s")
+                      << std::setw(14) << (std::to_string(link.received ? link.bandwidth_dropped * 100 / link.received : 0) + "%")
+                      << std::setw(12) << (std::to_string(static_cast<int>(rtt_sum / std::max(rtt_samples, 1u))) + " ms")
+                      << std::setw(12) << (congestion ? std::to_string(congestion->rate_bytes_per_second / 1024) + " KB/s" : "-")
+                      << "\n";
+        }
+    }
+    std::cout << "(link drops = packets the bottleneck's 200 ms queue turned away)\n";
+}
+
+// ============================================================================
+// Backpressure: a sender that keeps queueing vs one that backs off
+// ============================================================================
+
+constexpr uint32_t BACKPRESSURE_RUN_MS = 2000;
+
+void bench_backpressure() {
+    print_header("Backpressure (1000 B updates at 4 MB/s, 40 KB/s send budget, 20 ms link, " +
+                 std::to_string(BACKPRESSURE_RUN_MS / 1000) + " s)");
+
+    std::cout << std::left << std::setw(12) << "high-water"
+              << std::setw(14) << "delivered"
+              << std::setw(14) << "update age"
+              << std::setw(12) << "rejected"
+              << std::setw(12) << "expired"
+              << "\n";
+
+    const auto id_a = reinterpret_cast<EOS_ProductUserId>(0xA);
+    const auto id_b = reinterpret_cast<EOS_ProductUserId>(0xB);
+    uint8_t message[1000] = {};
+
+    for (uint32_t high_water : {0u, 2048u, 512u}) {
+        auto network = std::make_shared<LoopbackNetwork>(16384);
+        P2PManager a;
+        P2PManager b;
+
+        P2PConfig config;
+        config.ping_interval_ms = 0;
+        config.send_budget_bytes_per_second = 40 * 1024;
+        config.send_high_water_bytes = high_water;
+        config.transport = network->create_endpoint(id_a);
+        a.initialize(config);
+        config = P2PConfig();
+        config.ping_interval_ms = 0;
+        config.network_conditions.latency_ms = 20;
+        config.transport = network->create_endpoint(id_b);
+        b.initialize(config);
+        a.connect_to_peer(id_b);
+        b.connect_to_peer(id_a);
+
+        // Updates carry their send time; age is measured on arrival, over
+        // the second half so the queue has settled
+        auto begin = Clock::now();
+        uint64_t delivered = 0;
+        double age_sum = 0.0;
+        b.on_packet_view = [&](const PacketView& packet) {
+            if (packet.channel != 0 || packet.size < sizeof(double)) return;
+            double now_ms = elapsed_ms(begin);
+            if (now_ms < BACKPRESSURE_RUN_MS / 2) return;
+            double sent_ms = 0.0;
+            std::memcpy(&sent_ms, packet.data, sizeof(sent_ms));
+            age_sum += now_ms - sent_ms;
+            delivered++;
+        };
+
+        uint64_t rejected = 0;
+        while (Clock::now() - begin < std::chrono::milliseconds(BACKPRESSURE_RUN_MS)) {
+            for (int i = 0; i < 4; i++) {
+                double now_ms = elapsed_ms(begin);
+                std::memcpy(message, &now_ms, sizeof(now_ms));
+                if (a.send_packet(id_b, message, sizeof(message), 0).status == SendStatus::Rejected) rejected++;
+            }
+            a.tick();
+            b.receive_packets(1000);
+            b.tick();
+            a.receive_packets(1000);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double seconds = (elapsed_ms(begin) - BACKPRESSURE_RUN_MS / 2) / 1000.0;
+
+        auto queue = a.get_send_queue_stats(id_b);
+        std::cout << std::left << std::setw(12) << (high_water ? std::to_string(high_water) + " B" : "off")
+                  << std::setw(14) << (std::to_string(static_cast<int>(delivered * sizeof(message) / 1024 / seconds)) + " KB/s")
+                  << std::setw(14) << (std::to_string(static_cast<int>(age_sum / std::max<uint64_t>(delivered, 1))) + " ms")
+                  << std::setw(12) << rejected
+                  << std::setw(12) << (queue ? queue->frames_dropped : 0)
+                  << "\n";
+    }
+    std::cout << "(expired = queued updates dropped after waiting 100 ms for budget)\n";
+}
+
+// ============================================================================
+// Sockets: gameplay behind bulk bursts, one drain vs per-socket drains
+// ============================================================================
+
+constexpr uint32_t SOCKETS_RUN_MS = 1000;
+
+void bench_sockets() {
+    print_header("Sockets (1 gameplay update per frame, 1000 x 1000 B bulk every 100 frames, "
+                 "64 packets drained per frame, " + std::to_string(SOCKETS_RUN_MS / 1000) + " s)");
+
+    std::cout << std::left << std::setw(20) << "drain"
+              << std::setw(14) << "update age"
+              << std::setw(14) << "worst age"
+              << std::setw(14) << "bulk"
+              << "\n";
+
+    const auto id_a = reinterpret_cast<EOS_ProductUserId>(0xA);
+    const auto id_b = reinterpret_cast<EOS_ProductUserId>(0xB);
+    uint8_t update[64] = {};
+    uint8_t chunk[1000] = {};
+
+    for (bool per_socket : {false, true}) {
+        auto network = std::make_shared<LoopbackNetwork>(65536);
+        P2PManager a;
+        P2PManager b;
+
+        SocketConfig bulk_socket;
+        bulk_socket.name = "bulk";
+        bulk_socket.default_reliability = PacketReliability::ReliableOrdered;
+
+        P2PConfig config;
+        config.ping_interval_ms = 0;
+        config.sockets.push_back(bulk_socket);
+        config.transport = network->create_endpoint(id_a);
+        a.initialize(config);
+        config.transport = network->create_endpoint(id_b);
+        b.initialize(config);
+        a.connect_to_peer(id_b);
+        b.connect_to_peer(id_a);
+        uint8_t bulk = *a.get_socket_index("bulk");
+
+        // Updates carry their send time; age is measured on arrival
+        auto begin = Clock::now();
+        uint64_t updates = 0;
+        uint64_t bulk_received = 0;
+        double age_sum = 0.0;
+        double worst_age = 0.0;
+        b.on_packet_view = [&](const PacketView& packet) {
+            if (packet.socket == bulk) {
+                bulk_received++;
+                return;
+            }
+            if (packet.size < sizeof(double)) return;
+            double sent_ms = 0.0;
+            std::memcpy(&sent_ms, packet.data, sizeof(sent_ms));
+            double age = elapsed_ms(begin) - sent_ms;
+            age_sum += age;
+            worst_age = std::max(worst_age, age);
+            updates++;
+        };
+
+        uint32_t frame = 0;
+        while (Clock::now() - begin < std::chrono::milliseconds(SOCKETS_RUN_MS)) {
+            if (frame++ % 100 == 0) {
+                for (int i = 0; i < 1000; i++) a.send_on_socket(bulk, id_b, chunk, sizeof(chunk));
+            }
+            double now_ms = elapsed_ms(begin);
+            std::memcpy(update, &now_ms, sizeof(now_ms));
+            a.send_packet(id_b, update, sizeof(update));
+            a.tick();
+
+            // Same budget either way; per socket, gameplay goes first and
+            // bulk gets what is left
+            if (per_socket) {
+                uint32_t taken = b.receive_packets(64, socket_bit(0));
+                b.receive_packets(64 - std::min(taken, 64u), socket_bit(bulk));
+            } else {
+                b.receive_packets(64);
+            }
+            b.tick();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double seconds = elapsed_ms(begin) / 1000.0;
+
+        std::cout << std::left << std::setw(20) << (per_socket ? "gameplay, then bulk" : "all sockets")
+                  << std::setw(14) << (std::to_string(static_cast<int>(age_sum / std::max<uint64_t>(updates, 1))) + " ms")
+                  << std::setw(14) << (std::to_string(static_cast<int>(worst_age)) + " ms")
+                  << std::setw(14) << (std::to_string(static_cast<int>(bulk_received * sizeof(chunk) / 1024 / seconds)) + " KB/s")
+                  << "\n";
+    }
+    std::cout << "(per socket, a burst waits in the bulk receive queue instead of ahead of updates)\n";
+}
+
+// ============================================================================
+// Serialization: raw struct memcpy vs bit-packed fields
+// ============================================================================
+
+struct RawPlayerUpdate {
+    uint32_t tick;
+    float position[3];
+    float velocity[3];
+    float rotation[4];
+    uint16_t health;
+    uint8_t flags;
+};
+
+constexpr uint32_t SERIALIZE_MESSAGES = 2000000;
+
+// Position +/-512 m at ~4 mm, velocity +/-32 m/s, 10-bit smallest-three rotation
+uint32_t pack_update(const RawPlayerUpdate& update, uint8_t* out, uint32_t capacity) {
+    BitWriter writer(out, capacity);
+    writer.write_varint(update.tick);
+    writer.write_vec3({update.position[0], update.position[1], update.position[2]}, -512.0f, 512.0f, 18);
+    writer.write_vec3({update.velocity[0], update.velocity[1], update.velocity[2]}, -32.0f, 32.0f, 12);
+    writer.write_quat({update.rotation[0], update.rotation[1], update.rotation[2], update.rotation[3]}, 10);
+    writer.write_int(update.health, 0, 200);
+    writer.write_bits(update.flags, 8);
+    return writer.finish();
+}
+
+bool unpack_update(const uint8_t* data, uint32_t size, RawPlayerUpdate& update) {
+    BitReader reader(data, size);
+    update.tick = reader.read_varint();
+    Vec3 position = reader.read_vec3(-512.0f, 512.0f, 18);
+    Vec3 velocity = reader.read_vec3(-32.0f, 32.0f, 12);
+    Quat rotation = reader.read_quat(10);
+    update.position[0] = position.x;
+    update.position[1] = position.y;
+    update.position[2] = position.z;
+    update.velocity[0] = velocity.x;
+    update.velocity[1] = velocity.y;
+    update.velocity[2] = velocity.z;
+    update.rotation[0] = rotation.x;
+    update.rotation[1] = rotation.y;
+    update.rotation[2] = rotation.z;
+    update.rotation[3] = rotation.w;
+    update.health = static_cast<uint16_t>(reader.read_int(0, 200));
+    update.flags = static_cast<uint8_t>(reader.read_bits(8));
+    return !reader.overflowed();
+}
+
+void bench_serialize() {
+    print_header("Serialization (" + std::to_string(SERIALIZE_MESSAGES) + " player updates)");
+
+    // A spread of realistic updates, cycled through
+    std::vector<RawPlayerUpdate> updates(1024);
+    uint32_t seed = 7;
+    auto random_unit = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (uint32_t i = 0; i < updates.size(); i++) {
+        RawPlayerUpdate& update = updates[i];
+        update.tick = 100000 + i;
+        for (int axis = 0; axis < 3; axis++) {
+            update.position[axis] = random_unit() * 1000.0f - 500.0f;
+            update.velocity[axis] = random_unit() * 20.0f - 10.0f;
+        }
+        float yaw = random_unit() * 6.2831853f;
+        update.rotation[0] = 0.0f;
+        update.rotation[1] = std::sin(yaw / 2.0f);
+        update.rotation[2] = 0.0f;
+        update.rotation[3] = std::cos(yaw / 2.0f);
+        update.health = static_cast<uint16_t>(random_unit() * 200.0f);
+        update.flags = static_cast<uint8_t>(seed);
+    }
+
+    uint8_t wire[64];
+    RawPlayerUpdate decoded;
+
+    auto begin = Clock::now();
+    for (uint32_t i = 0; i < SERIALIZE_MESSAGES; i++) {
+        std::memcpy(wire, &updates[i & 1023], sizeof(RawPlayerUpdate));
+        g_sink += wire[i & 31];
+    }
+    double raw_encode_ms = elapsed_ms(begin);
+
+    begin = Clock::now();
+    for (uint32_t i = 0; i < SERIALIZE_MESSAGES; i++) {
+        wire[0] = static_cast<uint8_t>(i);
+        std::memcpy(&decoded, wire, sizeof(RawPlayerUpdate));
+        g_sink += decoded.tick;
+    }
+    double raw_decode_ms = elapsed_ms(begin);
+
+    uint32_t packed_size = 0;
+    begin = Clock::now();
+    for (uint32_t i = 0; i < SERIALIZE_MESSAGES; i++) {
+        packed_size = pack_update(updates[i & 1023], wire, sizeof(wire));
+        g_sink += wire[i & 15];
+    }
+    double packed_encode_ms = elapsed_ms(begin);
+
+    // Decode a different message each time so the work can't be hoisted
+    std::vector<std::vector<uint8_t>> encoded(updates.size());
+    float worst_error = 0.0f;
+    for (uint32_t i = 0; i < updates.size(); i++) {
+        uint32_t size = pack_update(updates[i], wire, sizeof(wire));
+        encoded[i].assign(wire, wire + size);
+        unpack_update(wire, size, decoded);
+        for (int axis = 0; axis < 3; axis++) {
+            worst_error = std::max(worst_error, std::fabs(decoded.position[axis] - updates[i].position[axis]));
+        }
+    }
+
+    begin = Clock::now();
+    for (uint32_t i = 0; i < SERIALIZE_MESSAGES; i++) {
+        const auto& message = encoded[i & 1023];
+        g_sink += unpack_update(message.data(), static_cast<uint32_t>(message.size()), decoded);
+        g_sink += decoded.tick;
+    }
+    double packed_decode_ms = elapsed_ms(begin);
+
+    auto per_message_ns = [](double ms) { return ms * 1e6 / SERIALIZE_MESSAGES; };
+    std::cout << std::left << std::setw(14) << "format"
+              << std::setw(10) << "bytes"
+              << std::setw(14) << "encode ns"
+              << std::setw(14) << "decode ns"
+              << "64 players @ 60 Hz\n";
+    std::cout << std::left << std::setw(14) << "raw struct"
+              << std::setw(10) << sizeof(RawPlayerUpdate)
+              << std::setw(14) << std::fixed << std::setprecision(1) << per_message_ns(raw_encode_ms)
+              << std::setw(14) << per_message_ns(raw_decode_ms)
+              << sizeof(RawPlayerUpdate) * 64 * 60 * 8 / 1000 << " kbps\n";
+    std::cout << std::left << std::setw(14) << "bit-packed"
+              << std::setw(10) << packed_size
+              << std::setw(14) << per_message_ns(packed_encode_ms)
+              << std::setw(14) << per_message_ns(packed_decode_ms)
+              << packed_size * 64 * 60 * 8 / 1000 << " kbps\n";
+    std::cout << "\nWorst position error: " << std::setprecision(4) << worst_error * 1000.0f << " mm\n";
+}
+
+// ============================================================================
+// Compression: none vs fast LZ vs LZ with a trained dictionary
+// ============================================================================
+
+const uint32_t COMPRESSION_MESSAGES = 2000;
+const uint32_t COMPRESSION_ROUNDS = 50;
+
+std::string make_chat_json(uint32_t i) {
+    static const char* const LINES[] = {"gg", "nice shot!", "rotate to B", "need healing over here",
+                                        "push now", "wp all", "anyone have ammo?", "watch the left flank"};
+    return "{\"type\":\"chat\",\"channel\":\"team\",\"sender\":\"Player" + std::to_string(i * 7 % 64) +
+           "\",\"text\":\"" + LINES[i * 13 % 8] + "\",\"timestamp\":" + std::to_string(1700000000 + i * 37) + "}";
+}
+
+// Lobby attribute sync: the same keys every time, different values
+std::string make_lobby_json(uint32_t i) {
+    static const char* const MAPS[] = {"harbor", "refinery", "canyon", "skyline"};
+    static const char* const MODES[] = {"deathmatch", "capture_the_flag", "king_of_the_hill"};
+    std::string text = "{\"lobby_id\":\"" + std::to_string(0x5f3a0000u + i) + "\",\"map\":\"" + MAPS[i % 4] +
+                       "\",\"game_mode\":\"" + MODES[i % 3] + "\",\"max_players\":16,\"region\":\"eu-west\",\"members\":[";
+    for (uint32_t m = 0; m < 1 + i % 6; m++) {
+        if (m) text += ",";
+        text += "{\"user_id\":\"" + std::to_string(9000 + (i * 31 + m * 17) % 500) + "\",\"ready\":" +
+                (((i + m) & 1) ? "true" : "false") + ",\"team\":" + std::to_string(m % 2) + "}";
+    }
+    return text + "]}";
+}
+
+void bench_compression() {
+    print_header("Compression (" + std::to_string(COMPRESSION_MESSAGES) + " messages x " +
+                 std::to_string(COMPRESSION_ROUNDS) + " rounds)");
+
+    struct Workload {
+        const char* name;
+        std::string (*make)(uint32_t);
+    };
+    const Workload workloads[] = {{"chat", make_chat_json}, {"lobby", make_lobby_json}};
+
+    std::cout << std::left << std::setw(8) << "payload"
+              << std::setw(12) << "mode"
+              << std::setw(12) << "avg bytes"
+              << std::setw(10) << "ratio"
+              << std::setw(16) << "compress MB/s"
+              << "decompress MB/s\n";
+
+    std::vector<uint8_t> compressed(4096);
+    std::vector<uint8_t> restored(4096);
+    for (const Workload& workload : workloads) {
+        // Train on one capture, measure on another
+        std::vector<std::vector<uint8_t>> training;
+        std::vector<std::vector<uint8_t>> messages;
+        for (uint32_t i = 0; i < COMPRESSION_MESSAGES; i++) {
+            std::string text = workload.make(i);
+            training.emplace_back(text.begin(), text.end());
+            text = workload.make(i + 100000);
+            messages.emplace_back(text.begin(), text.end());
+        }
+        CompressionDictionary dictionary = CompressionDictionary::train(training);
+
+        uint64_t input_bytes = 0;
+        for (const auto& message : messages) input_bytes += message.size();
+        std::cout << std::left << std::setw(8) << workload.name
+                  << std::setw(12) << "none"
+                  << std::setw(12) << input_bytes / messages.size()
+                  << std::setw(10) << "1.00"
+                  << std::setw(16) << "-" << "-\n";
+
+        for (CompressionMode mode : {CompressionMode::Fast, CompressionMode::Dictionary}) {
+            const CompressionDictionary* dict = mode == CompressionMode::Dictionary ? &dictionary : nullptr;
+
+            uint64_t output_bytes = 0;
+            auto begin = Clock::now();
+            for (uint32_t round = 0; round < COMPRESSION_ROUNDS; round++) {
+                for (const auto& message : messages) {
+                    uint32_t size = lz_compress(message.data(), static_cast<uint32_t>(message.size()),
+                                                compressed.data(), static_cast<uint32_t>(compressed.size()), dict);
+                    if (round == 0) output_bytes += size;
+                    g_sink += size;
+                }
+            }
+            double compress_ms = elapsed_ms(begin);
+
+            // Decode real output, one message at a time
+            std::vector<std::vector<uint8_t>> encoded;
+            for (const auto& message : messages) {
+                uint32_t size = lz_compress(message.data(), static_cast<uint32_t>(message.size()),
+                                            compressed.data(), static_cast<uint32_t>(compressed.size()), dict);
+                encoded.emplace_back(compressed.begin(), compressed.begin() + size);
+            }
+            begin = Clock::now();
+            for (uint32_t round = 0; round < COMPRESSION_ROUNDS; round++) {
+                for (const auto& message : encoded) {
+                    g_sink += lz_decompress(message.data(), static_cast<uint32_t>(message.size()),
+                                            restored.data(), static_cast<uint32_t>(restored.size()), dict);
+                }
+            }
+            double decompress_ms = elapsed_ms(begin);
+
+            double megabytes = static_cast<double>(input_bytes) * COMPRESSION_ROUNDS / 1e6;
+            std::cout << std::left << std::setw(8) << workload.name
+                      << std::setw(12) << (dict ? "dictionary" : "fast")
+                      << std::setw(12) << output_bytes / messages.size()
+                      << std::setw(10) << std::fixed << std::setprecision(2)
+                      << static_cast<double>(input_bytes) / output_bytes
+                      << std::setw(16) << std::setprecision(0) << megabytes / (compress_ms / 1000.0)
+                      << megabytes / (decompress_ms / 1000.0) << "\n";
+        }
+        std::cout << std::left << std::setw(8) << "" << "dictionary " << dictionary.content().size() << " bytes\n";
+    }
+}
+
+// ============================================================================
+// UDP: kernel socket costs, one syscall per datagram vs sendmmsg/recvmmsg
+// ============================================================================
+
+constexpr uint32_t UDP_MESSAGE_SIZE = 16 * 1024;   // 15 fragments
+constexpr uint32_t UDP_MESSAGES = 2000;
+constexpr uint32_t UDP_ROUND_TRIPS = 10000;
+
+void bench_udp() {
+    print_header("UDP localhost (" + std::to_string(UDP_MESSAGES) + " x " +
+                 std::to_string(UDP_MESSAGE_SIZE / 1024) + " KB messages)");
+
+    std::cout << std::left << std::setw(8) << "batch"
+              << std::setw(14) << "throughput"
+              << std::setw(16) << "sends/datagram"
+              << std::setw(16) << "recvs/datagram"
+              << "\n";
+
+    std::vector<uint8_t> message(UDP_MESSAGE_SIZE, 0x5A);
+
+    for (uint32_t batch_size : {1u, 8u, 32u, 64u}) {
+        auto transport_a = std::make_shared<UdpTransport>(0, 1170, batch_size);
+        auto transport_b = std::make_shared<UdpTransport>(0, 1170, batch_size);
+        P2PManager a;
+        P2PManager b;
+
+        P2PConfig config;
+        config.ping_interval_ms = 0;
+        config.transport = transport_a;
+        a.initialize(config);
+        config.transport = transport_b;
+        b.initialize(config);
+
+        EOS_ProductUserId id_b = transport_b->local_user_id();
+        a.connect_to_peer(id_b);
+
+        uint32_t delivered = 0;
+        b.on_packet_view = [&](const PacketView&) { delivered++; };
+
+        // A few messages at a time so the socket buffer never overflows
+        auto begin = Clock::now();
+        for (uint32_t sent = 0; sent < UDP_MESSAGES; sent += 4) {
+            for (uint32_t i = 0; i < 4; i++) {
+                a.send_packet(id_b, message.data(), UDP_MESSAGE_SIZE, 0, PacketReliability::ReliableOrdered);
+            }
+            while (b.receive_packets(1024) > 0) {}
+        }
+        double ms = elapsed_ms(begin);
+        g_sink = delivered;
+
+        uint32_t chunk = 1170 - 11;
+        double datagrams = static_cast<double>(UDP_MESSAGES) * ((UDP_MESSAGE_SIZE + chunk - 1) / chunk);
+        double mb_per_s = static_cast<double>(UDP_MESSAGES) * UDP_MESSAGE_SIZE / (ms / 1000.0) / (1024.0 * 1024.0);
+
+        std::cout << std::left << std::setw(8) << batch_size
+                  << std::setw(14) << (std::to_string(static_cast<int>(mb_per_s)) + " MB/s")
+                  << std::setw(16) << std::fixed << std::setprecision(3)
+                  << transport_a->get_send_call_count() / datagrams
+                  << std::setw(16) << transport_b->get_receive_call_count() / datagrams
+                  << "\n";
+        if (delivered != UDP_MESSAGES) {
+            std::cout << "  (" << UDP_MESSAGES - delivered << " messages lost)\n";
+        }
+    }
+
+    // Round trip: A sends, B echoes from its callback, A receives
+    auto transport_a = std::make_shared<UdpTransport>(0);
+    auto transport_b = std::make_shared<UdpTransport>(0);
+    P2PManager a;
+    P2PManager b;
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = transport_a;
+    a.initialize(config);
+    config.transport = transport_b;
+    b.initialize(config);
+
+    EOS_ProductUserId id_b = transport_b->local_user_id();
+    a.connect_to_peer(id_b);
+
+    b.on_packet_view = [&](const PacketView& packet) {
+        b.send_packet(packet.sender, packet.data, packet.size);
+    };
+    bool replied = false;
+    a.on_packet_view = [&](const PacketView&) { replied = true; };
+
+    uint8_t ping[64] = {};
+    auto begin = Clock::now();
+    for (uint32_t i = 0; i < UDP_ROUND_TRIPS; i++) {
+        replied = false;
+        a.send_packet(id_b, ping, sizeof(ping));
+        while (!replied) {
+            b.receive_packets();
+            a.receive_packets();
+        }
+    }
+    double ms = elapsed_ms(begin);
+
+    std::cout << "\nRound trip (64 B): " << std::fixed << std::setprecision(2)
+              << ms * 1000.0 / UDP_ROUND_TRIPS << " us\n";
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+int main(int argc, char* argv[]) {
+    const Benchmark benchmarks[] = {
+        {"queue", bench_incoming_queue},
+        {"send", bench_send_setup},
+        {"broadcast", bench_broadcast},
+        {"peers", bench_peer_lookup},
+        {"loopback", bench_loopback},
+        {"reliability", bench_reliability},
+        {"snapshot", bench_snapshot},
+        {"interest", bench_interest},
+        {"jitter", bench_jitter},
+        {"congestion", bench_congestion},
+        {"backpressure", bench_backpressure},
+        {"sockets", bench_sockets},
+        {"serialize", bench_serialize},
+        {"compression", bench_compression},
+        {"udp", bench_udp},
+    };
+
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    bool ran_any = false;
+
+    for (const auto& benchmark : benchmarks) {
+        if (filter && std::strcmp(filter, benchmark.name) != 0) continue;
+        benchmark.run();
+        ran_any = true;
+    }
+
+    if (!ran_any) {
+        std::cout << "Unknown benchmark '" << filter << "'. Available:";
+        for (const auto& benchmark : benchmarks) std::cout << " " << benchmark.name;
+        std::cout << "\n";
+        return 1;
+    }
+
+    return 0;
+}
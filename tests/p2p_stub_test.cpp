@@ -0,0 +1,2403 @@
+/**
+ * EOS Testing - P2P Stub-Mode Test
+ *
+ * Self-checking test of the P2P send/receive pipeline. Runs without
+ * credentials: stub_loopback delivers every sent packet back to us,
+ * LoopbackNetwork connects several P2PManagers in-process, and
+ * UdpTransport connects them over localhost sockets.
+ *
+ * Usage: eos_p2p_stub_test   (exit code 0 = all checks passed)
+ */
+
+#include "eos_testing/core/platform.hpp"
+#include "eos_testing/auth/auth_manager.hpp"
+#include "eos_testing/p2p/p2p_manager.hpp"
+#include "eos_testing/p2p/bit_stream.hpp"
+#include "eos_testing/p2p/compression.hpp"
+#include "eos_testing/p2p/congestion_controller.hpp"
+#include "eos_testing/p2p/interest_manager.hpp"
+#include "eos_testing/p2p/jitter_buffer.hpp"
+#include "eos_testing/p2p/loopback_transport.hpp"
+#include "eos_testing/p2p/network_simulator.hpp"
+#include "eos_testing/p2p/packet_capture.hpp"
+#include "eos_testing/p2p/ring_queue.hpp"
+#include "eos_testing/p2p/send_scheduler.hpp"
+#include "eos_testing/p2p/snapshot_replicator.hpp"
+#include "eos_testing/p2p/time_sync.hpp"
+#include "eos_testing/p2p/udp_transport.hpp"
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+using namespace eos_testing;
+
+static int g_failures = 0;
+
+// Allocations made by this thread, for checking allocation-free paths.
+// Every plain, array and nothrow form is replaced, so whatever new the
+// library picks is paired with a matching delete (sanitizers check this).
+thread_local uint64_t t_allocations = 0;
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    t_allocations++;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new(std::size_t size) {
+    if (void* memory = operator new(size, std::nothrow)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            std::cout << "  FAILED: " #condition " (line " << __LINE__ << ")\n"; \
+            g_failures++;                                                   \
+        }                                                                   \
+    } while (0)
+
+void print_header(const std::string& title) {
+    std::cout << "\n========================================\n";
+    std::cout << "  " << title << "\n";
+    std::cout << "========================================\n\n";
+}
+
+const EOS_ProductUserId PEER = reinterpret_cast<EOS_ProductUserId>(0x1001);
+const EOS_ProductUserId ENDPOINT_A = reinterpret_cast<EOS_ProductUserId>(0x2001);
+const EOS_ProductUserId ENDPOINT_B = reinterpret_cast<EOS_ProductUserId>(0x2002);
+const EOS_ProductUserId ENDPOINT_C = reinterpret_cast<EOS_ProductUserId>(0x2003);
+
+std::vector<uint8_t> make_payload(uint32_t size, uint32_t seed) {
+    std::vector<uint8_t> payload(size);
+    uint32_t state = seed;
+    for (auto& byte : payload) {
+        state = state * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(state >> 24);
+    }
+    return payload;
+}
+
+/**
+ * Bring P2P up with loopback on and one connected stub peer.
+ */
+void start_p2p(P2PConfig config) {
+    auto& p2p = P2PManager::instance();
+    p2p.shutdown();
+    p2p.on_packet_received = nullptr;
+    p2p.on_packet_view = nullptr;
+
+    config.stub_loopback = true;
+    CHECK(p2p.initialize(config));
+    p2p.connect_to_peer(PEER);
+}
+
+// ============================================================================
+// Fragmentation
+// ============================================================================
+
+void test_fragmentation() {
+    print_header("Fragmentation: 1 MB reliable payloads");
+
+    P2PConfig config;
+    config.incoming_queue_capacity = 2048;
+    config.packet_pool_slabs = 2048;
+    start_p2p(config);
+
+    auto& p2p = P2PManager::instance();
+    std::vector<std::vector<uint8_t>> received;
+    p2p.on_packet_view = [&](const PacketView& packet) {
+        received.emplace_back(packet.data, packet.data + packet.size);
+    };
+
+    const uint32_t ONE_MB = 1024 * 1024;
+    for (uint32_t i = 0; i < 3; i++) {
+        auto payload = make_payload(ONE_MB, i + 1);
+        auto reliability = (i % 2 == 0) ? PacketReliability::ReliableOrdered
+                                        : PacketReliability::ReliableUnordered;
+
+        received.clear();
+        CHECK(p2p.send_packet(PEER, payload.data(), ONE_MB, 1, reliability));
+        while (p2p.receive_packets(1000) > 0) {}
+
+        CHECK(received.size() == 1);
+        CHECK(!received.empty() && received[0] == payload);
+    }
+
+    std::cout << "Unreliable oversize send is still rejected\n";
+    auto payload = make_payload(4096, 7);
+    CHECK(!p2p.send_packet(PEER, payload.data(), 4096, 0, PacketReliability::UnreliableUnordered));
+
+    CHECK(p2p.get_dropped_packet_count() == 0);
+}
+
+void test_reassembly_budget() {
+    print_header("Fragmentation: per-peer reassembly budget");
+
+    P2PConfig config;
+    config.incoming_queue_capacity = 2048;
+    config.packet_pool_slabs = 2048;
+    config.max_reassembly_bytes_per_peer = 256 * 1024;
+    start_p2p(config);
+
+    auto& p2p = P2PManager::instance();
+    uint32_t delivered = 0;
+    p2p.on_packet_view = [&](const PacketView&) { delivered++; };
+
+    auto too_big = make_payload(1024 * 1024, 3);
+    CHECK(p2p.send_packet(PEER, too_big.data(), 1024 * 1024, 1, PacketReliability::ReliableOrdered));
+    while (p2p.receive_packets(1000) > 0) {}
+    CHECK(delivered == 0);
+
+    auto fits = make_payload(200 * 1024, 4);
+    CHECK(p2p.send_packet(PEER, fits.data(), 200 * 1024, 1, PacketReliability::ReliableOrdered));
+    while (p2p.receive_packets(1000) > 0) {}
+    CHECK(delivered == 1);
+}
+
+// ============================================================================
+// Batching
+// ============================================================================
+
+void test_batching() {
+    print_header("Batching: coalesced sends split on receive");
+
+    start_p2p(P2PConfig{});
+
+    auto& p2p = P2PManager::instance();
+    std::vector<uint32_t> received;
+    p2p.on_packet_view = [&](const PacketView& packet) {
+        uint32_t value = 0;
+        CHECK(packet.size == sizeof(value));
+        std::memcpy(&value, packet.data, sizeof(value));
+        received.push_back(value);
+    };
+
+    for (uint32_t i = 0; i < 1000; i++) {
+        CHECK(p2p.queue_packet(PEER, &i, sizeof(i)));
+    }
+    p2p.tick();
+
+    uint32_t wire_packets = p2p.receive_packets(1000);
+    std::cout << "1000 messages arrived in " << wire_packets << " packets\n";
+    CHECK(wire_packets < 10);
+    CHECK(received.size() == 1000);
+    for (uint32_t i = 0; i < received.size(); i++) {
+        CHECK(received[i] == i);
+    }
+
+    // Messages still batched for a peer that disconnects are discarded
+    received.clear();
+    uint32_t stale = 7;
+    CHECK(p2p.queue_packet(PEER, &stale, sizeof(stale)));
+    p2p.disconnect_from_peer(PEER);
+    p2p.tick();
+    CHECK(p2p.receive_packets(1000) == 0);
+    CHECK(received.empty());
+}
+
+// ============================================================================
+// Ring queue
+// ============================================================================
+
+void test_ring_queue() {
+    print_header("Ring queue: full queue, 4 producers into 1 consumer");
+
+    // Full: capacity rounds up to 8, the 9th push fails and leaves the
+    // value with the caller, and a pop makes room again
+    RingQueue<std::unique_ptr<uint32_t>> small(5);
+    CHECK(small.capacity() == 8);
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK(small.try_push(std::make_unique<uint32_t>(i)));
+    }
+    auto extra = std::make_unique<uint32_t>(8);
+    CHECK(!small.try_push(std::move(extra)));
+    CHECK(extra && *extra == 8);
+    CHECK(small.size_approx() == 8);
+
+    std::unique_ptr<uint32_t> popped;
+    CHECK(small.try_pop(popped) && popped && *popped == 0);
+    CHECK(small.try_push(std::move(extra)));
+    for (uint32_t i = 1; i <= 8; i++) {
+        CHECK(small.try_pop(popped) && popped && *popped == i);
+    }
+    CHECK(!small.try_pop(popped));
+    CHECK(small.size_approx() == 0);
+
+    // Several producers against a small queue, so it is full most of the
+    // time. Items carry (producer, sequence): each producer's items must
+    // come out exactly once and in the order it pushed them.
+    const uint32_t PRODUCERS = 4;
+    const uint32_t PER_PRODUCER = 200000;
+    RingQueue<uint64_t> queue(64);
+    std::atomic<uint64_t> full_pushes{0};
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < PRODUCERS; producer++) {
+        producers.emplace_back([&, producer] {
+            uint64_t full = 0;
+            for (uint32_t sequence = 0; sequence < PER_PRODUCER; sequence++) {
+                uint64_t item = (static_cast<uint64_t>(producer) << 32) | sequence;
+                while (!queue.try_push(std::move(item))) {
+                    full++;
+                    std::this_thread::yield();
+                }
+            }
+            full_pushes.fetch_add(full, std::memory_order_relaxed);
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint64_t received = 0;
+    uint64_t misordered = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (received < uint64_t(PRODUCERS) * PER_PRODUCER && std::chrono::steady_clock::now() < deadline) {
+        uint64_t item = 0;
+        if (!queue.try_pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t producer = static_cast<uint32_t>(item >> 32);
+        uint32_t sequence = static_cast<uint32_t>(item);
+        if (producer >= PRODUCERS || sequence != next[producer]) {
+            misordered++;
+        } else {
+            next[producer]++;
+        }
+        received++;
+    }
+    for (auto& thread : producers) thread.join();
+
+    uint64_t leftover = 0;
+    CHECK(!queue.try_pop(leftover));
+    CHECK(received == uint64_t(PRODUCERS) * PER_PRODUCER);
+    CHECK(misordered == 0);
+    CHECK(std::all_of(next.begin(), next.end(), [&](uint32_t count) { return count == PER_PRODUCER; }));
+    std::cout << "  " << received << " items, " << full_pushes.load() << " pushes found the queue full\n";
+}
+
+// ============================================================================
+// Broadcast
+// ============================================================================
+
+void test_broadcast() {
+    print_header("Broadcast: fan-out with exclude list");
+
+    start_p2p(P2PConfig{});
+
+    auto& p2p = P2PManager::instance();
+    const EOS_ProductUserId RELAY_SOURCE = reinterpret_cast<EOS_ProductUserId>(0x1002);
+    const EOS_ProductUserId OTHER = reinterpret_cast<EOS_ProductUserId>(0x1003);
+    p2p.connect_to_peer(RELAY_SOURCE);
+    p2p.connect_to_peer(OTHER);
+
+    // Loopback reports the destination as the sender
+    std::vector<EOS_ProductUserId> destinations;
+    p2p.on_packet_view = [&](const PacketView& packet) {
+        CHECK(packet.size == 4 && std::memcmp(packet.data, "ping", 4) == 0);
+        destinations.push_back(packet.sender);
+    };
+
+    p2p.broadcast_packet("ping", 4);
+    p2p.receive_packets(100);
+    CHECK(destinations.size() == 3);
+
+    destinations.clear();
+    p2p.broadcast_packet("ping", 4, 0, PacketReliability::UnreliableUnordered, {RELAY_SOURCE});
+    p2p.receive_packets(100);
+    CHECK(destinations.size() == 2);
+    CHECK(std::find(destinations.begin(), destinations.end(), RELAY_SOURCE) == destinations.end());
+
+    // Two broadcasts of a 5-byte frame ([type] + "ping") to PEER
+    auto conn = p2p.get_peer_connection(PEER);
+    CHECK(conn && conn->bytes_sent == 10);
+
+    p2p.disconnect_from_peer(OTHER);
+    destinations.clear();
+    p2p.broadcast_packet("ping", 4);
+    p2p.receive_packets(100);
+    CHECK(destinations.size() == 2);
+}
+
+// ============================================================================
+// Peer table
+// ============================================================================
+
+void test_peer_table() {
+    print_header("Peer table: churn and index lookups");
+
+    PeerTable table;
+    table.reset(64);
+
+    auto id = [](uint32_t n) {
+        return reinterpret_cast<EOS_ProductUserId>(static_cast<uintptr_t>(0x10000 + n * 16));
+    };
+
+    // Fill, then remove every third peer and re-add new ones, so probe
+    // runs get shifted by deletions
+    for (uint32_t i = 0; i < 64; i++) CHECK(table.insert(id(i)) != INVALID_PEER_INDEX);
+    CHECK(table.insert(id(1000)) == INVALID_PEER_INDEX);
+
+    for (uint32_t i = 0; i < 64; i += 3) CHECK(table.remove(id(i)));
+    for (uint32_t i = 100; i < 122; i++) CHECK(table.insert(id(i)) != INVALID_PEER_INDEX);
+    CHECK(table.size() == 64);
+
+    for (uint32_t i = 0; i < 64; i++) {
+        PeerIndex index = table.find(id(i));
+        if (i % 3 == 0) {
+            CHECK(index == INVALID_PEER_INDEX);
+        } else {
+            CHECK(index != INVALID_PEER_INDEX && table.hot(index).peer_id == id(i));
+        }
+    }
+    for (uint32_t i = 100; i < 122; i++) {
+        PeerIndex index = table.find(id(i));
+        CHECK(index != INVALID_PEER_INDEX && table.hot(index).peer_id == id(i));
+    }
+
+    // A slot taken by another peer is no longer current for the old one
+    PeerSlot slot = table.slot(table.find(id(1)));
+    CHECK(table.is_current(slot));
+    CHECK(table.remove(id(1)));
+    CHECK(!table.is_current(slot));
+    CHECK(table.insert(id(200)) == slot.index);
+    CHECK(!table.is_current(slot));
+    CHECK(table.is_current(table.slot(slot.index)));
+    CHECK(!table.is_current(PeerSlot()));
+
+    std::cout << "Index lookups through P2PManager\n";
+    start_p2p(P2PConfig{});
+    auto& p2p = P2PManager::instance();
+    PeerIndex index = p2p.get_peer_index(PEER);
+    CHECK(index != INVALID_PEER_INDEX);
+    auto conn = p2p.get_peer_connection_by_index(index);
+    CHECK(conn && conn->peer_id == PEER && conn->display_name == "StubPeer");
+
+    p2p.disconnect_from_peer(PEER);
+    CHECK(p2p.get_peer_index(PEER) == INVALID_PEER_INDEX);
+    CHECK(!p2p.get_peer_connection_by_index(index));
+}
+
+// ============================================================================
+// Link quality
+// ============================================================================
+
+void test_link_quality() {
+    print_header("Link quality: ping/pong RTT and loss");
+
+    auto network = std::make_shared<LoopbackNetwork>();
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.ping_interval_ms = 5;
+    config.ping_timeout_ms = 50;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    uint32_t delivered = 0;
+    a.on_packet_view = [&](const PacketView&) { delivered++; };
+    b.on_packet_view = [&](const PacketView&) { delivered++; };
+
+    // A pings, B answers; the sleep stands in for network delay
+    a.tick();
+    b.receive_packets(100);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    a.receive_packets(100);
+
+    auto conn = a.get_peer_connection(ENDPOINT_B);
+    CHECK(conn && conn->rtt_ms >= 2.0f && conn->rtt_ms < 1000.0f);
+    CHECK(conn && conn->ping_ms >= 2);
+    CHECK(conn && conn->packet_loss == 0.0f);
+    CHECK(delivered == 0);
+    if (conn) std::cout << "RTT " << conn->rtt_ms << " ms\n";
+
+    // B doesn't answer in time: the probe times out and counts as lost
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    a.tick();
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    a.tick();
+
+    conn = a.get_peer_connection(ENDPOINT_B);
+    float loss = conn ? conn->packet_loss : 0.0f;
+    CHECK(loss > 0.0f);
+    std::cout << "Loss after one timeout: " << loss << "\n";
+
+    // The late pong is ignored; answered probes pull the estimate back down
+    b.receive_packets(100);
+    a.receive_packets(100);
+    conn = a.get_peer_connection(ENDPOINT_B);
+    CHECK(conn && conn->packet_loss < loss);
+    CHECK(delivered == 0);
+}
+
+// ============================================================================
+// Loopback transport
+// ============================================================================
+
+/**
+ * Like EOS: receive() has to stay on the thread that sends and ticks.
+ */
+class TickThreadTransport : public Transport {
+public:
+    EOS_ProductUserId local_user_id() const override { return ENDPOINT_C; }
+    bool supports_threaded_receive() const override { return false; }
+    bool send(EOS_ProductUserId, uint8_t, const uint8_t*, uint32_t, PacketReliability, uint8_t) override {
+        return true;
+    }
+    bool receive(TransportPacketInfo&, uint8_t*, uint32_t) override { return false; }
+};
+
+void test_loopback_transport() {
+    print_header("Loopback transport: two endpoints in one process");
+
+    auto network = std::make_shared<LoopbackNetwork>();
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    CHECK(network->create_endpoint(ENDPOINT_A) == nullptr);
+
+    bool b_saw_a = false;
+    b.on_connection_established = [&](EOS_ProductUserId peer, ConnectionStatus) {
+        b_saw_a = (peer == ENDPOINT_A);
+    };
+
+    std::vector<std::vector<uint8_t>> received;
+    b.on_packet_view = [&](const PacketView& packet) {
+        CHECK(packet.sender == ENDPOINT_A);
+        received.emplace_back(packet.data, packet.data + packet.size);
+    };
+
+    // Real bytes cross between the managers, fragments included
+    a.connect_to_peer(ENDPOINT_B);
+    auto small = make_payload(100, 11);
+    auto large = make_payload(100 * 1024, 12);
+    CHECK(a.send_packet(ENDPOINT_B, small.data(), 100));
+    CHECK(a.send_packet(ENDPOINT_B, large.data(), 100 * 1024, 1, PacketReliability::ReliableOrdered));
+    b.receive_packets(1000);
+
+    CHECK(b_saw_a);
+    CHECK(b.is_connected_to(ENDPOINT_A));
+    CHECK(received.size() == 2);
+    CHECK(received.size() == 2 && received[0] == small && received[1] == large);
+
+    // And back the other way
+    bool a_got_reply = false;
+    a.on_packet_view = [&](const PacketView& packet) {
+        a_got_reply = packet.sender == ENDPOINT_B && packet.size == 5;
+    };
+    CHECK(b.send_packet(ENDPOINT_A, "reply", 5));
+    a.receive_packets(100);
+    CHECK(a_got_reply);
+
+    // Unknown destinations fail like a rejected EOS send
+    const EOS_ProductUserId NOBODY = reinterpret_cast<EOS_ProductUserId>(0x2999);
+    CHECK(!a.send_packet(NOBODY, "lost", 4));
+    CHECK(network->get_dropped_packet_count() == 1);
+
+    auto conn = a.get_peer_connection(ENDPOINT_B);
+    CHECK(conn && conn->bytes_sent > 100 * 1024);
+
+    // threaded_receive runs over loopback, but not over a transport that
+    // has to be read on the tick thread
+    P2PManager threaded;
+    config.threaded_receive = true;
+    config.transport = std::make_shared<TickThreadTransport>();
+    CHECK(!threaded.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_C);
+    CHECK(threaded.initialize(config));
+}
+
+void test_steady_state_allocations() {
+    print_header("Packet pool: steady-state send/receive allocates nothing");
+
+    auto network = std::make_shared<LoopbackNetwork>();
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+
+    uint64_t received = 0;
+    uint64_t bytes_received = 0;
+    b.on_packet_view = [&](const PacketView& packet) {
+        received++;
+        bytes_received += packet.size;
+    };
+    a.on_packet_view = [&](const PacketView&) {};
+
+    // A game-like frame: position spam, a couple of events, one fragmented
+    // message and a reply the other way
+    auto position = make_payload(64, 21);
+    auto event = make_payload(300, 22);
+    auto large = make_payload(4000, 23);
+    auto run_frame = [&] {
+        for (int i = 0; i < 20; i++) {
+            a.send_packet(ENDPOINT_B, position.data(), static_cast<uint32_t>(position.size()));
+        }
+        for (int i = 0; i < 2; i++) {
+            a.send_packet(ENDPOINT_B, event.data(), static_cast<uint32_t>(event.size()), 1,
+                          PacketReliability::ReliableOrdered);
+        }
+        a.send_packet(ENDPOINT_B, large.data(), static_cast<uint32_t>(large.size()), 1,
+                      PacketReliability::ReliableOrdered);
+        b.send_packet(ENDPOINT_A, position.data(), static_cast<uint32_t>(position.size()));
+        b.receive_packets(1000);
+        a.receive_packets(1000);
+    };
+
+    // Warm-up: connections, peer tables and scratch buffers reach size
+    for (int frame = 0; frame < 10; frame++) run_frame();
+    uint64_t received_before = received;
+
+    const int FRAMES = 500;
+    uint64_t allocations_before = t_allocations;
+    for (int frame = 0; frame < FRAMES; frame++) run_frame();
+    uint64_t allocations = t_allocations - allocations_before;
+
+    CHECK(received - received_before == uint64_t(FRAMES) * 23);
+    CHECK(allocations == 0);
+
+    // Everything fit in the pool, which never came close to its size
+    for (const P2PManager* manager : {&a, &b}) {
+        auto stats = manager->get_packet_pool_stats();
+        CHECK(stats.misses == 0);
+        CHECK(stats.oversize == 0);
+        CHECK(stats.in_use == 0);
+        CHECK(stats.high_water_mark > 0 && stats.high_water_mark < stats.slab_count / 4);
+    }
+    auto stats = b.get_packet_pool_stats();
+    std::cout << "  " << FRAMES << " frames, " << allocations << " allocations, pool high water "
+              << stats.high_water_mark << "/" << stats.slab_count << " slabs\n";
+}
+
+// ============================================================================
+// Network simulator
+// ============================================================================
+
+/**
+ * Sender endpoint and an impaired receiver on one LoopbackNetwork, with
+ * time stepped by hand.
+ */
+struct SimulatedLink {
+    explicit SimulatedLink(const NetworkConditions& conditions)
+        : network(std::make_shared<LoopbackNetwork>(16384)) {
+        sender = network->create_endpoint(ENDPOINT_A);
+        simulator = std::make_shared<NetworkSimulator>(network->create_endpoint(ENDPOINT_B), conditions, 1170,
+                                                       [this] { return now; });
+        simulator->open();
+    }
+
+    void send(uint32_t sequence) {
+        uint8_t packet[100] = {};
+        std::memcpy(packet, &sequence, sizeof(sequence));
+        sender->send(ENDPOINT_B, 0, packet, sizeof(packet), PacketReliability::UnreliableUnordered);
+    }
+
+    // Sequence numbers of everything due by now
+    std::vector<uint32_t> drain() {
+        std::vector<uint32_t> sequences;
+        TransportPacketInfo info;
+        uint8_t buffer[1170];
+        while (simulator->receive(info, buffer, sizeof(buffer))) {
+            uint32_t sequence;
+            std::memcpy(&sequence, buffer, sizeof(sequence));
+            sequences.push_back(sequence);
+        }
+        return sequences;
+    }
+
+    std::shared_ptr<LoopbackNetwork> network;
+    std::shared_ptr<Transport> sender;
+    std::shared_ptr<NetworkSimulator> simulator;
+    NetworkSimulator::Clock::time_point now = NetworkSimulator::Clock::time_point() + std::chrono::hours(1);
+};
+
+void test_network_simulator() {
+    print_header("Network simulator: latency, loss, duplication, reordering, bandwidth");
+
+    using std::chrono::milliseconds;
+
+    // Latency: nothing arrives early, everything arrives on time and in order
+    {
+        NetworkConditions conditions;
+        conditions.latency_ms = 100;
+        conditions.jitter_ms = 20;
+        SimulatedLink link(conditions);
+        for (uint32_t i = 0; i < 50; i++) link.send(i);
+        CHECK(link.drain().empty());    // Delay starts when the simulator sees them
+
+        link.now += milliseconds(79);
+        CHECK(link.drain().empty());
+        link.now += milliseconds(42);
+        auto arrived = link.drain();
+        CHECK(arrived.size() == 50);
+        CHECK(std::is_sorted(arrived.begin(), arrived.end()));
+    }
+
+    // Bursty loss: the configured rate, in runs of about the configured length
+    {
+        NetworkConditions conditions;
+        conditions.loss_rate = 0.2f;
+        conditions.loss_burst_length = 4.0f;
+        SimulatedLink link(conditions);
+
+        std::vector<uint32_t> arrived;
+        for (uint32_t i = 0; i < 20000; i++) {
+            link.send(i);
+            if (i % 1000 == 999) {
+                auto batch = link.drain();
+                arrived.insert(arrived.end(), batch.begin(), batch.end());
+            }
+        }
+
+        uint32_t bursts = 0;
+        uint32_t expected = 0;
+        for (uint32_t sequence : arrived) {
+            if (sequence != expected) bursts++;
+            expected = sequence + 1;
+        }
+        uint32_t lost = 20000 - static_cast<uint32_t>(arrived.size());
+        float burst_length = bursts > 0 ? static_cast<float>(lost) / bursts : 0.0f;
+        std::cout << "  Lost " << lost << " / 20000 in " << bursts << " bursts (mean " << burst_length << ")\n";
+
+        CHECK(lost > 3000 && lost < 5000);
+        CHECK(burst_length > 3.0f && burst_length < 5.0f);
+        CHECK(link.simulator->get_stats().lost == lost);
+
+        // Same seed, same losses
+        SimulatedLink replay(conditions);
+        std::vector<uint32_t> replayed;
+        for (uint32_t i = 0; i < 20000; i++) {
+            replay.send(i);
+            if (i % 1000 == 999) {
+                auto batch = replay.drain();
+                replayed.insert(replayed.end(), batch.begin(), batch.end());
+            }
+        }
+        CHECK(replayed == arrived);
+    }
+
+    // Duplication and reordering
+    {
+        NetworkConditions conditions;
+        conditions.latency_ms = 5;
+        conditions.duplicate_rate = 0.1f;
+        conditions.reorder_rate = 0.1f;
+        SimulatedLink link(conditions);
+
+        std::vector<uint32_t> arrived;
+        for (uint32_t i = 0; i < 1000; i++) {
+            link.send(i);
+            auto batch = link.drain();
+            arrived.insert(arrived.end(), batch.begin(), batch.end());
+            link.now += milliseconds(1);
+        }
+        link.now += milliseconds(100);
+        auto rest = link.drain();
+        arrived.insert(arrived.end(), rest.begin(), rest.end());
+
+        uint32_t out_of_order = 0;
+        for (size_t i = 1; i < arrived.size(); i++) {
+            if (arrived[i] < arrived[i - 1]) out_of_order++;
+        }
+        auto stats = link.simulator->get_stats();
+        CHECK(arrived.size() == 1000 + stats.duplicated);
+        CHECK(stats.duplicated > 50 && stats.duplicated < 150);
+        CHECK(stats.reordered > 50 && stats.reordered < 150);
+        CHECK(out_of_order > 0);
+        CHECK(stats.in_flight == 0);
+    }
+
+    // Bandwidth: 800 kbps = 100 bytes/ms, 16 KB burst, 200 ms queue
+    {
+        NetworkConditions conditions;
+        conditions.bandwidth_kbps = 800;
+        conditions.bandwidth_burst_bytes = 16 * 1024;
+        conditions.bandwidth_queue_ms = 200;
+        SimulatedLink link(conditions);
+
+        for (uint32_t i = 0; i < 500; i++) link.send(i);   // 50 KB at once
+        auto burst = link.drain();
+        CHECK(burst.size() == 163);     // 16384 / 100
+
+        link.now += milliseconds(100);
+        CHECK(link.drain().size() == 100);
+
+        link.now += milliseconds(1000);
+        size_t rest = link.drain().size();
+        auto stats = link.simulator->get_stats();
+        CHECK(rest + 263 == stats.delivered);
+        CHECK(stats.bandwidth_dropped == 500 - stats.delivered);
+        CHECK(stats.bandwidth_dropped > 100);
+    }
+
+    // Through P2PConfig: a managed link with real time
+    {
+        auto network = std::make_shared<LoopbackNetwork>();
+        P2PManager a;
+        P2PManager b;
+
+        P2PConfig config;
+        config.ping_interval_ms = 0;
+        config.transport = network->create_endpoint(ENDPOINT_A);
+        CHECK(a.initialize(config));
+        config.transport = network->create_endpoint(ENDPOINT_B);
+        config.network_conditions.latency_ms = 30;
+        CHECK(b.initialize(config));
+
+        uint32_t delivered = 0;
+        b.on_packet_view = [&](const PacketView&) { delivered++; };
+        a.connect_to_peer(ENDPOINT_B);
+        CHECK(a.send_packet(ENDPOINT_B, "late", 4));
+
+        b.receive_packets();
+        CHECK(delivered == 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        b.receive_packets();
+        CHECK(delivered == 1);
+        CHECK(b.get_network_simulator_stats().delivered == 1);
+        CHECK(a.get_network_simulator_stats().received == 0);
+    }
+}
+
+// ============================================================================
+// Custom reliability
+// ============================================================================
+
+void test_custom_reliability() {
+    print_header("Custom reliability: ack bitfields and resends over 20% loss");
+
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager a;
+    P2PManager b;
+
+    // Both directions lossy, so acks get lost too
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.custom_reliability = true;
+    config.reliability_min_rto_ms = 5;
+    config.network_conditions.loss_rate = 0.2f;
+    config.network_conditions.loss_burst_length = 2.0f;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.network_conditions.seed = 2;
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    std::vector<uint32_t> ordered;
+    std::vector<uint32_t> unordered;
+    std::vector<uint8_t> large_received;
+    b.on_packet_view = [&](const PacketView& packet) {
+        uint32_t value = 0;
+        if (packet.channel == 2) {
+            large_received.assign(packet.data, packet.data + packet.size);
+        } else if (packet.size == sizeof(value)) {
+            std::memcpy(&value, packet.data, sizeof(value));
+            (packet.channel == 0 ? ordered : unordered).push_back(value);
+        }
+    };
+
+    const uint32_t COUNT = 500;
+    auto large = make_payload(64 * 1024, 31);
+    for (uint32_t i = 0; i < COUNT; i++) {
+        CHECK(a.send_packet(ENDPOINT_B, &i, sizeof(i), 0, PacketReliability::ReliableOrdered));
+        CHECK(a.send_packet(ENDPOINT_B, &i, sizeof(i), 1, PacketReliability::ReliableUnordered));
+    }
+    CHECK(a.send_packet(ENDPOINT_B, large.data(), 64 * 1024, 2, PacketReliability::ReliableOrdered));
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while ((ordered.size() < COUNT || unordered.size() < COUNT || large_received.empty()) &&
+           std::chrono::steady_clock::now() < deadline) {
+        a.tick();
+        b.receive_packets(1000);
+        b.tick();
+        a.receive_packets(1000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Everything arrives exactly once; channel 0 in send order
+    CHECK(ordered.size() == COUNT);
+    bool in_order = true;
+    for (uint32_t i = 0; i < ordered.size(); i++) in_order = in_order && ordered[i] == i;
+    CHECK(in_order);
+
+    std::sort(unordered.begin(), unordered.end());
+    CHECK(unordered.size() == COUNT);
+    CHECK(std::adjacent_find(unordered.begin(), unordered.end()) == unordered.end());
+    CHECK(large_received == large);
+
+    // Let the last acks land, then nothing should be outstanding. A lost
+    // ack waits out a backed-off RTO, so allow a few seconds on a busy box.
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        a.tick();
+        b.receive_packets(1000);
+        b.tick();
+        a.receive_packets(1000);
+        auto stats = a.get_reliability_stats(ENDPOINT_B);
+        if (stats && stats->in_flight == 0 && stats->backlog == 0) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    auto stats = a.get_reliability_stats(ENDPOINT_B);
+    CHECK(stats.has_value());
+    if (stats) {
+        std::cout << "  Sent " << stats->packets_sent << ", resent " << stats->retransmits
+                  << ", RTO " << stats->rto_ms << " ms\n";
+        CHECK(stats->retransmits > 0);
+        CHECK(stats->packets_acked == stats->packets_sent);
+        CHECK(stats->in_flight == 0 && stats->backlog == 0);
+    }
+    CHECK(b.get_network_simulator_stats().lost > 0);
+
+    // Unreliable sends bypass the layer
+    CHECK(!b.get_reliability_stats(PEER).has_value());
+}
+
+// ============================================================================
+// Send scheduler
+// ============================================================================
+
+void test_send_scheduler() {
+    print_header("Send scheduler: priorities, weights, budget and drops");
+
+    using std::chrono::milliseconds;
+    PacketPool pool;
+    pool.reset(1170, 256);
+    auto start = SendScheduler::Clock::time_point() + std::chrono::hours(1);
+    uint8_t frame[100] = {};
+
+    SendScheduler::Settings settings;
+    settings.bytes_per_second = 10000;
+    settings.burst_bytes = 2000;
+    settings.max_unreliable_delay_ms = 100;
+    settings.quantum_bytes = 100;
+    settings.channel_priorities = {{0, 1}, {1, 1}, {0, 3}, {0, 1}};
+
+    // Position spam queued ahead of events still lets every event out first
+    SendScheduler scheduler;
+    scheduler.configure(settings, &pool);
+    for (int i = 0; i < 100; i++) {
+        CHECK(scheduler.enqueue(PEER, 0, frame, sizeof(frame), PacketReliability::UnreliableUnordered, start));
+    }
+    for (int i = 0; i < 10; i++) {
+        CHECK(scheduler.enqueue(PEER, 1, frame, sizeof(frame), PacketReliability::ReliableOrdered, start));
+    }
+
+    std::vector<SendScheduler::Frame> released;
+    scheduler.release(start, released);
+    CHECK(released.size() == 20);       // 2000 byte burst
+    bool events_first = released.size() == 20;
+    for (size_t i = 0; i < released.size(); i++) {
+        events_first = events_first && released[i].channel == (i < 10 ? 1 : 0);
+    }
+    CHECK(events_first);
+
+    // 50 ms refills 500 bytes; by 150 ms the rest of the positions are stale
+    released.clear();
+    scheduler.release(start + milliseconds(50), released);
+    CHECK(released.size() == 5);
+    released.clear();
+    scheduler.release(start + milliseconds(150), released);
+    auto stats = scheduler.get_stats(PEER);
+    CHECK(stats.has_value());
+    if (stats) {
+        std::cout << "  Sent " << stats->frames_sent << ", dropped " << stats->frames_dropped << " positions\n";
+        CHECK(stats->frames_sent + stats->frames_dropped == 110);
+        CHECK(stats->queued_frames == 0);
+    }
+
+    // Equal priority splits by weight: channel 2 gets three times channel 3
+    scheduler.configure(settings, &pool);
+    for (int i = 0; i < 60; i++) {
+        scheduler.enqueue(PEER, 2, frame, sizeof(frame), PacketReliability::UnreliableUnordered, start);
+        scheduler.enqueue(PEER, 3, frame, sizeof(frame), PacketReliability::UnreliableUnordered, start);
+    }
+    released.clear();
+    scheduler.release(start, released);
+    size_t heavy = std::count_if(released.begin(), released.end(),
+                                 [](const SendScheduler::Frame& f) { return f.channel == 2; });
+    std::cout << "  Weight 3:1 split " << heavy << ":" << released.size() - heavy << "\n";
+    CHECK(heavy == 15 && released.size() == 20);
+
+    // A full queue evicts the oldest unreliable frame of no higher priority;
+    // reliable frames evict any, and are queued even when none is left
+    settings.max_queued_bytes = 1000;
+    scheduler.configure(settings, &pool);
+    for (int i = 0; i < 10; i++) {
+        CHECK(scheduler.enqueue(PEER, 1, frame, sizeof(frame), PacketReliability::UnreliableUnordered, start));
+    }
+    CHECK(!scheduler.enqueue(PEER, 0, frame, sizeof(frame), PacketReliability::UnreliableUnordered, start));
+    CHECK(scheduler.enqueue(PEER, 1, frame, sizeof(frame), PacketReliability::UnreliableUnordered, start));
+    for (int i = 0; i < 12; i++) {
+        CHECK(scheduler.enqueue(PEER, 2, frame, sizeof(frame), PacketReliability::ReliableOrdered, start));
+    }
+    stats = scheduler.get_stats(PEER);
+    CHECK(stats && stats->frames_dropped == 12 && stats->queued_frames == 12);
+
+    // Through P2PManager: a 20 KB/s budget against 100 KB/s of positions
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.send_budget_bytes_per_second = 20000;
+    config.send_budget_burst_bytes = 2000;
+    config.channel_priorities = {{0, 1}, {1, 1}};
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    uint32_t positions = 0;
+    std::vector<uint32_t> events;
+    b.on_packet_view = [&](const PacketView& packet) {
+        if (packet.channel == 0) {
+            positions++;
+        } else {
+            uint32_t value;
+            std::memcpy(&value, packet.data, sizeof(value));
+            events.push_back(value);
+        }
+    };
+
+    uint8_t position[100] = {};
+    uint32_t next_event = 0;
+    for (int tick = 0; tick < 100; tick++) {
+        for (int i = 0; i < 10; i++) {
+            a.send_packet(ENDPOINT_B, position, sizeof(position), 0);
+        }
+        if (tick % 10 == 0) {
+            a.send_packet(ENDPOINT_B, &next_event, sizeof(next_event), 1, PacketReliability::ReliableOrdered);
+            next_event++;
+        }
+        a.tick();
+        b.receive_packets(1000);
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+
+    bool in_order = events.size() == next_event;
+    for (uint32_t i = 0; i < events.size(); i++) in_order = in_order && events[i] == i;
+    CHECK(in_order);
+
+    stats = a.get_send_queue_stats(ENDPOINT_B);
+    CHECK(stats.has_value());
+    if (stats) {
+        std::cout << "  Delivered " << events.size() << " events and " << positions << " of 1000 positions ("
+                  << stats->frames_dropped << " dropped, " << stats->queued_frames << " still queued)\n";
+        CHECK(stats->frames_dropped > 0);
+        CHECK(positions < 1000);
+    }
+}
+
+// ============================================================================
+// Snapshot replication
+// ============================================================================
+
+struct ReplicatedState {
+    float x, y, z;
+    float yaw;
+    uint16_t health;
+    uint8_t flags;
+    uint8_t team;
+};
+
+void test_snapshot_replicator() {
+    print_header("Snapshot replicator: deltas, parts, removal and loss fallback");
+
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager host;
+    P2PManager client;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(host.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(client.initialize(config));
+    host.connect_to_peer(ENDPOINT_B);
+
+    SnapshotReplicator sender(host);
+    SnapshotReplicator receiver(client);
+    uint8_t type = sender.register_type<ReplicatedState>();
+    CHECK(type == receiver.register_type<ReplicatedState>());
+    CHECK(sender.register_type(SnapshotReplicator::MAX_TYPE_SIZE + 1) == SnapshotReplicator::INVALID_TYPE);
+
+    bool drop_snapshots = false;
+    client.on_packet_view = [&](const PacketView& packet) {
+        if (!drop_snapshots) receiver.handle_packet(packet);
+    };
+    host.on_packet_view = [&](const PacketView& packet) { sender.handle_packet(packet); };
+
+    // 200 entities don't fit one packet
+    std::vector<ReplicatedState> world(200);
+    for (uint16_t id = 0; id < world.size(); id++) {
+        world[id] = {id * 1.0f, 0.0f, id * 2.0f, 0.0f, 100, 0, static_cast<uint8_t>(id % 2)};
+    }
+
+    auto step = [&]() {
+        for (uint16_t id = 0; id < world.size(); id++) {
+            if (world[id].health > 0) sender.set_entity(id, type, world[id]);
+        }
+        sender.commit();
+        uint32_t bytes = sender.send(ENDPOINT_B);
+        client.receive_packets(1000);
+        host.receive_packets(1000);
+        return bytes;
+    };
+
+    auto matches = [&]() {
+        for (uint16_t id = 0; id < world.size(); id++) {
+            ReplicatedState state;
+            bool present = receiver.get_entity(ENDPOINT_A, id, state);
+            if (present != (world[id].health > 0)) return false;
+            if (present && std::memcmp(&state, &world[id], sizeof(state)) != 0) return false;
+        }
+        return true;
+    };
+
+    uint32_t full_bytes = step();
+    CHECK(sender.get_stats().packets_sent > 1);
+    CHECK(receiver.get_latest_tick(ENDPOINT_A) == 1);
+    CHECK(matches());
+
+    // Five entities move: only their changed words go out
+    for (uint16_t id = 0; id < 5; id++) world[id].x += 0.5f;
+    uint32_t delta_bytes = step();
+    std::cout << "  Full snapshot " << full_bytes << " bytes, 5 moved " << delta_bytes << " bytes\n";
+    CHECK(delta_bytes < 100);
+    CHECK(matches());
+
+    // Nothing changed: header only, but still acked
+    CHECK(step() < 20);
+    CHECK(receiver.get_latest_tick(ENDPOINT_A) == 3);
+
+    // Removal
+    world[7].health = 0;
+    sender.remove_entity(7);
+    step();
+    CHECK(matches());
+    CHECK(receiver.get_entity_ids(ENDPOINT_A).size() == 199);
+
+    // Snapshots lost for longer than the history: back to full snapshots
+    uint64_t full_before = sender.get_stats().full_snapshots_sent;
+    drop_snapshots = true;
+    for (uint32_t tick = 0; tick < SnapshotReplicator::HISTORY + 2; tick++) {
+        world[tick % world.size()].yaw += 1.0f;
+        step();
+    }
+    CHECK(sender.get_stats().full_snapshots_sent > full_before);
+    drop_snapshots = false;
+
+    world[10].y = 42.0f;
+    step();
+    CHECK(matches());
+    step();
+    CHECK(step() < 20);
+    CHECK(receiver.get_stats().packets_rejected == 0);
+}
+
+// ============================================================================
+// Interest management
+// ============================================================================
+
+void test_interest_management() {
+    print_header("Interest management: relevance tiers, rates and filtered snapshots");
+
+    InterestManager interest;
+    interest.set_peer(ENDPOINT_A, 0.0f, 0.0f);
+    interest.set_peer(ENDPOINT_B, 1000.0f, 0.0f);
+    interest.set_entity(1, 10.0f, 0.0f);        // High for A
+    interest.set_entity(2, 50.0f, 20.0f);       // Medium for A
+    interest.set_entity(3, -200.0f, 0.0f);      // Low for A
+    interest.set_entity(4, 500.0f, 0.0f);       // Out of everyone's view
+    interest.set_entity(5, 1000.0f, 10.0f);     // High for B
+    interest.set_entity(6, 5000.0f, 5000.0f);
+    interest.set_always_relevant(6, true);
+    interest.update();
+
+    CHECK(interest.get_relevance(ENDPOINT_A, 1) == Relevance::High);
+    CHECK(interest.get_relevance(ENDPOINT_A, 2) == Relevance::Medium);
+    CHECK(interest.get_relevance(ENDPOINT_A, 3) == Relevance::Low);
+    CHECK(interest.get_relevance(ENDPOINT_A, 4) == Relevance::None);
+    CHECK(interest.get_relevance(ENDPOINT_A, 5) == Relevance::None);
+    CHECK(interest.get_relevance(ENDPOINT_B, 5) == Relevance::High);
+    CHECK(interest.get_relevance(ENDPOINT_B, 6) == Relevance::Low);
+    CHECK(interest.get_interest(ENDPOINT_A).size() == 4);
+    CHECK(interest.get_interest(ENDPOINT_C).empty());
+
+    std::vector<EOS_ProductUserId> peers;
+    interest.get_interested_peers(6, Relevance::Low, peers);
+    CHECK(peers.size() == 2);
+    interest.get_interested_peers(5, Relevance::Low, peers);
+    CHECK(peers.size() == 1 && peers[0] == ENDPOINT_B);
+    interest.get_interested_peers(2, Relevance::High, peers);
+    CHECK(peers.empty());
+
+    // Occlusion through the callback: entity 1 is behind a wall for A
+    interest.set_peer_callback(ENDPOINT_A, [](EOS_ProductUserId, uint16_t id, Relevance spatial) {
+        return id == 1 ? Relevance::Low : spatial;
+    });
+
+    // Rates: High every tick, Medium every 3rd, Low every 10th
+    uint32_t due[7] = {};
+    for (uint32_t tick = 0; tick < 30; tick++) {
+        interest.update();
+        for (const auto& entry : interest.get_interest(ENDPOINT_A)) due[entry.id] += entry.due;
+    }
+    std::cout << "  Due in 30 ticks: occluded " << due[1] << ", medium " << due[2] << ", low " << due[3] << "\n";
+    CHECK(due[1] == 3 && due[2] == 10 && due[3] == 3 && due[6] == 3);
+
+    // Moving across cells, and removal
+    interest.set_entity(4, 990.0f, 0.0f);
+    interest.remove_entity(5);
+    interest.update();
+    CHECK(interest.get_relevance(ENDPOINT_B, 4) == Relevance::High);
+    CHECK(interest.get_relevance(ENDPOINT_B, 5) == Relevance::None);
+    CHECK(interest.get_stats().entities == 5);
+
+    // Filtered snapshots: 100 entities along a line, the client sees 0..25
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager host;
+    P2PManager client;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(host.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(client.initialize(config));
+    host.connect_to_peer(ENDPOINT_B);
+
+    SnapshotReplicator sender(host);
+    SnapshotReplicator receiver(client);
+    uint8_t type = sender.register_type<ReplicatedState>();
+    receiver.register_type<ReplicatedState>();
+    host.on_packet_view = [&](const PacketView& packet) { sender.handle_packet(packet); };
+    client.on_packet_view = [&](const PacketView& packet) { receiver.handle_packet(packet); };
+
+    InterestManager world_interest;
+    sender.set_interest(&world_interest);
+    std::vector<ReplicatedState> world(100);
+    for (uint16_t id = 0; id < world.size(); id++) {
+        world[id] = {id * 10.0f, 0.0f, 0.0f, 0.0f, 100, 0, 0};
+    }
+
+    auto step = [&](float view_x) {
+        for (uint16_t id = 0; id < world.size(); id++) {
+            world[id].yaw += 1.0f;
+            sender.set_entity(id, type, world[id]);
+            world_interest.set_entity(id, world[id].x, world[id].y);
+        }
+        world_interest.set_peer(ENDPOINT_B, view_x, 0.0f);
+        world_interest.update();
+        sender.commit();
+        uint32_t bytes = sender.send(ENDPOINT_B);
+        client.receive_packets(1000);
+        host.receive_packets(1000);
+        return bytes;
+    };
+
+    auto visible = [&](uint16_t id) {
+        ReplicatedState state;
+        return receiver.get_entity(ENDPOINT_A, id, state);
+    };
+
+    uint32_t updates_near = 0;
+    uint32_t updates_far = 0;
+    float last_near = -1.0f;
+    float last_far = -1.0f;
+    uint64_t filtered_bytes = 0;
+    for (uint32_t tick = 0; tick < 30; tick++) {
+        filtered_bytes += step(0.0f);
+
+        ReplicatedState state;
+        CHECK(receiver.get_entity(ENDPOINT_A, 2, state) && state.yaw == world[2].yaw);
+        if (receiver.get_entity(ENDPOINT_A, 2, state) && state.yaw != last_near) {
+            last_near = state.yaw;
+            updates_near++;
+        }
+        if (receiver.get_entity(ENDPOINT_A, 20, state) && state.yaw != last_far) {
+            CHECK(world[20].yaw - state.yaw < 10.0f);
+            last_far = state.yaw;
+            updates_far++;
+        }
+    }
+    CHECK(receiver.get_entity_ids(ENDPOINT_A).size() == 26);
+    CHECK(visible(25) && !visible(26));
+    std::cout << "  Updates in 30 ticks: near " << updates_near << ", far " << updates_far << "\n";
+    CHECK(updates_near == 30 && updates_far == 4);     // Far: on arrival, then every 10th tick
+
+    // The same ticks unfiltered
+    sender.set_interest(nullptr);
+    uint64_t all_bytes = 0;
+    for (uint32_t tick = 0; tick < 30; tick++) all_bytes += step(0.0f);
+    CHECK(receiver.get_entity_ids(ENDPOINT_A).size() == 100);
+    std::cout << "  30 ticks: " << filtered_bytes << " bytes with interest, " << all_bytes << " without\n";
+    CHECK(filtered_bytes * 4 < all_bytes);
+
+    // Walking to the other end: entities behind drop out, ones ahead appear
+    sender.set_interest(&world_interest);
+    for (uint32_t tick = 0; tick < 3; tick++) step(990.0f);
+    CHECK(!visible(0) && !visible(73) && visible(74) && visible(99));
+    CHECK(receiver.get_entity_ids(ENDPOINT_A).size() == 26);
+    CHECK(receiver.get_stats().packets_rejected == 0);
+}
+
+// ============================================================================
+// Bit stream
+// ============================================================================
+
+void test_bit_stream() {
+    print_header("Bit stream: packing, quantization and overflow");
+
+    uint8_t buffer[256];
+    BitWriter writer(buffer, sizeof(buffer));
+    writer.write_bits(0x5, 3);
+    writer.write_bool(true);
+    writer.write_int(-7, -10, 10);
+    writer.write_bits(0xDEADBEEF, 32);
+    for (uint32_t value : {0u, 127u, 128u, 300000u, 0xFFFFFFFFu}) writer.write_varint(value);
+    writer.write_signed_varint(-3);
+    writer.write_signed_varint(-2147483647 - 1);
+    writer.write_float(3.14159f);
+    writer.write_float(12.345f, -100.0f, 100.0f, 16);
+    writer.write_float(500.0f, -100.0f, 100.0f, 8);    // Clamped
+    writer.write_vec3({1.5f, -250.25f, 511.0f}, -512.0f, 512.0f, 18);
+    writer.write_string("hello", 255);
+
+    // A quaternion per largest component, including a negative one
+    std::vector<Quat> rotations = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.7f, 0.1f, -0.1f, 0.7f},
+                                   {-0.9f, 0.3f, 0.2f, 0.25f}, {0.1f, 0.2f, -0.95f, 0.2f},
+                                   {0.2f, 0.97f, 0.1f, -0.05f}};
+    for (auto& q : rotations) {
+        float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        q = {q.x / length, q.y / length, q.z / length, q.w / length};
+        writer.write_quat(q, 10);
+    }
+    uint32_t size = writer.finish();
+    CHECK(size > 0 && !writer.overflowed());
+    std::cout << "  " << size << " bytes written\n";
+
+    BitReader reader(buffer, size);
+    CHECK(reader.read_bits(3) == 0x5);
+    CHECK(reader.read_bool());
+    CHECK(reader.read_int(-10, 10) == -7);
+    CHECK(reader.read_bits(32) == 0xDEADBEEF);
+    for (uint32_t value : {0u, 127u, 128u, 300000u, 0xFFFFFFFFu}) CHECK(reader.read_varint() == value);
+    CHECK(reader.read_signed_varint() == -3);
+    CHECK(reader.read_signed_varint() == -2147483647 - 1);
+    CHECK(reader.read_float() == 3.14159f);
+    CHECK(std::fabs(reader.read_float(-100.0f, 100.0f, 16) - 12.345f) < 200.0f / 65535.0f);
+    CHECK(reader.read_float(-100.0f, 100.0f, 8) == 100.0f);
+    Vec3 position = reader.read_vec3(-512.0f, 512.0f, 18);
+    float step = 1024.0f / ((1 << 18) - 1);
+    CHECK(std::fabs(position.x - 1.5f) <= step && std::fabs(position.y + 250.25f) <= step &&
+          std::fabs(position.z - 511.0f) <= step);
+    char text[16];
+    CHECK(reader.read_string(text, sizeof(text)) && std::strcmp(text, "hello") == 0);
+
+    // q and -q are the same rotation, so compare |dot|
+    float worst = 1.0f;
+    for (const auto& q : rotations) {
+        Quat decoded = reader.read_quat(10);
+        float dot = q.x * decoded.x + q.y * decoded.y + q.z * decoded.z + q.w * decoded.w;
+        worst = std::min(worst, std::fabs(dot));
+    }
+    std::cout << "  Worst quaternion |dot| " << worst << "\n";
+    CHECK(worst > 0.9999f);
+    CHECK(!reader.overflowed());
+    CHECK(reader.bits_remaining() < 8);
+
+    // Reading past the end yields zeros and a sticky flag
+    reader.read_bits(32);
+    CHECK(reader.overflowed());
+
+    // Writing past the end is flagged, not written
+    uint8_t small[5] = {};
+    BitWriter tight(small, 4);
+    tight.write_bits(0xFFFFFFFF, 32);
+    tight.write_bits(0xFF, 8);
+    CHECK(tight.finish() == 0 && tight.overflowed());
+    CHECK(small[4] == 0);
+
+    // A string longer than the destination is truncated
+    BitWriter long_writer(buffer, sizeof(buffer));
+    long_writer.write_string("a longer message", 255);
+    long_writer.write_bits(0x3, 2);
+    BitReader long_reader(buffer, long_writer.finish());
+    char clipped[8];
+    CHECK(!long_reader.read_string(clipped, sizeof(clipped)) && std::strcmp(clipped, "a longe") == 0);
+    CHECK(long_reader.read_bits(2) == 0x3 && !long_reader.overflowed());
+}
+
+// ============================================================================
+// Compression
+// ============================================================================
+
+std::vector<uint8_t> make_chat_message(uint32_t i) {
+    static const char* const LINES[] = {"gg", "nice shot!", "rotate to B", "need healing", "push now", "wp all"};
+    std::string text = "{\"type\":\"chat\",\"channel\":\"team\",\"sender\":\"Player" + std::to_string(i % 16) +
+                       "\",\"text\":\"" + LINES[i % 6] + "\",\"timestamp\":" + std::to_string(1700000000 + i * 37) + "}";
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+void test_compression() {
+    print_header("Compression: LZ codec, trained dictionary and compressed channels");
+
+    // Round trips, with repeats, without, and through a dictionary
+    std::vector<std::vector<uint8_t>> inputs = {make_payload(1000, 5), std::vector<uint8_t>(1000, 'x'),
+                                                make_chat_message(3)};
+    auto text = std::string(200, 'a') + "abcabcabcabc the quick brown fox, the quick brown fox";
+    inputs.emplace_back(text.begin(), text.end());
+
+    std::vector<std::vector<uint8_t>> samples;
+    for (uint32_t i = 0; i < 500; i++) samples.push_back(make_chat_message(i));
+    CompressionDictionary dictionary = CompressionDictionary::train(samples, 1024);
+    CHECK(!dictionary.empty() && dictionary.content().size() <= 1024);
+
+    std::vector<uint8_t> compressed(4096);
+    std::vector<uint8_t> restored(4096);
+    const CompressionDictionary* dictionaries[] = {nullptr, &dictionary};
+    for (const auto& input : inputs) {
+        for (const CompressionDictionary* dict : dictionaries) {
+            uint32_t size = lz_compress(input.data(), input.size(), compressed.data(), compressed.size(), dict);
+            CHECK(size > 0 && size <= lz_compress_bound(input.size()));
+            uint32_t restored_size = lz_decompress(compressed.data(), size, restored.data(), restored.size(), dict);
+            CHECK(restored_size == input.size() &&
+                  std::equal(input.begin(), input.end(), restored.begin()));
+        }
+    }
+    CHECK(lz_compress(inputs[1].data(), 1000, compressed.data(), compressed.size()) < 30);
+    CHECK(lz_compress(inputs[0].data(), 1000, compressed.data(), 500) == 0);
+
+    // The dictionary is what makes a lone short message shrink
+    auto chat = make_chat_message(1234);
+    uint32_t fast_size = lz_compress(chat.data(), chat.size(), compressed.data(), compressed.size());
+    uint32_t dict_size = lz_compress(chat.data(), chat.size(), compressed.data(), compressed.size(), &dictionary);
+    std::cout << "  " << chat.size() << " byte chat message: fast " << fast_size << ", dictionary " << dict_size << "\n";
+    CHECK(dict_size < chat.size() / 2 && dict_size < fast_size);
+
+    // Malformed input fails rather than overrunning
+    CHECK(lz_decompress(compressed.data(), dict_size, restored.data(), restored.size()) != chat.size());
+    CHECK(lz_decompress(compressed.data(), dict_size, restored.data(), chat.size() - 1, &dictionary) == 0);
+    const uint8_t bad_offset[] = {0x10, 'a', 0x00, 0x00};
+    CHECK(lz_decompress(bad_offset, sizeof(bad_offset), restored.data(), restored.size()) == 0);
+    const uint8_t truncated[] = {0xF0, 0xFF};
+    CHECK(lz_decompress(truncated, sizeof(truncated), restored.data(), restored.size()) == 0);
+
+    // Channel 1 fast, channel 2 dictionary, channel 3 plain
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager a;
+    P2PManager b;
+
+    auto shared = std::make_shared<CompressionDictionary>(dictionary);
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.channel_compression.resize(3);
+    config.channel_compression[1].mode = CompressionMode::Fast;
+    config.channel_compression[2] = {CompressionMode::Dictionary, shared};
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    std::vector<std::vector<uint8_t>> received[4];
+    b.on_packet_view = [&](const PacketView& packet) {
+        if (packet.channel < 4) received[packet.channel].emplace_back(packet.data, packet.data + packet.size);
+    };
+
+    // Reliable sizes above one packet go out as compressed fragments
+    auto repetitive = std::vector<uint8_t>(5000, 0);
+    for (uint32_t i = 0; i < repetitive.size(); i++) repetitive[i] = static_cast<uint8_t>(i % 50);
+    for (uint8_t channel = 1; channel <= 3; channel++) {
+        for (uint32_t i = 0; i < 20; i++) {
+            auto message = make_chat_message(i + 1000);
+            CHECK(a.send_packet(ENDPOINT_B, message.data(), message.size(), channel));
+        }
+        CHECK(a.send_packet(ENDPOINT_B, repetitive.data(), repetitive.size(), channel,
+                            PacketReliability::ReliableOrdered));
+    }
+    b.receive_packets(1000);
+
+    for (uint8_t channel = 1; channel <= 3; channel++) {
+        CHECK(received[channel].size() == 21);
+        bool intact = received[channel].size() == 21 && received[channel][20] == repetitive;
+        for (uint32_t i = 0; i < 20 && intact; i++) intact = received[channel][i] == make_chat_message(i + 1000);
+        CHECK(intact);
+    }
+
+    CompressionStats sent = a.get_compression_stats();
+    CompressionStats decoded = b.get_compression_stats();
+    std::cout << "  " << sent.frames_compressed << " frames compressed, " << sent.bytes_in << " -> "
+              << sent.bytes_out << " bytes\n";
+    CHECK(sent.frames_compressed >= 20 + 2);   // Every dictionary chat message and the fragments
+    CHECK(sent.bytes_out < sent.bytes_in / 2);
+    CHECK(decoded.frames_decompressed == sent.frames_compressed && decoded.decompress_failures == 0);
+
+    // A receiver with another dictionary drops rather than misdecodes
+    P2PManager c;
+    config.channel_compression[2].dictionary = std::make_shared<CompressionDictionary>(
+        std::vector<uint8_t>(64, 'z'));
+    config.transport = network->create_endpoint(ENDPOINT_C);
+    CHECK(c.initialize(config));
+    a.connect_to_peer(ENDPOINT_C);
+    uint32_t delivered = 0;
+    c.on_packet_view = [&](const PacketView&) { delivered++; };
+    auto message = make_chat_message(7);
+    CHECK(a.send_packet(ENDPOINT_C, message.data(), message.size(), 2));
+    c.receive_packets(10);
+    CHECK(delivered == 0 && c.get_compression_stats().decompress_failures == 1);
+
+    // A compressed frame claiming 0 bytes has no frame type to read, even
+    // right after a good frame left one in the decode buffer
+    std::vector<uint8_t> repeated(200, 'x');
+    CHECK(a.send_packet(ENDPOINT_C, repeated.data(), repeated.size(), 1));
+    c.receive_packets(10);
+    CHECK(delivered == 1);
+
+    const EOS_ProductUserId FORGER = reinterpret_cast<EOS_ProductUserId>(0x2999);
+    auto forger = network->create_endpoint(FORGER);
+    const uint8_t empty[] = {7, static_cast<uint8_t>(CompressionMode::Fast), 0, 0, 0, 0};
+    CHECK(forger->send(ENDPOINT_C, 1, empty, sizeof(empty), PacketReliability::UnreliableUnordered));
+    c.receive_packets(10);
+    CompressionStats forged = c.get_compression_stats();
+    CHECK(delivered == 1 && forged.decompress_failures == 2 && forged.frames_decompressed == 1);
+}
+
+// ============================================================================
+// Packet capture
+// ============================================================================
+
+void test_packet_capture() {
+    print_header("Packet capture: record a session, replay it deterministically");
+
+    const char* path = "p2p_stub_test.p2pcap";
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.capture_path = path;
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    std::vector<std::vector<uint8_t>> live;
+    b.on_packet_view = [&](const PacketView& packet) { live.emplace_back(packet.data, packet.data + packet.size); };
+
+    // Plain, batched and fragmented traffic, plus a reply from b
+    auto large = make_payload(10000, 17);
+    for (uint32_t i = 0; i < 50; i++) {
+        CHECK(a.send_packet(ENDPOINT_B, &i, sizeof(i), 0));
+        CHECK(a.queue_packet(ENDPOINT_B, &i, sizeof(i), 1));
+    }
+    a.flush_batches();
+    CHECK(a.send_packet(ENDPOINT_B, large.data(), large.size(), 2, PacketReliability::ReliableOrdered));
+    b.receive_packets(1000);
+    CHECK(b.send_packet(ENDPOINT_A, "ack", 3, 0));
+
+    CaptureStats stats = b.get_capture_stats();
+    CHECK(stats.packets_captured > 50 && stats.packets_dropped == 0);
+    b.shutdown();   // Flushes the file
+    a.shutdown();
+
+    std::vector<CaptureRecord> records;
+    CHECK(read_capture(path, records));
+    uint32_t sent = 0;
+    bool ordered = true;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (records[i].direction == CaptureDirection::Sent) sent++;
+        if (i > 0 && records[i].timestamp_us < records[i - 1].timestamp_us) ordered = false;
+    }
+    std::cout << "  " << records.size() << " packets captured, " << live.size() << " messages delivered live\n";
+    CHECK(records.size() == stats.packets_captured);
+    CHECK(sent == 1 && records.back().reliability == static_cast<uint8_t>(PacketReliability::UnreliableUnordered));
+    CHECK(ordered);
+
+    // Replay twice, as fast as possible: same messages as live, same order
+    for (int pass = 0; pass < 2; pass++) {
+        auto replay = std::make_shared<ReplayTransport>(records, 0.0);
+        P2PManager replayer;
+        P2PConfig replay_config;
+        replay_config.ping_interval_ms = 0;
+        replay_config.transport = replay;
+        CHECK(replayer.initialize(replay_config));
+
+        std::vector<std::vector<uint8_t>> replayed;
+        replayer.on_packet_view = [&](const PacketView& packet) {
+            replayed.emplace_back(packet.data, packet.data + packet.size);
+        };
+        while (!replay->finished()) replayer.receive_packets(1000);
+        CHECK(replayed == live);
+        CHECK(!records.empty() &&
+              replayer.get_peer_index(ReplayTransport::peer_id(records[0].peer)) != INVALID_PEER_INDEX);
+    }
+
+    // Truncated files return what is intact
+    std::vector<uint8_t> bytes(1 << 20);
+    std::FILE* file = std::fopen(path, "rb");
+    size_t size = file ? std::fread(bytes.data(), 1, bytes.size(), file) : 0;
+    if (file) std::fclose(file);
+    file = std::fopen(path, "wb");
+    CHECK(file != nullptr && size > 2);
+    if (file) {
+        std::fwrite(bytes.data(), 1, size - 2, file);
+        std::fclose(file);
+    }
+    std::vector<CaptureRecord> truncated;
+    CHECK(!read_capture(path, truncated) && truncated.size() == records.size() - 1);
+    std::remove(path);
+    CHECK(!read_capture(path, truncated));
+}
+
+// ============================================================================
+// Time sync
+// ============================================================================
+
+void test_time_sync() {
+    print_header("Time sync: offset filtering, slewing and P2PManager exchanges");
+
+    // Server clock 123 s ahead and running 50 ppm fast; each leg 1-5 ms
+    // with occasional 30 ms spikes on one side
+    uint64_t rng = 12345;
+    auto random_us = [&rng](uint32_t range) {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>((rng >> 33) % range);
+    };
+    auto true_server = [](uint64_t local_us) {
+        return local_us + 123000000 + local_us / 20000;
+    };
+
+    TimeSync sync;
+    uint64_t local = 1000000;
+    uint64_t last_server = 0;
+    bool monotonic = true;
+    int64_t worst_error = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        uint64_t up = 1000 + random_us(4000) + (i % 7 == 3 ? 30000 : 0);
+        uint64_t down = 1000 + random_us(4000);
+        sync.add_sample(local, true_server(local + up), local + up + down);
+        local += up + down;
+
+        // Read the clock through the next 100 ms
+        for (uint32_t step = 0; step < 10; step++) {
+            local += 10000;
+            uint64_t server = sync.server_time(local);
+            if (server < last_server) monotonic = false;
+            last_server = server;
+            int64_t error = static_cast<int64_t>(server - true_server(local));
+            if (i >= 16) worst_error = std::max(worst_error, error < 0 ? -error : error);
+        }
+    }
+    std::cout << "  Worst error after settling " << worst_error << " us\n";
+    CHECK(sync.is_synchronized() && monotonic);
+    CHECK(worst_error < 1000);
+
+    // A 5 ms correction slews in at 0.5% rather than jumping
+    TimeSync slewed;
+    const uint64_t SECOND = 1000000;
+    for (uint64_t t = 0; t < 10; t++) slewed.add_sample(t * SECOND, t * SECOND + 500 + 10 * SECOND, t * SECOND + 1000);
+    uint64_t before = slewed.server_time(10 * SECOND);
+    for (uint64_t t = 10; t < 20; t++) {
+        slewed.add_sample(t * SECOND, t * SECOND + 500 + 10005000, t * SECOND + 1000);
+        if (t == 10) CHECK(slewed.server_time(10 * SECOND + 100000) - before <= 100000 + 500);
+    }
+    CHECK(slewed.get_stats(20 * SECOND).target_offset_us == 10005000);
+    CHECK(slewed.get_stats(20 * SECOND).offset_us == 10005000);
+    CHECK(slewed.get_stats(20 * SECOND).steps == TimeSync::Settings().min_samples);
+
+    // Over a jittery simulated link; b is the authority
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager a;
+    P2PManager b;
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.time_sync_interval_ms = 50;
+    config.network_conditions.latency_ms = 10;
+    config.network_conditions.jitter_ms = 3;
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));   // Epochs differ
+    config.network_conditions.seed = 2;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    CHECK(!a.get_time_sync_stats().synchronized);
+    a.sync_time_to(ENDPOINT_B);
+    CHECK(!a.is_time_synchronized() && b.is_time_synchronized());
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+    while (std::chrono::steady_clock::now() < deadline) {
+        a.tick();
+        b.receive_packets(100);
+        b.tick();
+        a.receive_packets(100);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    CHECK(a.is_time_synchronized());
+    int64_t difference = static_cast<int64_t>(a.get_server_time_us()) - static_cast<int64_t>(b.get_server_time_us());
+    TimeSyncStats stats = a.get_time_sync_stats();
+    std::cout << "  " << stats.samples << " exchanges, best RTT " << stats.best_rtt_us << " us, clocks "
+              << difference << " us apart\n";
+    CHECK(stats.offset_us > 15000);   // b started 20 ms before a
+    CHECK(difference > -1000 && difference < 1000);
+}
+
+// ============================================================================
+// Jitter buffer
+// ============================================================================
+
+struct JitterState {
+    float x;
+    float y;
+};
+
+JitterState interpolate_jitter_state(const JitterState& from, const JitterState& to, float t) {
+    return {lerp(from.x, to.x, t), lerp(from.y, to.y, t)};
+}
+
+void test_jitter_buffer() {
+    print_header("Jitter buffer: ordering, adaptive delay, interpolation, no steady-state allocation");
+
+    // 20 Hz snapshots of 50 entities moving at 1 unit per ms, arriving
+    // 30 ms later plus 0-80 ms of jitter (so often out of order); rendered at 60 Hz
+    constexpr uint64_t INTERVAL_US = 50000;
+    constexpr uint64_t FRAME_US = 16667;
+    JitterBuffer<JitterState> buffer(interpolate_jitter_state);
+
+    struct Pending {
+        uint64_t timestamp;
+        uint64_t arrival;
+    };
+    std::vector<Pending> in_flight;
+    std::vector<JitterBuffer<JitterState>::Entity> entities(50);
+    std::vector<JitterBuffer<JitterState>::Entity> rendered;
+    uint32_t seed = 7;
+    auto jitter = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<uint64_t>(seed >> 8) % 80000;
+    };
+
+    uint64_t next_send = 1000000;
+    uint64_t last_render = 0;
+    uint64_t allocations = 0;
+    uint32_t frames = 0;
+    uint32_t bad_positions = 0;
+    uint32_t uneven_steps = 0;
+    for (uint64_t now = 1000000; now < 11000000; now += FRAME_US) {
+        while (next_send <= now) {
+            in_flight.push_back({next_send, next_send + 30000 + jitter()});
+            next_send += INTERVAL_US;
+        }
+
+        // Measured from 2 s in, once the buffer has settled
+        bool steady = now >= 3000000;
+        uint64_t allocations_before = t_allocations;
+
+        for (size_t i = 0; i < in_flight.size();) {
+            if (in_flight[i].arrival > now) {
+                i++;
+                continue;
+            }
+            uint64_t timestamp = in_flight[i].timestamp;
+            for (uint16_t id = 0; id < entities.size(); id++) {
+                // Entity 0 leaves after 6 s
+                if (id == 0 && timestamp >= 6000000) continue;
+                entities[id].id = id;
+                entities[id].state = {timestamp / 1000.0f + id, static_cast<float>(id)};
+            }
+            uint32_t count = static_cast<uint32_t>(entities.size());
+            if (timestamp >= 6000000) {
+                buffer.push(timestamp, now, entities.data() + 1, count - 1);
+            } else {
+                buffer.push(timestamp, now, entities.data(), count);
+            }
+            in_flight[i] = in_flight.back();
+            in_flight.pop_back();
+        }
+
+        uint64_t render_time = buffer.advance(now);
+        buffer.sample_all(render_time, rendered);
+        if (steady) allocations += t_allocations - allocations_before;
+        if (!steady || render_time == 0) {
+            last_render = render_time;
+            continue;
+        }
+
+        // Linear motion interpolates exactly; playout runs at 95-105% speed
+        frames++;
+        for (const auto& entity : rendered) {
+            if (entity.id == 0) continue;   // Held in place once it has left
+            if (std::fabs(entity.state.x - (render_time / 1000.0f + entity.id)) > 0.5f) bad_positions++;
+        }
+        uint64_t step = render_time - last_render;
+        if (step < FRAME_US * 95 / 100 || step > FRAME_US * 105 / 100 + 1) uneven_steps++;
+        last_render = render_time;
+    }
+
+    JitterStats stats = buffer.get_stats();
+    std::cout << "  Delay " << stats.delay_us / 1000.0 << " ms (jitter " << stats.jitter_us / 1000.0
+              << " ms, interval " << stats.interval_us / 1000.0 << " ms), " << stats.snapshots_late
+              << " late, " << stats.frames_extrapolated << " of " << stats.frames_rendered << " frames extrapolated\n";
+    std::cout << "  " << frames << " frames checked: " << bad_positions << " bad positions, " << uneven_steps
+              << " uneven steps, " << allocations << " allocations\n";
+    CHECK(stats.interval_us > 45000 && stats.interval_us < 55000);
+    CHECK(stats.delay_us > 130000 && stats.delay_us < 175000);
+    CHECK(bad_positions == 0);
+    CHECK(uneven_steps == 0);
+    CHECK(allocations == 0);
+    CHECK(stats.frames_extrapolated < stats.frames_rendered / 20);
+    CHECK(stats.buffered >= 2 && stats.buffered < 8);
+
+    // Entity 0 left; the others are all there
+    CHECK(rendered.size() == 49 && rendered.front().id == 1);
+    JitterState state;
+    CHECK(buffer.sample(last_render, 10, state) && std::fabs(state.y - 10.0f) < 0.001f);
+    CHECK(!buffer.sample(last_render, 0, state));
+
+    // Duplicates are dropped
+    uint64_t newest = buffer.newest_timestamp();
+    CHECK(!buffer.push(newest, 11000000, entities.data() + 1, 49));
+
+    // Sender stops: extrapolation runs on for 100 ms past the newest, then holds
+    uint64_t render_time = 0;
+    for (uint64_t now = 11000000; now < 11500000; now += FRAME_US) render_time = buffer.advance(now);
+    CHECK(render_time > newest + 200000);
+    CHECK(buffer.sample(render_time, 10, state));
+    CHECK(std::fabs(state.x - ((newest + 100000) / 1000.0f + 10)) < 0.5f);
+    CHECK(buffer.get_stats().frames_held > 0);
+}
+
+// ============================================================================
+// Congestion control
+// ============================================================================
+
+void test_congestion_control() {
+    print_header("Congestion control: AIMD on a bottleneck, snapshot pacing");
+
+    // A 20 ms path through a 100 KB/s bottleneck with a 200 ms buffer,
+    // dropping to 25 KB/s after 10 s. The sender always has data queued.
+    CongestionController controller;
+    controller.reset(0);
+    const uint64_t MS = 1000;
+    double queue = 0.0;
+    bool dropped = false;
+    double delivered[2] = {0.0, 0.0};     // Over the last 4 s of each phase
+    double delay_sum[2] = {0.0, 0.0};
+    uint32_t delay_samples[2] = {0, 0};
+    uint64_t backed_off_at = 0;
+    for (uint64_t now = MS; now <= 20000 * MS; now += MS) {
+        double capacity = now <= 10000 * MS ? 100000.0 : 25000.0;
+        uint32_t phase = now <= 10000 * MS ? 0 : 1;
+        bool measuring = now % (10000 * MS) > 6000 * MS || now % (10000 * MS) == 0;
+
+        double sent = controller.rate() / 1000.0;
+        double drained = std::min(queue + sent, capacity / 1000.0);
+        queue += sent - drained;
+        if (queue > capacity * 0.2) {
+            queue = capacity * 0.2;
+            dropped = true;
+        }
+        controller.update(static_cast<uint64_t>(sent), 1000, now);
+        if (measuring) delivered[phase] += drained;
+
+        if (now % (100 * MS) == 0) {
+            uint32_t delay_us = static_cast<uint32_t>(queue / capacity * 1e6);
+            if (dropped) {
+                controller.on_loss(now);
+            } else {
+                controller.on_rtt_sample(20 * MS + delay_us, now);
+            }
+            dropped = false;
+            if (measuring) {
+                delay_sum[phase] += delay_us / 1000.0;
+                delay_samples[phase]++;
+            }
+        }
+        if (phase == 1 && backed_off_at == 0 && controller.rate() < 25000 * 1.25) backed_off_at = now;
+    }
+
+    CongestionStats stats = controller.get_stats();
+    double utilization[2] = {delivered[0] / 4.0 / 100000.0, delivered[1] / 4.0 / 25000.0};
+    std::cout << "  Utilization " << utilization[0] * 100.0 << "% then " << utilization[1] * 100.0
+              << "%, queuing " << delay_sum[0] / delay_samples[0] << " then " << delay_sum[1] / delay_samples[1]
+              << " ms, backed off " << (backed_off_at - 10000 * MS) / 1000 << " ms after the drop\n";
+    std::cout << "  " << stats.decreases << " decreases (" << stats.delay_events << " delay, " << stats.loss_events
+              << " loss), base RTT " << stats.base_rtt_ms << " ms\n";
+    CHECK(!stats.slow_start && stats.decreases > 2);
+    CHECK(utilization[0] > 0.8 && utilization[1] > 0.8);
+    CHECK(delay_sum[0] / delay_samples[0] < 50.0 && delay_sum[1] / delay_samples[1] < 100.0);
+    CHECK(backed_off_at != 0 && backed_off_at - 10000 * MS < 1500 * MS);
+    CHECK(stats.base_rtt_ms >= 20.0f && stats.base_rtt_ms < 21.0f);
+
+    // A peer sending far below its rate doesn't get it raised
+    CongestionController idle;
+    idle.reset(0);
+    for (uint64_t now = 10 * MS; now <= 5000 * MS; now += 10 * MS) {
+        idle.update(10, 0, now);
+        if (now % (100 * MS) == 0) idle.on_rtt_sample(20 * MS, now);
+    }
+    CHECK(idle.get_stats().app_limited);
+    CHECK(idle.rate() == CongestionController::Settings().initial_bytes_per_second);
+
+    // A growing transport queue cuts the rate, once per response time
+    idle.on_backlog(5000 * MS);
+    idle.on_backlog(5001 * MS);
+    CHECK(idle.get_stats().backlog_events == 2 && idle.get_stats().decreases == 1);
+    CHECK(idle.rate() == CongestionController::Settings().min_bytes_per_second);
+
+    // Through P2PManager: the host floods snapshots at a client behind an
+    // 800 kbps (100 KB/s) link. Broadcast follows the host's rate for it;
+    // slow start overshoots, so losses are counted over the second half.
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager host;
+    P2PManager client;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;    // Congestion control probes anyway
+    config.congestion_control = true;
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(host.initialize(config));
+    config.congestion_control = false;
+    config.network_conditions.latency_ms = 10;
+    config.network_conditions.bandwidth_kbps = 800;
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(client.initialize(config));
+    host.connect_to_peer(ENDPOINT_B);
+    client.connect_to_peer(ENDPOINT_A);
+
+    SnapshotReplicator sender(host);
+    SnapshotReplicator receiver(client);
+    uint8_t type = sender.register_type<ReplicatedState>();
+    receiver.register_type<ReplicatedState>();
+    client.on_packet_view = [&](const PacketView& packet) { receiver.handle_packet(packet); };
+    host.on_packet_view = [&](const PacketView& packet) { sender.handle_packet(packet); };
+
+    std::vector<ReplicatedState> world(100);
+    auto start = std::chrono::steady_clock::now();
+    NetworkSimulatorStats halfway;
+    for (uint32_t tick = 0; std::chrono::steady_clock::now() < start + std::chrono::milliseconds(4000); tick++) {
+        if (halfway.received == 0 && std::chrono::steady_clock::now() > start + std::chrono::milliseconds(2000)) {
+            halfway = client.get_network_simulator_stats();
+        }
+        for (uint16_t id = 0; id < world.size(); id++) {
+            world[id] = {tick * 0.1f, id * 1.0f, 0.0f, tick * 0.01f, 100, 0, 0};
+            sender.set_entity(id, type, world[id]);
+        }
+        sender.commit();
+        sender.broadcast();
+        host.tick();
+        client.receive_packets(1000);
+        client.tick();
+        host.receive_packets(1000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto congestion = host.get_congestion_stats(ENDPOINT_B);
+    CHECK(congestion.has_value());
+    CHECK(!client.get_congestion_stats(ENDPOINT_A).has_value());
+    if (congestion) {
+        NetworkSimulatorStats link = client.get_network_simulator_stats();
+        uint64_t received = link.received - halfway.received;
+        uint64_t dropped = link.bandwidth_dropped - halfway.bandwidth_dropped;
+        std::cout << "  Over P2PManager: rate " << congestion->rate_bytes_per_second / 1024 << " KB/s, base RTT "
+                  << congestion->base_rtt_ms << " ms, " << congestion->decreases << " decreases, "
+                  << sender.get_stats().snapshots_sent << " snapshots sent, "
+                  << sender.get_stats().snapshots_deferred << " deferred; second half " << dropped << " of "
+                  << received << " packets dropped at the bottleneck\n";
+        CHECK(congestion->decreases > 1);
+        CHECK(congestion->rate_bytes_per_second > 30000 && congestion->rate_bytes_per_second < 250000);
+        CHECK(sender.get_stats().snapshots_deferred > sender.get_stats().snapshots_sent);
+        CHECK(receiver.get_stats().snapshots_received > 100);
+        CHECK(dropped * 10 < received);
+    }
+}
+
+// ============================================================================
+// Backpressure
+// ============================================================================
+
+/**
+ * Stands in for EOS's shared send queue: keeps what is sent until the
+ * test drains it.
+ */
+class QueueingTransport : public Transport {
+public:
+    EOS_ProductUserId local_user_id() const override { return ENDPOINT_A; }
+    bool send(EOS_ProductUserId, uint8_t, const uint8_t*, uint32_t size, PacketReliability, uint8_t) override {
+        queued += size;
+        return true;
+    }
+    bool receive(TransportPacketInfo&, uint8_t*, uint32_t) override { return false; }
+    uint64_t get_outgoing_queue_bytes() const override { return queued; }
+
+    uint64_t queued = 0;
+};
+
+void test_backpressure() {
+    print_header("Backpressure: queue depths, high-water marks, on_backpressure");
+
+    struct Event {
+        EOS_ProductUserId peer;
+        bool active;
+        uint64_t queued_bytes;
+    };
+    std::vector<Event> events;
+    auto record = [&](EOS_ProductUserId peer, bool active, uint64_t queued_bytes) {
+        events.push_back({peer, active, queued_bytes});
+    };
+
+    // Send scheduler mark: a 1 KB/s budget with no burst to speak of keeps
+    // frames queued. Channel 0 is low priority, channel 1 isn't.
+    auto network = std::make_shared<LoopbackNetwork>();
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    config.send_budget_bytes_per_second = 1000;
+    config.send_budget_burst_bytes = 1;
+    config.send_high_water_bytes = 3000;
+    config.channel_priorities = {{0, 1}, {1, 1}};
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    a.on_backpressure = record;
+    a.connect_to_peer(ENDPOINT_B);
+    b.connect_to_peer(ENDPOINT_A);
+
+    auto payload = make_payload(1000, 31);
+    for (uint32_t i = 1; i <= 3; i++) {
+        SendResult result = a.send_packet(ENDPOINT_B, payload.data(), 1000, 0);
+        CHECK(result.status == SendStatus::Queued);
+        CHECK(result.peer_queued_bytes == i * 1001 && result.channel_queued_bytes == i * 1001);
+    }
+
+    // Over the mark: low priority sends are turned away, others still queue
+    SendResult rejected = a.send_packet(ENDPOINT_B, payload.data(), 1000, 0);
+    CHECK(!rejected && rejected.status == SendStatus::Rejected);
+    CHECK(rejected.peer_queued_bytes == 3003 && rejected.channel_queued_bytes == 3003);
+    SendResult important = a.send_packet(ENDPOINT_B, payload.data(), 1000, 1);
+    CHECK(important.status == SendStatus::Queued);
+    CHECK(important.peer_queued_bytes == 4004 && important.channel_queued_bytes == 1001);
+    CHECK(!a.queue_packet(ENDPOINT_B, payload.data(), 100, 0));
+    a.broadcast_packet(payload.data(), 1000, 0);
+    CHECK(a.get_backpressure_rejected_count() == 3);
+    auto oversized = make_payload(4096, 32);
+    CHECK(a.send_packet(ENDPOINT_B, oversized.data(), 4096).status == SendStatus::Failed);
+
+    // tick() releases the channel 1 frame; the rest is still over the mark
+    a.tick();
+    CHECK(events.size() == 1);
+    if (events.size() == 1) {
+        CHECK(events[0].peer == ENDPOINT_B && events[0].active && events[0].queued_bytes == 3003);
+    }
+
+    // Unreliable frames expire after 100 ms, draining the queue
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    a.tick();
+    CHECK(events.size() == 2);
+    if (events.size() == 2) {
+        CHECK(events[1].peer == ENDPOINT_B && !events[1].active && events[1].queued_bytes == 0);
+    }
+    CHECK(a.send_packet(ENDPOINT_B, payload.data(), 1000, 0).status == SendStatus::Queued);
+
+    // Transport mark: the shared send queue backs up behind every peer
+    auto queueing = std::make_shared<QueueingTransport>();
+    P2PManager c;
+    config = P2PConfig();
+    config.ping_interval_ms = 0;
+    config.transport_high_water_bytes = 2000;
+    config.transport = queueing;
+    CHECK(c.initialize(config));
+    c.on_backpressure = record;
+    c.connect_to_peer(ENDPOINT_B);
+
+    for (int i = 0; i < 3; i++) {
+        SendResult result = c.send_packet(ENDPOINT_B, payload.data(), 1000);
+        CHECK(result.status == SendStatus::Sent && result.peer_queued_bytes == 0);
+    }
+    c.tick();
+    CHECK(events.size() == 3);
+    if (events.size() == 3) {
+        CHECK(events[2].peer == nullptr && events[2].active && events[2].queued_bytes == 3003);
+    }
+    rejected = c.send_packet(ENDPOINT_B, payload.data(), 1000);
+    CHECK(rejected.status == SendStatus::Rejected && rejected.transport_queued_bytes == 3003);
+
+    queueing->queued = 0;
+    c.tick();
+    CHECK(events.size() == 4 && !events.back().active);
+    CHECK(c.send_packet(ENDPOINT_B, payload.data(), 1000).status == SendStatus::Sent);
+    std::cout << "  " << a.get_backpressure_rejected_count() + c.get_backpressure_rejected_count()
+              << " sends rejected, " << events.size() << " backpressure events\n";
+}
+
+// ============================================================================
+// Sockets
+// ============================================================================
+
+void test_sockets() {
+    print_header("Sockets: per-socket queues, selective receive, send lanes");
+
+    auto network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager a;
+    P2PManager b;
+
+    // Socket 1 carries bulk data: reliable by default, compressed, and
+    // with room for 256 packets while gameplay is being drained
+    SocketConfig bulk_config;
+    bulk_config.name = "Bulk";
+    bulk_config.default_reliability = PacketReliability::ReliableOrdered;
+    bulk_config.channel_compression = {{CompressionMode::Fast, nullptr}};
+    bulk_config.incoming_queue_capacity = 256;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.sockets = {bulk_config};
+    config.additional_sockets = {"Voice"};
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(a.initialize(config));
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(b.initialize(config));
+    a.connect_to_peer(ENDPOINT_B);
+
+    CHECK(b.get_socket_count() == 3);
+    CHECK(b.get_socket_index("GameSocket") == uint8_t(0));
+    CHECK(b.get_socket_index("Bulk") == uint8_t(1));
+    CHECK(b.get_socket_index("Voice") == uint8_t(2));
+    CHECK(!b.get_socket_index("Missing"));
+    CHECK(!b.get_socket_stats(3));
+    CHECK(a.send_on_socket(3, ENDPOINT_B, "lost", 4).status == SendStatus::Failed);
+
+    P2PManager duplicate;
+    config.additional_sockets = {"Bulk"};
+    config.transport = network->create_endpoint(ENDPOINT_C);
+    CHECK(!duplicate.initialize(config));
+
+    struct Received {
+        uint8_t socket;
+        uint32_t value;
+    };
+    std::vector<Received> received;
+    b.on_packet_view = [&](const PacketView& packet) {
+        uint32_t value = 0;
+        std::memcpy(&value, packet.data, std::min<uint32_t>(packet.size, sizeof(value)));
+        received.push_back({packet.socket, value});
+    };
+
+    // Reliable bulk traffic floods socket 1 around gameplay packets while
+    // only socket 0 is drained. Past its 256-packet queue bulk overflows
+    // instead of stopping the read, so gameplay keeps arriving every frame.
+    const uint32_t FRAMES = 10;
+    const uint32_t BULK_PER_FRAME = 100;
+    uint32_t bulk_sent = 0;
+    bool gameplay_every_frame = true;
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        for (uint32_t i = 0; i < BULK_PER_FRAME; i++, bulk_sent++) {
+            CHECK(a.send_on_socket(1, ENDPOINT_B, &bulk_sent, sizeof(bulk_sent)));
+            if (i % 20 == 19) {
+                uint32_t value = frame;
+                CHECK(a.send_packet(ENDPOINT_B, &value, sizeof(value)));
+            }
+        }
+        received.clear();
+        gameplay_every_frame = gameplay_every_frame && b.receive_packets(100, socket_bit(0)) == 5 &&
+                               received.size() == 5 && received.back().socket == 0 &&
+                               received.back().value == frame;
+    }
+    CHECK(gameplay_every_frame);
+    CHECK(b.get_socket_stats(0)->packets_received == FRAMES * 5);
+
+    auto bulk_stats = b.get_socket_stats(1);
+    CHECK(bulk_stats && bulk_stats->queued_packets == bulk_sent);
+    CHECK(bulk_stats && bulk_stats->packets_overflowed == bulk_sent - 256);
+    CHECK(bulk_stats && bulk_stats->packets_received == 0 && bulk_stats->packets_dropped == 0);
+
+    // Nothing else can be queued from outside while the overflow is draining
+    IncomingPacket injected;
+    injected.socket = 1;
+    CHECK(!b.queue_incoming_packet(std::move(injected)));
+    CHECK(b.get_socket_stats(1)->packets_dropped == 1);
+
+    // Every bulk packet arrives, in order, across the queue and the overflow
+    received.clear();
+    CHECK(b.receive_packets(300, socket_bit(1)) == 300);
+    CHECK(b.receive_packets(10000) == bulk_sent - 300);
+    std::vector<uint32_t> bulk_values;
+    for (const Received& r : received) {
+        if (r.socket == 1) bulk_values.push_back(r.value);
+    }
+    bool in_order = bulk_values.size() == bulk_sent;
+    for (uint32_t i = 0; in_order && i < bulk_values.size(); i++) {
+        in_order = bulk_values[i] == i;
+    }
+    CHECK(in_order);
+    CHECK(b.get_socket_stats(1)->packets_received == bulk_sent);
+    CHECK(b.get_socket_stats(1)->queued_packets == 0);
+    CHECK(b.get_dropped_packet_count() == 1);
+
+    // Compression follows the socket's channel settings
+    std::vector<uint8_t> zeros(512, 0);
+    CHECK(a.send_packet(ENDPOINT_B, zeros.data(), 512));
+    CHECK(a.get_compression_stats().frames_compressed == 0);
+    CHECK(a.send_on_socket(1, ENDPOINT_B, zeros.data(), 512));
+    CHECK(a.get_compression_stats().frames_compressed == 1);
+    received.clear();
+    CHECK(b.receive_packets(10) == 2);
+    CHECK(received.size() == 2 && received[0].socket == 0 && received[1].socket == 1);
+    CHECK(b.get_compression_stats().frames_decompressed == 1);
+
+    // Send budget: the gameplay channel outranks the bulk socket, so it
+    // isn't stuck behind the bulk frames queued before it
+    network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager c;
+    P2PManager d;
+    config = P2PConfig();
+    config.ping_interval_ms = 0;
+    config.custom_reliability = true;
+    config.sockets = {bulk_config};
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(d.initialize(config));
+    config.send_budget_bytes_per_second = 100000;
+    config.send_budget_burst_bytes = 2000;
+    config.channel_priorities = {{1, 1}};
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(c.initialize(config));
+    c.connect_to_peer(ENDPOINT_B);
+
+    received.clear();
+    d.on_packet_view = b.on_packet_view;
+    auto chunk = make_payload(500, 41);
+    for (uint32_t i = 0; i < 10; i++) {
+        CHECK(c.send_on_socket(1, ENDPOINT_B, chunk.data(), 500).status == SendStatus::Queued);
+    }
+    uint32_t gameplay = 7;
+    CHECK(c.send_packet(ENDPOINT_B, &gameplay, sizeof(gameplay), 0, PacketReliability::ReliableOrdered));
+    c.tick();
+    d.receive_packets(100);
+    CHECK(!received.empty() && received[0].socket == 0 && received[0].value == gameplay);
+    CHECK(received.size() > 1 && received.size() < 11 && received.back().socket == 1);
+
+    // Each socket has its own sequence space
+    CHECK(c.get_reliability_stats(ENDPOINT_B, 0) && c.get_reliability_stats(ENDPOINT_B, 1));
+    CHECK(c.get_reliability_stats(ENDPOINT_B, 0)->packets_sent == 1);
+    // Same with the I/O thread reading the transport
+    network = std::make_shared<LoopbackNetwork>(8192);
+    P2PManager sender;
+    P2PManager threaded;
+    config = P2PConfig();
+    config.ping_interval_ms = 0;
+    config.sockets = {bulk_config};
+    config.transport = network->create_endpoint(ENDPOINT_A);
+    CHECK(sender.initialize(config));
+    config.threaded_receive = true;
+    config.transport = network->create_endpoint(ENDPOINT_B);
+    CHECK(threaded.initialize(config));
+    sender.connect_to_peer(ENDPOINT_B);
+
+    uint32_t gameplay_received = 0;
+    threaded.on_packet_view = [&](const PacketView& packet) {
+        if (packet.socket == 0) gameplay_received++;
+    };
+    for (uint32_t i = 0; i < 2000; i++) {
+        CHECK(sender.send_on_socket(1, ENDPOINT_B, &i, sizeof(i)));
+    }
+    CHECK(sender.send_packet(ENDPOINT_B, &gameplay, sizeof(gameplay)));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (gameplay_received == 0 && std::chrono::steady_clock::now() < deadline) {
+        threaded.receive_packets(100, socket_bit(0));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(gameplay_received == 1);
+    CHECK(threaded.get_socket_stats(1)->queued_packets == 2000);
+    CHECK(threaded.get_socket_stats(1)->packets_overflowed == 2000 - 256);
+    CHECK(threaded.receive_packets(5000, socket_bit(1)) == 2000);
+    threaded.shutdown();
+
+    std::cout << "  " << bulk_values.size() << " reliable bulk packets kept while set aside, "
+              << received.size() << " of 11 released by the first tick\n";
+}
+
+// ============================================================================
+// UDP transport
+// ============================================================================
+
+/**
+ * Receive until `done` holds; the kernel may take a moment to deliver.
+ */
+template <typename Done>
+void receive_until(P2PManager& p2p, Done done) {
+    for (int attempt = 0; attempt < 200 && !done(); attempt++) {
+        if (p2p.receive_packets(1000) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void test_udp_transport() {
+    print_header("UDP transport: two sockets on localhost");
+
+    auto transport_a = std::make_shared<UdpTransport>(0);
+    auto transport_b = std::make_shared<UdpTransport>(0);
+    P2PManager a;
+    P2PManager b;
+
+    P2PConfig config;
+    config.ping_interval_ms = 0;
+    config.transport = transport_a;
+    CHECK(a.initialize(config));
+    config.transport = transport_b;
+    CHECK(b.initialize(config));
+
+    const EOS_ProductUserId id_a = transport_a->local_user_id();
+    const EOS_ProductUserId id_b = transport_b->local_user_id();
+    CHECK(transport_b->local_port() != 0);
+    CHECK(UdpTransport::port_for_peer_id(id_b) == transport_b->local_port());
+    CHECK(UdpTransport::port_for_peer_id(PEER) == 0);
+
+    std::vector<std::vector<uint8_t>> received;
+    b.on_packet_view = [&](const PacketView& packet) {
+        CHECK(packet.sender == id_a);
+        received.emplace_back(packet.data, packet.data + packet.size);
+    };
+
+    // Plain and fragmented messages, addressed by port
+    a.connect_to_peer(id_b);
+    auto small = make_payload(100, 21);
+    auto large = make_payload(32 * 1024, 22);
+    CHECK(a.send_packet(id_b, small.data(), 100));
+    CHECK(a.send_packet(id_b, large.data(), 32 * 1024, 1, PacketReliability::ReliableOrdered));
+    receive_until(b, [&] { return received.size() >= 2; });
+
+    CHECK(b.is_connected_to(id_a));
+    CHECK(received.size() == 2 && received[0] == small && received[1] == large);
+
+    // Staged sends leave in one batch on flush
+    received.clear();
+    uint64_t send_calls = transport_a->get_send_call_count();
+    for (uint8_t i = 0; i < 8; i++) {
+        const uint8_t frame[2] = {0, i};     // Data frame carrying one byte
+        CHECK(transport_a->send(id_b, 0, frame, sizeof(frame), PacketReliability::UnreliableUnordered));
+    }
+    transport_a->flush();
+#ifdef __linux__
+    CHECK(transport_a->get_send_call_count() - send_calls == 1);
+#endif
+    receive_until(b, [&] { return received.size() >= 8; });
+    CHECK(received.size() == 8);
+    CHECK(received.size() == 8 && received[7].size() == 1 && received[7][0] == 7);
+
+    // Ids that don't name a port can't be sent to
+    CHECK(!a.send_packet(PEER, "lost", 4));
+    CHECK(transport_a->get_dropped_packet_count() == 0);
+    CHECK(transport_b->get_dropped_packet_count() == 0);
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main() {
+    PlatformConfig platform_config;
+    platform_config.product_name = "P2PStubTest";
+    platform_config.product_version = "1.0.0";
+    Platform::instance().initialize(platform_config);
+    AuthManager::instance().login_device_id("StubTester", nullptr);
+
+    test_fragmentation();
+    test_reassembly_budget();
+    test_batching();
+    test_ring_queue();
+    test_broadcast();
+    test_peer_table();
+    test_link_quality();
+    test_loopback_transport();
+    test_steady_state_allocations();
+    test_network_simulator();
+    test_custom_reliability();
+    test_send_scheduler();
+    test_snapshot_replicator();
+    test_interest_management();
+    test_bit_stream();
+    test_compression();
+    test_packet_capture();
+    test_time_sync();
+    test_jitter_buffer();
+    test_congestion_control();
+    test_backpressure();
+    test_sockets();
+    test_udp_transport();
+
+    P2PManager::instance().shutdown();
+    Platform::instance().shutdown();
+
+    if (g_failures > 0) {
+        std::cout << "\n" << g_failures << " check(s) FAILED\n";
+        return 1;
+    }
+
+    std::cout << "\nAll checks passed\n";
+    return 0;
+}
@@ -162,7 +162,7 @@ void test_p2p() {
         std::cout << "Sending test packet...\n";
         
         const char* message = "Hello, peer!";
-        bool sent = p2p.send_packet(fake_peer, message, strlen(message) + 1, 
+        auto sent = p2p.send_packet(fake_peer, message, strlen(message) + 1, 
                                      0, PacketReliability::ReliableOrdered);
         std::cout << "Packet sent: " << (sent ? "YES" : "NO") << "\n";
         